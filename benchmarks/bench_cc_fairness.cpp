@@ -0,0 +1,78 @@
+// Sharing of one bottleneck between two flows: each controller against
+// itself, Cubic against BBR and against LEDBAT, and a late starter joining
+// an established flow. Uses the LinkEmulator with a fixed path, a drop-tail
+// queue of one BDP, per-packet jitter and random loss. Reports each flow's
+// goodput and queueing delay and the pair's Jain fairness index. Runs in
+// simulated time, so an hour of transfer per pair takes seconds.
+//
+// Usage: bench_cc_fairness [seconds] [rtt-ms] [Mbit/s] [jitter-ms] [loss-percent]
+
+#include "cc_link_model.h"
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace LinkModel;
+
+namespace {
+
+struct Pair {
+    const char* title;
+    std::unique_ptr<Controller> first;
+    std::unique_ptr<Controller> second;
+    double secondStart;  // Seconds into the run
+};
+
+void runPair(Pair& pair, const LinkEmulator::Config& config, TimePoint start) {
+    LinkEmulator emulator(config, start);
+    emulator.addFlow(*pair.first);
+    emulator.addFlow(*pair.second, pair.secondStart);
+    Result result = emulator.run();
+
+    std::printf("%-18s", pair.title);
+    for (const auto& flow : result.flows) {
+        std::printf(" %-8s %8.2f %8.1f", flow.name.c_str(), flow.goodputMbps(), flow.averageQueueDelayMs);
+    }
+    std::printf(" %10.1f%% %8.3f\n", 100 * result.utilization(), result.fairness);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LinkEmulator::Config config;
+    config.seconds = argc > 1 ? std::atof(argv[1]) : 3600;
+    config.rtt = std::chrono::milliseconds(argc > 2 ? std::atoi(argv[2]) : 600);
+    config.bytesPerSecond = (argc > 3 ? std::atof(argv[3]) : 20) * 1e6 / 8;
+    config.jitter = std::chrono::milliseconds(argc > 4 ? std::atoi(argv[4]) : 5);
+    config.lossRate = (argc > 5 ? std::atof(argv[5]) : 0.01) / 100;
+    config.mss = MSS;
+    uint64_t bdp = static_cast<uint64_t>(config.bytesPerSecond * config.rtt.count() / 1e6);
+    config.bufferBytes = bdp;
+    config.receiveWindow = 4 * bdp;
+    TimePoint start = TimePoint() + std::chrono::hours(1);
+
+    std::printf("%.0f s simulated, %.0f ms RTT + up to %.0f ms jitter, %.0f Mbit/s, %.3f%% loss, 1 BDP of buffer\n\n",
+                config.seconds, config.rtt.count() / 1000.0, config.jitter.count() / 1000.0,
+                config.bytesPerSecond * 8 / 1e6, config.lossRate * 100);
+    std::printf("%-18s %-8s %8s %8s %-8s %8s %8s %11s %8s\n", "pair", "flow 1", "Mb/s", "queue ms", "flow 2", "Mb/s",
+                "queue ms", "utilization", "Jain");
+
+    double late = config.seconds / 4;
+    std::vector<Pair> pairs;
+    pairs.push_back(Pair{"Cubic/Cubic", std::make_unique<CubicController>(start),
+                         std::make_unique<CubicController>(start), 0});
+    pairs.push_back(Pair{"BBR/BBR", std::make_unique<BbrController>(start), std::make_unique<BbrController>(start), 0});
+    pairs.push_back(Pair{"SatOpt/SatOpt", std::make_unique<SatelliteController>(SatelliteOptimized::Options(), start),
+                         std::make_unique<SatelliteController>(SatelliteOptimized::Options(), start), 0});
+    pairs.push_back(Pair{"Cubic/BBR", std::make_unique<CubicController>(start), std::make_unique<BbrController>(start), 0});
+    pairs.push_back(Pair{"Cubic/LEDBAT", std::make_unique<CubicController>(start),
+                         std::make_unique<LedbatController>(start), 0});
+    pairs.push_back(Pair{"Cubic/late Cubic", std::make_unique<CubicController>(start),
+                         std::make_unique<CubicController>(start + std::chrono::microseconds(
+                                                                       static_cast<int64_t>(late * 1e6))),
+                         late});
+    for (auto& pair : pairs) {
+        runPair(pair, config, start);
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Goodput of Cubic and BBR over an emulated satellite bottleneck with
+// random (non-congestive) loss, with textbook Reno as a loss-based
+// reference. Uses the link model in cc_link_model.h with a fixed path: a
+// drop-tail queue of one BDP, a fixed propagation delay, and independent
+// random loss on the forward path. The receiver advertises a window of
+// four BDPs. Runs in simulated time, so minutes of transfer take a few
+// seconds.
+//
+// Usage: bench_cc_lossy_link [seconds] [loss-percent] [rtt-ms] [Mbit/s]
+
+#include "cc_link_model.h"
+#include <cstdlib>
+
+using namespace LinkModel;
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 120;
+    double lossRate = argc > 2 ? std::atof(argv[2]) / 100 : 0.01;
+    microseconds rtt = std::chrono::milliseconds(argc > 3 ? std::atoi(argv[3]) : 600);
+    double bytesPerSecond = (argc > 4 ? std::atof(argv[4]) : 50) * 1e6 / 8;
+    uint64_t bdp = static_cast<uint64_t>(bytesPerSecond * rtt.count() / 1e6);
+
+    std::printf("%.0f s simulated, %.0f ms RTT, %.0f Mbit/s bottleneck, 1 BDP of buffer\n", seconds,
+                rtt.count() / 1000.0, bytesPerSecond * 8 / 1e6);
+    TimePoint start = TimePoint() + std::chrono::hours(1);
+    for (double loss : {0.0, lossRate}) {
+        LinkConfig config;
+        config.seconds = seconds;
+        config.bufferBytes = bdp;
+        config.receiveWindow = 4 * bdp;
+        config.path = [=](double) { return PathState{rtt, bytesPerSecond, loss}; };
+
+        std::printf("\n%.2f%% random loss\n", loss * 100);
+        printHeader();
+        RenoController reno;
+        CubicController cubic(start);
+        BbrController bbr(start);
+        for (Controller* controller : std::initializer_list<Controller*>{&reno, &cubic, &bbr}) {
+            printResult(*controller, config, run(*controller, config, start));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Cubic, BBR and SatelliteOptimized on emulated satellite paths, using the
+// link model in cc_link_model.h.
+//
+//   GEO: 600 ms RTT, 50 Mbit/s, 0.1% random loss.
+//   LEO: Starlink-like. Every 15 s the terminal is handed to another
+//        satellite: the base RTT steps to a new value between 25 and 60 ms,
+//        the link is dark for 50 ms around the switch, and capacity changes
+//        with it. +/-2 ms of jitter and 0.05% random loss in between.
+//
+// SatelliteOptimized runs twice on LEO: detecting handovers from the RTT
+// alone, and with the 15 s schedule configured. The AdaptiveSelector starts
+// on Cubic and picks its own controller. LEDBAT is the scavenger for
+// background transfers: alone on the link it should use most of it with
+// the queue under its 25 ms target. On LEO nothing reports the handovers
+// to it, so a step to a longer path reads as queueing and it backs off.
+//
+//   GEO startup: the first 10 s of a transfer on a loss-free 600 ms,
+//        100 Mbit/s path, from the initial window and jump-started (+js)
+//        from an accurate path estimate and from one that has the
+//        bandwidth twice too high (+stale). t90 is the time to 90%
+//        utilization.
+//
+// Usage: bench_cc_satellite_paths [seconds]
+
+#include "cc_link_model.h"
+#include <cmath>
+#include <cstdlib>
+
+using namespace LinkModel;
+
+namespace {
+
+constexpr double HANDOVER_PERIOD_S = 15;
+constexpr double BLACKOUT_S = 0.05;
+
+PathState geoPath(double) {
+    return PathState{std::chrono::milliseconds(600), 50e6 / 8, 0.001};
+}
+
+PathState leoPath(double seconds) {
+    static const int rttsMs[] = {32, 48, 27, 55, 38, 60, 25, 44};
+    static const double mbps[] = {120, 90, 150, 80, 110, 70, 140, 100};
+    auto slot = static_cast<size_t>(seconds / HANDOVER_PERIOD_S);
+    double phase = std::fmod(seconds, HANDOVER_PERIOD_S);
+    // Deterministic jitter that changes every 10 ms
+    auto tick = static_cast<uint64_t>(seconds * 100);
+    int64_t jitterUs = static_cast<int64_t>((tick * 2654435761u) % 4001) - 2000;
+
+    PathState state;
+    state.rtt = std::chrono::milliseconds(rttsMs[slot % 8]) + microseconds(jitterUs);
+    state.bytesPerSecond = mbps[slot % 8] * 1e6 / 8;
+    state.lossRate = slot > 0 && phase < BLACKOUT_S ? 1.0 : 0.0005;
+    return state;
+}
+
+void runAll(const char* title, const LinkConfig& config, TimePoint start, bool scheduledVariant) {
+    std::printf("\n%s\n", title);
+    printHeader();
+    CubicController cubic(start);
+    BbrController bbr(start);
+    SatelliteController satellite(SatelliteOptimized::Options(), start);
+    LedbatController ledbat(start);
+    for (Controller* controller : std::initializer_list<Controller*>{&cubic, &bbr, &satellite, &ledbat}) {
+        printResult(*controller, config, run(*controller, config, start));
+    }
+    if (scheduledVariant) {
+        SatelliteOptimized::Options options;
+        options.handoverPeriod = std::chrono::milliseconds(static_cast<int64_t>(HANDOVER_PERIOD_S * 1000));
+        options.handoverEpoch = start;
+        SatelliteController scheduled(options, start, "SatOpt+s");
+        printResult(scheduled, config, run(scheduled, config, start));
+    }
+    AdaptiveController adaptive(start);
+    printResult(adaptive, config, run(adaptive, config, start));
+    std::printf("%-12s ended on %s after %llu switch(es)\n", "", AdaptiveSelector::algorithmName(adaptive.get().getAlgorithm()),
+                static_cast<unsigned long long>(adaptive.get().getSwitches()));
+}
+
+PathState geoStartupPath(double) {
+    return PathState{std::chrono::milliseconds(600), 100e6 / 8, 0};
+}
+
+void runStartup(const LinkConfig& config, TimePoint start) {
+    std::printf("\nGEO startup: 600 ms, 100 Mbit/s, no loss, first %.0f s\n", config.seconds);
+    printHeader();
+    PathEstimate accurate{static_cast<uint64_t>(100e6 / 8), std::chrono::milliseconds(600)};
+    PathEstimate stale{static_cast<uint64_t>(200e6 / 8), std::chrono::milliseconds(600)};
+    auto runVariants = [&](auto makeController, const char* jumpName, const char* staleName) {
+        auto plain = makeController();
+        printResult(plain, config, run(plain, config, start));
+        auto inner = makeController();
+        JumpStartController jumped(inner, accurate, jumpName);
+        printResult(jumped, config, run(jumped, config, start));
+        auto staleInner = makeController();
+        JumpStartController staleJump(staleInner, stale, staleName);
+        printResult(staleJump, config, run(staleJump, config, start));
+    };
+    runVariants([&] { return CubicController(start); }, "Cubic+js", "Cubic+stale");
+    runVariants([&] { return BbrController(start); }, "BBR+js", "BBR+stale");
+    runVariants([&] { return SatelliteController(SatelliteOptimized::Options(), start); }, "SatOpt+js",
+                "SatOpt+stale");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 120;
+    TimePoint start = TimePoint() + std::chrono::hours(1);
+    std::printf("%.0f s simulated; buffer of one BDP; receive window of four\n", seconds);
+
+    LinkConfig geo;
+    geo.seconds = seconds;
+    geo.bufferBytes = static_cast<uint64_t>(50e6 / 8 * 0.6);
+    geo.receiveWindow = 4 * geo.bufferBytes;
+    geo.path = geoPath;
+    runAll("GEO: 600 ms, 50 Mbit/s, 0.1% loss", geo, start, false);
+
+    LinkConfig leo;
+    leo.seconds = seconds;
+    leo.bufferBytes = static_cast<uint64_t>(150e6 / 8 * 0.06);
+    leo.receiveWindow = 4 * leo.bufferBytes;
+    leo.path = leoPath;
+    runAll("LEO: 25-60 ms, 70-150 Mbit/s, handover every 15 s", leo, start, true);
+
+    LinkConfig startup;
+    startup.seconds = std::min(seconds, 10.0);
+    startup.bufferBytes = static_cast<uint64_t>(100e6 / 8 * 0.6);
+    startup.receiveWindow = 4 * startup.bufferBytes;
+    startup.path = geoStartupPath;
+    runStartup(startup, start);
+    return 0;
+}
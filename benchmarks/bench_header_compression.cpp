@@ -0,0 +1,217 @@
+// Header compression over an emulated Iridium link. SRPT packets carrying
+// small payloads, as fit SBD messages, go through a TraceReplayProvider on
+// a ManualClock, with four packages in flight at a time and each new
+// package under a fresh random ID. Every run sends the same packets on the
+// same schedule. The first run sends them uncompressed. The later runs
+// compress them with a range of refresh intervals, with and without
+// feedback from the decompressor. Feedback reaches the compressor half an
+// RTT after it is raised.
+//
+// The built-in trace is Iridium-like: 2 kbit/s, an RTT that moves between
+// 1.2 and 2.6 s every 20 s, random loss from 0.5% to 6%, and an 8 s outage
+// every 3 minutes. A recorded trace can be given instead. Nothing is sent
+// during an outage.
+//
+// Reported per run:
+//   hdr/pkt    mean SRPT header bytes per packet on the wire
+//   saved      header bytes saved per packet against the raw header
+//   IR%        share of packets sent as refreshes
+//   link loss  packets the link lost
+//   ctx loss   packets that arrived but could not be restored, for want
+//              of a context: the IR starting their flow was lost, or
+//              reached the decompressor damaged
+//
+// Usage: bench_header_compression [seconds] [payload-bytes] [trace-file]
+
+#include "../src/common/clock.h"
+#include "../src/core/srpt_header_compression.h"
+#include "../src/satellite/trace_replay_provider.h"
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+using CongestionControl::LinkTrace;
+
+namespace {
+
+constexpr auto SEND_INTERVAL = 350ms;  // About 80% of 2 kbit/s with raw 50-byte packets
+constexpr auto STEP = 10ms;
+constexpr size_t FLOWS = 4;
+constexpr uint32_t PACKETS_PER_PACKAGE = 100;
+
+LinkTrace iridiumTrace() {
+    static const int rttsMs[] = {1500, 1200, 1800, 2600, 1400, 2100};
+    static const double lossRates[] = {0.005, 0.01, 0.03, 0.06, 0.01, 0.02};
+    LinkTrace trace;
+    trace.setProvider("iridium");
+    for (int i = 0; i < 90; ++i) {
+        LinkTrace::Sample sample;
+        sample.at = std::chrono::milliseconds(i * 20000);
+        sample.rtt = std::chrono::milliseconds(rttsMs[i % 6]);
+        sample.bitsPerSecond = 2000;
+        sample.lossRate = lossRates[(i / 2) % 6];
+        trace.addSample(sample);
+    }
+    for (int i = 1; i < 10; ++i) {
+        trace.addOutage(LinkTrace::Outage{std::chrono::milliseconds(i * 180000), 8s});
+    }
+    return trace;
+}
+
+struct Run {
+    const char* name;
+    bool compress;
+    uint32_t refreshInterval;
+    bool feedback;
+};
+
+struct Outcome {
+    uint64_t sent = 0;
+    uint64_t arrived = 0;
+    uint64_t restored = 0;
+    uint64_t headerBytesIn = 0;
+    uint64_t headerBytesOut = 0;
+    uint64_t refreshes = 0;
+};
+
+// Sends the packets of FLOWS packages round robin, starting a new package
+// when one is done
+class Traffic {
+public:
+    explicit Traffic(size_t payloadBytes) : payloadBytes_(payloadBytes) {
+        for (auto& flow : flows_) {
+            flow = {rng_(), 0};
+        }
+    }
+
+    SRPTPacket next() {
+        auto& flow = flows_[turn_++ % FLOWS];
+        if (flow.second == PACKETS_PER_PACKAGE) {
+            flow = {rng_(), 0};
+        }
+        std::vector<uint8_t> payload(payloadBytes_, static_cast<uint8_t>(flow.second));
+        return SRPTPacket(static_cast<uint8_t>(SRPTPacketType::DATA), flow.first, flow.second++,
+                          PACKETS_PER_PACKAGE, payload);
+    }
+
+private:
+    size_t payloadBytes_;
+    std::mt19937_64 rng_{42};
+    std::pair<uint64_t, uint32_t> flows_[FLOWS];
+    size_t turn_ = 0;
+};
+
+Outcome run(const Run& config, const LinkTrace& trace, std::chrono::seconds duration, size_t payloadBytes) {
+    Common::ManualClock clock;
+    TraceReplayProvider link(trace, clock);
+    link.Initialize({{"seed", "7"}});
+    link.Connect("iridium");
+
+    HeaderCompressor::Options options;
+    options.refreshInterval = config.refreshInterval;
+    HeaderCompressor compressor(options);
+    HeaderDecompressor decompressor;
+    std::deque<std::pair<Common::Clock::TimePoint, std::vector<uint8_t>>> feedback;
+    Traffic traffic(payloadBytes);
+    Outcome outcome;
+
+    auto end = clock.now() + duration;
+    auto nextSend = clock.now();
+    ByteVector bytes;
+    while (clock.now() < end) {
+        if (clock.now() >= nextSend) {
+            nextSend += SEND_INTERVAL;
+            if (!link.inOutage()) {
+                SRPTPacket packet = traffic.next();
+                size_t headerBytes = packet.encodedSize() - packet.getPayload().size();
+                outcome.headerBytesIn += headerBytes;
+                if (config.compress) {
+                    bytes = compressor.compress(packet);
+                } else {
+                    bytes = packet.toBytes();
+                    outcome.headerBytesOut += headerBytes;
+                }
+                if (link.SendData(bytes)) {
+                    ++outcome.sent;
+                }
+            }
+        }
+
+        while (link.ReceiveData(bytes)) {
+            ++outcome.arrived;
+            try {
+                if (config.compress) {
+                    decompressor.decompress(bytes);
+                } else {
+                    SRPTPacket::fromBytes(bytes);
+                }
+                ++outcome.restored;
+            } catch (const std::runtime_error&) {
+            }
+        }
+        if (config.feedback) {
+            auto ids = decompressor.takeFeedback();
+            if (!ids.empty()) {
+                auto delay = std::chrono::microseconds(static_cast<int64_t>(link.GetLatency() * 500));
+                feedback.emplace_back(clock.now() + delay, std::move(ids));
+            }
+            while (!feedback.empty() && feedback.front().first <= clock.now()) {
+                compressor.onFeedback(feedback.front().second);
+                feedback.pop_front();
+            }
+        }
+        clock.advance(STEP);
+    }
+
+    if (config.compress) {
+        outcome.headerBytesOut = compressor.getStats().headerBytesOut;
+        outcome.refreshes = compressor.getStats().refreshes;
+    }
+    return outcome;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto duration = std::chrono::seconds(argc > 1 ? std::atoi(argv[1]) : 1800);
+    size_t payloadBytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+    LinkTrace trace = iridiumTrace();
+    if (argc > 3 && !trace.load(argv[3])) {
+        std::fprintf(stderr, "%s: %s\n", argv[3], trace.getLastError().c_str());
+        return 1;
+    }
+
+    const Run runs[] = {
+        {"raw", false, 0, false},
+        {"refresh 16", true, 16, false},
+        {"refresh 32", true, 32, false},
+        {"refresh 64", true, 64, false},
+        {"refresh 32 + feedback", true, 32, true},
+        {"refresh 128 + feedback", true, 128, true},
+        {"on demand + feedback", true, 0, true},
+        {"on demand, no feedback", true, 0, false},
+    };
+
+    std::printf("%lld s of trace, %zu-byte payloads, a packet every %lld ms\n\n",
+                static_cast<long long>(duration.count()), payloadBytes,
+                static_cast<long long>(SEND_INTERVAL.count()));
+    std::printf("%-24s %8s %8s %8s %7s %10s %9s\n", "run", "sent", "hdr/pkt", "saved", "IR%", "link loss",
+                "ctx loss");
+    for (const auto& config : runs) {
+        Outcome outcome = run(config, trace, duration, payloadBytes);
+        double packets = outcome.sent > 0 ? static_cast<double>(outcome.sent) : 1;
+        double rawPerPacket = outcome.headerBytesIn / packets;
+        double perPacket = outcome.headerBytesOut / packets;
+        std::printf("%-24s %8llu %8.2f %8.2f %6.1f%% %9.2f%% %8.2f%%\n", config.name,
+                    static_cast<unsigned long long>(outcome.sent), perPacket, rawPerPacket - perPacket,
+                    100.0 * outcome.refreshes / packets, 100.0 * (outcome.sent - outcome.arrived) / packets,
+                    100.0 * (outcome.arrived - outcome.restored) / packets);
+    }
+    return 0;
+}
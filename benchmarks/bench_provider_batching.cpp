@@ -0,0 +1,103 @@
+// Provider queue throughput: one thread sends 1200-byte packets into a
+// StarlinkProvider's loopback queue while another drains it, first one
+// packet per call through SendData()/ReceiveData(), then in batches through
+// SendBatch()/ReceiveBatch(), which move the buffers instead of copying.
+// In the batched run the receiver hands drained buffers back to the sender
+// on a second ring, so packet memory is recycled rather than allocated and
+// copied per packet. A full queue pushes back on the sender, which yields
+// and retries.
+//
+// Usage: bench_provider_batching [packets] [batch]
+
+#include "../src/common/spsc_ring.h"
+#include "../src/satellite/starlink_provider.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t PACKET_SIZE = 1200;
+
+double runSingle(size_t packets) {
+    StarlinkProvider provider;
+    auto start = Clock::now();
+    std::thread sender([&] {
+        ByteVector packet(PACKET_SIZE);
+        for (size_t i = 0; i < packets; ++i) {
+            while (!provider.SendData(packet)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    ByteVector packet;
+    for (size_t received = 0; received < packets;) {
+        if (provider.ReceiveData(packet)) {
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    sender.join();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double runBatched(size_t packets, size_t batch) {
+    StarlinkProvider provider;
+    Common::SpscRing<ByteVector> recycled(8192);
+    auto start = Clock::now();
+    std::thread sender([&] {
+        std::vector<ByteVector> pending;
+        ByteVector buffer;
+        for (size_t sent = 0; sent < packets;) {
+            while (pending.size() < batch && sent + pending.size() < packets) {
+                if (!recycled.tryPop(buffer)) {
+                    buffer.resize(PACKET_SIZE);
+                }
+                pending.push_back(std::move(buffer));
+            }
+            size_t taken = provider.SendBatch(pending);
+            sent += taken;
+            if (taken == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::vector<ByteVector> received;
+    for (size_t count = 0; count < packets;) {
+        size_t got = provider.ReceiveBatch(received, batch);
+        count += got;
+        for (auto& buffer : received) {
+            recycled.tryPush(std::move(buffer));
+        }
+        received.clear();
+        if (got == 0) {
+            std::this_thread::yield();
+        }
+    }
+    sender.join();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* title, size_t packets, double seconds) {
+    std::printf("%-22s %10.2f %10.1f\n", title, packets / seconds / 1e6, packets * PACKET_SIZE / seconds / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    size_t batch = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 32;
+
+    std::printf("%zu packets of %zu bytes, batches of %zu\n\n", packets, PACKET_SIZE, batch);
+    std::printf("%-22s %10s %10s\n", "", "Mpkt/s", "MB/s");
+    report("SendData/ReceiveData", packets, runSingle(packets));
+    report("SendBatch/ReceiveBatch", packets, runBatched(packets, batch));
+    return 0;
+}
@@ -0,0 +1,113 @@
+// End-to-end throughput between two SatelliteSessions over an emulated
+// link, on real time. A sender thread writes fixed-size packets through the
+// ground session's stream at a fraction of the link rate; the terminal
+// session reads them and reports goodput, loss and one-way delay. Offered
+// loads above 100% show the bottleneck queue filling and dropping.
+//
+// Usage: bench_satellite_session [seconds] [rtt-ms] [Mbit/s] [loss-percent]
+
+#include "../src/satellite/emulated_link_provider.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t PACKET_SIZE = 1200;
+
+struct Outcome {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    double seconds = 0;
+    double averageDelayMs = 0;
+    double maxDelayMs = 0;
+};
+
+Outcome run(const EmulatedLink::Config& config, double offeredLoad, double seconds) {
+    auto endpoints = EmulatedLink::createPair(config);
+    EmulatedLinkProvider* receiver = endpoints.second.get();
+    SatelliteSession ground(std::move(endpoints.first));
+    SatelliteSession terminal(std::move(endpoints.second));
+    ground.Connect("terminal");
+    terminal.Connect("ground");
+    auto out = ground.CreateSatelliteStream();
+    auto in = terminal.CreateSatelliteStream();
+
+    Outcome outcome;
+    std::atomic<bool> sending{true};
+    double packetsPerSecond = offeredLoad * config.bitsPerSecond / 8.0 / PACKET_SIZE;
+    auto start = Clock::now();
+
+    std::thread sender([&] {
+        ByteVector packet(PACKET_SIZE);
+        while (true) {
+            auto now = Clock::now();
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            if (elapsed >= seconds) {
+                break;
+            }
+            // Catch up on every packet due by now, then sleep a millisecond
+            auto due = static_cast<uint64_t>(elapsed * packetsPerSecond);
+            for (; outcome.sent < due; ++outcome.sent) {
+                int64_t stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                std::memcpy(packet.data(), &stamp, sizeof(stamp));
+                out->Write(packet);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        sending = false;
+    });
+
+    double delaySum = 0;
+    ByteVector packet;
+    auto drainUntil = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)) +
+                      4 * config.delay + std::chrono::milliseconds(100);
+    while (sending || Clock::now() < drainUntil) {
+        receiver->waitForData(std::chrono::milliseconds(10));
+        while (in->Read(packet)) {
+            int64_t stamp = 0;
+            std::memcpy(&stamp, packet.data(), sizeof(stamp));
+            auto arrival = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            double delayMs = (arrival - stamp) / 1e6;
+            delaySum += delayMs;
+            outcome.maxDelayMs = std::max(outcome.maxDelayMs, delayMs);
+            ++outcome.received;
+        }
+    }
+    sender.join();
+    outcome.seconds = seconds;
+    outcome.averageDelayMs = outcome.received ? delaySum / outcome.received : 0;
+    return outcome;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 3;
+    EmulatedLink::Config config;
+    config.delay = std::chrono::microseconds(static_cast<int64_t>((argc > 2 ? std::atof(argv[2]) : 40) * 500));
+    config.bitsPerSecond = static_cast<uint64_t>((argc > 3 ? std::atof(argv[3]) : 50) * 1e6);
+    config.lossRate = (argc > 4 ? std::atof(argv[4]) : 0) / 100;
+
+    std::printf("%.1f s per run, %.1f ms RTT, %.1f Mbit/s, %.3f%% loss, %zu-byte packets, 1 BDP of buffer\n\n",
+                seconds, 2 * config.delay.count() / 1000.0, config.bitsPerSecond / 1e6, config.lossRate * 100,
+                PACKET_SIZE);
+    std::printf("%8s %10s %10s %8s %12s %12s\n", "offered", "sent", "received", "Mb/s", "avg delay ms",
+                "max delay ms");
+    for (double load : {0.25, 0.5, 0.9, 1.0, 1.2, 2.0}) {
+        Outcome outcome = run(config, load, seconds);
+        double goodput = outcome.received * PACKET_SIZE * 8 / outcome.seconds / 1e6;
+        std::printf("%7.0f%% %10llu %10llu %8.2f %12.1f %12.1f\n", load * 100,
+                    static_cast<unsigned long long>(outcome.sent), static_cast<unsigned long long>(outcome.received),
+                    goodput, outcome.averageDelayMs, outcome.maxDelayMs);
+    }
+    return 0;
+}
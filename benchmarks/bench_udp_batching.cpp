@@ -0,0 +1,215 @@
+// Loopback throughput of the UDP data path: one datagram per syscall versus
+// sendmmsg/recvmmsg batches, with and without UDP GSO/GRO. Each run encodes
+// SRPT DATA packets, sends them from one thread and receives and decodes
+// them on another; --no-codec sends pre-encoded bytes and skips decoding to
+// isolate the syscall cost.
+//
+// Usage: bench_udp_batching [packets] [payload-bytes] [--no-codec]
+
+#include "../src/core/srpt_packet.h"
+#include "../src/transport/udp_socket.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace SRPT::Transport;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum class Mode { PerDatagram, Batched, BatchedOffload };
+
+const char* modeName(Mode mode) {
+    switch (mode) {
+        case Mode::PerDatagram: return "sendto/recvfrom";
+        case Mode::Batched: return "sendmmsg/recvmmsg";
+        case Mode::BatchedOffload: return "sendmmsg/recvmmsg + GSO/GRO";
+    }
+    return "";
+}
+
+struct Result {
+    size_t sent = 0;
+    size_t received = 0;
+    size_t payloadBytes = 0;
+    size_t sendCalls = 0;
+    size_t receiveCalls = 0;
+    double seconds = 0;
+};
+
+constexpr size_t BATCH = 64;
+constexpr int SOCKET_BUFFER = 8 << 20;
+constexpr auto IDLE_TIMEOUT = std::chrono::milliseconds(200);
+
+bool useCodec = true;
+
+void sendAll(UdpSocket& socket, const Endpoint& peer, Mode mode, size_t packets, size_t payloadSize,
+             Result& result) {
+    std::vector<uint8_t> payload(payloadSize, 0xA5);
+    std::vector<SRPTPacket> batch;
+    std::vector<uint8_t> buffer;
+    std::vector<size_t> sizes;
+    std::vector<DatagramRef> refs;
+    std::vector<uint8_t> bytes;
+
+    for (size_t next = 0; next < packets;) {
+        size_t count = mode == Mode::PerDatagram ? 1 : std::min(BATCH, packets - next);
+        if (useCodec || batch.size() != count) {
+            batch.clear();
+            for (size_t i = 0; i < count; ++i) {
+                batch.emplace_back(static_cast<uint8_t>(SRPTPacketType::DATA), 1,
+                                   static_cast<uint32_t>(next + i), 0, payload);
+            }
+        }
+        if (mode == Mode::PerDatagram) {
+            if (useCodec || bytes.empty()) {
+                bytes = batch.front().toBytes();
+            }
+            while (socket.sendTo(bytes.data(), bytes.size(), peer) < 0) {
+                std::this_thread::yield();  // Socket buffer full
+            }
+            ++result.sendCalls;
+            ++next;
+            continue;
+        }
+
+        if (useCodec || buffer.empty() || sizes.size() != count) {
+            buffer.clear();
+            sizes.clear();
+            SRPTPacket::encodeBatch(batch, buffer, sizes);
+        }
+        refs.clear();
+        size_t offset = 0;
+        for (size_t size : sizes) {
+            refs.push_back(DatagramRef{&peer, buffer.data() + offset, size});
+            offset += size;
+        }
+        size_t done = 0;
+        while (done < refs.size()) {
+            ssize_t sent = socket.sendBatch(refs.data() + done, refs.size() - done);
+            ++result.sendCalls;
+            if (sent <= 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            done += static_cast<size_t>(sent);
+        }
+        next += count;
+    }
+    result.sent = packets;
+}
+
+void receiveAll(UdpSocket& socket, Mode mode, size_t packets, Result& result, std::atomic<bool>& ready,
+                Clock::time_point& last) {
+    std::vector<uint8_t> buffer(65535);
+    ReceiveBatch batch(BATCH);
+    std::vector<SRPTPacketView> views;
+    std::vector<SRPTPacket> decoded;
+    std::vector<size_t> indices;
+    Clock::time_point lastArrival = Clock::now();
+    ready = true;
+
+    while (result.received < packets && Clock::now() - lastArrival < IDLE_TIMEOUT) {
+        if (mode == Mode::PerDatagram) {
+            Endpoint peer;
+            ssize_t size = socket.receiveFrom(buffer.data(), buffer.size(), peer);
+            ++result.receiveCalls;
+            if (size < 0) {
+                continue;
+            }
+            if (useCodec) {
+                SRPTPacket packet = SRPTPacket::fromBytes(buffer.data(), static_cast<size_t>(size));
+                result.payloadBytes += packet.getPayload().size();
+            } else {
+                result.payloadBytes += static_cast<size_t>(size);
+            }
+            ++result.received;
+        } else {
+            ssize_t count = socket.receiveBatch(batch);
+            ++result.receiveCalls;
+            if (count < 0) {
+                continue;
+            }
+            if (useCodec) {
+                views.clear();
+                for (const auto& datagram : batch.datagrams()) {
+                    views.push_back(SRPTPacketView{datagram.data, datagram.size});
+                }
+                decoded.clear();
+                indices.clear();
+                SRPTPacket::decodeBatch(views, decoded, indices);
+                for (const auto& packet : decoded) {
+                    result.payloadBytes += packet.getPayload().size();
+                }
+                result.received += decoded.size();
+            } else {
+                for (const auto& datagram : batch.datagrams()) {
+                    result.payloadBytes += datagram.size;
+                }
+                result.received += batch.datagrams().size();
+            }
+        }
+        lastArrival = Clock::now();
+        last = lastArrival;
+    }
+}
+
+Result run(Mode mode, size_t packets, size_t payloadSize) {
+    UdpSocket receiver;
+    UdpSocket sender;
+    receiver.bind(Endpoint::loopback(0));
+    sender.bind(Endpoint::loopback(0));
+    receiver.setBufferSizes(SOCKET_BUFFER, SOCKET_BUFFER);
+    sender.setBufferSizes(SOCKET_BUFFER, SOCKET_BUFFER);
+    if (mode == Mode::BatchedOffload) {
+        if (!sender.enableGso() || !receiver.enableGro()) {
+            std::printf("  (GSO/GRO unavailable: %s)\n", sender.getLastError().c_str());
+        }
+    }
+
+    Result result;
+    Result sendResult;
+    std::atomic<bool> ready{false};
+    Clock::time_point last;
+    Endpoint peer = receiver.localEndpoint();
+
+    auto start = Clock::now();
+    std::thread receiveThread(receiveAll, std::ref(receiver), mode, packets, std::ref(result), std::ref(ready),
+                              std::ref(last));
+    while (!ready) {
+        std::this_thread::yield();
+    }
+    sendAll(sender, peer, mode, packets, payloadSize, sendResult);
+    receiveThread.join();
+
+    result.sent = sendResult.sent;
+    result.sendCalls = sendResult.sendCalls;
+    result.seconds = std::chrono::duration<double>((last == Clock::time_point() ? Clock::now() : last) - start).count();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t packets = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    size_t payloadSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1200;
+    useCodec = !(argc > 3 && std::strcmp(argv[3], "--no-codec") == 0);
+
+    std::printf("%zu packets, %zu-byte payload, loopback%s\n\n", packets, payloadSize,
+                useCodec ? "" : ", codec bypassed");
+    std::printf("%-30s %12s %10s %10s %12s %12s\n", "mode", "packets/s", "Gbit/s", "delivered", "send calls",
+                "recv calls");
+    for (Mode mode : {Mode::PerDatagram, Mode::Batched, Mode::BatchedOffload}) {
+        Result result = run(mode, packets, payloadSize);
+        double pps = result.received / result.seconds;
+        double gbps = result.payloadBytes * 8.0 / result.seconds / 1e9;
+        std::printf("%-30s %12.0f %10.2f %9.1f%% %12zu %12zu\n", modeName(mode), pps, gbps,
+                    100.0 * result.received / result.sent, result.sendCalls, result.receiveCalls);
+    }
+    return 0;
+}
@@ -0,0 +1,242 @@
+// Controller adapters and reporting for the congestion-control benchmarks,
+// on top of the LinkEmulator in the congestion_control library: a
+// drop-tail FIFO draining at the bottleneck rate, a propagation delay, and
+// independent random loss on the forward path. Rate, RTT and loss come
+// from a PathTrace evaluated at send time, so GEO and LEO paths (handover
+// RTT steps, outages) can be replayed. Everything runs in simulated time.
+#pragma once
+
+#include "../src/congestion_control/adaptive_selector.h"
+#include "../src/congestion_control/bbr.h"
+#include "../src/congestion_control/cubic.h"
+#include "../src/congestion_control/jump_start.h"
+#include "../src/congestion_control/ledbat.h"
+#include "../src/congestion_control/link_emulator.h"
+#include "../src/congestion_control/satellite_optimized.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace LinkModel {
+
+using namespace SRPT::CongestionControl;
+using TimePoint = std::chrono::steady_clock::time_point;
+using std::chrono::microseconds;
+
+constexpr uint32_t MSS = 1460;
+
+using Controller = LinkEmulator::Sender;
+using PathState = LinkEmulator::PathState;
+using PathTrace = LinkEmulator::PathTrace;
+using Result = LinkEmulator::Result;
+
+// Textbook AIMD, in packets
+class RenoController : public Controller {
+public:
+    const char* name() const override { return "Reno"; }
+    void sent(TimePoint) override {}
+    void acked(microseconds rtt, TimePoint) override {
+        lastRtt_ = rtt;
+        cwnd_ += cwnd_ < ssthresh_ ? 1.0 : 1.0 / cwnd_;
+    }
+    void lost(TimePoint now) override {
+        if (now >= recoveryEnd_) {
+            ssthresh_ = cwnd_ = std::max(cwnd_ / 2, 2.0);
+            recoveryEnd_ = now + lastRtt_;
+        }
+    }
+    uint64_t windowBytes() const override { return static_cast<uint64_t>(cwnd_) * MSS; }
+    double pacingRate() const override { return 0; }
+
+private:
+    double cwnd_ = 10;
+    double ssthresh_ = 1e9;
+    TimePoint recoveryEnd_;
+    microseconds lastRtt_{0};
+};
+
+// Cubic counts its window in packets
+class CubicController : public Controller {
+public:
+    explicit CubicController(TimePoint start) : cubic_(start) {}
+    const char* name() const override { return "Cubic"; }
+    void sent(TimePoint now) override { cubic_.onPacketSent(1, now); }
+    void acked(microseconds rtt, TimePoint now) override {
+        lastRtt_ = rtt;
+        cubic_.onAckReceived(1, std::chrono::duration_cast<std::chrono::milliseconds>(rtt), now);
+    }
+    void lost(TimePoint now) override {
+        // One window reduction per round trip, as in fast recovery
+        if (now >= recoveryEnd_) {
+            cubic_.onPacketLoss(now);
+            recoveryEnd_ = now + lastRtt_;
+        }
+    }
+    uint64_t windowBytes() const override { return static_cast<uint64_t>(cubic_.getCongestionWindow()) * MSS; }
+    double pacingRate() const override { return 0; }
+    void adopt(const ControllerState& state, TimePoint now) override { cubic_.adoptState(state, MSS, now); }
+
+private:
+    Cubic cubic_;
+    TimePoint recoveryEnd_;
+    microseconds lastRtt_{0};
+};
+
+class BbrController : public Controller {
+public:
+    explicit BbrController(TimePoint start) : bbr_(MSS, start) {}
+    const char* name() const override { return "BBR"; }
+    void sent(TimePoint now) override { bbr_.onPacketSent(MSS, now); }
+    void acked(microseconds rtt, TimePoint now) override { bbr_.onAckReceived(MSS, rtt, now); }
+    void lost(TimePoint now) override { bbr_.onPacketsLost(MSS, now); }
+    uint64_t windowBytes() const override { return bbr_.getCongestionWindow(); }
+    double pacingRate() const override { return bbr_.getSendingRate(); }
+    void adopt(const ControllerState& state, TimePoint now) override { bbr_.adoptState(state, now); }
+
+private:
+    Bbr bbr_;
+};
+
+class SatelliteController : public Controller {
+public:
+    SatelliteController(const SatelliteOptimized::Options& options, TimePoint start, const char* name = "SatOpt")
+        : controller_(options, start), name_(name) {}
+    const char* name() const override { return name_; }
+    void sent(TimePoint now) override { controller_.onPacketSent(MSS, now); }
+    void acked(microseconds rtt, TimePoint now) override { controller_.onAckReceived(MSS, rtt, now); }
+    void lost(TimePoint now) override { controller_.onPacketLoss(now); }
+    uint64_t windowBytes() const override { return controller_.getCongestionWindow(); }
+    double pacingRate() const override { return controller_.getSendingRate(); }
+    void adopt(const ControllerState& state, TimePoint now) override { controller_.adoptState(state, now); }
+    const SatelliteOptimized& get() const { return controller_; }
+
+private:
+    SatelliteOptimized controller_;
+    const char* name_;
+};
+
+class LedbatController : public Controller {
+public:
+    explicit LedbatController(TimePoint start) : controller_(Ledbat::Options(), start) {}
+    const char* name() const override { return "LEDBAT"; }
+    void sent(TimePoint now) override { controller_.onPacketSent(MSS, now); }
+    void acked(microseconds rtt, TimePoint now) override { controller_.onAckReceived(MSS, rtt, now); }
+    void lost(TimePoint now) override { controller_.onPacketLoss(now); }
+    uint64_t windowBytes() const override { return controller_.getCongestionWindow(); }
+    double pacingRate() const override { return controller_.getSendingRate(); }
+    void adopt(const ControllerState& state, TimePoint now) override { controller_.adoptState(state, now); }
+
+private:
+    Ledbat controller_;
+};
+
+class AdaptiveController : public Controller {
+public:
+    explicit AdaptiveController(TimePoint start) : selector_(AdaptiveSelector::Options(), start) {}
+    const char* name() const override { return "Adaptive"; }
+    void sent(TimePoint now) override { selector_.onPacketSent(MSS, now); }
+    void acked(microseconds rtt, TimePoint now) override { selector_.onAckReceived(MSS, rtt, now); }
+    void lost(TimePoint now) override { selector_.onPacketLoss(now); }
+    uint64_t windowBytes() const override { return selector_.getCongestionWindow(); }
+    double pacingRate() const override {
+        // Cubic is ack-clocked, the others pace
+        return selector_.getAlgorithm() == AdaptiveSelector::Algorithm::CUBIC ? 0 : selector_.getSendingRate();
+    }
+    const AdaptiveSelector& get() const { return selector_; }
+
+private:
+    AdaptiveSelector selector_;
+};
+
+// Any controller, jump-started from a path estimate (JumpStart). The jump
+// is planned on the first send; every loss during it counts, as the link
+// model does not classify them.
+class JumpStartController : public Controller {
+public:
+    JumpStartController(Controller& inner, const PathEstimate& estimate, const char* name)
+        : inner_(inner), estimate_(estimate), name_(name) {
+        JumpStart::Options options;
+        options.mss = MSS;
+        jump_ = JumpStart(options);
+    }
+    const char* name() const override { return name_; }
+    void sent(TimePoint now) override {
+        if (!planned_) {
+            planned_ = true;
+            ControllerState state;
+            if (jump_.plan(estimate_, static_cast<uint32_t>(inner_.windowBytes()), 0, state)) {
+                inner_.adopt(state, now);
+            }
+        }
+        inflight_ += MSS;
+        jump_.onPacketSent(MSS);
+        inner_.sent(now);
+    }
+    void acked(microseconds rtt, TimePoint now) override {
+        inflight_ -= std::min<uint64_t>(MSS, inflight_);
+        inner_.acked(rtt, now);
+        if (jump_.onAck(MSS, rtt)) {
+            inner_.adopt(jump_.retreatState(static_cast<uint32_t>(inflight_)), now);
+        }
+    }
+    void lost(TimePoint now) override {
+        inflight_ -= std::min<uint64_t>(MSS, inflight_);
+        if (jump_.onLoss()) {
+            inner_.adopt(jump_.retreatState(static_cast<uint32_t>(inflight_)), now);
+            return;
+        }
+        inner_.lost(now);
+    }
+    uint64_t windowBytes() const override { return inner_.windowBytes(); }
+    double pacingRate() const override {
+        if (jump_.getPhase() == JumpStart::Phase::UNVALIDATED && estimate_.valid()) {
+            // Spread the jump over one RTT even for an ack-clocked controller
+            return std::max(inner_.pacingRate(), static_cast<double>(jump_.getJumpWindow()) * 1e6 /
+                                                     estimate_.rtt.count());
+        }
+        return inner_.pacingRate();
+    }
+    JumpStart::Phase phase() const { return jump_.getPhase(); }
+
+private:
+    Controller& inner_;
+    PathEstimate estimate_;
+    const char* name_;
+    JumpStart jump_;
+    bool planned_ = false;
+    uint64_t inflight_ = 0;
+};
+
+struct LinkConfig {
+    double seconds = 120;
+    uint64_t bufferBytes = 0;   // Bottleneck queue
+    uint64_t receiveWindow = 0; // Cap on inflight
+    PathTrace path;
+};
+
+// One flow alone on the link
+inline Result run(Controller& controller, const LinkConfig& config, TimePoint start) {
+    LinkEmulator::Config emulated;
+    emulated.seconds = config.seconds;
+    emulated.bufferBytes = config.bufferBytes;
+    emulated.receiveWindow = config.receiveWindow;
+    emulated.mss = MSS;
+    emulated.path = config.path;
+    LinkEmulator emulator(emulated, start);
+    emulator.addFlow(controller);
+    return emulator.run();
+}
+
+inline void printHeader() {
+    std::printf("%-12s %12s %12s %10s %12s %12s %12s\n", "cc", "goodput Mb/s", "utilization", "t90 s", "queue ms",
+                "random loss", "queue drops");
+}
+
+inline void printResult(const Controller& controller, const LinkConfig& config, const Result& result) {
+    std::printf("%-12s %12.2f %11.1f%% %10.1f %12.1f %12llu %12llu\n", controller.name(),
+                result.goodputMbps(config.seconds), 100 * result.utilization(), result.secondsTo90,
+                result.averageQueueDelayMs, static_cast<unsigned long long>(result.randomLosses),
+                static_cast<unsigned long long>(result.queueDrops));
+}
+
+} // namespace LinkModel
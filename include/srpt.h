@@ -25,6 +25,15 @@ public:
     void setReceiveWindowSize(uint32_t size);
     void setMaxPacketSize(uint32_t size);
     // Add other configuration options as needed
+
+    std::chrono::seconds getKeepAliveInterval() const { return keepAliveInterval_; }
+    uint32_t getReceiveWindowSize() const { return receiveWindowSize_; }
+    uint32_t getMaxPacketSize() const { return maxPacketSize_; }
+
+private:
+    std::chrono::seconds keepAliveInterval_{60};
+    uint32_t receiveWindowSize_ = 65536;
+    uint32_t maxPacketSize_ = 1200;  // Payload bytes per datagram
 };
 
 class Stream {
@@ -42,6 +51,8 @@ public:
 
     bool Connect(const std::string& host, uint16_t port);
     bool Listen(uint16_t port);
+    // Local UDP port once connected or listening, e.g. after Listen(0)
+    uint16_t GetLocalPort() const;
     std::unique_ptr<Stream> CreateStream();
 
     ConnectionState GetState() const;
@@ -6,6 +6,7 @@
 #include <string>
 #include <map>
 #include <functional>
+#include <vector>
 
 namespace SRPT {
 namespace Satellite {
@@ -19,6 +20,8 @@ enum class Provider {
     // Add other providers as needed
 };
 
+class LinkTelemetry;
+
 class SatelliteConfig {
 public:
     const Provider& getProvider() const { return provider_; };
@@ -36,6 +39,11 @@ public:
     virtual bool Write(const ByteVector& data) override = 0;
     virtual bool Read(ByteVector& data) override = 0;
     virtual void Close() override = 0;
+
+    // Batch forms of Write() and Read(), with the provider's SendBatch()
+    // and ReceiveBatch() semantics
+    virtual size_t WriteBatch(std::vector<ByteVector>& packets);
+    virtual size_t ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets);
 };
 
 class ISatelliteProvider {
@@ -52,11 +60,66 @@ public:
     virtual uint64_t GetBandwidth() const = 0;
     virtual std::unique_ptr<SatelliteStream> CreateStream() = 0;  
     virtual void setVerboseLogging(bool verbose) = 0;
+
+    // Hands over packets from the front of `packets` until the provider
+    // pushes back, and removes the ones taken; what is left is the caller's
+    // to retry. Returns the number taken. Providers with their own queue
+    // move the buffers instead of copying them; the default sends one at a
+    // time through SendData().
+    virtual size_t SendBatch(std::vector<ByteVector>& packets);
+    // Appends up to maxPackets waiting packets; returns the number appended
+    virtual size_t ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets);
+
+    // Live measurements of this provider's link, or nullptr if it keeps
+    // none. Whoever sees acks and losses (e.g. PacketPacer) reports RTT
+    // samples and losses here; the provider records its own traffic.
+    virtual LinkTelemetry* GetTelemetry() { return nullptr; }
+};
+
+// Completion-based counterparts of SatelliteStream and ISatelliteProvider.
+// Every call returns at once; its completion runs later, on whatever thread
+// the implementation delivers completions to, never inside the call. Any
+// number of operations may be in flight. Operations on one provider take
+// effect in the order they were issued, and receives complete in arrival
+// order. Completions may be empty when the result does not matter.
+class AsyncSatelliteStream {
+public:
+    using Completion = std::function<void(bool ok)>;
+    using ReadCompletion = std::function<void(bool ok, ByteVector data)>;
+
+    virtual ~AsyncSatelliteStream() = default;
+    virtual void WriteAsync(ByteVector data, Completion done) = 0;
+    virtual void ReadAsync(ReadCompletion done) = 0;
+    virtual void Close() = 0;
+};
+
+class IAsyncSatelliteProvider {
+public:
+    using Completion = std::function<void(bool ok)>;
+    using ReceiveCompletion = std::function<void(bool ok, ByteVector data)>;
+    using CommandCompletion = std::function<void(bool ok, std::string response)>;
+
+    virtual ~IAsyncSatelliteProvider() = default;
+    virtual void InitializeAsync(const std::map<std::string, std::string>& options, Completion done) = 0;
+    virtual void ConnectAsync(const std::string& satellite_id, Completion done) = 0;
+    // Pending receives complete with ok == false
+    virtual void DisconnectAsync(Completion done) = 0;
+    virtual void SendAsync(ByteVector data, Completion done) = 0;
+    // Completes when a packet arrives, or fails on disconnect or shutdown
+    virtual void ReceiveAsync(ReceiveCompletion done) = 0;
+    virtual void ExecuteCommandAsync(const std::string& command, CommandCompletion done) = 0;
+    virtual double GetSignalStrength() const = 0;
+    virtual double GetLatency() const = 0;
+    virtual uint64_t GetBandwidth() const = 0;
+    virtual std::unique_ptr<AsyncSatelliteStream> CreateAsyncStream() = 0;
 };
 
 class SatelliteSession {
 public:
     SatelliteSession(const SatelliteConfig& config);
+    // Session over a provider built by the caller, e.g. one end of an
+    // emulated link
+    explicit SatelliteSession(std::unique_ptr<ISatelliteProvider> provider);
     virtual ~SatelliteSession();
 
     bool Connect(const std::string& satellite_id);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+
+namespace SRPT::Common {
+
+// Source of the current time for components that schedule or measure on
+// steady_clock. Production code uses SteadyClock; tests and simulations pass
+// a ManualClock so time only moves when they say so, which keeps results
+// independent of machine load and lets hours of protocol time run in
+// milliseconds. A component holds a reference to its clock, so the clock
+// must outlive it.
+class Clock {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    virtual ~Clock() = default;
+    virtual TimePoint now() const = 0;
+};
+
+class SteadyClock : public Clock {
+public:
+    TimePoint now() const override { return std::chrono::steady_clock::now(); }
+
+    // Shared default for components constructed without a clock
+    static const SteadyClock& instance() {
+        static const SteadyClock clock;
+        return clock;
+    }
+};
+
+// Time that only moves by advance() or set(). Not thread-safe: the test or
+// simulator that owns it drives it from one thread.
+class ManualClock : public Clock {
+public:
+    // Starts well after the epoch so that `now() - interval` stays valid
+    explicit ManualClock(TimePoint start = TimePoint() + std::chrono::hours(1)) : now_(start) {}
+
+    TimePoint now() const override { return now_; }
+
+    void advance(std::chrono::steady_clock::duration elapsed) { now_ += elapsed; }
+    void set(TimePoint now) { now_ = now; }
+
+private:
+    TimePoint now_;
+};
+
+} // namespace SRPT::Common
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace SRPT::Common {
+
+// Bounded queue between exactly one producer thread and one consumer
+// thread, without a lock. Each side owns one index and publishes it with a
+// release store; the other side's index is cached and only re-read when
+// the ring looks full or empty, so the two threads share a cache line only
+// when they have to. Elements are moved in and out, never copied.
+//
+// tryPush() fails when the ring is full and leaves the value with the
+// caller, which is the producer's backpressure signal. Capacity is rounded
+// up to a power of two, and may not exceed MAX_CAPACITY.
+template <typename T>
+class SpscRing {
+public:
+    static constexpr size_t MAX_CAPACITY = (std::numeric_limits<size_t>::max() >> 1) + 1;
+
+    explicit SpscRing(size_t capacity) : capacity_(roundUp(capacity)), mask_(capacity_ - 1), slots_(new T[capacity_]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only
+    bool tryPush(T&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == capacity_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == capacity_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool tryPop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // From either thread; already stale if the other side is running
+    size_t size() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    static size_t roundUp(size_t capacity) {
+        assert(capacity <= MAX_CAPACITY);
+        size_t rounded = 1;
+        while (rounded < capacity && rounded < MAX_CAPACITY) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // Consumer's line
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cachedTail_ = 0;
+
+    // Producer's line
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;
+};
+
+} // namespace SRPT::Common
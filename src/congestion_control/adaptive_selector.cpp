@@ -0,0 +1,457 @@
+#include "adaptive_selector.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+// A change in the RTT floor between rounds at least this large is a
+// candidate path change (the same size test as SatelliteOptimized)
+constexpr std::chrono::microseconds RTT_STEP_MIN{8000};
+constexpr double RTT_STEP_FRACTION = 0.2;
+constexpr std::chrono::seconds STEP_HOLD{1};
+// A loss with less queueing delay than max(4 ms, min RTT / 8) is random
+constexpr std::chrono::microseconds QUEUE_DELAY_MIN{4000};
+constexpr int QUEUE_DELAY_DIVISOR = 8;
+constexpr size_t MIN_RATE_SAMPLES = 3;
+constexpr std::chrono::microseconds DEFAULT_RTT{100000};  // Until the first sample
+}
+
+AdaptiveSelector::AdaptiveSelector() : AdaptiveSelector(Options()) {}
+
+AdaptiveSelector::AdaptiveSelector(const Options& options)
+    : AdaptiveSelector(options, std::chrono::steady_clock::now()) {}
+
+AdaptiveSelector::AdaptiveSelector(const Options& options, TimePoint start)
+    : options_(options),
+      cubic_(start),
+      bbr_(std::max<uint32_t>(options.mss, 1), start),
+      satellite_([&] {
+          SatelliteOptimized::Options satellite = options.satellite;
+          satellite.mss = std::max<uint32_t>(options.mss, 1);
+          return satellite;
+      }(), start),
+      active_(options.initial),
+      jump_([&] {
+          JumpStart::Options jump = options.jumpStart;
+          jump.mss = std::max<uint32_t>(options.mss, 1);
+          return jump;
+      }()),
+      min_rtt_(options.metricsWindow),
+      interval_start_(start),
+      pending_(options.initial),
+      last_switch_(start) {
+    options_.mss = std::max<uint32_t>(options_.mss, 1);
+    options_.evaluationInterval = std::max(options_.evaluationInterval, std::chrono::milliseconds(1));
+}
+
+void AdaptiveSelector::onPacketSent(uint32_t packetSize) {
+    onPacketSent(packetSize, std::chrono::steady_clock::now());
+}
+
+void AdaptiveSelector::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
+    onAckReceived(ackedBytes, rtt, std::chrono::steady_clock::now());
+}
+
+void AdaptiveSelector::onPacketLoss() {
+    onPacketLoss(std::chrono::steady_clock::now());
+}
+
+uint32_t AdaptiveSelector::getCongestionWindow() const {
+    if (active_ == Algorithm::CUBIC) {
+        // Cubic counts packets
+        uint64_t cwnd = static_cast<uint64_t>(cubic_.getCongestionWindow()) * options_.mss;
+        return static_cast<uint32_t>(std::min<uint64_t>(cwnd, std::numeric_limits<uint32_t>::max()));
+    }
+    return activeController().getCongestionWindow();
+}
+
+uint32_t AdaptiveSelector::getSendingRate() const {
+    if (active_ == Algorithm::CUBIC) {
+        // Cubic's own rate is in packets and timed from its last loss
+        auto rtt = metrics_.smoothedRtt.count() > 0 ? metrics_.smoothedRtt : DEFAULT_RTT;
+        double rate = static_cast<double>(getCongestionWindow()) * 1e6 / rtt.count();
+        return static_cast<uint32_t>(std::min(rate, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+    }
+    return activeController().getSendingRate();
+}
+
+void AdaptiveSelector::onPacketSent(uint32_t packetSize, TimePoint now) {
+    bytes_in_flight_ += packetSize;
+    jump_.onPacketSent(packetSize);
+    switch (active_) {
+        case Algorithm::CUBIC:
+            cubic_.onPacketSent(1, now);
+            break;
+        case Algorithm::BBR:
+            bbr_.onPacketSent(packetSize, now);
+            break;
+        case Algorithm::SATELLITE:
+            satellite_.onPacketSent(packetSize, now);
+            break;
+    }
+}
+
+void AdaptiveSelector::onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now) {
+    recordAck(ackedBytes, rtt, now);
+    switch (active_) {
+        case Algorithm::CUBIC:
+            ackCubic(ackedBytes, rtt, now);
+            break;
+        case Algorithm::BBR:
+            bbr_.onAckReceived(ackedBytes, rtt, now);
+            break;
+        case Algorithm::SATELLITE:
+            satellite_.onAckReceived(ackedBytes, rtt, now);
+            break;
+    }
+    if (jump_.onAck(ackedBytes, rtt)) {
+        adopt(active_, jump_.retreatState(bytes_in_flight_), now);
+    }
+    maybeEvaluate(now);
+}
+
+void AdaptiveSelector::onPacketLoss(TimePoint now) {
+    bytes_in_flight_ -= std::min(options_.mss, bytes_in_flight_);
+    bool random = recordLosses(1, LossCause::UNKNOWN);
+    if (!random && jump_.onLoss()) {
+        // Retreat in place of the controller's own loss response
+        adopt(active_, jump_.retreatState(bytes_in_flight_), now);
+        maybeEvaluate(now);
+        return;
+    }
+
+    switch (active_) {
+        case Algorithm::CUBIC:
+            cubic_.onPacketLoss(now);
+            break;
+        case Algorithm::BBR:
+            bbr_.onPacketsLost(options_.mss, now);
+            break;
+        case Algorithm::SATELLITE:
+            satellite_.onPacketLoss(now);
+            break;
+    }
+    maybeEvaluate(now);
+}
+
+void AdaptiveSelector::onAck(const AckEvent& ack) {
+    bool retreat = false;
+    if (ack.lostBytes > 0) {
+        bytes_in_flight_ -= std::min(ack.lostBytes, bytes_in_flight_);
+        bool random = recordLosses(std::max(ack.lostPackets, 1U), ack.lossCause);
+        retreat = !random && jump_.onLoss();
+    }
+    recordAck(ack.ackedBytes, ack.rtt, ack.now);
+    retreat = jump_.onAck(ack.ackedBytes, ack.rtt) || retreat;
+    if (retreat) {
+        adopt(active_, jump_.retreatState(bytes_in_flight_), ack.now);
+        maybeEvaluate(ack.now);
+        return;
+    }
+
+    switch (active_) {
+        case Algorithm::CUBIC:
+            if (ack.lostBytes > 0 && ack.lossCause != LossCause::WIRELESS) {
+                cubic_.onPacketLoss(ack.now);
+            }
+            ackCubic(ack.ackedBytes, ack.rtt, ack.now);
+            break;
+        case Algorithm::BBR:
+            bbr_.onAck(ack);
+            break;
+        case Algorithm::SATELLITE:
+            satellite_.onAck(ack);
+            break;
+    }
+    maybeEvaluate(ack.now);
+}
+
+AdaptiveSelector::Algorithm AdaptiveSelector::recommend() const {
+    bool long_rtt = metrics_.minRtt >= options_.longRtt;
+    bool handovers = metrics_.rttSteps >= options_.handoverSteps;
+    if (long_rtt || handovers) {
+        return Algorithm::SATELLITE;
+    }
+    // Heavy loss is Cubic's own doing as much as the path's, so it is only
+    // measured while Cubic runs, and remembered once it has been seen
+    bool cubic_failing = active_ == Algorithm::CUBIC ? metrics_.lossRate >= options_.failingLossRate
+                                                     : cubic_failed_;
+    bool lossy = metrics_.randomLossRate >= options_.lossyRate || cubic_failing;
+    if (lossy || metrics_.bandwidthVariation >= options_.bandwidthVariation) {
+        return Algorithm::BBR;
+    }
+    return Algorithm::CUBIC;
+}
+
+void AdaptiveSelector::switchTo(Algorithm algorithm, TimePoint now) {
+    pending_count_ = 0;
+    if (algorithm == active_) {
+        return;
+    }
+    adopt(algorithm, exportState(), now);
+    ++departures_[static_cast<size_t>(active_)];
+    active_ = algorithm;
+    last_switch_ = now;
+    ++switches_;
+}
+
+bool AdaptiveSelector::jumpStart(const PathEstimate& estimate, TimePoint now) {
+    ControllerState state;
+    if (!jump_.plan(estimate, getCongestionWindow(), bytes_in_flight_, state)) {
+        return false;
+    }
+    adopt(active_, state, now);
+    return true;
+}
+
+void AdaptiveSelector::warmStart(const PathCache::Entry& entry, TimePoint now) {
+    Algorithm algorithm = active_;
+    if (entry.minRtt >= options_.longRtt) {
+        algorithm = Algorithm::SATELLITE;
+    } else if (entry.lossRate >= options_.lossyRate) {
+        algorithm = Algorithm::BBR;
+    }
+    if (algorithm != active_) {
+        switchTo(algorithm, now);
+        // A choice made before the first packet is not a departure
+        departures_.fill(0);
+        switches_ = 0;
+        pending_ = algorithm;
+    }
+    jumpStart(entry.estimate(), now);
+}
+
+void AdaptiveSelector::adopt(Algorithm algorithm, const ControllerState& state, TimePoint now) {
+    switch (algorithm) {
+        case Algorithm::CUBIC:
+            cubic_ack_credit_ = 0;
+            cubic_.adoptState(state, options_.mss, now);
+            break;
+        case Algorithm::BBR:
+            bbr_.adoptState(state, now);
+            break;
+        case Algorithm::SATELLITE:
+            satellite_.adoptState(state, now);
+            break;
+    }
+}
+
+const char* AdaptiveSelector::algorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::CUBIC:
+            return "cubic";
+        case Algorithm::BBR:
+            return "bbr";
+        case Algorithm::SATELLITE:
+            return "satellite";
+    }
+    return "unknown";
+}
+
+ICongestionControl& AdaptiveSelector::activeController() {
+    return const_cast<ICongestionControl&>(static_cast<const AdaptiveSelector*>(this)->activeController());
+}
+
+const ICongestionControl& AdaptiveSelector::activeController() const {
+    switch (active_) {
+        case Algorithm::BBR:
+            return bbr_;
+        case Algorithm::SATELLITE:
+            return satellite_;
+        case Algorithm::CUBIC:
+        default:
+            return cubic_;
+    }
+}
+
+ControllerState AdaptiveSelector::exportState() const {
+    ControllerState state;
+    state.cwnd = getCongestionWindow();
+    bool slow_start = false;
+    switch (active_) {
+        case Algorithm::CUBIC:
+            slow_start = cubic_.inSlowStart();
+            break;
+        case Algorithm::BBR:
+            slow_start = !bbr_.filledPipe();
+            break;
+        case Algorithm::SATELLITE:
+            slow_start = satellite_.inSlowStart();
+            break;
+    }
+    state.ssthresh = slow_start ? UINT32_MAX : state.cwnd;
+    state.bytesInFlight = bytes_in_flight_;
+    state.bandwidth = active_ == Algorithm::BBR && bbr_.getBottleneckBandwidth() > 0
+                          ? bbr_.getBottleneckBandwidth()
+                          : metrics_.maxDeliveryRate;
+    state.minRtt = metrics_.minRtt;
+    state.smoothedRtt = metrics_.smoothedRtt;
+    return state;
+}
+
+void AdaptiveSelector::recordAck(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now) {
+    bytes_in_flight_ -= std::min(ackedBytes, bytes_in_flight_);
+    if (rtt.count() > 0) {
+        updateRtt(rtt, now);
+    }
+    interval_acked_bytes_ += ackedBytes;
+    interval_acked_packets_ += (ackedBytes + options_.mss - 1) / options_.mss;
+}
+
+bool AdaptiveSelector::recordLosses(uint32_t packets, LossCause cause) {
+    interval_losses_ += packets;
+    bool random = cause == LossCause::WIRELESS;
+    auto base = metrics_.minRtt;
+    if (cause == LossCause::UNKNOWN && base.count() > 0) {
+        random = metrics_.smoothedRtt <= base + std::max(QUEUE_DELAY_MIN, base / QUEUE_DELAY_DIVISOR);
+    }
+    if (random) {
+        interval_random_losses_ += packets;
+    }
+    return random;
+}
+
+void AdaptiveSelector::ackCubic(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now) {
+    // Cubic counts whole packets
+    cubic_ack_credit_ += ackedBytes;
+    uint32_t packets = cubic_ack_credit_ / options_.mss;
+    cubic_ack_credit_ %= options_.mss;
+    if (packets > 0) {
+        cubic_.onAckReceived(packets, std::chrono::duration_cast<std::chrono::milliseconds>(rtt), now);
+    }
+}
+
+void AdaptiveSelector::updateRtt(std::chrono::microseconds rtt, TimePoint now) {
+    checkRttStep(rtt, now);
+
+    // RFC 6298 smoothing
+    if (metrics_.smoothedRtt.count() == 0) {
+        metrics_.smoothedRtt = rtt;
+        metrics_.rttVariation = rtt / 2;
+    } else {
+        auto deviation = rtt > metrics_.smoothedRtt ? rtt - metrics_.smoothedRtt : metrics_.smoothedRtt - rtt;
+        metrics_.rttVariation = (metrics_.rttVariation * 3 + deviation) / 4;
+        metrics_.smoothedRtt = (metrics_.smoothedRtt * 7 + rtt) / 8;
+    }
+
+    min_rtt_.update(rtt, now);
+    metrics_.minRtt = min_rtt_.get();
+}
+
+void AdaptiveSelector::checkRttStep(std::chrono::microseconds rtt, TimePoint now) {
+    // Compare the floors (min RTT) of successive rounds: queueing moves
+    // individual samples around, a handover moves the floor
+    if (round_floor_.count() == 0 || rtt < round_floor_) {
+        round_floor_ = rtt;
+    }
+    if (now < round_end_) {
+        return;
+    }
+    round_end_ = now + std::max(metrics_.smoothedRtt, rtt);
+    auto floor = round_floor_;
+    round_floor_ = std::chrono::microseconds(0);
+
+    auto threshold = [](std::chrono::microseconds from) {
+        return std::max(RTT_STEP_MIN,
+                        std::chrono::microseconds(static_cast<int64_t>(from.count() * RTT_STEP_FRACTION)));
+    };
+    auto distance = [](std::chrono::microseconds a, std::chrono::microseconds b) { return a > b ? a - b : b - a; };
+    if (step_floor_.count() > 0) {
+        // A step counts once the floor has held at the new level for
+        // STEP_HOLD; the dip of a ProbeRTT or a drained queue does not
+        if (distance(floor, step_floor_) > threshold(step_floor_) / 2) {
+            step_floor_ = std::chrono::microseconds(0);
+        } else if (now - step_since_ >= STEP_HOLD) {
+            rtt_steps_.push_back(now);
+            step_floor_ = std::chrono::microseconds(0);
+        }
+    } else if (last_floor_.count() > 0 && distance(floor, last_floor_) >= threshold(last_floor_)) {
+        step_floor_ = floor;
+        step_since_ = now;
+    }
+    last_floor_ = floor;
+}
+
+void AdaptiveSelector::maybeEvaluate(TimePoint now) {
+    if (now - interval_start_ >= options_.evaluationInterval) {
+        evaluate(now);
+    }
+}
+
+void AdaptiveSelector::evaluate(TimePoint now) {
+    double seconds = std::chrono::duration<double>(now - interval_start_).count();
+
+    // Delivery rate, skipping intervals where the window is still ramping:
+    // a slow-start ramp is not path variance
+    bool ramping = exportState().ssthresh == UINT32_MAX;
+    if (!ramping && interval_acked_bytes_ > 0) {
+        interval_rates_.push_back(static_cast<uint64_t>(interval_acked_bytes_ / seconds));
+        size_t max_samples = std::max<size_t>(
+            MIN_RATE_SAMPLES, std::chrono::duration_cast<std::chrono::milliseconds>(options_.metricsWindow) /
+                                  options_.evaluationInterval);
+        while (interval_rates_.size() > max_samples) {
+            interval_rates_.pop_front();
+        }
+    }
+    if (!interval_rates_.empty()) {
+        double sum = 0;
+        uint64_t max_rate = 0;
+        for (uint64_t rate : interval_rates_) {
+            sum += rate;
+            max_rate = std::max(max_rate, rate);
+        }
+        double mean = sum / interval_rates_.size();
+        double variance = 0;
+        for (uint64_t rate : interval_rates_) {
+            variance += (rate - mean) * (rate - mean);
+        }
+        variance /= interval_rates_.size();
+        metrics_.deliveryRate = static_cast<uint64_t>(mean);
+        metrics_.maxDeliveryRate = max_rate;
+        metrics_.bandwidthVariation =
+            interval_rates_.size() >= MIN_RATE_SAMPLES && mean > 0 ? std::sqrt(variance) / mean : 0;
+    }
+
+    // Loss over this interval only; the confirmations provide persistence
+    uint32_t packets = interval_acked_packets_ + interval_losses_;
+    metrics_.lossRate = packets > 0 ? static_cast<double>(interval_losses_) / packets : 0;
+    metrics_.randomLossRate = packets > 0 ? static_cast<double>(interval_random_losses_) / packets : 0;
+
+    while (!rtt_steps_.empty() && now - rtt_steps_.front() > options_.metricsWindow) {
+        rtt_steps_.pop_front();
+    }
+    metrics_.rttSteps = static_cast<uint32_t>(rtt_steps_.size());
+
+    interval_start_ = now;
+    interval_acked_bytes_ = 0;
+    interval_acked_packets_ = 0;
+    interval_losses_ = 0;
+    interval_random_losses_ = 0;
+
+    if (active_ == Algorithm::CUBIC && metrics_.lossRate >= options_.failingLossRate) {
+        cubic_failed_ = true;
+    }
+
+    Algorithm candidate = recommend();
+    if (candidate == active_) {
+        pending_count_ = 0;
+        return;
+    }
+    if (candidate != pending_) {
+        pending_ = candidate;
+        pending_count_ = 0;
+    }
+    ++pending_count_;
+    // Returning to an algorithm already left waits twice as long each time,
+    // so a path where each choice changes the metrics that chose it settles
+    auto dwell = options_.minDwell * (1 << std::min<uint32_t>(departures_[static_cast<size_t>(candidate)], 6));
+    if (pending_count_ >= options_.confirmations && now - last_switch_ >= dwell) {
+        switchTo(candidate, now);
+    }
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
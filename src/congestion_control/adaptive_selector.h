@@ -0,0 +1,181 @@
+#pragma once
+
+#include "interface.h"
+#include "bbr.h"
+#include "cubic.h"
+#include "jump_start.h"
+#include "path_cache.h"
+#include "rate_sample.h"
+#include "satellite_optimized.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Picks the congestion controller for one path while a transfer runs.
+//
+// The selector watches the path's RTT, loss pattern and delivery-rate
+// variance and routes every event to one of Cubic, Bbr and
+// SatelliteOptimized:
+//   - a GEO-class min RTT, or repeated RTT steps (LEO handovers), selects
+//     SatelliteOptimized. Steps are read from the per-round RTT floor, so
+//     they show while the queue is short; a standing queue absorbs them;
+//   - frequent random loss (no standing queue when it happens), heavy loss
+//     of any kind (the loss-based window is not converging), or a delivery
+//     rate that swings a lot, selects Bbr;
+//   - anything else stays on Cubic.
+// A switch needs the same recommendation on several consecutive
+// evaluations and a minimum time on the current controller, so a single
+// bad interval does not flap the choice. Going back to a controller that
+// was already left takes twice as long each time: loss measured under
+// Cubic can favour Bbr, whose lower loss then favours Cubic again.
+//
+// On a switch the new controller adopts the old one's window, slow-start
+// state and the measured bandwidth and RTTs (ControllerState) rather than
+// starting from an initial window: on a 600 ms path a reset costs seconds
+// of throughput.
+//
+// jumpStart() opens the window of a new transfer straight to a share of an
+// estimated BDP (see JumpStart) on whichever controller is active, and
+// retreats if the jump is not confirmed. Only losses that do not look
+// random count against the jump.
+//
+// Create one selector per path. All quantities are in bytes;
+// getSendingRate() is in bytes per second.
+class AdaptiveSelector : public ICongestionControl {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    enum class Algorithm { CUBIC, BBR, SATELLITE };
+
+    struct Options {
+        uint32_t mss = 1460;
+        Algorithm initial = Algorithm::CUBIC;
+        std::chrono::milliseconds evaluationInterval{1000};
+        uint32_t confirmations = 3;        // Consecutive agreeing evaluations
+        std::chrono::seconds minDwell{10};  // Minimum time between switches
+        std::chrono::seconds metricsWindow{30};
+        // Selection thresholds
+        std::chrono::milliseconds longRtt{250};  // GEO-class min RTT
+        uint32_t handoverSteps = 2;              // RTT steps within metricsWindow
+        double lossyRate = 0.002;                // Random loss fraction Cubic copes with
+        double failingLossRate = 0.05;           // Any loss: the window is not converging
+        double bandwidthVariation = 0.3;         // Coefficient of variation
+        SatelliteOptimized::Options satellite;
+        JumpStart::Options jumpStart;
+    };
+
+    // What the selector has measured about the path
+    struct PathMetrics {
+        std::chrono::microseconds minRtt{0};
+        std::chrono::microseconds smoothedRtt{0};
+        std::chrono::microseconds rttVariation{0};
+        uint32_t rttSteps = 0;     // Within metricsWindow
+        // Over the last evaluation interval
+        double lossRate = 0;        // Lost / (acked + lost) packets
+        double randomLossRate = 0;  // The part lost with no queue standing
+        uint64_t deliveryRate = 0;  // Mean over metricsWindow, bytes/s
+        uint64_t maxDeliveryRate = 0;
+        double bandwidthVariation = 0;
+    };
+
+    AdaptiveSelector();
+    explicit AdaptiveSelector(const Options& options);
+    AdaptiveSelector(const Options& options, TimePoint start);
+
+    void onPacketSent(uint32_t packetSize) override;
+    void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) override;
+    // Treated as the loss of one MSS
+    void onPacketLoss() override;
+    uint32_t getCongestionWindow() const override;
+    uint32_t getSendingRate() const override;
+    // Losses count per packet in the metrics; the active controller gets
+    // the event as a whole, so Bbr sees the rate sample
+    void onAck(const AckEvent& ack) override;
+
+    // Same events at an explicit time, for simulated links
+    void onPacketSent(uint32_t packetSize, TimePoint now);
+    void onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now);
+    void onPacketLoss(TimePoint now);
+
+    Algorithm getAlgorithm() const { return active_; }
+    // The algorithm the current metrics favour, before hysteresis
+    Algorithm recommend() const;
+    // Switch now, bypassing hysteresis; the window is handed over as usual
+    void switchTo(Algorithm algorithm, TimePoint now);
+
+    // Start from an estimate of the path (cached or provider-reported)
+    // instead of the initial window; false if the estimate does not help
+    bool jumpStart(const PathEstimate& estimate, TimePoint now);
+    JumpStart::Phase getJumpPhase() const { return jump_.getPhase(); }
+
+    // Seed a new transfer from what an earlier connection on the path
+    // measured: start on the controller its RTT and loss rate call for,
+    // and jump-start from its bandwidth (capped at its ssthresh)
+    void warmStart(const PathCache::Entry& entry, TimePoint now);
+    // Window and path state, e.g. to store in a PathCache at the end of a
+    // transfer
+    ControllerState getState() const { return exportState(); }
+
+    const PathMetrics& getMetrics() const { return metrics_; }
+    uint64_t getSwitches() const { return switches_; }
+    uint32_t getBytesInFlight() const { return bytes_in_flight_; }
+
+    static const char* algorithmName(Algorithm algorithm);
+
+private:
+    Options options_;
+    Cubic cubic_;
+    Bbr bbr_;
+    SatelliteOptimized satellite_;
+    Algorithm active_;
+    uint32_t bytes_in_flight_ = 0;
+    uint32_t cubic_ack_credit_ = 0;  // Acked bytes short of a whole packet
+    JumpStart jump_;
+
+    // Path metrics
+    PathMetrics metrics_;
+    // RTT floor per round, for handover steps
+    std::chrono::microseconds round_floor_{0};
+    std::chrono::microseconds last_floor_{0};
+    std::chrono::microseconds step_floor_{0};  // Candidate level, not yet held long enough
+    TimePoint step_since_;
+    TimePoint round_end_;
+    WindowedMinRtt min_rtt_;
+    std::deque<TimePoint> rtt_steps_;
+    std::deque<uint64_t> interval_rates_;
+
+    // Current evaluation interval
+    TimePoint interval_start_;
+    uint64_t interval_acked_bytes_ = 0;
+    uint32_t interval_acked_packets_ = 0;
+    uint32_t interval_losses_ = 0;
+    uint32_t interval_random_losses_ = 0;
+    bool cubic_failed_ = false;  // Cubic has seen failingLossRate on this path
+
+    // Hysteresis
+    Algorithm pending_;
+    uint32_t pending_count_ = 0;
+    std::array<uint32_t, 3> departures_{};  // Times each algorithm was left
+    TimePoint last_switch_;
+    uint64_t switches_ = 0;
+
+    ICongestionControl& activeController();
+    const ICongestionControl& activeController() const;
+    ControllerState exportState() const;
+    void adopt(Algorithm algorithm, const ControllerState& state, TimePoint now);
+    void recordAck(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now);
+    // Returns whether the losses look random (no standing queue)
+    bool recordLosses(uint32_t packets, LossCause cause);
+    void ackCubic(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now);
+    void updateRtt(std::chrono::microseconds rtt, TimePoint now);
+    void checkRttStep(std::chrono::microseconds rtt, TimePoint now);
+    void maybeEvaluate(TimePoint now);
+    void evaluate(TimePoint now);
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
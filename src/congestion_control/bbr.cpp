@@ -0,0 +1,295 @@
+#include "bbr.h"
+#include <algorithm>
+#include <limits>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+constexpr double PACING_GAIN_CYCLE[] = {1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+constexpr size_t CYCLE_LENGTH = sizeof(PACING_GAIN_CYCLE) / sizeof(PACING_GAIN_CYCLE[0]);
+constexpr double PROBE_BW_CWND_GAIN = 2.0;
+constexpr double FULL_BW_GROWTH = 1.25;
+constexpr uint32_t FULL_BW_ROUNDS = 3;
+constexpr std::chrono::microseconds DEFAULT_RTT{1000};  // Until the first sample
+}
+
+Bbr::Bbr(uint32_t mss) : Bbr(mss, std::chrono::steady_clock::now()) {}
+
+Bbr::Bbr(uint32_t mss, TimePoint start)
+    : mss_(std::max<uint32_t>(mss, 1)),
+      cwnd_(INITIAL_WINDOW_PACKETS * mss_),
+      min_rtt_stamp_(start),
+      cycle_stamp_(start) {}
+
+void Bbr::onPacketSent(uint32_t packetSize) {
+    onPacketSent(packetSize, std::chrono::steady_clock::now());
+}
+
+void Bbr::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
+    onAckReceived(ackedBytes, rtt, std::chrono::steady_clock::now());
+}
+
+void Bbr::onPacketLoss() {
+    onPacketsLost(mss_, std::chrono::steady_clock::now());
+}
+
+uint32_t Bbr::getCongestionWindow() const {
+    return cwnd_;
+}
+
+uint32_t Bbr::getSendingRate() const {
+    double rate;
+    if (btl_bw_ == 0) {
+        auto rtt = min_rtt_.count() > 0 ? min_rtt_ : DEFAULT_RTT;
+        rate = HIGH_GAIN * cwnd_ * 1e6 / rtt.count();
+    } else {
+        rate = pacing_gain_ * btl_bw_;
+    }
+    return static_cast<uint32_t>(std::min(rate, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+}
+
+void Bbr::onPacketSent(uint32_t packetSize, TimePoint now) {
+    if (bytes_in_flight_ == 0) {
+        // Restarting from idle: measure the next samples from this send, not
+        // from the last ack before the pause
+        acks_.clear();
+        acks_.push_back(AckRecord{now, delivered_});
+    }
+    bytes_in_flight_ += packetSize;
+}
+
+void Bbr::onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now) {
+    processAck(ackedBytes, rtt, now, nullptr);
+}
+
+void Bbr::onAck(const AckEvent& ack) {
+    if (ack.lostBytes > 0) {
+        onPacketsLost(ack.lostBytes, ack.now);
+    }
+    if (ack.ackedBytes > 0) {
+        processAck(ack.ackedBytes, ack.rtt, ack.now, &ack);
+    }
+}
+
+void Bbr::processAck(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now, const AckEvent* ack) {
+    bytes_in_flight_ -= std::min(ackedBytes, bytes_in_flight_);
+    delivered_ += ackedBytes;
+
+    updateRound();
+    bool min_rtt_expired = now - min_rtt_stamp_ > MIN_RTT_WINDOW;
+    updateMinRtt(rtt, now);
+    updateBandwidth(now, ack);
+    if (round_start_ && !full_bw_reached_) {
+        checkFullBandwidth();
+    }
+    if (min_rtt_expired && mode_ != Mode::PROBE_RTT) {
+        mode_ = Mode::PROBE_RTT;
+        pacing_gain_ = 1.0;
+        cwnd_gain_ = 1.0;
+        prior_cwnd_ = cwnd_;
+        probe_rtt_done_ = TimePoint{};
+        probe_rtt_round_done_ = false;
+    }
+    updateMode(now);
+    updateCwnd(ackedBytes);
+}
+
+void Bbr::onPacketsLost(uint32_t lostBytes, TimePoint) {
+    // Loss only leaves the pipe; the model is driven by delivery rate and RTT
+    bytes_in_flight_ -= std::min(lostBytes, bytes_in_flight_);
+}
+
+void Bbr::adoptState(const ControllerState& state, TimePoint now) {
+    cwnd_ = std::max(state.cwnd, minWindow());
+    bytes_in_flight_ = state.bytesInFlight;
+    acks_.clear();
+    acks_.push_back(AckRecord{now, delivered_});
+    next_round_delivered_ = delivered_ + bytes_in_flight_;
+    if (state.minRtt.count() > 0) {
+        min_rtt_ = state.minRtt;
+        min_rtt_stamp_ = now;
+    }
+    if (state.bandwidth > 0) {
+        round_max_bw_.fill(0);
+        round_max_bw_[bw_round_ % BANDWIDTH_WINDOW_ROUNDS] = state.bandwidth;
+        btl_bw_ = state.bandwidth;
+        full_bw_ = state.bandwidth;
+        full_bw_rounds_ = 0;
+    }
+    full_bw_reached_ = state.ssthresh != UINT32_MAX && btl_bw_ > 0 && min_rtt_.count() > 0;
+    if (full_bw_reached_) {
+        enterProbeBw(now);
+    } else {
+        mode_ = Mode::STARTUP;
+        pacing_gain_ = HIGH_GAIN;
+        cwnd_gain_ = HIGH_GAIN;
+    }
+}
+
+void Bbr::updateRound() {
+    round_start_ = false;
+    if (delivered_ >= next_round_delivered_) {
+        // Everything in flight when the previous round began has been acked
+        next_round_delivered_ = delivered_ + bytes_in_flight_;
+        ++round_count_;
+        round_start_ = true;
+        // ProbeRTT rounds run at a tiny window; letting them age out the
+        // filter would throw away the estimate on short paths
+        if (mode_ != Mode::PROBE_RTT) {
+            ++bw_round_;
+            round_max_bw_[bw_round_ % BANDWIDTH_WINDOW_ROUNDS] = 0;
+        }
+    }
+}
+
+void Bbr::updateBandwidth(TimePoint now, const AckEvent* ack) {
+    if (ack != nullptr) {
+        // A rate sample from the sender's packet records
+        if (ack->deliveryRate == 0 || mode_ == Mode::PROBE_RTT || (ack->appLimited && ack->deliveryRate < btl_bw_)) {
+            return;
+        }
+        recordBandwidth(ack->deliveryRate);
+        return;
+    }
+
+    acks_.push_back(AckRecord{now, delivered_});
+    // Delivery rate over roughly the last min RTT of acks
+    auto window = min_rtt_.count() > 0 ? min_rtt_ : DEFAULT_RTT;
+    while (acks_.size() > 2 && acks_[1].time <= now - window) {
+        acks_.pop_front();
+    }
+    const AckRecord& oldest = acks_.front();
+    auto interval = std::chrono::duration<double>(now - oldest.time).count();
+    if (acks_.size() < 2 || interval <= 0 || mode_ == Mode::PROBE_RTT) {
+        return;
+    }
+    recordBandwidth(static_cast<uint64_t>((delivered_ - oldest.delivered) / interval));
+}
+
+void Bbr::recordBandwidth(uint64_t sample) {
+    uint64_t& slot = round_max_bw_[bw_round_ % BANDWIDTH_WINDOW_ROUNDS];
+    slot = std::max(slot, sample);
+    btl_bw_ = *std::max_element(round_max_bw_.begin(), round_max_bw_.end());
+}
+
+void Bbr::updateMinRtt(std::chrono::microseconds rtt, TimePoint now) {
+    if (rtt.count() <= 0) {
+        return;
+    }
+    if (min_rtt_.count() == 0 || rtt <= min_rtt_ || now - min_rtt_stamp_ > MIN_RTT_WINDOW) {
+        min_rtt_ = rtt;
+        min_rtt_stamp_ = now;
+    }
+}
+
+void Bbr::checkFullBandwidth() {
+    if (btl_bw_ >= full_bw_ * FULL_BW_GROWTH) {
+        full_bw_ = btl_bw_;
+        full_bw_rounds_ = 0;
+        return;
+    }
+    if (++full_bw_rounds_ >= FULL_BW_ROUNDS) {
+        full_bw_reached_ = true;
+    }
+}
+
+void Bbr::updateMode(TimePoint now) {
+    switch (mode_) {
+        case Mode::STARTUP:
+            if (full_bw_reached_) {
+                // Drain the queue built while probing at high gain
+                mode_ = Mode::DRAIN;
+                pacing_gain_ = 1.0 / HIGH_GAIN;
+                cwnd_gain_ = HIGH_GAIN;
+            }
+            break;
+        case Mode::DRAIN:
+            if (bytes_in_flight_ <= bdp(1.0)) {
+                enterProbeBw(now);
+            }
+            break;
+        case Mode::PROBE_BW:
+            advanceCycle(now);
+            break;
+        case Mode::PROBE_RTT:
+            if (probe_rtt_done_ == TimePoint{}) {
+                if (bytes_in_flight_ <= minWindow()) {
+                    probe_rtt_done_ = now + PROBE_RTT_DURATION;
+                    next_round_delivered_ = delivered_;
+                }
+            } else {
+                probe_rtt_round_done_ = probe_rtt_round_done_ || round_start_;
+                if (probe_rtt_round_done_ && now >= probe_rtt_done_) {
+                    min_rtt_stamp_ = now;
+                    cwnd_ = std::max(cwnd_, prior_cwnd_);
+                    if (full_bw_reached_) {
+                        enterProbeBw(now);
+                    } else {
+                        mode_ = Mode::STARTUP;
+                        pacing_gain_ = HIGH_GAIN;
+                        cwnd_gain_ = HIGH_GAIN;
+                    }
+                }
+            }
+            break;
+    }
+}
+
+void Bbr::advanceCycle(TimePoint now) {
+    bool full_length = now - cycle_stamp_ > min_rtt_;
+    bool advance;
+    if (pacing_gain_ > 1.0) {
+        // Probe until the extra inflight is actually in the pipe
+        advance = full_length && bytes_in_flight_ >= bdp(pacing_gain_);
+        advance = advance || now - cycle_stamp_ > 2 * min_rtt_;
+    } else if (pacing_gain_ < 1.0) {
+        advance = full_length || bytes_in_flight_ <= bdp(1.0);
+    } else {
+        advance = full_length;
+    }
+    if (advance) {
+        cycle_index_ = (cycle_index_ + 1) % CYCLE_LENGTH;
+        cycle_stamp_ = now;
+        pacing_gain_ = PACING_GAIN_CYCLE[cycle_index_];
+    }
+}
+
+void Bbr::enterProbeBw(TimePoint now) {
+    mode_ = Mode::PROBE_BW;
+    cwnd_gain_ = PROBE_BW_CWND_GAIN;
+    // Random phase, but never the draining one, so flows do not synchronize
+    cycle_index_ = rng_() % (CYCLE_LENGTH - 1);
+    if (cycle_index_ >= 1) {
+        ++cycle_index_;
+    }
+    cycle_stamp_ = now;
+    pacing_gain_ = PACING_GAIN_CYCLE[cycle_index_];
+}
+
+void Bbr::updateCwnd(uint32_t ackedBytes) {
+    if (mode_ == Mode::PROBE_RTT) {
+        cwnd_ = std::min(cwnd_, minWindow());
+        return;
+    }
+    // Allow for delayed and aggregated acks on top of the BDP
+    uint64_t target = bdp(cwnd_gain_) + 3 * static_cast<uint64_t>(mss_);
+    uint64_t cwnd = cwnd_;
+    if (full_bw_reached_) {
+        cwnd = std::min<uint64_t>(cwnd + ackedBytes, target);
+    } else if (cwnd < target || delivered_ < INITIAL_WINDOW_PACKETS * static_cast<uint64_t>(mss_)) {
+        cwnd += ackedBytes;
+    }
+    cwnd = std::max<uint64_t>(cwnd, minWindow());
+    cwnd_ = static_cast<uint32_t>(std::min<uint64_t>(cwnd, std::numeric_limits<uint32_t>::max()));
+}
+
+uint64_t Bbr::bdp(double gain) const {
+    if (min_rtt_.count() == 0 || btl_bw_ == 0) {
+        return INITIAL_WINDOW_PACKETS * static_cast<uint64_t>(mss_);
+    }
+    return static_cast<uint64_t>(gain * btl_bw_ * min_rtt_.count() / 1e6);
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
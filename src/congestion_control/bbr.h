@@ -0,0 +1,122 @@
+#pragma once
+
+#include "interface.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Model-based controller after BBR (v1). Estimates the bottleneck
+// bandwidth (windowed max of delivery-rate samples over 10 rounds) and the
+// path's min RTT (over 10 s), then paces at gain * bandwidth and caps
+// inflight at a multiple of the bandwidth-delay product. Random loss does
+// not shrink the model, so throughput holds up on lossy satellite links
+// where Cubic collapses.
+//
+// All quantities are in bytes; getSendingRate() is in bytes per second.
+class Bbr : public ICongestionControl {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    enum class Mode { STARTUP, DRAIN, PROBE_BW, PROBE_RTT };
+
+    static constexpr uint32_t DEFAULT_MSS = 1460;
+    static constexpr uint32_t INITIAL_WINDOW_PACKETS = 10;
+    static constexpr uint32_t MIN_WINDOW_PACKETS = 4;
+    static constexpr double HIGH_GAIN = 2.885;  // 2 / ln 2
+    static constexpr std::chrono::seconds MIN_RTT_WINDOW{10};
+    static constexpr std::chrono::milliseconds PROBE_RTT_DURATION{200};
+    static constexpr size_t BANDWIDTH_WINDOW_ROUNDS = 10;
+
+    explicit Bbr(uint32_t mss = DEFAULT_MSS);
+    Bbr(uint32_t mss, TimePoint start);
+
+    void onPacketSent(uint32_t packetSize) override;
+    void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) override;
+    // Treated as the loss of one MSS
+    void onPacketLoss() override;
+    uint32_t getCongestionWindow() const override;
+    uint32_t getSendingRate() const override;
+    // Takes the event's delivery-rate sample in place of the rate measured
+    // from ack arrivals; app-limited samples only ever raise the estimate
+    void onAck(const AckEvent& ack) override;
+
+    // Same events at an explicit time, for simulated links
+    void onPacketSent(uint32_t packetSize, TimePoint now);
+    void onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now);
+    void onPacketsLost(uint32_t lostBytes, TimePoint now);
+
+    Mode getMode() const { return mode_; }
+    uint64_t getBottleneckBandwidth() const { return btl_bw_; }  // Bytes/s
+    std::chrono::microseconds getMinRtt() const { return min_rtt_; }
+    uint32_t getBytesInFlight() const { return bytes_in_flight_; }
+    double getPacingGain() const { return pacing_gain_; }
+    bool filledPipe() const { return full_bw_reached_; }
+
+    // Take over a transfer from another controller. A measured bandwidth
+    // and min RTT seed the model; if the previous controller had left slow
+    // start the pipe counts as filled and ProbeBW starts right away.
+    void adoptState(const ControllerState& state, TimePoint now);
+
+private:
+    struct AckRecord {
+        TimePoint time;
+        uint64_t delivered;
+    };
+
+    uint32_t mss_;
+    Mode mode_ = Mode::STARTUP;
+    uint32_t cwnd_;
+    uint32_t bytes_in_flight_ = 0;
+    double pacing_gain_ = HIGH_GAIN;
+    double cwnd_gain_ = HIGH_GAIN;
+
+    // Bandwidth model
+    uint64_t delivered_ = 0;
+    std::deque<AckRecord> acks_;  // Recent acks for delivery-rate samples
+    std::array<uint64_t, BANDWIDTH_WINDOW_ROUNDS> round_max_bw_{};
+    uint64_t btl_bw_ = 0;
+
+    // Round trips, counted in delivered bytes
+    uint64_t round_count_ = 0;
+    uint64_t bw_round_ = 0;  // Rounds outside ProbeRTT, indexing round_max_bw_
+    uint64_t next_round_delivered_ = 0;
+    bool round_start_ = false;
+
+    // Startup exit
+    uint64_t full_bw_ = 0;
+    uint32_t full_bw_rounds_ = 0;
+    bool full_bw_reached_ = false;
+
+    // Min RTT and ProbeRTT
+    std::chrono::microseconds min_rtt_{0};
+    TimePoint min_rtt_stamp_;
+    TimePoint probe_rtt_done_;
+    bool probe_rtt_round_done_ = false;
+    uint32_t prior_cwnd_ = 0;
+
+    // ProbeBW gain cycling
+    size_t cycle_index_ = 0;
+    TimePoint cycle_stamp_;
+    std::minstd_rand rng_;
+
+    void processAck(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now, const AckEvent* ack);
+    void updateRound();
+    void updateBandwidth(TimePoint now, const AckEvent* ack);
+    void recordBandwidth(uint64_t sample);
+    void updateMinRtt(std::chrono::microseconds rtt, TimePoint now);
+    void checkFullBandwidth();
+    void updateMode(TimePoint now);
+    void advanceCycle(TimePoint now);
+    void enterProbeBw(TimePoint now);
+    void updateCwnd(uint32_t ackedBytes);
+    uint64_t bdp(double gain) const;
+    uint32_t minWindow() const { return MIN_WINDOW_PACKETS * mss_; }
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,199 @@
+#include "coupled_multipath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+// Round trip assumed before a path's first RTT sample
+constexpr std::chrono::microseconds DEFAULT_RTT{100000};
+// Relative tolerance when comparing paths for OLIA's best and max sets
+constexpr double TIE_TOLERANCE = 1e-9;
+
+bool atLeast(double value, double best) {
+    return value >= best * (1 - TIE_TOLERANCE);
+}
+}
+
+CoupledMultipath::Path::Path(CoupledMultipath& owner, std::string name, TimePoint start)
+    : owner_(owner),
+      name_(std::move(name)),
+      cwnd_(INITIAL_WINDOW_PACKETS * owner.options_.mss),
+      ssthresh_(std::numeric_limits<uint32_t>::max()),
+      recovery_end_(start) {}
+
+void CoupledMultipath::Path::onPacketSent(uint32_t packetSize) {
+    onPacketSent(packetSize, std::chrono::steady_clock::now());
+}
+
+void CoupledMultipath::Path::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
+    onAckReceived(ackedBytes, rtt, std::chrono::steady_clock::now());
+}
+
+void CoupledMultipath::Path::onPacketLoss() {
+    onPacketLoss(std::chrono::steady_clock::now());
+}
+
+uint32_t CoupledMultipath::Path::getSendingRate() const {
+    double rate = cwnd_ * 1e6 / roundTrip().count();
+    return static_cast<uint32_t>(std::min(rate, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+}
+
+void CoupledMultipath::Path::onAck(const AckEvent& ack) {
+    if (ack.lostBytes > 0 && ack.lossCause != LossCause::WIRELESS) {
+        onPacketLoss(ack.now);
+    }
+    if (ack.ackedBytes > 0) {
+        onAckReceived(ack.ackedBytes, ack.rtt, ack.now);
+    }
+}
+
+void CoupledMultipath::Path::onPacketSent(uint32_t, TimePoint) {
+    // Window accounting is the caller's; nothing to track per send
+}
+
+void CoupledMultipath::Path::onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint) {
+    if (rtt.count() > 0) {
+        srtt_ = srtt_.count() == 0 ? rtt : (srtt_ * 7 + rtt) / 8;
+    }
+    since_loss_ += ackedBytes;
+    owner_.increase(*this, ackedBytes);
+}
+
+void CoupledMultipath::Path::onPacketLoss(TimePoint now) {
+    if (now < recovery_end_) {
+        return;  // Same loss event
+    }
+    between_losses_ = since_loss_;
+    since_loss_ = 0;
+    ssthresh_ = std::max(cwnd_ / 2, MIN_WINDOW_PACKETS * owner_.options_.mss);
+    cwnd_ = ssthresh_;
+    credit_ = 0;
+    recovery_end_ = now + roundTrip();
+}
+
+std::chrono::microseconds CoupledMultipath::Path::roundTrip() const {
+    return srtt_.count() > 0 ? srtt_ : DEFAULT_RTT;
+}
+
+CoupledMultipath::CoupledMultipath() : CoupledMultipath(Options()) {}
+
+CoupledMultipath::CoupledMultipath(const Options& options) : options_(options) {
+    options_.mss = std::max<uint32_t>(options_.mss, 1);
+}
+
+CoupledMultipath::Path& CoupledMultipath::addPath(const std::string& name) {
+    return addPath(name, std::chrono::steady_clock::now());
+}
+
+CoupledMultipath::Path& CoupledMultipath::addPath(const std::string& name, TimePoint now) {
+    paths_.push_back(std::unique_ptr<Path>(new Path(*this, name, now)));
+    return *paths_.back();
+}
+
+bool CoupledMultipath::removePath(const Path& path) {
+    auto it = std::find_if(paths_.begin(), paths_.end(), [&](const auto& candidate) { return candidate.get() == &path; });
+    if (it == paths_.end()) {
+        return false;
+    }
+    paths_.erase(it);
+    return true;
+}
+
+uint64_t CoupledMultipath::getTotalWindow() const {
+    uint64_t total = 0;
+    for (const auto& path : paths_) {
+        total += path->cwnd_;
+    }
+    return total;
+}
+
+uint64_t CoupledMultipath::getAggregateRate() const {
+    uint64_t total = 0;
+    for (const auto& path : paths_) {
+        total += path->getSendingRate();
+    }
+    return total;
+}
+
+double CoupledMultipath::getLiaAlpha() const {
+    double best = 0;
+    double sum = 0;
+    for (const auto& path : paths_) {
+        double rtt = static_cast<double>(path->roundTrip().count());
+        best = std::max(best, path->cwnd_ / (rtt * rtt));
+        sum += path->cwnd_ / rtt;
+    }
+    return sum > 0 ? getTotalWindow() * best / (sum * sum) : 1.0;
+}
+
+void CoupledMultipath::increase(Path& path, uint32_t ackedBytes) {
+    if (path.inSlowStart()) {
+        path.credit_ += ackedBytes;
+    } else if (options_.algorithm == Algorithm::LIA) {
+        path.credit_ += liaIncrease(path, ackedBytes);
+    } else {
+        path.credit_ += oliaIncrease(path, ackedBytes);
+    }
+    // OLIA can take window from a path; it never goes below the minimum
+    double cwnd = std::max(path.cwnd_ + std::trunc(path.credit_),
+                           static_cast<double>(MIN_WINDOW_PACKETS * options_.mss));
+    path.credit_ -= std::trunc(path.credit_);
+    path.cwnd_ = static_cast<uint32_t>(std::min(cwnd, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+}
+
+double CoupledMultipath::liaIncrease(const Path& path, uint32_t ackedBytes) const {
+    // min(alpha * acked * mss / total, acked * mss / cwnd): never more
+    // than a single-path flow on this path would take
+    double coupled = getLiaAlpha() * ackedBytes * options_.mss / getTotalWindow();
+    double uncoupled = static_cast<double>(ackedBytes) * options_.mss / path.cwnd_;
+    return std::min(coupled, uncoupled);
+}
+
+double CoupledMultipath::oliaIncrease(const Path& path, uint32_t ackedBytes) const {
+    // Best paths: most bytes between losses per RTT^2. Max paths: largest
+    // windows. Window moves from the max paths that are not best to the
+    // best paths that are not max.
+    double best_quality = 0;
+    uint32_t max_cwnd = 0;
+    double rate_sum = 0;
+    for (const auto& candidate : paths_) {
+        double rtt = static_cast<double>(candidate->roundTrip().count());
+        double delivered = static_cast<double>(std::max(candidate->between_losses_, candidate->since_loss_));
+        best_quality = std::max(best_quality, delivered / (rtt * rtt));
+        max_cwnd = std::max(max_cwnd, candidate->cwnd_);
+        rate_sum += candidate->cwnd_ / rtt;
+    }
+    auto isBest = [&](const Path& candidate) {
+        double rtt = static_cast<double>(candidate.roundTrip().count());
+        double delivered = static_cast<double>(std::max(candidate.between_losses_, candidate.since_loss_));
+        return atLeast(delivered / (rtt * rtt), best_quality);
+    };
+    size_t collected = 0;
+    size_t max_paths = 0;
+    for (const auto& candidate : paths_) {
+        bool is_max = candidate->cwnd_ == max_cwnd;
+        max_paths += is_max;
+        collected += isBest(*candidate) && !is_max;
+    }
+
+    double alpha = 0;
+    if (collected > 0) {
+        double paths = static_cast<double>(paths_.size());
+        if (path.cwnd_ == max_cwnd) {
+            alpha = -1.0 / (paths * max_paths);
+        } else if (isBest(path)) {
+            alpha = 1.0 / (paths * collected);
+        }
+    }
+
+    double rtt = static_cast<double>(path.roundTrip().count());
+    double mss = options_.mss;
+    double coupled = mss * (path.cwnd_ / (rtt * rtt)) / (rate_sum * rate_sum);
+    return ackedBytes * (coupled + alpha * mss / path.cwnd_);
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
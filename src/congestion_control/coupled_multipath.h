@@ -0,0 +1,128 @@
+#pragma once
+
+#include "interface.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Coupled congestion control for one transfer spread over several paths
+// (e.g. a Starlink and an Iridium provider at once), after LIA (RFC 6356)
+// and OLIA (Khalili et al., "MPTCP is not Pareto-optimal", CoNEXT 2012).
+//
+// Each path gets its own controller from addPath(), an ICongestionControl
+// with its own window, slow start, loss recovery and RTT. Only the
+// congestion-avoidance increase is coupled, so that:
+//   - the transfer takes no more than one single-path flow would at a
+//     bottleneck its paths share;
+//   - the total grows as fast as a single-path flow would on the best path,
+//     so aggregate throughput tracks that path;
+//   - load moves to the paths that lose least. LIA moves it only slowly.
+//     OLIA works out which paths are best from the bytes delivered between
+//     losses, and moves window to them from the paths with the largest
+//     windows. A provider that starts to lose packets gives up its share
+//     within a few RTTs.
+// Losses halve the losing path's window, once per RTT. Wireless losses
+// (AckEvent::lossCause) leave it alone, as in the single-path controllers.
+//
+// The coupling needs all the windows, so the paths are views into this
+// object and must not outlive it. Not thread-safe, like the controllers.
+// All quantities are in bytes; getSendingRate() is in bytes per second.
+class CoupledMultipath {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    enum class Algorithm { LIA, OLIA };
+
+    struct Options {
+        Algorithm algorithm = Algorithm::OLIA;
+        uint32_t mss = 1460;
+    };
+
+    static constexpr uint32_t INITIAL_WINDOW_PACKETS = 10;
+    static constexpr uint32_t MIN_WINDOW_PACKETS = 2;
+
+    class Path : public ICongestionControl {
+    public:
+        void onPacketSent(uint32_t packetSize) override;
+        void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) override;
+        void onPacketLoss() override;
+        uint32_t getCongestionWindow() const override { return cwnd_; }
+        // cwnd per smoothed RTT
+        uint32_t getSendingRate() const override;
+        // Microsecond RTT; the losses in one event are one loss
+        void onAck(const AckEvent& ack) override;
+
+        // Same events at an explicit time, for simulated links
+        void onPacketSent(uint32_t packetSize, TimePoint now);
+        void onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now);
+        void onPacketLoss(TimePoint now);
+
+        const std::string& getName() const { return name_; }
+        bool inSlowStart() const { return cwnd_ < ssthresh_; }
+        uint32_t getSsthresh() const { return ssthresh_; }
+        std::chrono::microseconds getSmoothedRtt() const { return srtt_; }
+        // Bytes delivered between the last two losses, and since the last
+        uint64_t getDeliveredBetweenLosses() const { return between_losses_; }
+        uint64_t getDeliveredSinceLoss() const { return since_loss_; }
+
+    private:
+        friend class CoupledMultipath;
+
+        Path(CoupledMultipath& owner, std::string name, TimePoint start);
+
+        CoupledMultipath& owner_;
+        std::string name_;
+        uint32_t cwnd_;
+        uint32_t ssthresh_;
+        double credit_ = 0;  // Fractional window growth, in bytes
+        std::chrono::microseconds srtt_{0};
+        TimePoint recovery_end_;
+        uint64_t between_losses_ = 0;
+        uint64_t since_loss_ = 0;
+
+        std::chrono::microseconds roundTrip() const;
+    };
+
+    CoupledMultipath();
+    explicit CoupledMultipath(const Options& options);
+
+    CoupledMultipath(const CoupledMultipath&) = delete;
+    CoupledMultipath& operator=(const CoupledMultipath&) = delete;
+
+    // The path stays valid until removePath() or the destruction of this
+    // object
+    Path& addPath(const std::string& name);
+    Path& addPath(const std::string& name, TimePoint now);
+    // The path's window no longer counts in the coupling. False if it is
+    // not one of this object's paths.
+    bool removePath(const Path& path);
+
+    size_t getPathCount() const { return paths_.size(); }
+    Path& getPath(size_t index) { return *paths_[index]; }
+    const Path& getPath(size_t index) const { return *paths_[index]; }
+    Algorithm getAlgorithm() const { return options_.algorithm; }
+
+    uint64_t getTotalWindow() const;
+    // Sum of the paths' sending rates
+    uint64_t getAggregateRate() const;
+    // LIA's alpha, the aggressiveness of the whole transfer (RFC 6356
+    // section 3): 1 when the paths are alike, more when the best path's
+    // window is a small share of the total
+    double getLiaAlpha() const;
+
+private:
+    Options options_;
+    std::vector<std::unique_ptr<Path>> paths_;
+
+    void increase(Path& path, uint32_t ackedBytes);
+    double liaIncrease(const Path& path, uint32_t ackedBytes) const;
+    double oliaIncrease(const Path& path, uint32_t ackedBytes) const;
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
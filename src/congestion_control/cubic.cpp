@@ -8,24 +8,64 @@
 namespace SRPT {
 namespace CongestionControl {
 
-Cubic::Cubic()
-    : cwnd_(INITIAL_WINDOW), ssthresh_(UINT32_MAX), w_max_(INITIAL_WINDOW), last_max_cwnd_(0),
+Cubic::Cubic() : Cubic(Common::SteadyClock::instance()) {}
+
+Cubic::Cubic(const Common::Clock& clock) : Cubic(clock.now()) {
+    clock_ = &clock;
+}
+
+Cubic::Cubic(TimePoint start)
+    : clock_(&Common::SteadyClock::instance()),
+      cwnd_(INITIAL_WINDOW), ssthresh_(UINT32_MAX), w_max_(INITIAL_WINDOW), last_max_cwnd_(0),
       k_(0), in_slow_start_(true), bytes_in_flight_(0), pacing_rate_(std::chrono::microseconds(1000000)) {
-    last_congestion_ = std::chrono::steady_clock::now();
+    last_congestion_ = start;
     last_sent_ = last_congestion_;
     last_send_time_ = last_congestion_;
     next_send_time_ = last_congestion_;
 }
 
 void Cubic::onPacketSent(uint32_t packetSize) {
-    handleIdlePeriod();
-    if (canSendPacket(packetSize)) {
-        last_sent_ = std::chrono::steady_clock::now();
+    onPacketSent(packetSize, clock_->now());
+}
+
+void Cubic::onPacketSent(uint32_t packetSize, TimePoint now) {
+    handleIdlePeriod(now);
+    if (canSendPacket(packetSize, now)) {
+        last_sent_ = now;
         bytes_in_flight_ += packetSize;
     }
 }
 
 void Cubic::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
+    onAckReceived(ackedBytes, rtt, clock_->now());
+}
+
+void Cubic::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt, TimePoint now) {
+    if (rtt.count() > 0) {
+        updateRtt(rtt);
+    }
+    growWindow(ackedBytes, rtt, now);
+}
+
+void Cubic::onAck(const AckEvent& ack) {
+    if (ack.lostPackets > 0) {
+        bytes_in_flight_ -= std::min(ack.lostPackets, bytes_in_flight_);
+        if (ack.lossCause != LossCause::WIRELESS) {
+            onPacketLoss(ack.now);
+        }
+    }
+    if (ack.ackedPackets == 0) {
+        return;
+    }
+    auto rtt = last_rtt_;
+    if (ack.rtt.count() > 0) {
+        updateRtt(ack.rtt);
+        rtt = std::chrono::duration_cast<std::chrono::milliseconds>(ack.rtt);
+    }
+    growWindow(ack.ackedPackets, rtt, ack.now);
+}
+
+void Cubic::growWindow(uint32_t ackedBytes, std::chrono::milliseconds rtt, TimePoint now) {
     bytes_in_flight_ = (bytes_in_flight_ > ackedBytes) ? bytes_in_flight_ - ackedBytes : 0;
     if (in_slow_start_) {
         cwnd_ += std::min(ackedBytes, INITIAL_WINDOW);
@@ -33,33 +73,57 @@ void Cubic::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
             in_slow_start_ = false;
         }
     } else {
-        updateCubic(rtt);
+        updateCubic(rtt, now);
     }
     updatePacingRate();
 }
 
 void Cubic::onPacketLoss() {
+    onPacketLoss(clock_->now());
+}
+
+void Cubic::onPacketLoss(TimePoint now) {
     uint32_t previous_w_max = w_max_;
     fastConvergence();
     ssthresh_ = std::max(static_cast<uint32_t>(cwnd_ * BETA_CUBIC), 2U * INITIAL_WINDOW);
     cwnd_ = ssthresh_;
     k_ = std::cbrt((w_max_ * (1 - BETA_CUBIC)) / C);
-    last_congestion_ = std::chrono::steady_clock::now();
+    last_congestion_ = now;
     in_slow_start_ = false;
 }
 
+void Cubic::adoptState(const ControllerState& state, uint32_t mss, TimePoint now) {
+    mss = std::max<uint32_t>(mss, 1);
+    cwnd_ = std::max(state.cwnd / mss, 2U);
+    bytes_in_flight_ = state.bytesInFlight / mss;
+    in_slow_start_ = state.ssthresh == UINT32_MAX;
+    ssthresh_ = in_slow_start_ ? UINT32_MAX : std::max(state.ssthresh / mss, 2U);
+    w_max_ = cwnd_;
+    last_max_cwnd_ = cwnd_;
+    k_ = 0;
+    last_congestion_ = now;
+    last_sent_ = now;
+    next_send_time_ = now;
+    if (state.smoothedRtt.count() > 0) {
+        srtt_ = state.smoothedRtt;
+        last_rtt_ = std::clamp(std::chrono::duration_cast<std::chrono::milliseconds>(state.smoothedRtt), MIN_RTT,
+                               MAX_RTT);
+    }
+}
+
 uint32_t Cubic::getCongestionWindow() const {
     return cwnd_;
 }
 
 uint32_t Cubic::getSendingRate() const {
-    auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::steady_clock::now() - last_congestion_);
-    return static_cast<uint32_t>((static_cast<uint64_t>(cwnd_) * 1000000) / rtt.count());
+    return static_cast<uint32_t>((static_cast<uint64_t>(cwnd_) * 1000000) / pacingRtt().count());
 }
 
 bool Cubic::canSendPacket(uint32_t packet_size) {
-    auto now = std::chrono::steady_clock::now();
+    return canSendPacket(packet_size, clock_->now());
+}
+
+bool Cubic::canSendPacket(uint32_t packet_size, TimePoint now) {
     bool time_condition = now >= next_send_time_;
     bool bytes_condition = bytes_in_flight_ + packet_size <= cwnd_ || bytes_in_flight_ == 0;
     
@@ -72,9 +136,24 @@ bool Cubic::canSendPacket(uint32_t packet_size) {
     return false;
 }
 
-void Cubic::updateCubic(std::chrono::milliseconds rtt) {
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - last_congestion_);
+bool Cubic::hasWindowFor(uint32_t packet_size) const {
+    return bytes_in_flight_ + packet_size <= cwnd_ || bytes_in_flight_ == 0;
+}
+
+std::chrono::steady_clock::time_point Cubic::schedulePacedSend(uint32_t packet_size) {
+    auto now = clock_->now();
+    handleIdlePeriod(now);
+    // A sender that fell behind its schedule starts again from now instead
+    // of bursting to catch up
+    auto release_time = std::max(now, next_send_time_);
+    next_send_time_ = release_time + pacing_rate_;
+    bytes_in_flight_ += packet_size;
+    last_sent_ = now;
+    return release_time;
+}
+
+void Cubic::updateCubic(std::chrono::milliseconds rtt, TimePoint now) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_congestion_);
     
     rtt = std::clamp(rtt, MIN_RTT, MAX_RTT);
     
@@ -99,27 +178,31 @@ uint32_t Cubic::cubicUpdate(std::chrono::milliseconds elapsed) {
     return static_cast<uint32_t>(std::max(w_cubic, static_cast<double>(INITIAL_WINDOW)));
 }
 
-void Cubic::enterCongestionAvoidance() {
+void Cubic::enterCongestionAvoidance(TimePoint now) {
     in_slow_start_ = false;
     w_max_ = cwnd_;
     k_ = 0;
-    last_congestion_ = std::chrono::steady_clock::now();
+    last_congestion_ = now;
+}
+
+void Cubic::updateRtt(std::chrono::microseconds rtt) {
+    srtt_ = srtt_.count() == 0 ? rtt : (srtt_ * 7 + rtt) / 8;
+}
+
+std::chrono::microseconds Cubic::pacingRtt() const {
+    // Until the first sample, the default RTT the window growth assumes
+    auto rtt = srtt_.count() > 0 ? srtt_ : std::chrono::microseconds(last_rtt_);
+    return std::max(rtt, std::chrono::microseconds(1000)); // Minimum RTT of 1ms
 }
 
 void Cubic::updatePacingRate() {
-    auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::steady_clock::now() - last_congestion_);
-    
-    rtt = std::max(rtt, std::chrono::microseconds(1000)); // Minimum RTT of 1ms
-    
-    uint64_t target_rate = static_cast<uint64_t>(cwnd_) * 1000000 / rtt.count();
+    uint64_t target_rate = static_cast<uint64_t>(cwnd_) * 1000000 / pacingRtt().count();
     uint64_t pacing_rate = target_rate / 2; // Pace at half the target rate for more visible pacing
     
     pacing_rate_ = std::chrono::microseconds(1000000 / std::max(pacing_rate, static_cast<uint64_t>(1)));
 }
 
-void Cubic::handleIdlePeriod() {
-    auto now = std::chrono::steady_clock::now();
+void Cubic::handleIdlePeriod(TimePoint now) {
     auto idle_time = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_sent_);
     
     if (idle_time > std::chrono::seconds(1)) {
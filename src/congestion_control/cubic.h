@@ -1,6 +1,7 @@
 #pragma once
 
 #include "interface.h"
+#include "../common/clock.h"
 #include <chrono>
 #include <cstdint>
 
@@ -9,18 +10,52 @@ namespace CongestionControl {
 
 class Cubic : public ICongestionControl {
 public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
     static constexpr uint32_t INITIAL_WINDOW = 10; // In packets
     static constexpr double BETA_CUBIC = 0.7;
 
     Cubic();
+    explicit Cubic(TimePoint start);
+    // The overloads without a time read `clock`, which must outlive this
+    // object; the default is the steady clock
+    explicit Cubic(const Common::Clock& clock);
     void onPacketSent(uint32_t packetSize) override;
     void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) override;
     void onPacketLoss() override;
     uint32_t getCongestionWindow() const override;
+    // Window units (packets) per smoothed RTT
     uint32_t getSendingRate() const override;
+    bool countsPackets() const override { return true; }
+    // Cubic counts packets, so this takes ackedPackets and lostPackets; a
+    // batch that lost several packets is one congestion event, and wireless
+    // losses leave the window alone
+    void onAck(const AckEvent& ack) override;
     bool canSendPacket(uint32_t packet_size);
+
+    // Same events at an explicit time, for simulated links
+    void onPacketSent(uint32_t packetSize, TimePoint now);
+    void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt, TimePoint now);
+    void onPacketLoss(TimePoint now);
+    bool canSendPacket(uint32_t packet_size, TimePoint now);
+
+    // Kernel-offloaded pacing (SO_TXTIME). Rather than refusing sends until
+    // the next pacing slot, schedulePacedSend() admits the packet and returns
+    // the time it should leave, so a whole window can be handed to the
+    // socket in one batch and the qdisc releases it on schedule. Like the
+    // window, `packet_size` is in packets: pass 1 per datagram, not its bytes.
+    bool hasWindowFor(uint32_t packet_size) const;
+    std::chrono::steady_clock::time_point schedulePacedSend(uint32_t packet_size);
+    std::chrono::microseconds getPacingInterval() const { return pacing_rate_; }
     
     uint32_t getBytes_in_flight() const { return bytes_in_flight_; }
+    bool inSlowStart() const { return in_slow_start_; }
+    std::chrono::microseconds getSmoothedRtt() const { return srtt_; }
+
+    // Take over a transfer from another controller. The window is in bytes
+    // and converted to packets of `mss`; the cubic curve restarts with its
+    // plateau at the adopted window rather than from INITIAL_WINDOW.
+    void adoptState(const ControllerState& state, uint32_t mss, TimePoint now);
 
     // New method to set SSThresh
     void setSSThresh(uint32_t new_ssthresh) { ssthresh_ = new_ssthresh; }
@@ -38,6 +73,7 @@ private:
     static constexpr std::chrono::milliseconds MAX_RTT{1000}; // 1 second
     static constexpr std::chrono::milliseconds MIN_RTT{10};   // 10 milliseconds
 
+    const Common::Clock* clock_;
     uint32_t cwnd_;           // Congestion window
     uint32_t ssthresh_;       // Slow start threshold
     uint32_t w_max_;          // Window size before last reduction
@@ -51,14 +87,18 @@ private:
     std::chrono::microseconds pacing_rate_;
     std::chrono::steady_clock::time_point next_send_time_;
     std::chrono::milliseconds last_rtt_{100};  // Initialize with a default value
+    std::chrono::microseconds srtt_{0};        // Zero until the first sample
 
     static constexpr uint32_t CWND_INCREASE_FACTOR = 1000;
 
-    void updateCubic(std::chrono::milliseconds rtt);
+    void growWindow(uint32_t ackedPackets, std::chrono::milliseconds rtt, TimePoint now);
+    void updateRtt(std::chrono::microseconds rtt);
+    std::chrono::microseconds pacingRtt() const;
+    void updateCubic(std::chrono::milliseconds rtt, TimePoint now);
     uint32_t cubicUpdate(std::chrono::milliseconds elapsed);
-    void enterCongestionAvoidance();
+    void enterCongestionAvoidance(TimePoint now);
     void updatePacingRate();
-    void handleIdlePeriod();
+    void handleIdlePeriod(TimePoint now);
     void fastConvergence();
 };
 
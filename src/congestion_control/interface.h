@@ -6,6 +6,49 @@
 namespace SRPT {
 namespace CongestionControl {
 
+// Window and path state handed to a controller taking over a transfer
+// mid-flight, so it continues from where the previous one was instead of
+// from an initial window. Bytes and bytes per second.
+struct ControllerState {
+    uint32_t cwnd = 0;
+    uint32_t ssthresh = UINT32_MAX;  // UINT32_MAX while still in slow start
+    uint32_t bytesInFlight = 0;
+    uint64_t bandwidth = 0;  // Delivery rate; 0 if not yet measured
+    std::chrono::microseconds minRtt{0};
+    std::chrono::microseconds smoothedRtt{0};
+};
+
+// Why packets were lost, as far as the sender can tell. Wireless losses
+// (rain fade, obstruction, handover) are repaired by retransmission alone;
+// cutting the window for them only costs throughput.
+enum class LossCause {
+    UNKNOWN,     // Unclassified: the controller decides
+    CONGESTION,  // Queue overflow at the bottleneck
+    WIRELESS
+};
+
+// One acknowledgement, possibly covering several packets (a stretch ack,
+// or every ack read from the socket in one batch). Built by RateSampler.
+// Bytes, microseconds and bytes per second; a zero RTT or rate means no
+// valid sample.
+struct AckEvent {
+    std::chrono::steady_clock::time_point now;
+    uint32_t ackedBytes = 0;
+    uint32_t ackedPackets = 0;
+    uint32_t lostBytes = 0;  // Declared lost by this ack
+    uint32_t lostPackets = 0;
+    LossCause lossCause = LossCause::UNKNOWN;  // Of lostBytes; see LossClassifier
+    uint32_t priorInFlight = 0;        // Bytes in flight before this ack
+    std::chrono::microseconds rtt{0};  // From the most recently sent acked packet
+    std::chrono::microseconds minRtt{0};
+    // Rate sample: `deliveredInInterval` bytes delivered over `interval`
+    uint64_t delivered = 0;  // Total delivered on the path, this ack included
+    uint64_t deliveredInInterval = 0;
+    std::chrono::microseconds interval{0};
+    uint64_t deliveryRate = 0;
+    bool appLimited = false;  // The sample is bounded by the sender, not the path
+};
+
 class ICongestionControl {
 public:
     virtual ~ICongestionControl() = default;
@@ -15,6 +58,21 @@ public:
     virtual void onPacketLoss() = 0;
     virtual uint32_t getCongestionWindow() const = 0;
     virtual uint32_t getSendingRate() const = 0;
+    // True if the methods above count packets rather than bytes (Cubic), so
+    // a caller working in bytes converts at its MSS
+    virtual bool countsPackets() const { return false; }
+
+    // Richer form of onAckReceived/onPacketLoss. The default maps it onto
+    // them, at millisecond RTT resolution and one loss per event, and drops
+    // wireless losses; controllers that use the rate sample override it.
+    virtual void onAck(const AckEvent& ack) {
+        if (ack.lostBytes > 0 && ack.lossCause != LossCause::WIRELESS) {
+            onPacketLoss();
+        }
+        if (ack.ackedBytes > 0) {
+            onAckReceived(ack.ackedBytes, std::chrono::duration_cast<std::chrono::milliseconds>(ack.rtt));
+        }
+    }
 };
 
 } // namespace CongestionControl
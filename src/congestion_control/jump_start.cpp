@@ -0,0 +1,103 @@
+#include "jump_start.h"
+#include <algorithm>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+constexpr uint32_t MIN_WINDOW_PACKETS = 2;
+constexpr uint32_t INITIAL_WINDOW_PACKETS = 10;
+}
+
+JumpStart::JumpStart() : JumpStart(Options()) {}
+
+JumpStart::JumpStart(const Options& options) : options_(options) {
+    options_.mss = std::max<uint32_t>(options_.mss, 1);
+    options_.rttTolerance = std::max(options_.rttTolerance, 1.0);
+}
+
+bool JumpStart::plan(const PathEstimate& estimate, uint32_t currentCwnd, uint32_t bytesInFlight,
+                     ControllerState& state) {
+    phase_ = Phase::IDLE;
+    if (!estimate.valid()) {
+        return false;
+    }
+    double bdp = static_cast<double>(estimate.bandwidth) * estimate.rtt.count() / 1e6;
+    double window = std::min({options_.fraction * bdp, static_cast<double>(options_.maxWindow),
+                              static_cast<double>(estimate.windowLimit)});
+    if (window <= currentCwnd) {
+        return false;
+    }
+    jump_window_ = static_cast<uint32_t>(window) / options_.mss * options_.mss;
+    expected_rtt_ = estimate.rtt;
+    sent_ = 0;
+    acked_ = 0;
+    rtt_checked_ = false;
+    rtt_mismatch_ = false;
+    phase_ = Phase::UNVALIDATED;
+
+    state = ControllerState();
+    state.cwnd = jump_window_;
+    state.bytesInFlight = bytesInFlight;
+    // Scaled like the window, so a rate-based controller paces the jump
+    // over one RTT rather than bursting it
+    state.bandwidth = static_cast<uint64_t>(options_.fraction * estimate.bandwidth);
+    state.minRtt = estimate.rtt;
+    state.smoothedRtt = estimate.rtt;
+    return true;
+}
+
+void JumpStart::onPacketSent(uint32_t bytes) {
+    if (phase_ != Phase::UNVALIDATED) {
+        return;
+    }
+    sent_ += bytes;
+    if (sent_ >= jump_window_) {
+        phase_ = Phase::VALIDATING;
+    }
+}
+
+bool JumpStart::onAck(uint32_t ackedBytes, std::chrono::microseconds rtt) {
+    if (!active()) {
+        return false;
+    }
+    if (!rtt_checked_ && rtt.count() > 0) {
+        rtt_checked_ = true;
+        if (rtt.count() * options_.rttTolerance < expected_rtt_.count() ||
+            rtt.count() > expected_rtt_.count() * options_.rttTolerance) {
+            rtt_mismatch_ = true;
+            phase_ = Phase::RETREATED;
+            return true;
+        }
+    }
+    acked_ += ackedBytes;
+    if (phase_ == Phase::VALIDATING && acked_ >= sent_) {
+        phase_ = Phase::DONE;
+    }
+    return false;
+}
+
+bool JumpStart::onLoss() {
+    if (!active()) {
+        return false;
+    }
+    phase_ = Phase::RETREATED;
+    return true;
+}
+
+ControllerState JumpStart::retreatState(uint32_t bytesInFlight) const {
+    ControllerState state;
+    state.bytesInFlight = bytesInFlight;
+    if (rtt_mismatch_) {
+        // Nothing is known about this path: slow start as if there had
+        // been no estimate
+        state.cwnd = INITIAL_WINDOW_PACKETS * options_.mss;
+        return state;
+    }
+    state.cwnd = std::max(static_cast<uint32_t>(acked_ / 2), MIN_WINDOW_PACKETS * options_.mss);
+    state.ssthresh = state.cwnd;
+    return state;
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "interface.h"
+#include <chrono>
+#include <cstdint>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// What is known about a path before the first packet: from a cached
+// earlier connection, or the provider's nominal figures
+struct PathEstimate {
+    uint64_t bandwidth = 0;  // Bytes/s
+    std::chrono::microseconds rtt{0};
+    // Largest window known to be safe, e.g. the ssthresh an earlier
+    // connection ended with; caps the jump
+    uint32_t windowLimit = UINT32_MAX;
+
+    bool valid() const { return bandwidth > 0 && rtt.count() > 0; }
+};
+
+// Jump-start for high-BDP paths, after Careful Resume
+// (draft-ietf-tsvwg-careful-resume). Slow start from 10 packets needs
+// log2(BDP / 10 MSS) round trips; at 600 ms and 100 Mbit/s that is over
+// 4 s before the pipe is full, longer than most transfers.
+//
+// Instead the window jumps to a fraction of the estimated BDP, sent paced
+// over one RTT (the controllers pace at cwnd / RTT), and stays in slow
+// start so the controller grows or cuts it from there. The jump is then
+// validated:
+//   - the first RTT sample must be within rttTolerance of the estimate,
+//     or the path is not the one the estimate was made for;
+//   - no packet of the jump may be lost to congestion before the jump is
+//     acked. Callers that can tell wireless losses apart (LossClassifier)
+//     report only congestion losses to onLoss().
+// A loss is a retreat: the window falls to half of what the path actually
+// delivered during the jump, and slow start ends there. An RTT mismatch
+// falls back to an ordinary slow start from the initial window.
+//
+// JumpStart only tracks the phases; the caller applies the planned and
+// retreat states to its controller with adoptState().
+class JumpStart {
+public:
+    enum class Phase {
+        IDLE,         // No jump planned
+        UNVALIDATED,  // Sending the jump window
+        VALIDATING,   // Jump sent, waiting for its acks
+        DONE,         // Validated
+        RETREATED
+    };
+
+    struct Options {
+        uint32_t mss = 1460;
+        double fraction = 0.5;              // Share of the estimated BDP to jump to
+        uint32_t maxWindow = 64 * 1024 * 1024;  // Bytes
+        double rttTolerance = 2.0;          // First sample within [rtt / t, rtt * t]
+    };
+
+    JumpStart();
+    explicit JumpStart(const Options& options);
+
+    // Plan a jump from `currentCwnd` (bytes). Returns false, leaving the
+    // phase IDLE, if the estimate is unusable or no larger than the window
+    // already is; otherwise `state` is filled for adoptState().
+    bool plan(const PathEstimate& estimate, uint32_t currentCwnd, uint32_t bytesInFlight, ControllerState& state);
+
+    void onPacketSent(uint32_t bytes);
+    // Both return true when the controller must retreat to retreatState()
+    bool onAck(uint32_t ackedBytes, std::chrono::microseconds rtt);
+    bool onLoss();
+
+    ControllerState retreatState(uint32_t bytesInFlight) const;
+
+    Phase getPhase() const { return phase_; }
+    bool active() const { return phase_ == Phase::UNVALIDATED || phase_ == Phase::VALIDATING; }
+    uint32_t getJumpWindow() const { return jump_window_; }
+
+private:
+    Options options_;
+    Phase phase_ = Phase::IDLE;
+    uint32_t jump_window_ = 0;
+    std::chrono::microseconds expected_rtt_{0};
+    uint64_t sent_ = 0;   // During the jump
+    uint64_t acked_ = 0;  // Of the jump
+    bool rtt_checked_ = false;
+    bool rtt_mismatch_ = false;
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,248 @@
+#include "ledbat.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+// Round trip assumed before the first RTT sample
+constexpr std::chrono::microseconds DEFAULT_RTT{100000};
+// Slow start ends once the queueing delay reaches this share of the target
+constexpr double SLOW_START_EXIT = 0.75;
+// Largest multiplicative decrease per RTT while above the target
+constexpr double MAX_DECREASE = 0.5;
+// LEDBAT++: the gain shrinks on short paths, where a window of packets per
+// RTT is a much larger rate
+constexpr double MAX_GAIN_DIVISOR = 16;
+// Satellite paths lose packets without congestion. A loss while the queue
+// is below this share of the target is taken as such and costs 10%, at
+// most once every few RTTs; a GEO window sees several per RTT at 0.1% loss
+constexpr double RANDOM_LOSS_QUEUE = 0.5;
+constexpr double RANDOM_LOSS_BETA = 0.9;
+constexpr int RANDOM_LOSS_RTTS = 4;
+// Growth per RTT, as a fraction of cwnd, while the queue is nearly empty.
+// One packet per RTT would take an hour to fill a GEO path, and the delay
+// signal stops the growth well before the buffer overflows.
+constexpr double EMPTY_QUEUE = 0.25;
+constexpr double EMPTY_QUEUE_GROWTH = 0.0625;
+constexpr int SLOWDOWN_RTTS = 2;
+// Time between slowdowns, as a multiple of the last slowdown's duration
+// (hold plus ramp back up)
+constexpr int SLOWDOWN_INTERVAL = 9;
+}
+
+Ledbat::Ledbat() : Ledbat(Options()) {}
+
+Ledbat::Ledbat(const Options& options) : Ledbat(options, std::chrono::steady_clock::now()) {}
+
+Ledbat::Ledbat(const Options& options, TimePoint start)
+    : options_(options),
+      cwnd_(INITIAL_WINDOW_PACKETS * std::max<uint32_t>(options.mss, 1)),
+      ssthresh_(std::numeric_limits<uint32_t>::max()),
+      base_delay_(options.baseHistory),
+      recovery_end_(start) {
+    options_.mss = std::max<uint32_t>(options_.mss, 1);
+    options_.target = std::max(options_.target, std::chrono::milliseconds(1));
+    options_.currentFilter = std::max<size_t>(options_.currentFilter, 1);
+}
+
+void Ledbat::onPacketSent(uint32_t packetSize) {
+    onPacketSent(packetSize, std::chrono::steady_clock::now());
+}
+
+void Ledbat::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
+    onAckReceived(ackedBytes, rtt, std::chrono::steady_clock::now());
+}
+
+void Ledbat::onPacketLoss() {
+    onPacketLoss(std::chrono::steady_clock::now());
+}
+
+uint32_t Ledbat::getCongestionWindow() const {
+    return cwnd_;
+}
+
+uint32_t Ledbat::getSendingRate() const {
+    double rate = cwnd_ * 1e6 / roundTrip().count();
+    return static_cast<uint32_t>(std::min(rate, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+}
+
+void Ledbat::onAck(const AckEvent& ack) {
+    if (ack.lostBytes > 0 && ack.lossCause != LossCause::WIRELESS) {
+        onPacketLoss(ack.now);
+    }
+    if (ack.ackedBytes > 0) {
+        onAckReceived(ack.ackedBytes, ack.rtt, ack.now);
+    }
+}
+
+void Ledbat::onPacketSent(uint32_t, TimePoint) {
+    // Window accounting is the caller's; nothing to track per send
+}
+
+void Ledbat::onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now) {
+    if (rtt.count() > 0) {
+        updateDelay(rtt, now);
+    }
+
+    if (phase_ == Phase::CONGESTION_AVOIDANCE && slowdown_scheduled_ && now >= next_slowdown_) {
+        // Let the queue drain so the base delay is measured without it
+        phase_ = Phase::SLOWDOWN;
+        slowdown_scheduled_ = false;
+        slowed_down_ = true;
+        ++slowdowns_;
+        ssthresh_ = cwnd_;
+        cwnd_ = minWindow();
+        credit_ = 0;
+        slowdown_start_ = now;
+        slowdown_end_ = now + SLOWDOWN_RTTS * roundTrip();
+    }
+    if (phase_ == Phase::SLOWDOWN) {
+        if (now < slowdown_end_) {
+            return;
+        }
+        phase_ = Phase::SLOW_START;  // Back up to ssthresh
+    }
+
+    auto queuing = getQueuingDelay();
+    double target = static_cast<double>(std::chrono::microseconds(options_.target).count());
+    if (phase_ == Phase::SLOW_START) {
+        if (queuing.count() > SLOW_START_EXIT * target) {
+            ssthresh_ = cwnd_;
+            exitSlowStart(now);
+            return;
+        }
+        credit_ += gain() * ackedBytes;
+        applyCredit();
+        if (cwnd_ >= ssthresh_) {
+            cwnd_ = ssthresh_;
+            exitSlowStart(now);
+        }
+        return;
+    }
+
+    // Additive increase below the target; above it, a decrease in
+    // proportion to how far the delay overshoots. Acks come at the
+    // bottleneck rate whatever the window, so the decrease is bounded per
+    // round trip rather than per ack; and the RTT after a decrease still
+    // carries the queue from before it, so that round does not decrease.
+    if (now >= round_end_) {
+        round_end_ = now + roundTrip();
+        round_floor_ = cwnd_ < round_start_cwnd_
+                           ? cwnd_
+                           : std::max(static_cast<uint32_t>(cwnd_ * (1 - MAX_DECREASE)), minWindow());
+        round_start_cwnd_ = cwnd_;
+    }
+    double off_target = (target - queuing.count()) / target;
+    double change = gain() * options_.mss * ackedBytes / cwnd_;
+    if (off_target >= 0) {
+        change *= off_target;
+        if (queuing.count() < EMPTY_QUEUE * target) {
+            change = std::max(change, EMPTY_QUEUE_GROWTH * ackedBytes);
+        }
+    } else {
+        change -= std::min(-off_target, MAX_DECREASE) * ackedBytes;
+    }
+    credit_ += change;
+    applyCredit();
+    if (change < 0 && cwnd_ < round_floor_) {
+        cwnd_ = round_floor_;
+        credit_ = 0;
+    }
+}
+
+void Ledbat::onPacketLoss(TimePoint now) {
+    if (phase_ == Phase::SLOWDOWN || now < recovery_end_) {
+        return;  // Already at the minimum, or the same loss event
+    }
+    double target = static_cast<double>(std::chrono::microseconds(options_.target).count());
+    credit_ = 0;
+    if (getQueuingDelay().count() < RANDOM_LOSS_QUEUE * target) {
+        // Slow start goes on: the delay signal still ends it in time
+        recovery_end_ = now + RANDOM_LOSS_RTTS * roundTrip();
+        cwnd_ = std::max(static_cast<uint32_t>(cwnd_ * RANDOM_LOSS_BETA), minWindow());
+        return;
+    }
+    recovery_end_ = now + roundTrip();
+    cwnd_ = std::max(cwnd_ / 2, minWindow());
+    ssthresh_ = cwnd_;
+    if (phase_ == Phase::SLOW_START) {
+        exitSlowStart(now);
+    }
+}
+
+void Ledbat::onPathChange(TimePoint) {
+    base_delay_.reset();
+    current_delay_.clear();
+    srtt_ = std::chrono::microseconds(0);
+}
+
+void Ledbat::adoptState(const ControllerState& state, TimePoint now) {
+    cwnd_ = std::max(state.cwnd, minWindow());
+    ssthresh_ = state.ssthresh == UINT32_MAX ? state.ssthresh : std::max(state.ssthresh, minWindow());
+    phase_ = cwnd_ < ssthresh_ ? Phase::SLOW_START : Phase::CONGESTION_AVOIDANCE;
+    credit_ = 0;
+    recovery_end_ = now;
+    if (state.minRtt.count() > 0) {
+        base_delay_.reset(state.minRtt, now);
+    }
+    if (state.smoothedRtt.count() > 0) {
+        srtt_ = state.smoothedRtt;
+    }
+    if (phase_ == Phase::CONGESTION_AVOIDANCE && !slowdown_scheduled_) {
+        exitSlowStart(now);
+    }
+}
+
+std::chrono::microseconds Ledbat::getQueuingDelay() const {
+    if (current_delay_.empty() || base_delay_.empty()) {
+        return std::chrono::microseconds(0);
+    }
+    auto current = *std::min_element(current_delay_.begin(), current_delay_.end());
+    return std::max(current - base_delay_.get(), std::chrono::microseconds(0));
+}
+
+void Ledbat::updateDelay(std::chrono::microseconds rtt, TimePoint now) {
+    srtt_ = srtt_.count() == 0 ? rtt : (srtt_ * 7 + rtt) / 8;
+    base_delay_.update(rtt, now);
+    current_delay_.push_back(rtt);
+    while (current_delay_.size() > options_.currentFilter) {
+        current_delay_.pop_front();
+    }
+}
+
+double Ledbat::gain() const {
+    auto base = getBaseDelay();
+    if (base.count() <= 0) {
+        return options_.gain;
+    }
+    double target = static_cast<double>(std::chrono::microseconds(options_.target).count());
+    return options_.gain / std::min(MAX_GAIN_DIVISOR, std::ceil(2 * target / base.count()));
+}
+
+void Ledbat::exitSlowStart(TimePoint now) {
+    phase_ = Phase::CONGESTION_AVOIDANCE;
+    if (!options_.periodicSlowdown) {
+        return;
+    }
+    // The first slowdown follows slow start after two RTTs; later ones are
+    // spaced by what the previous one cost
+    slowdown_scheduled_ = true;
+    next_slowdown_ = slowed_down_ ? now + SLOWDOWN_INTERVAL * (now - slowdown_start_)
+                                  : now + SLOWDOWN_RTTS * roundTrip();
+}
+
+void Ledbat::applyCredit() {
+    double cwnd = std::max(cwnd_ + std::trunc(credit_), static_cast<double>(minWindow()));
+    credit_ -= std::trunc(credit_);
+    cwnd_ = static_cast<uint32_t>(std::min(cwnd, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+}
+
+std::chrono::microseconds Ledbat::roundTrip() const {
+    return srtt_.count() > 0 ? srtt_ : DEFAULT_RTT;
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "interface.h"
+#include "rate_sample.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Less-than-best-effort controller after LEDBAT (RFC 6817) with the
+// LEDBAT++ changes (draft-irtf-iccrg-ledbat-plus-plus), for bulk transfers
+// that should only use capacity nothing else wants.
+//
+// The one-way queueing delay is estimated as the RTT (min of the last few
+// samples) above the base RTT (min over the last ten minutes). Below
+// `target` the window grows by up to `gain` packets per RTT, or by a
+// sixteenth per RTT while the queue is nearly empty, since a packet per
+// RTT would take the better part of an hour to fill a GEO path. Above the
+// target it shrinks multiplicatively, by up to half every other RTT, so a
+// competing flow that builds even a small queue takes the capacity within
+// a few RTTs. Slow start ends at 3/4 of the target. A loss with a queue of
+// half the target or more halves the window; one on an empty queue is a
+// link error and costs 10%.
+//
+// LEDBAT flows that start later see the earlier flows' queue as part of
+// their base RTT. To avoid that, the window periodically drops to the
+// minimum for two RTTs so the queue drains and the base RTT is measured
+// again; the time between slowdowns is nine times the slowdown's cost, so
+// at most 10% of the capacity is given up.
+//
+// A path change that raises the RTT (a LEO handover) looks like queueing
+// delay and would make the flow yield until the base history ages out;
+// callers that know of the change report it with onPathChange().
+//
+// All quantities are in bytes; getSendingRate() is in bytes per second.
+class Ledbat : public ICongestionControl {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    enum class Phase { SLOW_START, CONGESTION_AVOIDANCE, SLOWDOWN };
+
+    struct Options {
+        uint32_t mss = 1460;
+        // Queueing delay the flow may add; well under what control traffic
+        // on the same uplink notices, and above LEO RTT jitter
+        std::chrono::milliseconds target{25};
+        double gain = 1.0;  // Packets per RTT at zero queueing delay
+        std::chrono::seconds baseHistory{600};
+        size_t currentFilter = 4;  // RTT samples the current delay is the min of
+        bool periodicSlowdown = true;
+    };
+
+    static constexpr uint32_t INITIAL_WINDOW_PACKETS = 2;
+    static constexpr uint32_t MIN_WINDOW_PACKETS = 2;
+
+    Ledbat();
+    explicit Ledbat(const Options& options);
+    Ledbat(const Options& options, TimePoint start);
+
+    void onPacketSent(uint32_t packetSize) override;
+    void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) override;
+    void onPacketLoss() override;
+    uint32_t getCongestionWindow() const override;
+    uint32_t getSendingRate() const override;
+    // Microsecond RTT; a batch of losses is one loss event and wireless
+    // losses leave the window alone
+    void onAck(const AckEvent& ack) override;
+
+    // Same events at an explicit time, for simulated links
+    void onPacketSent(uint32_t packetSize, TimePoint now);
+    void onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now);
+    void onPacketLoss(TimePoint now);
+
+    // The path changed (e.g. reported by the provider): forget the base and
+    // current delay so the new path's RTT is not taken for queueing
+    void onPathChange(TimePoint now);
+
+    // Take over a transfer from another controller, keeping its window and
+    // seeding the base RTT from the measured min RTT
+    void adoptState(const ControllerState& state, TimePoint now);
+
+    Phase getPhase() const { return phase_; }
+    bool inSlowStart() const { return phase_ == Phase::SLOW_START; }
+    uint32_t getSsthresh() const { return ssthresh_; }
+    std::chrono::microseconds getBaseDelay() const { return base_delay_.get(); }
+    std::chrono::microseconds getQueuingDelay() const;
+    std::chrono::microseconds getSmoothedRtt() const { return srtt_; }
+    uint64_t getSlowdowns() const { return slowdowns_; }
+
+private:
+    Options options_;
+    uint32_t cwnd_;
+    uint32_t ssthresh_;
+    Phase phase_ = Phase::SLOW_START;
+    double credit_ = 0;  // Fractional window change, in bytes
+    std::chrono::microseconds srtt_{0};
+    WindowedMinRtt base_delay_;
+    std::deque<std::chrono::microseconds> current_delay_;
+    TimePoint recovery_end_;
+    TimePoint round_end_;
+    uint32_t round_start_cwnd_ = 0;
+    uint32_t round_floor_ = 0;  // Lowest the delay response may take the window this round
+    TimePoint next_slowdown_;
+    TimePoint slowdown_start_;
+    TimePoint slowdown_end_;
+    bool slowdown_scheduled_ = false;
+    bool slowed_down_ = false;  // slowdown_start_ is valid
+    uint64_t slowdowns_ = 0;
+
+    void updateDelay(std::chrono::microseconds rtt, TimePoint now);
+    double gain() const;
+    void exitSlowStart(TimePoint now);
+    void applyCredit();
+    std::chrono::microseconds roundTrip() const;
+    uint32_t minWindow() const { return MIN_WINDOW_PACKETS * options_.mss; }
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
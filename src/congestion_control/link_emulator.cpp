@@ -0,0 +1,290 @@
+#include "link_emulator.h"
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <random>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+constexpr uint64_t REORDER_THRESHOLD = 3;
+constexpr size_t BINS_PER_SECOND = 10;  // Delivery is counted per 100 ms
+constexpr std::chrono::milliseconds TIMEOUT_TICK{100};
+constexpr std::chrono::milliseconds MIN_TIMEOUT{200};
+
+struct Outstanding {
+    uint64_t seq;
+    LinkEmulator::TimePoint sentAt;
+    bool acked = false;
+};
+
+enum class EventType { Ack, Send, Timeout };
+
+struct Event {
+    LinkEmulator::TimePoint time;
+    EventType type;
+    uint64_t seq;
+    size_t flow;
+    // Acks held back behind a slower packet share its arrival time and
+    // must still come out in sequence
+    bool operator>(const Event& other) const {
+        if (time != other.time) {
+            return time > other.time;
+        }
+        return seq != other.seq ? seq > other.seq : flow > other.flow;
+    }
+};
+
+struct FlowState {
+    LinkEmulator::Sender* sender;
+    LinkEmulator::TimePoint start;
+    LinkEmulator::TimePoint stop;
+    std::deque<Outstanding> outstanding;  // In send order
+    LinkEmulator::TimePoint nextSend;
+    LinkEmulator::TimePoint lastAck;
+    bool sendScheduled = false;
+    uint64_t nextSeq = 0;
+    uint64_t inflight = 0;
+    std::chrono::microseconds srtt{0};
+    double queueDelaySum = 0;
+    uint64_t queued = 0;
+};
+
+std::chrono::nanoseconds transmissionTime(uint32_t bytes, double bytesPerSecond) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(bytes * 1e9 / bytesPerSecond));
+}
+}
+
+LinkEmulator::LinkEmulator(const Config& config, TimePoint start)
+    : config_(config), start_(start), clock_(start) {
+    config_.mss = std::max<uint32_t>(config_.mss, 1);
+    config_.seconds = std::max(config_.seconds, 0.0);
+}
+
+void LinkEmulator::addFlow(Sender& sender, double startSeconds, double stopSeconds) {
+    flows_.push_back(Flow{&sender, std::max(startSeconds, 0.0), stopSeconds});
+}
+
+LinkEmulator::PathState LinkEmulator::pathAt(double seconds) const {
+    if (config_.path) {
+        return config_.path(seconds);
+    }
+    return PathState{config_.rtt, config_.bytesPerSecond, config_.lossRate};
+}
+
+LinkEmulator::Result LinkEmulator::run() {
+    auto at = [&](double seconds) { return start_ + std::chrono::microseconds(static_cast<int64_t>(seconds * 1e6)); };
+    auto elapsed = [&](TimePoint time) { return std::chrono::duration<double>(time - start_).count(); };
+    const TimePoint end = at(config_.seconds);
+    const uint32_t mss = config_.mss;
+    const uint64_t receiveWindow =
+        config_.receiveWindow > 0 ? config_.receiveWindow : std::numeric_limits<uint64_t>::max();
+    uint64_t bufferBytes = config_.bufferBytes;
+    if (bufferBytes == 0) {
+        PathState initial = pathAt(0);
+        bufferBytes = static_cast<uint64_t>(initial.bytesPerSecond * initial.rtt.count() / 1e6);
+    }
+
+    std::mt19937_64 rng(config_.seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+
+    Result result;
+    std::vector<FlowState> flows;
+    for (const Flow& flow : flows_) {
+        FlowState state;
+        state.sender = flow.sender;
+        state.start = at(flow.startSeconds);
+        state.stop = flow.stopSeconds < 0 ? end : std::min(at(flow.stopSeconds), end);
+        state.nextSend = state.start;
+        state.lastAck = state.start;
+        state.srtt = pathAt(flow.startSeconds).rtt;
+        flows.push_back(std::move(state));
+        FlowResult flowResult;
+        flowResult.name = flow.sender->name();
+        result.flows.push_back(flowResult);
+    }
+
+    TimePoint now = start_;
+    TimePoint linkFree = start_;
+    TimePoint lastArrival = start_;
+    double queueDelaySum = 0;
+    uint64_t queued = 0;
+    std::vector<uint64_t> deliveredPerBin(static_cast<size_t>(config_.seconds * BINS_PER_SECOND) + 1, 0);
+
+    auto trySend = [&](size_t index) {
+        FlowState& flow = flows[index];
+        FlowResult& flowResult = result.flows[index];
+        if (now < flow.start || now >= flow.stop) {
+            return;
+        }
+        while (flow.inflight + mss <= std::min(flow.sender->windowBytes(), receiveWindow)) {
+            if (now < flow.nextSend) {
+                if (!flow.sendScheduled) {
+                    events.push(Event{flow.nextSend, EventType::Send, 0, index});
+                    flow.sendScheduled = true;
+                }
+                return;
+            }
+            uint64_t seq = flow.nextSeq++;
+            flow.outstanding.push_back(Outstanding{seq, now});
+            flow.inflight += mss;
+            flow.sender->sent(now);
+            double rate = flow.sender->pacingRate();
+            if (rate > 0) {
+                flow.nextSend = now + transmissionTime(mss, rate);
+            }
+
+            PathState path = pathAt(elapsed(now));
+            if (uniform(rng) < path.lossRate) {
+                ++flowResult.randomLosses;
+                continue;
+            }
+            auto serialization = transmissionTime(mss, path.bytesPerSecond);
+            TimePoint departure = std::max(now, linkFree) + serialization;
+            auto wait = departure - now - serialization;
+            if (std::chrono::duration<double>(wait).count() * path.bytesPerSecond > bufferBytes) {
+                ++flowResult.queueDrops;
+                continue;
+            }
+            linkFree = departure;
+            double waitMs = std::chrono::duration<double, std::milli>(wait).count();
+            queueDelaySum += waitMs;
+            ++queued;
+            flow.queueDelaySum += waitMs;
+            ++flow.queued;
+            TimePoint arrival = departure + path.rtt;
+            if (config_.jitter.count() > 0) {
+                arrival += std::chrono::microseconds(static_cast<int64_t>(uniform(rng) * config_.jitter.count()));
+            }
+            // FIFO end to end: neither jitter nor an RTT drop lets a packet
+            // overtake
+            lastArrival = std::max(arrival, lastArrival);
+            events.push(Event{lastArrival, EventType::Ack, seq, index});
+        }
+    };
+
+    auto declareLost = [&](FlowState& flow) {
+        flow.inflight -= mss;
+        flow.sender->lost(now);
+    };
+
+    events.push(Event{start_ + TIMEOUT_TICK, EventType::Timeout, 0, 0});
+    for (size_t index = 0; index < flows.size(); ++index) {
+        events.push(Event{flows[index].start, EventType::Send, 0, index});
+        flows[index].sendScheduled = true;
+    }
+    while (!events.empty() && events.top().time < end) {
+        Event event = events.top();
+        events.pop();
+        now = event.time;
+        clock_.set(now);
+        switch (event.type) {
+            case EventType::Send:
+                flows[event.flow].sendScheduled = false;
+                trySend(event.flow);
+                break;
+            case EventType::Ack: {
+                FlowState& flow = flows[event.flow];
+                flow.lastAck = now;
+                auto it = std::lower_bound(
+                    flow.outstanding.begin(), flow.outstanding.end(), event.seq,
+                    [](const Outstanding& packet, uint64_t seq) { return packet.seq < seq; });
+                if (it == flow.outstanding.end() || it->seq != event.seq) {
+                    break;  // Already declared lost by the timeout
+                }
+                auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(now - it->sentAt);
+                flow.srtt = (flow.srtt * 7 + rtt) / 8;
+                it->acked = true;
+                flow.inflight -= mss;
+                result.flows[event.flow].deliveredBytes += mss;
+                deliveredPerBin[static_cast<size_t>(elapsed(now) * BINS_PER_SECOND)] += mss;
+                flow.sender->acked(rtt, now);
+                // Acks arrive in order, so anything older than the reorder
+                // threshold that is still unacked was lost
+                while (!flow.outstanding.empty() && (flow.outstanding.front().acked ||
+                                                     flow.outstanding.front().seq + REORDER_THRESHOLD < event.seq)) {
+                    if (!flow.outstanding.front().acked) {
+                        declareLost(flow);
+                    }
+                    flow.outstanding.pop_front();
+                }
+                trySend(event.flow);
+                break;
+            }
+            case EventType::Timeout:
+                // Retransmission timeout: the tail of a flight was lost
+                for (size_t index = 0; index < flows.size(); ++index) {
+                    FlowState& flow = flows[index];
+                    if (!flow.outstanding.empty() && now - flow.lastAck > flow.srtt * 2 + MIN_TIMEOUT) {
+                        for (const auto& packet : flow.outstanding) {
+                            if (!packet.acked) {
+                                declareLost(flow);
+                            }
+                        }
+                        flow.outstanding.clear();
+                        flow.lastAck = now;
+                    }
+                    trySend(index);
+                }
+                events.push(Event{now + TIMEOUT_TICK, EventType::Timeout, 0, 0});
+                break;
+        }
+    }
+
+    size_t bins = static_cast<size_t>(config_.seconds * BINS_PER_SECOND);
+    std::vector<double> capacityPerBin(bins, 0);
+    for (size_t bin = 0; bin < bins; ++bin) {
+        for (int slice = 0; slice < 10; ++slice) {
+            capacityPerBin[bin] += pathAt((bin + slice / 10.0) / BINS_PER_SECOND).bytesPerSecond / 10 / BINS_PER_SECOND;
+        }
+        result.capacityBytes += capacityPerBin[bin];
+    }
+    // Utilization over a sliding second, so ack clocking within an RTT does
+    // not read as idle time
+    double windowDelivered = 0;
+    double windowCapacity = 0;
+    for (size_t bin = 0; bin < bins && result.secondsTo90 < 0; ++bin) {
+        windowDelivered += deliveredPerBin[bin];
+        windowCapacity += capacityPerBin[bin];
+        if (bin >= BINS_PER_SECOND) {
+            windowDelivered -= deliveredPerBin[bin - BINS_PER_SECOND];
+            windowCapacity -= capacityPerBin[bin - BINS_PER_SECOND];
+        }
+        if (bin + 1 >= BINS_PER_SECOND && windowDelivered >= 0.9 * windowCapacity) {
+            result.secondsTo90 = static_cast<double>(bin + 1) / BINS_PER_SECOND;
+        }
+    }
+
+    std::vector<double> goodputs;
+    for (size_t index = 0; index < flows.size(); ++index) {
+        FlowResult& flowResult = result.flows[index];
+        const FlowState& flow = flows[index];
+        flowResult.activeSeconds = std::max(std::chrono::duration<double>(flow.stop - flow.start).count(), 0.0);
+        flowResult.averageQueueDelayMs = flow.queued ? flow.queueDelaySum / flow.queued : 0;
+        result.deliveredBytes += flowResult.deliveredBytes;
+        result.randomLosses += flowResult.randomLosses;
+        result.queueDrops += flowResult.queueDrops;
+        if (flowResult.activeSeconds > 0) {
+            goodputs.push_back(flowResult.deliveredBytes / flowResult.activeSeconds);
+        }
+    }
+    result.averageQueueDelayMs = queued ? queueDelaySum / queued : 0;
+    result.fairness = jainFairness(goodputs);
+    return result;
+}
+
+double jainFairness(const std::vector<double>& values) {
+    double sum = 0;
+    double squares = 0;
+    for (double value : values) {
+        sum += value;
+        squares += value * value;
+    }
+    return squares > 0 ? sum * sum / (values.size() * squares) : 1.0;
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
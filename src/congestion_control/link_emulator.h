@@ -0,0 +1,133 @@
+#pragma once
+
+#include "interface.h"
+#include "../common/clock.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Deterministic discrete-event emulator of one bottleneck link shared by
+// several flows, for comparing controllers without wall-clock noise.
+//
+// The link is a drop-tail FIFO draining at the bottleneck rate, followed by
+// a propagation delay (the configured RTT, ack path included) with optional
+// per-packet jitter, and independent random loss on the forward path.
+// Packets never overtake each other. Rate, RTT and loss can instead come
+// from a PathTrace evaluated at send time, to replay GEO and LEO paths
+// (handover RTT steps, outages).
+//
+// Each flow is a greedy sender driven by its Sender: packets go out while
+// the window allows, paced when the sender gives a rate; a packet is lost
+// once three later ones are acked, or when nothing has been acked for two
+// smoothed RTTs plus 200 ms.
+//
+// Everything happens in simulated time and the only randomness is a
+// generator seeded from the config, so the same config gives the same
+// result, and an hour of a 50 Mbit/s transfer takes seconds of CPU.
+//
+// All quantities are in bytes and seconds unless named otherwise.
+class LinkEmulator {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    // A flow's congestion controller as the emulator drives it
+    class Sender {
+    public:
+        virtual ~Sender() = default;
+        virtual const char* name() const = 0;
+        virtual void sent(TimePoint now) = 0;
+        virtual void acked(std::chrono::microseconds rtt, TimePoint now) = 0;
+        virtual void lost(TimePoint now) = 0;
+        virtual uint64_t windowBytes() const = 0;
+        virtual double pacingRate() const = 0;  // Bytes/s; 0 when ack-clocked only
+        // Take over window and path state; controllers without adoptState()
+        // ignore it
+        virtual void adopt(const ControllerState&, TimePoint) {}
+    };
+
+    struct PathState {
+        std::chrono::microseconds rtt;
+        double bytesPerSecond;
+        double lossRate;
+    };
+
+    // Path conditions at `seconds` since the start of the run
+    using PathTrace = std::function<PathState(double seconds)>;
+
+    struct Config {
+        double seconds = 120;
+        double bytesPerSecond = 50e6 / 8;
+        std::chrono::microseconds rtt{600000};
+        // Extra one-way delay per packet, uniform in [0, jitter]
+        std::chrono::microseconds jitter{0};
+        double lossRate = 0;
+        uint64_t bufferBytes = 0;    // Bottleneck queue; 0 is one BDP
+        uint64_t receiveWindow = 0;  // Cap on each flow's inflight; 0 is none
+        uint32_t mss = 1460;
+        uint64_t seed = 1;
+        PathTrace path;  // Replaces rate, RTT and loss when set
+    };
+
+    struct FlowResult {
+        std::string name;
+        uint64_t deliveredBytes = 0;
+        double activeSeconds = 0;
+        uint64_t randomLosses = 0;
+        uint64_t queueDrops = 0;
+        double averageQueueDelayMs = 0;
+
+        double goodputMbps() const { return activeSeconds > 0 ? deliveredBytes * 8 / activeSeconds / 1e6 : 0; }
+    };
+
+    struct Result {
+        std::vector<FlowResult> flows;
+        uint64_t deliveredBytes = 0;
+        double capacityBytes = 0;  // What the bottleneck could have carried
+        uint64_t randomLosses = 0;
+        uint64_t queueDrops = 0;
+        double averageQueueDelayMs = 0;
+        double secondsTo90 = -1;  // End of the first 1 s window (in 100 ms steps) at >= 90% of capacity
+        // Jain's index over the flows' goodput: 1 for an equal split, 1/n
+        // when one flow takes everything
+        double fairness = 1;
+
+        double goodputMbps(double seconds) const { return deliveredBytes * 8 / seconds / 1e6; }
+        double utilization() const { return capacityBytes > 0 ? deliveredBytes / capacityBytes : 0; }
+    };
+
+    LinkEmulator(const Config& config, TimePoint start);
+
+    // `sender` must outlive run(). The flow sends from `startSeconds` until
+    // `stopSeconds` into the run, or to the end when that is negative.
+    void addFlow(Sender& sender, double startSeconds = 0, double stopSeconds = -1);
+
+    Result run();
+
+    // Simulated time, at the current event during run(); for controllers
+    // that read a Clock rather than taking explicit times
+    const Common::Clock& getClock() const { return clock_; }
+    PathState pathAt(double seconds) const;
+
+private:
+    struct Flow {
+        Sender* sender;
+        double startSeconds;
+        double stopSeconds;
+    };
+
+    Config config_;
+    TimePoint start_;
+    Common::ManualClock clock_;
+    std::vector<Flow> flows_;
+};
+
+// Jain's fairness index of `values`, (sum x)^2 / (n * sum x^2)
+double jainFairness(const std::vector<double>& values);
+
+} // namespace CongestionControl
+} // namespace SRPT
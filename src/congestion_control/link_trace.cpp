@@ -0,0 +1,346 @@
+#include "link_trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+const char MAGIC[4] = {'S', 'R', 'T', 'R'};
+constexpr int64_t RTT_UNIT_US = 100;
+constexpr uint64_t RATE_UNIT_BPS = 1000;
+constexpr double LOSS_UNIT = 1e-6;
+constexpr size_t MAX_VARINT_BYTES = 10;
+constexpr size_t MAX_PROVIDER_LENGTH = 255;
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class Reader {
+public:
+    explicit Reader(const std::vector<uint8_t>& data) : data_(data) {}
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (size_t i = 0; i < MAX_VARINT_BYTES; ++i) {
+            if (pos_ >= data_.size()) {
+                return false;
+            }
+            uint8_t byte = data_[pos_++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    bool bytes(size_t count, std::string& out) {
+        if (data_.size() - pos_ < count) {
+            return false;
+        }
+        out.assign(data_.begin() + pos_, data_.begin() + pos_ + count);
+        pos_ += count;
+        return true;
+    }
+    bool done() const { return pos_ == data_.size(); }
+
+private:
+    const std::vector<uint8_t>& data_;
+    size_t pos_ = 0;
+};
+
+LinkTrace::Sample quantize(const LinkTrace::Sample& sample) {
+    LinkTrace::Sample rounded = sample;
+    rounded.rtt = std::chrono::microseconds((sample.rtt.count() + RTT_UNIT_US / 2) / RTT_UNIT_US * RTT_UNIT_US);
+    rounded.bitsPerSecond = (sample.bitsPerSecond + RATE_UNIT_BPS / 2) / RATE_UNIT_BPS * RATE_UNIT_BPS;
+    rounded.lossRate = std::round(std::clamp(sample.lossRate, 0.0, 1.0) / LOSS_UNIT) * LOSS_UNIT;
+    return rounded;
+}
+}
+
+bool LinkTrace::addSample(const Sample& sample) {
+    if (sample.at.count() < 0 || sample.rtt.count() < 0 || (!samples_.empty() && sample.at < samples_.back().at)) {
+        lastError_ = "Sample out of order at " + std::to_string(sample.at.count()) + " ms";
+        return false;
+    }
+    samples_.push_back(quantize(sample));
+    return true;
+}
+
+bool LinkTrace::addOutage(const Outage& outage) {
+    if (outage.start.count() < 0 || outage.duration.count() < 0 ||
+        (!outages_.empty() && outage.start < outages_.back().end())) {
+        lastError_ = "Outage out of order at " + std::to_string(outage.start.count()) + " ms";
+        return false;
+    }
+    outages_.push_back(outage);
+    return true;
+}
+
+void LinkTrace::clear() {
+    provider_.clear();
+    samples_.clear();
+    outages_.clear();
+}
+
+std::chrono::milliseconds LinkTrace::duration() const {
+    std::chrono::milliseconds end{0};
+    if (!samples_.empty()) {
+        end = samples_.back().at;
+        if (samples_.size() > 1) {
+            end += samples_.back().at - samples_[samples_.size() - 2].at;
+        }
+    }
+    if (!outages_.empty()) {
+        end = std::max(end, outages_.back().end());
+    }
+    return end;
+}
+
+LinkTrace::Sample LinkTrace::sampleAt(std::chrono::milliseconds at) const {
+    if (samples_.empty()) {
+        return Sample();
+    }
+    auto it = std::upper_bound(samples_.begin(), samples_.end(), at,
+                               [](std::chrono::milliseconds time, const Sample& sample) { return time < sample.at; });
+    return it == samples_.begin() ? *it : *std::prev(it);
+}
+
+bool LinkTrace::inOutage(std::chrono::milliseconds at) const {
+    auto it = std::upper_bound(outages_.begin(), outages_.end(), at,
+                               [](std::chrono::milliseconds time, const Outage& outage) { return time < outage.start; });
+    return it != outages_.begin() && at < std::prev(it)->end();
+}
+
+std::vector<uint8_t> LinkTrace::serialize() const {
+    std::vector<uint8_t> out(MAGIC, MAGIC + sizeof(MAGIC));
+    out.push_back(FORMAT_VERSION);
+    out.push_back(0);  // Flags
+    size_t length = std::min(provider_.size(), MAX_PROVIDER_LENGTH);
+    putVarint(out, length);
+    out.insert(out.end(), provider_.begin(), provider_.begin() + length);
+
+    putVarint(out, samples_.size());
+    Sample previous;
+    for (const Sample& sample : samples_) {
+        putVarint(out, static_cast<uint64_t>((sample.at - previous.at).count()));
+        putVarint(out, zigzag((sample.rtt.count() - previous.rtt.count()) / RTT_UNIT_US));
+        putVarint(out, zigzag(static_cast<int64_t>(sample.bitsPerSecond / RATE_UNIT_BPS) -
+                              static_cast<int64_t>(previous.bitsPerSecond / RATE_UNIT_BPS)));
+        putVarint(out, zigzag(std::llround(sample.lossRate / LOSS_UNIT) - std::llround(previous.lossRate / LOSS_UNIT)));
+        previous = sample;
+    }
+
+    putVarint(out, outages_.size());
+    std::chrono::milliseconds previousStart{0};
+    for (const Outage& outage : outages_) {
+        putVarint(out, static_cast<uint64_t>((outage.start - previousStart).count()));
+        putVarint(out, static_cast<uint64_t>(outage.duration.count()));
+        previousStart = outage.start;
+    }
+    return out;
+}
+
+bool LinkTrace::deserialize(const std::vector<uint8_t>& data) {
+    if (data.size() < sizeof(MAGIC) + 2 || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), data.begin())) {
+        lastError_ = "Not a link trace";
+        return false;
+    }
+    if (data[sizeof(MAGIC)] != FORMAT_VERSION) {
+        lastError_ = "Unsupported trace version " + std::to_string(data[sizeof(MAGIC)]);
+        return false;
+    }
+    std::vector<uint8_t> body(data.begin() + sizeof(MAGIC) + 2, data.end());
+    Reader reader(body);
+    LinkTrace trace;
+    uint64_t length = 0;
+    uint64_t count = 0;
+    if (!reader.varint(length) || length > MAX_PROVIDER_LENGTH || !reader.bytes(length, trace.provider_) ||
+        !reader.varint(count)) {
+        lastError_ = "Truncated trace header";
+        return false;
+    }
+
+    int64_t at = 0;
+    int64_t rtt = 0;
+    int64_t rate = 0;
+    int64_t loss = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t delta = 0;
+        uint64_t rttDelta = 0;
+        uint64_t rateDelta = 0;
+        uint64_t lossDelta = 0;
+        if (!reader.varint(delta) || !reader.varint(rttDelta) || !reader.varint(rateDelta) ||
+            !reader.varint(lossDelta)) {
+            lastError_ = "Truncated sample " + std::to_string(i);
+            return false;
+        }
+        at += static_cast<int64_t>(delta);
+        rtt += unzigzag(rttDelta);
+        rate += unzigzag(rateDelta);
+        loss += unzigzag(lossDelta);
+        Sample sample;
+        sample.at = std::chrono::milliseconds(at);
+        sample.rtt = std::chrono::microseconds(rtt * RTT_UNIT_US);
+        sample.bitsPerSecond = rate < 0 ? 0 : static_cast<uint64_t>(rate) * RATE_UNIT_BPS;
+        sample.lossRate = loss * LOSS_UNIT;
+        if (rtt < 0 || rate < 0 || loss < 0 || loss > 1 / LOSS_UNIT || !trace.addSample(sample)) {
+            lastError_ = "Invalid sample " + std::to_string(i);
+            return false;
+        }
+    }
+
+    if (!reader.varint(count)) {
+        lastError_ = "Truncated outage list";
+        return false;
+    }
+    int64_t start = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t delta = 0;
+        uint64_t duration = 0;
+        if (!reader.varint(delta) || !reader.varint(duration)) {
+            lastError_ = "Truncated outage " + std::to_string(i);
+            return false;
+        }
+        start += static_cast<int64_t>(delta);
+        Outage outage{std::chrono::milliseconds(start), std::chrono::milliseconds(duration)};
+        if (!trace.addOutage(outage)) {
+            lastError_ = "Invalid outage " + std::to_string(i);
+            return false;
+        }
+    }
+    if (!reader.done()) {
+        lastError_ = "Trailing bytes after trace";
+        return false;
+    }
+    provider_ = std::move(trace.provider_);
+    samples_ = std::move(trace.samples_);
+    outages_ = std::move(trace.outages_);
+    return true;
+}
+
+bool LinkTrace::parseText(const std::string& text) {
+    LinkTrace trace;
+    std::istringstream in(text);
+    std::string line;
+    for (size_t number = 1; std::getline(in, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first)) {
+            continue;
+        }
+        std::string rest;
+        bool ok = false;
+        if (first == "provider") {
+            ok = static_cast<bool>(fields >> trace.provider_);
+        } else if (first == "outage") {
+            int64_t start = 0;
+            int64_t duration = 0;
+            ok = fields >> start >> duration &&
+                 trace.addOutage(Outage{std::chrono::milliseconds(start), std::chrono::milliseconds(duration)});
+        } else {
+            char* end = nullptr;
+            double at = std::strtod(first.c_str(), &end);
+            double rttMs = 0;
+            double mbps = 0;
+            double lossPercent = 0;
+            ok = *end == '\0' && fields >> rttMs >> mbps >> lossPercent && at >= 0 && rttMs >= 0 && mbps >= 0 &&
+                 lossPercent >= 0 && lossPercent <= 100;
+            if (ok) {
+                Sample sample;
+                sample.at = std::chrono::milliseconds(std::llround(at));
+                sample.rtt = std::chrono::microseconds(std::llround(rttMs * 1000));
+                sample.bitsPerSecond = static_cast<uint64_t>(std::llround(mbps * 1e6));
+                sample.lossRate = lossPercent / 100;
+                ok = trace.addSample(sample);
+            }
+        }
+        if (!ok || fields >> rest) {
+            lastError_ = "Malformed trace line " + std::to_string(number);
+            return false;
+        }
+    }
+    provider_ = std::move(trace.provider_);
+    samples_ = std::move(trace.samples_);
+    outages_ = std::move(trace.outages_);
+    return true;
+}
+
+bool LinkTrace::save(const std::string& path) const {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            lastError_ = "Cannot open " + temporary + " for writing";
+            return false;
+        }
+        auto data = serialize();
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        out.flush();
+        if (!out) {
+            lastError_ = "Write to " + temporary + " failed";
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        lastError_ = "Cannot rename " + temporary + " to " + path;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool LinkTrace::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        lastError_ = "Cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() >= sizeof(MAGIC) && std::equal(MAGIC, MAGIC + sizeof(MAGIC), data.begin())) {
+        return deserialize(data);
+    }
+    return parseText(std::string(data.begin(), data.end()));
+}
+
+LinkEmulator::PathTrace LinkTrace::replay(bool loop) const {
+    auto trace = std::make_shared<const LinkTrace>(*this);
+    auto period = duration();
+    return [trace, period, loop](double seconds) {
+        auto at = std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000));
+        if (loop && period.count() > 0) {
+            at %= period;
+        }
+        Sample sample = trace->sampleAt(at);
+        LinkEmulator::PathState state{sample.rtt, sample.bitsPerSecond / 8.0, sample.lossRate};
+        if (trace->inOutage(at) || sample.bitsPerSecond == 0) {
+            // The emulator needs a rate to serialize at
+            state.bytesPerSecond = std::max(state.bytesPerSecond, 1.0);
+            state.lossRate = 1;
+        }
+        return state;
+    };
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
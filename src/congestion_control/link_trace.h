@@ -0,0 +1,96 @@
+#pragma once
+
+#include "link_emulator.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// A recorded satellite link: RTT, capacity and loss over time, plus the
+// intervals the terminal had no link at all. Each sample holds until the
+// next one. A terminal logging once a second gives a day of Starlink in
+// about half a megabyte, small enough to check in next to the tests that
+// replay it.
+//
+// The binary file is "SRTR", a version byte and a flags byte, then varints:
+// the provider name (length and bytes), the sample count and per sample
+// the time since the previous sample in ms, then the changes (zigzag) in
+// RTT in units of 100 us, in capacity in kbit/s and in loss rate in parts
+// per million; then the outage count and per outage the time since the
+// previous outage started and its duration, in ms.
+//
+// Recorders that cannot write it produce text, one record per line, which
+// load() also reads:
+//   provider starlink
+//   <ms> <rtt ms> <capacity Mbit/s> <loss %>
+//   outage <start ms> <duration ms>
+// with '#' starting a comment.
+class LinkTrace {
+public:
+    struct Sample {
+        std::chrono::milliseconds at{0};  // Since the start of the trace
+        std::chrono::microseconds rtt{0};
+        uint64_t bitsPerSecond = 0;
+        double lossRate = 0;
+    };
+
+    struct Outage {
+        std::chrono::milliseconds start{0};
+        std::chrono::milliseconds duration{0};
+
+        std::chrono::milliseconds end() const { return start + duration; }
+    };
+
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
+    // Samples and outages must come in time order, and outages must not
+    // overlap; false otherwise. The RTT is rounded to 100 us, the capacity
+    // to 1 kbit/s and the loss rate to one in a million, the resolution of
+    // the file, so a trace is unchanged by a round trip through it.
+    bool addSample(const Sample& sample);
+    bool addOutage(const Outage& outage);
+    void clear();
+
+    void setProvider(const std::string& provider) { provider_ = provider; }
+    const std::string& getProvider() const { return provider_; }
+    const std::vector<Sample>& getSamples() const { return samples_; }
+    const std::vector<Outage>& getOutages() const { return outages_; }
+    bool empty() const { return samples_.empty(); }
+    // Up to the end of the last outage, or the last sample plus the gap
+    // before it, so a looped trace keeps its rhythm
+    std::chrono::milliseconds duration() const;
+
+    // The sample in effect at `at`; the first before the trace starts, the
+    // last after it ends. Empty traces give a zero sample.
+    Sample sampleAt(std::chrono::milliseconds at) const;
+    bool inOutage(std::chrono::milliseconds at) const;
+
+    std::vector<uint8_t> serialize() const;
+    // Replaces the trace. False, with the trace unchanged, on a malformed
+    // or truncated buffer or an unknown version.
+    bool deserialize(const std::vector<uint8_t>& data);
+    bool parseText(const std::string& text);
+
+    // Written to a temporary file and renamed over `path`
+    bool save(const std::string& path) const;
+    // Binary or text, told apart by the magic
+    bool load(const std::string& path);
+    std::string getLastError() const { return lastError_; }
+
+    // Path conditions for the LinkEmulator, restarting from the beginning
+    // when `loop` is set. An outage is total loss at the recorded rate, so
+    // the emulated senders see a blackout rather than a slow link.
+    LinkEmulator::PathTrace replay(bool loop = true) const;
+
+private:
+    std::string provider_;
+    std::vector<Sample> samples_;
+    std::vector<Outage> outages_;
+    mutable std::string lastError_;
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,133 @@
+#include "loss_classifier.h"
+#include <algorithm>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+// Evidence weights; a total of zero or more is congestion
+constexpr int STANDING_QUEUE_WEIGHT = 2;
+constexpr int RISING_DELAY_WEIGHT = 1;
+constexpr int EMPTY_QUEUE_WEIGHT = -1;
+constexpr int BURST_WEIGHT = -1;
+}
+
+LossClassifier::LossClassifier() : LossClassifier(Options()) {}
+
+LossClassifier::LossClassifier(const Options& options)
+    : options_(options), min_rtt_(options.minRttWindow) {
+    options_.queueDelayDivisor = std::max(options_.queueDelayDivisor, 1);
+    options_.burstLosses = std::max<uint32_t>(options_.burstLosses, 1);
+}
+
+void LossClassifier::onRttSample(std::chrono::microseconds rtt, TimePoint now) {
+    if (rtt.count() <= 0) {
+        return;
+    }
+    min_rtt_.update(rtt, now);
+    if (fast_rtt_.count() == 0) {
+        fast_rtt_ = rtt;
+        slow_rtt_ = rtt;
+        return;
+    }
+    fast_rtt_ = (fast_rtt_ * 3 + rtt) / 4;
+    slow_rtt_ = (slow_rtt_ * 31 + rtt) / 32;
+}
+
+void LossClassifier::onSignalStrength(double strength, TimePoint now) {
+    if (strength <= 0 && !signal_seen_) {
+        return;  // Not measured by this provider
+    }
+    signal_seen_ = true;
+    last_signal_ = SignalSample{now, strength};
+    while (!signal_max_.empty() && signal_max_.back().strength <= strength) {
+        signal_max_.pop_back();
+    }
+    signal_max_.push_back(last_signal_);
+    while (now - signal_max_.front().time > options_.signalWindow) {
+        signal_max_.pop_front();
+    }
+}
+
+LossCause LossClassifier::classify(uint32_t lostPackets, TimePoint now) {
+    pruneLosses(now);
+    losses_.push_back(LossRecord{now, std::max<uint32_t>(lostPackets, 1)});
+
+    LossCause cause;
+    if (signalDegraded(now)) {
+        cause = LossCause::WIRELESS;
+    } else if (fast_rtt_.count() == 0) {
+        cause = LossCause::UNKNOWN;
+    } else {
+        int score = 0;
+        if (queueStanding()) {
+            score += STANDING_QUEUE_WEIGHT;
+        } else if (getQueueDelay() < queueThreshold() / 2) {
+            score += EMPTY_QUEUE_WEIGHT;
+        }
+        if (delayRising()) {
+            score += RISING_DELAY_WEIGHT;
+        }
+        if (inBurst(now)) {
+            score += BURST_WEIGHT;
+        }
+        cause = score >= 0 ? LossCause::CONGESTION : LossCause::WIRELESS;
+    }
+
+    switch (cause) {
+        case LossCause::CONGESTION:
+            ++stats_.congestion;
+            break;
+        case LossCause::WIRELESS:
+            ++stats_.wireless;
+            break;
+        case LossCause::UNKNOWN:
+            ++stats_.unknown;
+            break;
+    }
+    return cause;
+}
+
+std::chrono::microseconds LossClassifier::getQueueDelay() const {
+    auto base = min_rtt_.get();
+    return fast_rtt_ > base ? fast_rtt_ - base : std::chrono::microseconds(0);
+}
+
+bool LossClassifier::queueStanding() const {
+    return fast_rtt_.count() > 0 && getQueueDelay() > queueThreshold();
+}
+
+bool LossClassifier::delayRising() const {
+    return fast_rtt_ > slow_rtt_ && fast_rtt_ - slow_rtt_ > queueThreshold() / 2;
+}
+
+bool LossClassifier::signalDegraded(TimePoint now) const {
+    if (!signal_seen_ || now - last_signal_.time > options_.signalWindow) {
+        return false;  // No recent reading
+    }
+    double recent_max = signal_max_.empty() ? last_signal_.strength : signal_max_.front().strength;
+    return last_signal_.strength < options_.weakSignal || last_signal_.strength < recent_max - options_.signalDrop;
+}
+
+bool LossClassifier::inBurst(TimePoint now) const {
+    uint32_t packets = 0;
+    for (const LossRecord& loss : losses_) {
+        if (now - loss.time <= options_.burstWindow) {
+            packets += loss.packets;
+        }
+    }
+    return packets >= options_.burstLosses;
+}
+
+std::chrono::microseconds LossClassifier::queueThreshold() const {
+    return std::max(options_.queueDelayMin, min_rtt_.get() / options_.queueDelayDivisor);
+}
+
+void LossClassifier::pruneLosses(TimePoint now) {
+    while (!losses_.empty() && now - losses_.front().time > options_.burstWindow) {
+        losses_.pop_front();
+    }
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "interface.h"
+#include "rate_sample.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Tells queue-overflow losses from wireless ones (rain fade, obstruction,
+// handover), so the controller only backs off for the first kind.
+//
+// Three signals are weighed when a loss is reported:
+//   - delay: a standing queue (smoothed RTT well above the min RTT) or an
+//     RTT that is still climbing points to congestion; a flat RTT at the
+//     floor means the bottleneck queue was empty and could not overflow;
+//   - loss pattern: a burst of losses within a short window, with the
+//     queue not standing, is typical of a fade or an obstruction;
+//   - signal strength from the provider: a weak signal, or one that dropped
+//     within the last few seconds, explains the loss on its own.
+// Strong congestion evidence (a standing queue) outweighs a burst; a
+// degraded signal outweighs a standing queue, which a fade itself builds
+// as the link slows. A tie counts as congestion.
+//
+// Feed it every RTT sample and, when the provider has one, the signal
+// strength in [0, 1]; a provider that does not measure it reports 0, which
+// is ignored until a positive reading has been seen.
+class LossClassifier {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Options {
+        // Queueing delay above max(queueDelayMin, min RTT / divisor) is a standing queue
+        std::chrono::microseconds queueDelayMin{4000};
+        int queueDelayDivisor = 8;
+        std::chrono::seconds minRttWindow{10};
+        std::chrono::milliseconds burstWindow{100};
+        uint32_t burstLosses = 3;  // Losses within burstWindow that make a burst
+        double weakSignal = 0.3;
+        double signalDrop = 0.2;  // Below the recent maximum by this much
+        std::chrono::milliseconds signalWindow{2000};
+    };
+
+    struct Stats {
+        uint64_t congestion = 0;
+        uint64_t wireless = 0;
+        uint64_t unknown = 0;  // Before the first RTT sample
+    };
+
+    LossClassifier();
+    explicit LossClassifier(const Options& options);
+
+    void onRttSample(std::chrono::microseconds rtt, TimePoint now);
+    void onSignalStrength(double strength, TimePoint now);
+    // Classify `lostPackets` lost at `now`; they count towards later bursts
+    LossCause classify(uint32_t lostPackets, TimePoint now);
+
+    std::chrono::microseconds getMinRtt() const { return min_rtt_.get(); }
+    std::chrono::microseconds getQueueDelay() const;
+    bool queueStanding() const;
+    bool delayRising() const;
+    bool signalDegraded(TimePoint now) const;
+    bool inBurst(TimePoint now) const;
+    const Stats& getStats() const { return stats_; }
+
+private:
+    struct SignalSample {
+        TimePoint time;
+        double strength;
+    };
+    struct LossRecord {
+        TimePoint time;
+        uint32_t packets;
+    };
+
+    Options options_;
+    WindowedMinRtt min_rtt_;
+    std::chrono::microseconds fast_rtt_{0};  // Gain 1/4: the current delay
+    std::chrono::microseconds slow_rtt_{0};  // Gain 1/32: the delay a few RTTs ago
+    std::deque<SignalSample> signal_max_;    // Monotonic queue for the windowed max
+    SignalSample last_signal_{};
+    bool signal_seen_ = false;
+    std::deque<LossRecord> losses_;  // Within burstWindow
+    Stats stats_;
+
+    std::chrono::microseconds queueThreshold() const;
+    void pruneLosses(TimePoint now);
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,185 @@
+#include "path_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+constexpr const char* FILE_HEADER = "# srpt path cache v1";
+// Weight of a new connection's bandwidth and loss rate
+constexpr double SAMPLE_WEIGHT = 0.5;
+
+bool persistable(const std::string& key) {
+    return !key.empty() && key.find_first_of("\t\n\r") == std::string::npos;
+}
+}
+
+PathCache::PathCache() : PathCache(Options()) {}
+
+PathCache::PathCache(const Options& options) : options_(options) {
+    options_.capacity = std::max<size_t>(options_.capacity, 1);
+}
+
+void PathCache::store(const std::string& peer, const std::string& provider, const Entry& sample) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(Key(peer, provider));
+    if (it == entries_.end() || expired(it->second, sample.updated)) {
+        entries_[Key(peer, provider)] = sample;
+        evictLocked();
+        return;
+    }
+    Entry& entry = it->second;
+    if (sample.minRtt.count() > 0) {
+        entry.minRtt = sample.minRtt;
+    }
+    if (sample.bandwidth > 0) {
+        entry.bandwidth = entry.bandwidth == 0
+                              ? sample.bandwidth
+                              : static_cast<uint64_t>(SAMPLE_WEIGHT * sample.bandwidth +
+                                                      (1 - SAMPLE_WEIGHT) * entry.bandwidth);
+    }
+    if (sample.ssthresh != UINT32_MAX) {
+        entry.ssthresh = sample.ssthresh;
+    }
+    entry.lossRate = SAMPLE_WEIGHT * sample.lossRate + (1 - SAMPLE_WEIGHT) * entry.lossRate;
+    entry.updated = std::max(entry.updated, sample.updated);
+}
+
+void PathCache::store(const std::string& peer, const std::string& provider, const ControllerState& state,
+                      double lossRate, Clock::time_point now) {
+    Entry sample;
+    sample.minRtt = state.minRtt;
+    sample.bandwidth = state.bandwidth;
+    sample.ssthresh = state.ssthresh;
+    sample.lossRate = lossRate;
+    sample.updated = now;
+    store(peer, provider, sample);
+}
+
+bool PathCache::lookup(const std::string& peer, const std::string& provider, Entry& entry,
+                       Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(Key(peer, provider));
+    if (it == entries_.end() || expired(it->second, now)) {
+        return false;
+    }
+    entry = it->second;
+    auto age = std::chrono::duration<double>(now - entry.updated).count();
+    double half_life = std::chrono::duration<double>(options_.bandwidthHalfLife).count();
+    if (age > 0 && half_life > 0) {
+        entry.bandwidth = static_cast<uint64_t>(entry.bandwidth * std::exp2(-age / half_life));
+    }
+    return true;
+}
+
+void PathCache::erase(const std::string& peer, const std::string& provider) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(Key(peer, provider));
+}
+
+void PathCache::expire(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        it = expired(it->second, now) ? entries_.erase(it) : std::next(it);
+    }
+}
+
+size_t PathCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void PathCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+bool PathCache::save(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            lastError_ = "Cannot open " + temporary + " for writing";
+            return false;
+        }
+        out << FILE_HEADER << '\n';
+        for (const auto& item : entries_) {
+            if (!persistable(item.first.first) || !persistable(item.first.second)) {
+                continue;
+            }
+            const Entry& entry = item.second;
+            auto updated = std::chrono::duration_cast<std::chrono::milliseconds>(entry.updated.time_since_epoch());
+            out << item.first.first << '\t' << item.first.second << '\t' << entry.minRtt.count() << '\t'
+                << entry.bandwidth << '\t' << entry.ssthresh << '\t' << entry.lossRate << '\t' << updated.count()
+                << '\n';
+        }
+        out.flush();
+        if (!out) {
+            lastError_ = "Write to " + temporary + " failed";
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        lastError_ = "Cannot rename " + temporary + " to " + path;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PathCache::load(const std::string& path, Clock::time_point now) {
+    std::ifstream in(path);
+    if (!in) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_ = "Cannot open " + path;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string peer, provider;
+        int64_t min_rtt = 0;
+        int64_t updated = 0;
+        Entry entry;
+        if (!std::getline(fields, peer, '\t') || !std::getline(fields, provider, '\t') ||
+            !(fields >> min_rtt >> entry.bandwidth >> entry.ssthresh >> entry.lossRate >> updated)) {
+            continue;
+        }
+        entry.minRtt = std::chrono::microseconds(min_rtt);
+        entry.updated = Clock::time_point(std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(updated)));
+        if (!persistable(peer) || !persistable(provider) || expired(entry, now)) {
+            continue;
+        }
+        store(peer, provider, entry);
+    }
+    return true;
+}
+
+std::string PathCache::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+bool PathCache::expired(const Entry& entry, Clock::time_point now) const {
+    return now - entry.updated > options_.maxAge;
+}
+
+void PathCache::evictLocked() {
+    while (entries_.size() > options_.capacity) {
+        auto oldest = std::min_element(entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+            return a.second.updated < b.second.updated;
+        });
+        entries_.erase(oldest);
+    }
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "interface.h"
+#include "jump_start.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// What earlier connections learned about a path, keyed by peer and
+// provider, so a reconnection to the same ground station starts from the
+// measured path instead of from nothing (like Linux tcp_metrics).
+//
+// Entries age: the bandwidth a lookup reports halves every
+// bandwidthHalfLife, so an old measurement leads to a smaller jump, and
+// entries older than maxAge are dropped. Timestamps are wall-clock so the
+// cache can be saved to disk and loaded by the next process.
+//
+// Thread-safe.
+class PathCache {
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Entry {
+        std::chrono::microseconds minRtt{0};
+        uint64_t bandwidth = 0;          // Bytes/s
+        uint32_t ssthresh = UINT32_MAX;  // Bytes; UINT32_MAX if slow start never ended
+        double lossRate = 0;
+        Clock::time_point updated{};
+
+        PathEstimate estimate() const { return PathEstimate{bandwidth, minRtt, ssthresh}; }
+    };
+
+    struct Options {
+        std::chrono::seconds maxAge{3600};
+        std::chrono::seconds bandwidthHalfLife{600};
+        size_t capacity = 1024;  // The least recently updated entry goes first
+    };
+
+    PathCache();
+    explicit PathCache(const Options& options);
+
+    // Merge a connection's measurements into the entry: RTT and ssthresh
+    // replace the cached values, bandwidth and loss rate are averaged with
+    // them so one bad connection does not overwrite the history
+    void store(const std::string& peer, const std::string& provider, const Entry& sample);
+    void store(const std::string& peer, const std::string& provider, const ControllerState& state, double lossRate,
+               Clock::time_point now = Clock::now());
+    // False if there is no entry or it has expired; the bandwidth is aged
+    bool lookup(const std::string& peer, const std::string& provider, Entry& entry,
+                Clock::time_point now = Clock::now()) const;
+    void erase(const std::string& peer, const std::string& provider);
+    void expire(Clock::time_point now = Clock::now());
+    size_t size() const;
+    void clear();
+
+    // One entry per line, tab-separated; written to a temporary file and
+    // renamed over `path`. Keys containing tabs or newlines are not saved.
+    bool save(const std::string& path) const;
+    // Adds the file's unexpired entries to the cache; malformed lines are
+    // skipped. False if the file cannot be read.
+    bool load(const std::string& path, Clock::time_point now = Clock::now());
+    std::string getLastError() const;
+
+private:
+    using Key = std::pair<std::string, std::string>;
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> entries_;
+    mutable std::string lastError_;
+
+    bool expired(const Entry& entry, Clock::time_point now) const;
+    void evictLocked();
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
@@ -0,0 +1,129 @@
+#include "rate_sample.h"
+#include <algorithm>
+
+namespace SRPT {
+namespace CongestionControl {
+
+void WindowedMinRtt::update(std::chrono::microseconds rtt, TimePoint now) {
+    if (rtt.count() <= 0) {
+        return;
+    }
+    while (!samples_.empty() && samples_.back().rtt >= rtt) {
+        samples_.pop_back();
+    }
+    samples_.push_back(Sample{now, rtt});
+    while (now - samples_.front().time > window_) {
+        samples_.pop_front();
+    }
+}
+
+void WindowedMinRtt::reset(std::chrono::microseconds rtt, TimePoint now) {
+    samples_.clear();
+    update(rtt, now);
+}
+
+std::chrono::microseconds WindowedMinRtt::get() const {
+    return samples_.empty() ? std::chrono::microseconds(0) : samples_.front().rtt;
+}
+
+RateSampler::RateSampler() : RateSampler(MIN_RTT_WINDOW) {}
+
+RateSampler::RateSampler(std::chrono::microseconds minRttWindow) : min_rtt_(minRttWindow) {}
+
+void RateSampler::onPacketSent(uint64_t packetNumber, uint32_t bytes, TimePoint now) {
+    if (bytes_in_flight_ == 0) {
+        // Restarting from idle: the pause is not part of any interval
+        first_sent_time_ = now;
+        delivered_time_ = now;
+    }
+    auto inserted = in_flight_.emplace(packetNumber, SentPacket{now, first_sent_time_, delivered_time_, delivered_,
+                                                                 bytes, app_limited_until_ != 0});
+    if (inserted.second) {
+        bytes_in_flight_ += bytes;
+    }
+}
+
+void RateSampler::onAppLimited() {
+    app_limited_until_ = std::max<uint64_t>(delivered_ + bytes_in_flight_, 1);
+}
+
+void RateSampler::onPacketAcked(uint64_t packetNumber, TimePoint now) {
+    auto it = in_flight_.find(packetNumber);
+    if (it == in_flight_.end()) {
+        return;
+    }
+    openEvent();
+    const SentPacket& packet = it->second;
+    delivered_ += packet.bytes;
+    delivered_time_ = now;
+    bytes_in_flight_ -= std::min(packet.bytes, bytes_in_flight_);
+    event_.ackedBytes += packet.bytes;
+    ++event_.ackedPackets;
+
+    // The most recently sent packet of the ack gives both the RTT and the
+    // rate sample's starting point
+    if (!have_sample_ || packet.sent >= newest_sent_) {
+        have_sample_ = true;
+        newest_sent_ = packet.sent;
+        prior_delivered_ = packet.delivered;
+        prior_time_ = packet.deliveredTime;
+        send_elapsed_ = std::chrono::duration_cast<std::chrono::microseconds>(packet.sent - packet.firstSent);
+        event_.appLimited = packet.appLimited;
+        event_.rtt = std::chrono::duration_cast<std::chrono::microseconds>(now - packet.sent);
+        first_sent_time_ = packet.sent;
+    }
+    in_flight_.erase(it);
+}
+
+void RateSampler::onPacketLost(uint64_t packetNumber) {
+    auto it = in_flight_.find(packetNumber);
+    if (it == in_flight_.end()) {
+        return;
+    }
+    openEvent();
+    bytes_in_flight_ -= std::min(it->second.bytes, bytes_in_flight_);
+    event_.lostBytes += it->second.bytes;
+    ++event_.lostPackets;
+    in_flight_.erase(it);
+}
+
+AckEvent RateSampler::takeAckEvent(TimePoint now) {
+    openEvent();
+    event_open_ = false;
+    event_.now = now;
+    if (app_limited_until_ != 0 && delivered_ > app_limited_until_) {
+        app_limited_until_ = 0;
+    }
+    min_rtt_.update(event_.rtt, now);
+    event_.minRtt = min_rtt_.get();
+    event_.delivered = delivered_;
+    if (!have_sample_) {
+        return event_;
+    }
+
+    // Over the longer of the send and ack intervals: a burst of acks
+    // (compression) shortens the ack interval, a burst of sends the other
+    auto ack_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(delivered_time_ - prior_time_);
+    auto interval = std::max(send_elapsed_, ack_elapsed);
+    event_.deliveredInInterval = delivered_ - prior_delivered_;
+    event_.interval = interval;
+    // An interval shorter than the min RTT cannot be right (the packet
+    // timestamps predate an idle restart, say); report no rate
+    if (interval.count() > 0 && interval >= event_.minRtt) {
+        event_.deliveryRate = event_.deliveredInInterval * 1000000 / static_cast<uint64_t>(interval.count());
+    }
+    return event_;
+}
+
+void RateSampler::openEvent() {
+    if (event_open_) {
+        return;
+    }
+    event_ = AckEvent();
+    event_.priorInFlight = bytes_in_flight_;
+    have_sample_ = false;
+    event_open_ = true;
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
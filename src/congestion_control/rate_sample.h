@@ -0,0 +1,114 @@
+#pragma once
+
+#include "interface.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Minimum RTT over a sliding time window. A monotonic queue: a sample
+// evicts every older sample that is no smaller, so the front is always the
+// window's minimum and each sample is pushed and popped at most once.
+class WindowedMinRtt {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    explicit WindowedMinRtt(std::chrono::microseconds window) : window_(window) {}
+
+    void update(std::chrono::microseconds rtt, TimePoint now);
+    // Forget every sample, e.g. after a path change
+    void reset() { samples_.clear(); }
+    // Restart the window from a single known value
+    void reset(std::chrono::microseconds rtt, TimePoint now);
+
+    // Zero until the first sample
+    std::chrono::microseconds get() const;
+    std::chrono::microseconds getWindow() const { return window_; }
+    bool empty() const { return samples_.empty(); }
+
+private:
+    struct Sample {
+        TimePoint time;
+        std::chrono::microseconds rtt;
+    };
+
+    std::chrono::microseconds window_;
+    std::deque<Sample> samples_;
+};
+
+// Sender-side delivery-rate estimation after the Linux tcp_rate scheme
+// (draft-cheng-iccrg-delivery-rate-estimation). Each packet remembers how
+// much had been delivered when it was sent; when it is acked, the bytes
+// delivered since, over the longer of the send and ack intervals, give a
+// rate sample that neither ack compression nor stretched acks inflate.
+//
+// Report every packet with onPacketSent(), then for each ack (or batch of
+// acks read from the socket together) call onPacketAcked()/onPacketLost()
+// for the packets it covers and takeAckEvent() to close it. The event
+// carries the newest RTT sample, the windowed min RTT and the rate sample,
+// ready for ICongestionControl::onAck().
+//
+// Packet numbers identify packets and must not be reused; a retransmission
+// is a new packet number.
+class RateSampler {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    static constexpr std::chrono::seconds MIN_RTT_WINDOW{10};
+
+    RateSampler();
+    explicit RateSampler(std::chrono::microseconds minRttWindow);
+
+    void onPacketSent(uint64_t packetNumber, uint32_t bytes, TimePoint now);
+    // The application has nothing to send although the window has room.
+    // Rate samples taken until the packets now in flight are delivered are
+    // marked app-limited: they measure the sender, not the path.
+    void onAppLimited();
+
+    // Unknown and already-reported packet numbers are ignored
+    void onPacketAcked(uint64_t packetNumber, TimePoint now);
+    void onPacketLost(uint64_t packetNumber);
+    // Close the current ack and return it; ackedBytes and lostBytes are
+    // zero if nothing was reported since the last call
+    AckEvent takeAckEvent(TimePoint now);
+
+    uint32_t getBytesInFlight() const { return bytes_in_flight_; }
+    uint64_t getDelivered() const { return delivered_; }
+    std::chrono::microseconds getMinRtt() const { return min_rtt_.get(); }
+    bool isAppLimited() const { return app_limited_until_ != 0; }
+
+private:
+    struct SentPacket {
+        TimePoint sent;
+        TimePoint firstSent;      // Send time of the newest acked packet when this was sent
+        TimePoint deliveredTime;  // Time of the newest ack when this was sent
+        uint64_t delivered;       // delivered_ when this was sent
+        uint32_t bytes;
+        bool appLimited;
+    };
+
+    std::map<uint64_t, SentPacket> in_flight_;
+    uint32_t bytes_in_flight_ = 0;
+    uint64_t delivered_ = 0;
+    TimePoint delivered_time_;
+    TimePoint first_sent_time_;
+    uint64_t app_limited_until_ = 0;  // delivered_ at which app-limited ends; 0 if not limited
+    WindowedMinRtt min_rtt_;
+
+    // Current ack
+    AckEvent event_;
+    bool have_sample_ = false;
+    uint64_t prior_delivered_ = 0;
+    TimePoint prior_time_;
+    std::chrono::microseconds send_elapsed_{0};
+    TimePoint newest_sent_;
+    bool event_open_ = false;
+
+    void openEvent();
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
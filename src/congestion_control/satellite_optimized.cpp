@@ -0,0 +1,251 @@
+#include "satellite_optimized.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SRPT {
+namespace CongestionControl {
+
+namespace {
+constexpr double SLOW_START_PACING_GAIN = 2.0;
+constexpr double PACING_GAIN = 1.2;
+// A change of the per-round RTT floor at least this large is a step; a
+// filling queue moves the floor by far less per round
+constexpr std::chrono::microseconds RTT_STEP_MIN{8000};
+constexpr double RTT_STEP_FRACTION = 0.2;
+// Queueing delay above max(4 ms, base RTT / 8) means the bottleneck queue
+// is standing: slow start ends, and losses are taken as congestion
+constexpr std::chrono::microseconds QUEUE_DELAY_MIN{4000};
+constexpr int QUEUE_DELAY_DIVISOR = 8;
+// Reduction for a loss with no standing queue (link errors, rain fade)
+constexpr double RANDOM_LOSS_BETA = 0.9;
+// Congestion-avoidance growth per RTT, as a fraction of cwnd, while no
+// queue is standing
+constexpr double EMPTY_QUEUE_GROWTH = 0.125;
+}
+
+SatelliteOptimized::SatelliteOptimized() : SatelliteOptimized(Options()) {}
+
+SatelliteOptimized::SatelliteOptimized(const Options& options)
+    : SatelliteOptimized(options, std::chrono::steady_clock::now()) {}
+
+SatelliteOptimized::SatelliteOptimized(const Options& options, TimePoint start)
+    : options_(options),
+      cwnd_(INITIAL_WINDOW_PACKETS * std::max<uint32_t>(options.mss, 1)),
+      ssthresh_(std::numeric_limits<uint32_t>::max()),
+      recovery_end_(start),
+      handover_until_(start) {
+    options_.mss = std::max<uint32_t>(options_.mss, 1);
+    options_.referenceRtt = std::max(options_.referenceRtt, std::chrono::milliseconds(1));
+}
+
+void SatelliteOptimized::onPacketSent(uint32_t packetSize) {
+    onPacketSent(packetSize, std::chrono::steady_clock::now());
+}
+
+void SatelliteOptimized::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
+    onAckReceived(ackedBytes, rtt, std::chrono::steady_clock::now());
+}
+
+void SatelliteOptimized::onPacketLoss() {
+    onPacketLoss(std::chrono::steady_clock::now());
+}
+
+uint32_t SatelliteOptimized::getCongestionWindow() const {
+    return cwnd_;
+}
+
+uint32_t SatelliteOptimized::getSendingRate() const {
+    auto rtt = srtt_.count() > 0 ? srtt_ : std::chrono::microseconds(options_.referenceRtt);
+    double gain = inSlowStart() ? SLOW_START_PACING_GAIN : PACING_GAIN;
+    double rate = gain * cwnd_ * 1e6 / rtt.count();
+    return static_cast<uint32_t>(std::min(rate, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+}
+
+void SatelliteOptimized::onAck(const AckEvent& ack) {
+    if (ack.lostBytes > 0) {
+        onLoss(ack.lossCause, ack.now);
+    }
+    if (ack.ackedBytes > 0) {
+        onAckReceived(ack.ackedBytes, ack.rtt, ack.now);
+    }
+}
+
+void SatelliteOptimized::onPacketSent(uint32_t, TimePoint) {
+    // Window accounting is the caller's; nothing to track per send
+}
+
+void SatelliteOptimized::onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now) {
+    if (rtt.count() > 0) {
+        updateRtt(rtt, now);
+    }
+
+    uint64_t cwnd = cwnd_;
+    if (inSlowStart()) {
+        // 2^rho - 1 packets per acked packet: rho doublings per RTT
+        double increment = std::exp2(std::min(rho_, MAX_SLOW_START_RHO)) - 1.0;
+        cwnd += static_cast<uint64_t>(increment * ackedBytes);
+        if (queueStanding(rtt) && !inHandover(now)) {
+            // Queue is building: stop before the overshoot turns into loss
+            ssthresh_ = static_cast<uint32_t>(std::min<uint64_t>(cwnd, std::numeric_limits<uint32_t>::max()));
+        }
+    } else {
+        // rho^2 packets per RTT; while the RTT shows no queue the window is
+        // below the BDP (random losses cut it there), so probe faster
+        double increment = rho_ * rho_ * options_.mss * ackedBytes / static_cast<double>(cwnd_);
+        if (!queueStanding(rtt)) {
+            increment = std::max(increment, ackedBytes * EMPTY_QUEUE_GROWTH);
+        }
+        ca_credit_ += increment;
+        uint64_t whole = static_cast<uint64_t>(ca_credit_);
+        cwnd += whole;
+        ca_credit_ -= whole;
+    }
+    cwnd_ = static_cast<uint32_t>(std::min<uint64_t>(cwnd, std::numeric_limits<uint32_t>::max()));
+}
+
+void SatelliteOptimized::onPacketLoss(TimePoint now) {
+    onLoss(LossCause::UNKNOWN, now);
+}
+
+void SatelliteOptimized::onLoss(LossCause cause, TimePoint now) {
+    if (inHandover(now)) {
+        ++handover_losses_;
+        return;
+    }
+    if (cause == LossCause::WIRELESS) {
+        ++random_losses_;
+        return;
+    }
+    if (now < recovery_end_) {
+        return;  // Same loss event
+    }
+    // Unclassified losses without a standing queue are link errors: back
+    // off a little so a shallow buffer still converges, but do not halve
+    bool congestion = cause == LossCause::CONGESTION || srtt_.count() == 0 || queueStanding(srtt_);
+    double beta = congestion ? options_.beta : RANDOM_LOSS_BETA;
+    if (!congestion) {
+        ++random_losses_;
+    }
+    ssthresh_ = std::max(static_cast<uint32_t>(cwnd_ * beta), minWindow());
+    cwnd_ = ssthresh_;
+    ca_credit_ = 0;
+    auto rtt = srtt_.count() > 0 ? srtt_ : std::chrono::microseconds(options_.referenceRtt);
+    recovery_end_ = now + rtt;
+}
+
+void SatelliteOptimized::onPathChange(TimePoint now) {
+    ++path_changes_;
+    base_rtt_.reset();
+    srtt_ = std::chrono::microseconds(0);
+    // Floors from the old path say nothing about the new one
+    round_floor_ = last_floor_ = step_floor_ = std::chrono::microseconds(0);
+    auto rtt = last_rtt_.count() > 0 ? last_rtt_ : std::chrono::microseconds(options_.referenceRtt);
+    handover_until_ = std::max(handover_until_, now + options_.handoverGuard + rtt);
+}
+
+bool SatelliteOptimized::inHandover(TimePoint now) const {
+    if (now < handover_until_) {
+        return true;
+    }
+    if (options_.handoverPeriod.count() <= 0 || now < options_.handoverEpoch) {
+        return false;
+    }
+    // Losses from a scheduled handover are noticed up to an RTT later
+    auto period = std::chrono::duration_cast<std::chrono::microseconds>(options_.handoverPeriod);
+    auto phase = std::chrono::duration_cast<std::chrono::microseconds>(now - options_.handoverEpoch) % period;
+    return phase < options_.handoverGuard + srtt_;
+}
+
+void SatelliteOptimized::adoptState(const ControllerState& state, TimePoint now) {
+    cwnd_ = std::max(state.cwnd, minWindow());
+    ssthresh_ = state.ssthresh == UINT32_MAX ? state.ssthresh : std::max(state.ssthresh, minWindow());
+    ca_credit_ = 0;
+    recovery_end_ = now;
+    if (state.minRtt.count() > 0) {
+        base_rtt_.reset(state.minRtt, now);
+        updateRho();
+    }
+    if (state.smoothedRtt.count() > 0) {
+        srtt_ = state.smoothedRtt;
+        last_rtt_ = state.smoothedRtt;
+    }
+}
+
+std::chrono::microseconds SatelliteOptimized::getBaseRtt() const {
+    return base_rtt_.get();
+}
+
+void SatelliteOptimized::updateRtt(std::chrono::microseconds rtt, TimePoint now) {
+    last_rtt_ = rtt;
+    if (checkRttStep(rtt, now)) {
+        // Guard from where the step began, not from its confirmation
+        onPathChange(step_since_);
+    }
+    srtt_ = srtt_.count() == 0 ? rtt : (srtt_ * 7 + rtt) / 8;
+    base_rtt_.update(rtt, now);
+
+    updateRho();
+}
+
+void SatelliteOptimized::updateRho() {
+    double rtt_ratio = static_cast<double>(getBaseRtt().count()) /
+                       std::chrono::duration_cast<std::chrono::microseconds>(options_.referenceRtt).count();
+    rho_ = std::max(rtt_ratio, 1.0);
+}
+
+bool SatelliteOptimized::queueStanding(std::chrono::microseconds rtt) const {
+    auto base = getBaseRtt();
+    return base.count() > 0 && rtt > base + std::max(QUEUE_DELAY_MIN, base / QUEUE_DELAY_DIVISOR);
+}
+
+bool SatelliteOptimized::checkRttStep(std::chrono::microseconds rtt, TimePoint now) {
+    if (round_floor_.count() == 0) {
+        // First sample of a round; a round lasts one RTT
+        round_floor_ = rtt;
+        round_start_ = now;
+        round_end_ = now + std::max(srtt_, rtt);
+        return false;
+    }
+    round_floor_ = std::min(round_floor_, rtt);
+    if (now < round_end_) {
+        return false;
+    }
+    auto floor = round_floor_;
+    round_floor_ = std::chrono::microseconds(0);
+
+    auto distance = [](std::chrono::microseconds a, std::chrono::microseconds b) {
+        return a > b ? a - b : b - a;
+    };
+    auto threshold = [](std::chrono::microseconds from) {
+        return std::max(RTT_STEP_MIN, std::chrono::microseconds(
+            static_cast<int64_t>(from.count() * RTT_STEP_FRACTION)));
+    };
+
+    bool step = false;
+    if (step_floor_.count() > 0) {
+        // The floor has to stay at its new level; anything else was jitter
+        if (distance(floor, step_floor_) > threshold(step_floor_) / 2) {
+            step_floor_ = std::chrono::microseconds(0);
+        } else if (++step_rounds_ >= STEP_HOLD_ROUNDS) {
+            step_floor_ = std::chrono::microseconds(0);
+            step = true;
+        }
+    }
+    if (!step && step_floor_.count() == 0 && last_floor_.count() > 0) {
+        // A queue draining after a window cut brings the floor back down to
+        // the base RTT, never below it: only a drop below both is a step
+        auto below = std::min(last_floor_, getBaseRtt().count() > 0 ? getBaseRtt() : last_floor_);
+        auto limit = threshold(last_floor_);
+        if (floor >= last_floor_ + limit || floor + limit <= below) {
+            step_floor_ = floor;
+            step_rounds_ = 0;
+            step_since_ = round_start_;
+        }
+    }
+    last_floor_ = floor;
+    return step;
+}
+
+} // namespace CongestionControl
+} // namespace SRPT
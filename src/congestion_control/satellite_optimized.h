@@ -0,0 +1,125 @@
+#pragma once
+
+#include "interface.h"
+#include "rate_sample.h"
+#include <chrono>
+#include <cstdint>
+
+namespace SRPT {
+namespace CongestionControl {
+
+// Loss-based controller for long and changing satellite RTTs.
+//
+// Window growth is scaled Hybla-style by rho = RTT / REFERENCE_RTT, so a
+// 600 ms GEO path opens its window as fast in wall-clock time as a 25 ms
+// terrestrial one instead of 24x slower. Sending is paced at cwnd / RTT.
+// Loss only halves the window when the RTT shows a standing queue; a loss
+// on an empty queue is a link error and costs a 10% reduction.
+//
+// LEO handovers move the path RTT in steps every few seconds. Individual
+// samples jitter by more than a handover step, so steps are detected on the
+// RTT floor (min sample) of each round: a floor that moves by a step and
+// holds there for STEP_HOLD_ROUNDS more rounds (as opposed to jitter, or the
+// gradual rise of a filling queue) is taken as a path change. The base-RTT
+// estimate restarts from the new path, and losses within a short guard
+// window from the start of the step do not cut the window; losses before
+// the step is confirmed are handled as usual.
+// Handovers on a known schedule (Starlink reconfigures every 15 s) can be
+// configured up front, and callers that learn of a handover from the
+// provider can report it with onPathChange().
+//
+// All quantities are in bytes; getSendingRate() is in bytes per second.
+class SatelliteOptimized : public ICongestionControl {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Options {
+        uint32_t mss = 1460;
+        std::chrono::milliseconds referenceRtt{25};
+        double beta = 0.5;  // Multiplicative decrease on congestion loss
+        // Scheduled handovers: every `handoverPeriod` starting at
+        // `handoverEpoch`; zero period disables the schedule
+        std::chrono::milliseconds handoverPeriod{0};
+        TimePoint handoverEpoch{};
+        std::chrono::milliseconds handoverGuard{200};
+    };
+
+    static constexpr uint32_t INITIAL_WINDOW_PACKETS = 10;
+    static constexpr uint32_t MIN_WINDOW_PACKETS = 2;
+    // Caps the per-ack slow-start increment at 2^MAX_SLOW_START_RHO - 1
+    // packets, bounding the overshoot before the first loss or delay signal
+    static constexpr double MAX_SLOW_START_RHO = 4.0;
+    static constexpr std::chrono::seconds BASE_RTT_WINDOW{10};
+    // Rounds a moved RTT floor has to hold before it counts as a path change
+    static constexpr uint32_t STEP_HOLD_ROUNDS = 2;
+
+    SatelliteOptimized();
+    explicit SatelliteOptimized(const Options& options);
+    SatelliteOptimized(const Options& options, TimePoint start);
+
+    void onPacketSent(uint32_t packetSize) override;
+    void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) override;
+    void onPacketLoss() override;
+    uint32_t getCongestionWindow() const override;
+    uint32_t getSendingRate() const override;
+    // Losses in one event are one loss for the window: they fall in the
+    // same recovery period anyway. A classified cause overrides the
+    // standing-queue test; wireless losses do not reduce the window at all.
+    void onAck(const AckEvent& ack) override;
+
+    // Same events at an explicit time, for simulated links
+    void onPacketSent(uint32_t packetSize, TimePoint now);
+    void onAckReceived(uint32_t ackedBytes, std::chrono::microseconds rtt, TimePoint now);
+    void onPacketLoss(TimePoint now);
+
+    // The path changed (e.g. reported by the provider): rebase the RTT
+    // estimates and ignore losses for the guard window
+    void onPathChange(TimePoint now);
+    bool inHandover(TimePoint now) const;
+
+    // Take over a transfer from another controller, keeping its window and
+    // seeding the base RTT (and so rho) from the measured min RTT
+    void adoptState(const ControllerState& state, TimePoint now);
+
+    double getRho() const { return rho_; }
+    bool inSlowStart() const { return cwnd_ < ssthresh_; }
+    uint32_t getSsthresh() const { return ssthresh_; }
+    std::chrono::microseconds getBaseRtt() const;
+    std::chrono::microseconds getSmoothedRtt() const { return srtt_; }
+    uint64_t getHandoverLosses() const { return handover_losses_; }
+    uint64_t getRandomLosses() const { return random_losses_; }
+    uint64_t getPathChanges() const { return path_changes_; }
+
+private:
+    Options options_;
+    uint32_t cwnd_;
+    uint32_t ssthresh_;
+    double rho_ = 1.0;
+    double ca_credit_ = 0;  // Fractional congestion-avoidance growth, in bytes
+    std::chrono::microseconds srtt_{0};
+    std::chrono::microseconds last_rtt_{0};
+    WindowedMinRtt base_rtt_{BASE_RTT_WINDOW};
+    // RTT step detection on per-round floors
+    std::chrono::microseconds round_floor_{0};
+    std::chrono::microseconds last_floor_{0};
+    std::chrono::microseconds step_floor_{0};
+    uint32_t step_rounds_ = 0;
+    TimePoint round_start_;
+    TimePoint round_end_;
+    TimePoint step_since_;
+    TimePoint recovery_end_;
+    TimePoint handover_until_;
+    uint64_t handover_losses_ = 0;
+    uint64_t random_losses_ = 0;
+    uint64_t path_changes_ = 0;
+
+    void onLoss(LossCause cause, TimePoint now);
+    void updateRtt(std::chrono::microseconds rtt, TimePoint now);
+    bool checkRttStep(std::chrono::microseconds rtt, TimePoint now);
+    bool queueStanding(std::chrono::microseconds rtt) const;
+    void updateRho();
+    uint32_t minWindow() const { return MIN_WINDOW_PACKETS * options_.mss; }
+};
+
+} // namespace CongestionControl
+} // namespace SRPT
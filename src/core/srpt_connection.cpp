@@ -1,53 +1,82 @@
 #include "srpt_connection.h"
+#include <algorithm>
 
 namespace SRPT {
 
-SRPTConnection::SRPTConnection() 
-    : state_(SRPTConnectionState::CLOSED),
-      lastActivityTime_(std::chrono::steady_clock::now()),
-      keepAliveInterval_(std::chrono::seconds(60)) // Default to 60 seconds
+SRPTConnection::SRPTConnection() : SRPTConnection(Common::SteadyClock::instance()) {}
+
+SRPTConnection::SRPTConnection(const Common::Clock& clock)
+    : clock_(clock),
+      state_(SRPTConnectionState::CLOSED),
+      lastActivityTime_(clock_.now()),
+      keepAliveInterval_(std::chrono::seconds(60)), // Default to 60 seconds
+      receive_window_size_(DEFAULT_RECEIVE_WINDOW),
+      available_window_size_(DEFAULT_RECEIVE_WINDOW),
+      advertised_window_size_(DEFAULT_RECEIVE_WINDOW),
+      retransmissionTimeout_(DEFAULT_RETRANSMISSION_TIMEOUT),
+      currentRetransmissionTimeout_(DEFAULT_RETRANSMISSION_TIMEOUT),
+      lastPeerActivityTime_(lastActivityTime_),
+      timeWaitDuration_(DEFAULT_TIME_WAIT),
+      idleTimeout_(0)
 {
 }
 
-SRPTConnection::~SRPTConnection() {}
+SRPTConnection::~SRPTConnection() {
+    detachTimerWheel();
+}
 
 bool SRPTConnection::initiate() {
     if (state_ != SRPTConnectionState::CLOSED) {
         return false;
     }
-    state_ = SRPTConnectionState::SYN_SENT;
+    transitionTo(SRPTConnectionState::SYN_SENT);
+    emitPacket(SRPTPacketType::SYN);
     return true;
 }
 
 bool SRPTConnection::handleIncomingSYN() {
+    notePeerActivity();
     if (state_ == SRPTConnectionState::CLOSED) {
-        state_ = SRPTConnectionState::SYN_RECEIVED;
+        transitionTo(SRPTConnectionState::SYN_RECEIVED);
+        emitPacket(SRPTPacketType::SYN_ACK);
         return true;
     }
+    if (state_ == SRPTConnectionState::SYN_RECEIVED) {
+        // Our SYN-ACK was lost and the peer retransmitted its SYN
+        emitPacket(SRPTPacketType::SYN_ACK);
+    }
     return false; // Unexpected SYN in other states
 }
 
 bool SRPTConnection::handleIncomingSYNACK() {
+    notePeerActivity();
     if (state_ == SRPTConnectionState::SYN_SENT) {
-        state_ = SRPTConnectionState::ESTABLISHED;
+        noteAcknowledgement();
+        transitionTo(SRPTConnectionState::ESTABLISHED);
+        emitPacket(SRPTPacketType::ACK);
         return true;
     }
+    if (state_ == SRPTConnectionState::ESTABLISHED) {
+        // Our ACK was lost and the peer retransmitted its SYN-ACK
+        emitPacket(SRPTPacketType::ACK);
+    }
     return false; // Unexpected SYNACK in other states
 }
 
 bool SRPTConnection::handleIncomingACK() {
+    notePeerActivity();
     switch (state_) {
         case SRPTConnectionState::SYN_RECEIVED:
-            state_ = SRPTConnectionState::ESTABLISHED;
+            transitionTo(SRPTConnectionState::ESTABLISHED);
             return true;
         case SRPTConnectionState::FIN_WAIT_1:
-            state_ = SRPTConnectionState::FIN_WAIT_2;
+            transitionTo(SRPTConnectionState::FIN_WAIT_2);
             return true;
         case SRPTConnectionState::CLOSING:
-            state_ = SRPTConnectionState::TIME_WAIT;
+            transitionTo(SRPTConnectionState::TIME_WAIT);
             return true;
         case SRPTConnectionState::LAST_ACK:
-            state_ = SRPTConnectionState::CLOSED;
+            transitionTo(SRPTConnectionState::CLOSED);
             return true;
         default:
             return false;
@@ -58,20 +87,25 @@ bool SRPTConnection::initiateClose() {
     if (state_ != SRPTConnectionState::ESTABLISHED) {
         return false;
     }
-    state_ = SRPTConnectionState::FIN_WAIT_1;
+    transitionTo(SRPTConnectionState::FIN_WAIT_1);
+    emitPacket(SRPTPacketType::FIN);
     return true;
 }
 
 bool SRPTConnection::handleIncomingFIN() {
+    notePeerActivity();
     switch (state_) {
         case SRPTConnectionState::ESTABLISHED:
-            state_ = SRPTConnectionState::CLOSE_WAIT;
+            transitionTo(SRPTConnectionState::CLOSE_WAIT);
+            emitPacket(SRPTPacketType::ACK);
             return true;
         case SRPTConnectionState::FIN_WAIT_1:
-            state_ = SRPTConnectionState::CLOSING;
+            transitionTo(SRPTConnectionState::CLOSING);
+            emitPacket(SRPTPacketType::ACK);
             return true;
         case SRPTConnectionState::FIN_WAIT_2:
-            state_ = SRPTConnectionState::TIME_WAIT;
+            transitionTo(SRPTConnectionState::TIME_WAIT);
+            emitPacket(SRPTPacketType::ACK);
             return true;
         default:
             return false; // Unexpected FIN in other states
@@ -80,21 +114,53 @@ bool SRPTConnection::handleIncomingFIN() {
 
 bool SRPTConnection::close() {
     if (state_ == SRPTConnectionState::CLOSE_WAIT) {
-        state_ = SRPTConnectionState::LAST_ACK;
+        transitionTo(SRPTConnectionState::LAST_ACK);
+        emitPacket(SRPTPacketType::FIN);
         return true;
     }
     return false;
 }
 
 SRPTConnectionState SRPTConnection::getState() const { return state_; }
-void SRPTConnection::setState(SRPTConnectionState newState) { state_ = newState; }
+void SRPTConnection::setState(SRPTConnectionState newState) { transitionTo(newState); }
 
 void SRPTConnection::simulateTimeWaitTimeout() {
     if (state_ == SRPTConnectionState::TIME_WAIT) {
-        state_ = SRPTConnectionState::CLOSED;
+        transitionTo(SRPTConnectionState::CLOSED);
     }
 }
 
+void SRPTConnection::attachTimerWheel(TimerWheel& wheel) {
+    detachTimerWheel();
+    timerWheel_ = &wheel;
+    // Re-enter the current state so its timers are armed on the new wheel
+    transitionTo(state_);
+}
+
+void SRPTConnection::detachTimerWheel() {
+    if (!timerWheel_) {
+        return;
+    }
+    cancelTimer(keepAliveTimer_);
+    cancelTimer(livenessTimer_);
+    cancelTimer(timeWaitTimer_);
+    cancelTimer(retransmitTimer_);
+    timerWheel_ = nullptr;
+}
+
+void SRPTConnection::setTimeWaitDuration(std::chrono::milliseconds duration) {
+    timeWaitDuration_ = duration;
+}
+
+void SRPTConnection::setIdleTimeout(std::chrono::milliseconds timeout) {
+    idleTimeout_ = timeout;
+}
+
+void SRPTConnection::setRetransmissionTimeout(std::chrono::milliseconds timeout) {
+    retransmissionTimeout_ = std::max(timeout, std::chrono::milliseconds(1));
+    currentRetransmissionTimeout_ = retransmissionTimeout_;
+}
+
 bool SRPTConnection::handleReset() {
     resetConnection();
     return true;
@@ -113,7 +179,7 @@ void SRPTConnection::simulateTimeout() {
             break;
         case SRPTConnectionState::CLOSE_WAIT:
             // In CLOSE_WAIT, we might want to force the connection closed
-            state_ = SRPTConnectionState::CLOSED;
+            transitionTo(SRPTConnectionState::CLOSED);
             break;
         default:
             // Do nothing for ESTABLISHED and CLOSED states
@@ -122,16 +188,163 @@ void SRPTConnection::simulateTimeout() {
 }
 
 void SRPTConnection::resetConnection() {
-    state_ = SRPTConnectionState::CLOSED;
+    transitionTo(SRPTConnectionState::CLOSED);
     // Reset any other connection-specific data here
 }
 
 bool SRPTConnection::isValidTransition(SRPTConnectionState newState) const { return true; }
 
+void SRPTConnection::transitionTo(SRPTConnectionState newState) {
+    state_ = newState;
+    if (!timerWheel_) {
+        return;
+    }
+
+    switch (newState) {
+        case SRPTConnectionState::ESTABLISHED:
+            if (!timerWheel_->isPending(keepAliveTimer_)) {
+                armKeepAliveTimer(lastActivityTime_ + keepAliveInterval_);
+            }
+            if (!timerWheel_->isPending(livenessTimer_)) {
+                armLivenessTimer(lastPeerActivityTime_ + effectiveIdleTimeout());
+            }
+            break;
+        case SRPTConnectionState::TIME_WAIT:
+            cancelTimer(keepAliveTimer_);
+            cancelTimer(livenessTimer_);
+            if (!timerWheel_->isPending(timeWaitTimer_)) {
+                timeWaitTimer_ = timerWheel_->schedule(timeWaitDuration_, [this]() {
+                    timeWaitTimer_ = TimerWheel::INVALID_TIMER;
+                    simulateTimeWaitTimeout();
+                });
+            }
+            break;
+        case SRPTConnectionState::CLOSED:
+            cancelTimer(keepAliveTimer_);
+            cancelTimer(livenessTimer_);
+            cancelTimer(timeWaitTimer_);
+            break;
+        default:
+            // Timers armed in ESTABLISHED keep running through the close handshake
+            break;
+    }
+
+    if (!awaitingAcknowledgement()) {
+        cancelTimer(retransmitTimer_);
+    } else if (!timerWheel_->isPending(retransmitTimer_)) {
+        armRetransmitTimer();
+    }
+}
+
+void SRPTConnection::notePeerActivity() {
+    lastPeerActivityTime_ = clock_.now();
+}
+
+void SRPTConnection::armKeepAliveTimer(std::chrono::steady_clock::time_point deadline) {
+    keepAliveTimer_ = timerWheel_->scheduleAt(deadline, [this]() { onKeepAliveTimer(); });
+}
+
+void SRPTConnection::armLivenessTimer(std::chrono::steady_clock::time_point deadline) {
+    livenessTimer_ = timerWheel_->scheduleAt(deadline, [this]() { onLivenessTimer(); });
+}
+
+void SRPTConnection::onKeepAliveTimer() {
+    keepAliveTimer_ = TimerWheel::INVALID_TIMER;
+    if (state_ == SRPTConnectionState::CLOSED || state_ == SRPTConnectionState::TIME_WAIT) {
+        return;
+    }
+    // Timers are not moved on every packet; if there was traffic since the
+    // timer was armed just re-arm it for the remaining idle time.
+    auto now = timerWheel_->currentTime();
+    auto due = lastActivityTime_ + keepAliveInterval_;
+    if (due > now) {
+        armKeepAliveTimer(due);
+        return;
+    }
+    sendKeepAlive();
+    armKeepAliveTimer(now + keepAliveInterval_);
+}
+
+void SRPTConnection::onLivenessTimer() {
+    livenessTimer_ = TimerWheel::INVALID_TIMER;
+    if (state_ == SRPTConnectionState::CLOSED || state_ == SRPTConnectionState::TIME_WAIT) {
+        return;
+    }
+    auto now = timerWheel_->currentTime();
+    auto due = lastPeerActivityTime_ + effectiveIdleTimeout();
+    if (due > now) {
+        armLivenessTimer(due);
+        return;
+    }
+    // Peer has been silent for the whole idle timeout
+    resetConnection();
+}
+
+void SRPTConnection::armRetransmitTimer() {
+    retransmitTimer_ = timerWheel_->schedule(currentRetransmissionTimeout_, [this]() { onRetransmitTimer(); });
+}
+
+void SRPTConnection::onRetransmitTimer() {
+    retransmitTimer_ = TimerWheel::INVALID_TIMER;
+    if (!awaitingAcknowledgement()) {
+        return;
+    }
+    if (retransmitAttempts_ >= MAX_RETRANSMISSIONS) {
+        // Nothing got through for the whole backoff: the peer is gone
+        resetConnection();
+        return;
+    }
+    ++retransmitAttempts_;
+    ++retransmissions_;
+    if (state_ == SRPTConnectionState::SYN_SENT) {
+        emitPacket(SRPTPacketType::SYN);
+        lastActivityTime_ = clock_.now();
+    } else {
+        retransmitUnacknowledgedPackets();
+    }
+    currentRetransmissionTimeout_ = std::min(currentRetransmissionTimeout_ * 2, MAX_RETRANSMISSION_TIMEOUT);
+    armRetransmitTimer();
+}
+
+void SRPTConnection::noteAcknowledgement() {
+    retransmitAttempts_ = 0;
+    currentRetransmissionTimeout_ = retransmissionTimeout_;
+}
+
+bool SRPTConnection::awaitingAcknowledgement() const {
+    switch (state_) {
+        case SRPTConnectionState::CLOSED:
+        case SRPTConnectionState::TIME_WAIT:
+            return false;
+        case SRPTConnectionState::SYN_SENT:
+            return true;
+        default:
+            return !unacknowledgedPackets_.empty();
+    }
+}
+
+void SRPTConnection::cancelTimer(TimerWheel::TimerId& timer) {
+    if (timerWheel_ && timer != TimerWheel::INVALID_TIMER) {
+        timerWheel_->cancel(timer);
+    }
+    timer = TimerWheel::INVALID_TIMER;
+}
+
+std::chrono::milliseconds SRPTConnection::effectiveIdleTimeout() const {
+    if (idleTimeout_.count() > 0) {
+        return idleTimeout_;
+    }
+    // Three missed keep-alives by default
+    return std::chrono::duration_cast<std::chrono::milliseconds>(keepAliveInterval_ * 3);
+}
+
 // Packet retransmission
 bool SRPTConnection::sendPacket(uint32_t sequenceNumber, const std::vector<uint8_t>& data) {
     unacknowledgedPackets_[sequenceNumber] = data;
-    lastActivityTime_ = std::chrono::steady_clock::now();
+    lastActivityTime_ = clock_.now();
+    if (timerWheel_ && awaitingAcknowledgement() && !timerWheel_->isPending(retransmitTimer_)) {
+        armRetransmitTimer();
+    }
     return true;
 }
 
@@ -139,30 +352,44 @@ bool SRPTConnection::acknowledgePacket(uint32_t sequenceNumber) {
     auto it = unacknowledgedPackets_.find(sequenceNumber);
     if (it != unacknowledgedPackets_.end()) {
         unacknowledgedPackets_.erase(it);
-        lastActivityTime_ = std::chrono::steady_clock::now();
+        lastActivityTime_ = clock_.now();
+        lastPeerActivityTime_ = lastActivityTime_;
+        noteAcknowledgement();
+        if (unacknowledgedPackets_.empty()) {
+            cancelTimer(retransmitTimer_);
+        }
         return true;
     }
     return false;
 }
 
 void SRPTConnection::retransmitUnacknowledgedPackets() {
-    // In a real implementation, you would actually resend the packets here
-    lastActivityTime_ = std::chrono::steady_clock::now();
+    for (const auto& [sequenceNumber, data] : unacknowledgedPackets_) {
+        emitPacket(SRPTPacketType::DATA, sequenceNumber, data);
+    }
+    lastActivityTime_ = clock_.now();
 }
 
 // Keep-alive
 void SRPTConnection::sendKeepAlive() {
-    lastActivityTime_ = std::chrono::steady_clock::now();
+    emitPacket(SRPTPacketType::KEEP_ALIVE);
+    lastActivityTime_ = clock_.now();
+    ++keepAlivesSent_;
 }
 
 bool SRPTConnection::handleKeepAlive() {
-    lastActivityTime_ = std::chrono::steady_clock::now();
+    lastActivityTime_ = clock_.now();
+    lastPeerActivityTime_ = lastActivityTime_;
     return true;
 }
 
 void SRPTConnection::setKeepAliveInterval(std::chrono::seconds interval) {
     keepAliveInterval_ = interval;
-    lastActivityTime_ = std::chrono::steady_clock::now();
+    lastActivityTime_ = clock_.now();
+    if (timerWheel_ && timerWheel_->isPending(keepAliveTimer_)) {
+        cancelTimer(keepAliveTimer_);
+        armKeepAliveTimer(lastActivityTime_ + keepAliveInterval_);
+    }
 }
 
 // For testing
@@ -171,13 +398,15 @@ size_t SRPTConnection::getUnacknowledgedPacketCount() const {
 }
 
 bool SRPTConnection::isConnectionAlive() const {
-    auto now = std::chrono::steady_clock::now();
+    auto now = clock_.now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastActivityTime_);
     return elapsed <= (keepAliveInterval_ + std::chrono::milliseconds(100)); // Add 100ms buffer
 }
 
 void SRPTConnection::setReceiveWindowSize(uint32_t size) {
     receive_window_size_ = size;
+    advertised_window_size_ = size;
+    // Until the peer advertises its window, assume it matches ours
     available_window_size_ = size;
 }
 
@@ -201,9 +430,20 @@ bool SRPTConnection::sendData(const std::vector<uint8_t>& data) {
     if (!canSendData(data.size())) {
         return false;
     }
-    // Existing send logic...
+    uint32_t sequenceNumber = nextSequenceNumber_;
+    if (!emitPacket(SRPTPacketType::DATA, sequenceNumber, data)) {
+        return false;
+    }
+    ++nextSequenceNumber_;
+    if (packetSender_) {
+        // Keep a copy until the peer acknowledges it
+        unacknowledgedPackets_[sequenceNumber] = data;
+        if (timerWheel_ && !timerWheel_->isPending(retransmitTimer_)) {
+            armRetransmitTimer();
+        }
+    }
     available_window_size_ -= data.size();
-    lastActivityTime_ = std::chrono::steady_clock::now(); // Update last activity time
+    lastActivityTime_ = clock_.now(); // Update last activity time
     return true;
 }
 
@@ -211,22 +451,118 @@ void SRPTConnection::receiveData(const std::vector<uint8_t>& data) {
     if (state_ != SRPTConnectionState::ESTABLISHED) {
         return; // Only receive data in ESTABLISHED state
     }
-    // Existing receive logic...
-    available_window_size_ -= data.size();
-    // Logic to process received data...
-    // After processing:
-    uint32_t processed_size = data.size(); // Assume all data is processed
-    available_window_size_ += processed_size;
-    lastActivityTime_ = std::chrono::steady_clock::now(); // Update last activity time
-    // Notify peer about updated window size
-    sendWindowUpdate(available_window_size_);
+    notePeerActivity();
+    // The handler consumes the data as it is delivered, so the whole
+    // receive window is free again afterwards
+    if (dataHandler_) {
+        dataHandler_(data);
+    }
+    lastActivityTime_ = clock_.now(); // Update last activity time
+    // Notify peer about updated window size once enough has been consumed;
+    // flushWindowUpdate() covers the rest
+    unadvertisedBytes_ += data.size();
+    if (unadvertisedBytes_ >= std::max<uint32_t>(receive_window_size_ / WINDOW_UPDATE_FRACTION, 1)) {
+        sendWindowUpdate(receive_window_size_);
+    }
+}
+
+void SRPTConnection::flushWindowUpdate() {
+    if (unadvertisedBytes_ > 0) {
+        sendWindowUpdate(receive_window_size_);
+    }
 }
 
 void SRPTConnection::sendWindowUpdate(uint32_t newSize) {
-    // In a real implementation, you would create and send a window update packet
-    // For now, we'll just update the local state
-    available_window_size_ = newSize;
-    lastActivityTime_ = std::chrono::steady_clock::now(); // Update last activity time
+    std::vector<uint8_t> payload = {
+        static_cast<uint8_t>(newSize & 0xFF),
+        static_cast<uint8_t>((newSize >> 8) & 0xFF),
+        static_cast<uint8_t>((newSize >> 16) & 0xFF),
+        static_cast<uint8_t>((newSize >> 24) & 0xFF)
+    };
+    emitPacket(SRPTPacketType::WINDOW_UPDATE, 0, payload);
+    unadvertisedBytes_ = 0;
+    advertised_window_size_ = newSize;
+    lastActivityTime_ = clock_.now(); // Update last activity time
+}
+
+void SRPTConnection::setPacketSender(PacketSender sender) {
+    packetSender_ = std::move(sender);
+}
+
+void SRPTConnection::setDataHandler(DataHandler handler) {
+    dataHandler_ = std::move(handler);
+}
+
+bool SRPTConnection::handlePacket(const SRPTPacket& packet) {
+    switch (static_cast<SRPTPacketType>(packet.getPacketType())) {
+        case SRPTPacketType::DATA:
+            if (state_ != SRPTConnectionState::ESTABLISHED) {
+                return false;
+            }
+            // Always acknowledge: a duplicate means our DATA_ACK was lost
+            emitPacket(SRPTPacketType::DATA_ACK, packet.getSequenceNumber());
+            if (!markDelivered(packet.getSequenceNumber())) {
+                notePeerActivity();
+                return true;
+            }
+            receiveData(packet.getPayload());
+            return true;
+        case SRPTPacketType::DATA_ACK:
+            return acknowledgePacket(packet.getSequenceNumber());
+        case SRPTPacketType::SYN:
+            return handleIncomingSYN();
+        case SRPTPacketType::SYN_ACK:
+            return handleIncomingSYNACK();
+        case SRPTPacketType::ACK:
+            return handleIncomingACK();
+        case SRPTPacketType::FIN:
+            return handleIncomingFIN();
+        case SRPTPacketType::RESET:
+            return handleReset();
+        case SRPTPacketType::KEEP_ALIVE:
+            return handleKeepAlive();
+        case SRPTPacketType::WINDOW_UPDATE: {
+            const auto& payload = packet.getPayload();
+            if (payload.size() < 4) {
+                return false;
+            }
+            uint32_t size = static_cast<uint32_t>(payload[0]) |
+                            (static_cast<uint32_t>(payload[1]) << 8) |
+                            (static_cast<uint32_t>(payload[2]) << 16) |
+                            (static_cast<uint32_t>(payload[3]) << 24);
+            notePeerActivity();
+            updateAvailableWindowSize(size);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool SRPTConnection::markDelivered(uint32_t sequenceNumber) {
+    if (sequenceNumber < nextExpectedSequence_ || deliveredAhead_.count(sequenceNumber) > 0) {
+        return false;
+    }
+    if (sequenceNumber != nextExpectedSequence_) {
+        // Out of order: deliver it now and remember it, the gap may still fill
+        deliveredAhead_.insert(sequenceNumber);
+        return true;
+    }
+    ++nextExpectedSequence_;
+    while (!deliveredAhead_.empty() && *deliveredAhead_.begin() == nextExpectedSequence_) {
+        deliveredAhead_.erase(deliveredAhead_.begin());
+        ++nextExpectedSequence_;
+    }
+    return true;
+}
+
+bool SRPTConnection::emitPacket(SRPTPacketType type, uint32_t sequenceNumber,
+                                const std::vector<uint8_t>& payload) {
+    if (!packetSender_) {
+        return true;  // Not wired to a transport
+    }
+    SRPTPacket packet(static_cast<uint8_t>(type), connectionId_, sequenceNumber, 0, payload);
+    return packetSender_(packet);
 }
 
-} // namespace SRPT
\ No newline at end of file
+} // namespace SRPT
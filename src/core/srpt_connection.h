@@ -2,9 +2,14 @@
 
 #include <cstdint>
 #include <map>
+#include <set>
 #include <vector>
 #include <chrono>
+#include <functional>
 #include <thread>
+#include "srpt_packet.h"
+#include "srpt_timer_wheel.h"
+#include "../common/clock.h"
 
 namespace SRPT {
 
@@ -24,6 +29,9 @@ enum class SRPTConnectionState {
 class SRPTConnection {
 public:
     SRPTConnection();
+    // Activity times and liveness are read from `clock`, which must outlive
+    // the connection; the default is the steady clock
+    explicit SRPTConnection(const Common::Clock& clock);
     ~SRPTConnection();
 
     // Connection establishment
@@ -48,7 +56,22 @@ public:
     // Simulation methods for testing
     void simulateTimeWaitTimeout();
 
-    // Packet retransmission
+    // Timer-driven lifecycle: keep-alive sends, liveness expiry and the
+    // TIME_WAIT -> CLOSED transition are armed on a shared wheel. The wheel
+    // must outlive the connection (or the connection must be detached first).
+    void attachTimerWheel(TimerWheel& wheel);
+    void detachTimerWheel();
+    void setTimeWaitDuration(std::chrono::milliseconds duration);
+    void setIdleTimeout(std::chrono::milliseconds timeout);
+
+    // Packet retransmission. With a timer wheel attached, an outstanding SYN
+    // or unacknowledged DATA is resent when the retransmission timeout runs
+    // out; the timeout doubles on every attempt (up to 60 s) and is back to
+    // its initial value once the peer acknowledges something. After
+    // MAX_RETRANSMISSIONS attempts without progress the connection is reset.
+    static constexpr uint32_t MAX_RETRANSMISSIONS = 8;
+    void setRetransmissionTimeout(std::chrono::milliseconds timeout);
+    uint64_t getRetransmissions() const { return retransmissions_; }
     bool sendPacket(uint32_t sequenceNumber, const std::vector<uint8_t>& data);
     bool acknowledgePacket(uint32_t sequenceNumber);
     void retransmitUnacknowledgedPackets();
@@ -59,11 +82,15 @@ public:
     bool handleKeepAlive();
     bool isConnectionAlive() const;
 
-    // Flow control methods
+    // Flow control methods. The available window is send credit: the
+    // window the peer last advertised, less what was sent since. The
+    // receive window is ours, and is what WINDOW_UPDATE advertises; the two
+    // are tracked separately.
     void setReceiveWindowSize(uint32_t size);
     uint32_t getReceiveWindowSize() const;
     void updateAvailableWindowSize(uint32_t size);
     uint32_t getAvailableWindowSize() const;
+    uint32_t getAdvertisedWindowSize() const { return advertised_window_size_; }
     bool canSendData(uint32_t dataSize) const;
 
     // Data transfer methods
@@ -71,23 +98,95 @@ public:
     void receiveData(const std::vector<uint8_t>& data);
     void sendWindowUpdate(uint32_t newSize);
 
+    // Window updates for received data are coalesced: one is sent once a
+    // quarter of the receive window has been consumed since the last, and
+    // flushWindowUpdate() sends any remainder. Transports call it after each
+    // receive batch, so a burst costs the peer one WINDOW_UPDATE, not one
+    // per DATA packet.
+    void flushWindowUpdate();
+    bool windowUpdatePending() const { return unadvertisedBytes_ > 0; }
+
+    // Wire integration: once a packet sender is installed, state transitions
+    // emit the matching control packets and sendData() emits DATA packets.
+    // Without a sender the connection is a pure state machine.
+    using PacketSender = std::function<bool(const SRPTPacket&)>;
+    using DataHandler = std::function<void(const std::vector<uint8_t>&)>;
+    void setPacketSender(PacketSender sender);
+    void setDataHandler(DataHandler handler);
+    void setConnectionId(uint64_t id) { connectionId_ = id; }
+    uint64_t getConnectionId() const { return connectionId_; }
+
+    // Dispatch a packet received from the peer
+    bool handlePacket(const SRPTPacket& packet);
+
     // For testing
     size_t getUnacknowledgedPacketCount() const;
     std::chrono::steady_clock::time_point getLastActivityTime() const {
         return lastActivityTime_;
     }
+    uint64_t getKeepAlivesSent() const { return keepAlivesSent_; }
 
 private:
+    const Common::Clock& clock_;
     SRPTConnectionState state_;
     std::map<uint32_t, std::vector<uint8_t>> unacknowledgedPackets_;
     std::chrono::steady_clock::time_point lastActivityTime_;
     std::chrono::seconds keepAliveInterval_;
     uint32_t receive_window_size_;
-    uint32_t available_window_size_;
+    uint32_t available_window_size_;   // Send credit from the peer
+    uint32_t advertised_window_size_;  // Last receive window sent to the peer
+    uint64_t unadvertisedBytes_ = 0;  // Received since the last WINDOW_UPDATE
     // Other private members...
 
+    // Wire state
+    PacketSender packetSender_;
+    DataHandler dataHandler_;
+    uint64_t connectionId_ = 0;
+    uint32_t nextSequenceNumber_ = 1;
+    // DATA below nextExpectedSequence_, or in deliveredAhead_ (delivered out
+    // of order), has been handed to the data handler already
+    uint32_t nextExpectedSequence_ = 1;
+    std::set<uint32_t> deliveredAhead_;
+
+    // Timer state
+    TimerWheel* timerWheel_ = nullptr;
+    TimerWheel::TimerId keepAliveTimer_ = TimerWheel::INVALID_TIMER;
+    TimerWheel::TimerId livenessTimer_ = TimerWheel::INVALID_TIMER;
+    TimerWheel::TimerId timeWaitTimer_ = TimerWheel::INVALID_TIMER;
+    TimerWheel::TimerId retransmitTimer_ = TimerWheel::INVALID_TIMER;
+    std::chrono::milliseconds retransmissionTimeout_;
+    std::chrono::milliseconds currentRetransmissionTimeout_;
+    uint32_t retransmitAttempts_ = 0;
+    uint64_t retransmissions_ = 0;
+    std::chrono::steady_clock::time_point lastPeerActivityTime_;
+    std::chrono::milliseconds timeWaitDuration_;
+    std::chrono::milliseconds idleTimeout_;
+    uint64_t keepAlivesSent_ = 0;
+
+    static constexpr std::chrono::milliseconds DEFAULT_TIME_WAIT{60000};  // 2 * MSL
+    static constexpr uint32_t DEFAULT_RECEIVE_WINDOW = 65536;
+    static constexpr uint32_t WINDOW_UPDATE_FRACTION = 4;
+    static constexpr std::chrono::milliseconds DEFAULT_RETRANSMISSION_TIMEOUT{1000};
+    static constexpr std::chrono::milliseconds MAX_RETRANSMISSION_TIMEOUT{60000};
+
     void resetConnection();
     bool isValidTransition(SRPTConnectionState newState) const;
+    void transitionTo(SRPTConnectionState newState);
+    bool emitPacket(SRPTPacketType type, uint32_t sequenceNumber = 0,
+                    const std::vector<uint8_t>& payload = {});
+    void notePeerActivity();
+    void armKeepAliveTimer(std::chrono::steady_clock::time_point deadline);
+    void armLivenessTimer(std::chrono::steady_clock::time_point deadline);
+    void onKeepAliveTimer();
+    void onLivenessTimer();
+    void armRetransmitTimer();
+    void onRetransmitTimer();
+    void noteAcknowledgement();
+    bool awaitingAcknowledgement() const;
+    // Returns false if the DATA packet was delivered before
+    bool markDelivered(uint32_t sequenceNumber);
+    void cancelTimer(TimerWheel::TimerId& timer);
+    std::chrono::milliseconds effectiveIdleTimeout() const;
 };
 
 } // namespace SRPT
\ No newline at end of file
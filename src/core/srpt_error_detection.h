@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -7,6 +8,7 @@ namespace SRPT {
 
 // Calculate CRC-32C for the given data
 uint32_t calculateCRC32C(const std::vector<uint8_t>& data);
+uint32_t calculateCRC32C(const uint8_t* data, size_t size);
 
 // Verify the CRC-32C of the given data
 bool verifyCRC32C(const std::vector<uint8_t>& data, uint32_t expected_crc);
@@ -0,0 +1,247 @@
+#include "srpt_header_compression.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace SRPT {
+
+namespace {
+constexpr uint8_t IR = 0x00;
+constexpr uint8_t CO = 0x40;
+constexpr uint8_t CO_T = 0x80;
+constexpr uint8_t CO_S = 0xC0;
+constexpr uint8_t KIND_MASK = 0xC0;
+constexpr uint8_t CONTEXT_MASK = 0x3F;
+
+// Sequence numbers within this many below the reference decode from their LSBs
+constexpr uint32_t WINDOW_BELOW = 64;
+constexpr uint32_t WINDOW_SIZE = 256;
+constexpr size_t MAX_SEQUENCE_BYTES = 5;
+constexpr size_t MAX_PAYLOAD_BYTES = 65535;
+constexpr size_t CRC_BYTES = sizeof(uint32_t);
+
+void appendVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Whether `sequence` is in the LSB window of `reference`, wrapping mod 2^32
+bool inWindow(uint32_t sequence, uint32_t reference) {
+    return sequence - (reference - WINDOW_BELOW) < WINDOW_SIZE;
+}
+
+uint32_t decodeLsb(uint8_t lsb, uint32_t reference) {
+    uint32_t low = reference - WINDOW_BELOW;
+    return low + ((lsb - low) & (WINDOW_SIZE - 1));
+}
+} // namespace
+
+// HeaderCompressor implementation
+HeaderCompressor::HeaderCompressor() : HeaderCompressor(Options()) {}
+
+HeaderCompressor::HeaderCompressor(const Options& options) : options_(options) {
+    options_.maxContexts = std::min(std::max<size_t>(options_.maxContexts, 1), MAX_CONTEXTS);
+    contexts_.resize(options_.maxContexts);
+}
+
+size_t HeaderCompressor::compress(const SRPTPacket& packet, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    const auto& payload = packet.getPayload();
+    size_t id = contextFor(packet.getPackageId());
+    Context& context = contexts_[id];
+    uint8_t packetType = packet.getPacketType();
+    uint32_t sequence = packet.getSequenceNumber();
+
+    bool refresh = context.refresh || packet.getTotalPackets() != context.totalPackets ||
+                   (options_.refreshInterval > 0 && context.sinceRefresh >= options_.refreshInterval);
+    if (refresh) {
+        out.push_back(static_cast<uint8_t>(IR | id));
+        packet.appendTo(out);
+        context.refresh = false;
+        context.totalPackets = packet.getTotalPackets();
+        context.sinceRefresh = 0;
+        ++stats_.refreshes;
+    } else {
+        if (!inWindow(sequence, context.lastSequence)) {
+            out.push_back(static_cast<uint8_t>(CO_S | id));
+            out.push_back(packetType);
+            appendVarint(out, sequence);
+        } else {
+            if (packetType == context.packetType) {
+                out.push_back(static_cast<uint8_t>(CO | id));
+            } else {
+                out.push_back(static_cast<uint8_t>(CO_T | id));
+                out.push_back(packetType);
+            }
+            out.push_back(static_cast<uint8_t>(sequence));
+        }
+        // In the byte order SRPTPacket uses for it
+        uint32_t crc = packet.getHeader().crc;
+        const auto* crcBytes = reinterpret_cast<const uint8_t*>(&crc);
+        out.insert(out.end(), crcBytes, crcBytes + CRC_BYTES);
+        out.insert(out.end(), payload.begin(), payload.end());
+        ++context.sinceRefresh;
+    }
+    context.packetType = packetType;
+    context.lastSequence = sequence;
+
+    size_t size = out.size() - start;
+    ++stats_.packets;
+    stats_.headerBytesIn += packet.encodedSize() - payload.size();
+    stats_.headerBytesOut += size - payload.size();
+    return size;
+}
+
+std::vector<uint8_t> HeaderCompressor::compress(const SRPTPacket& packet) {
+    std::vector<uint8_t> out;
+    out.reserve(packet.encodedSize() + 1);
+    compress(packet, out);
+    return out;
+}
+
+void HeaderCompressor::onFeedback(const std::vector<uint8_t>& contextIds) {
+    for (uint8_t id : contextIds) {
+        if (id < contexts_.size()) {
+            contexts_[id].refresh = true;
+        }
+    }
+}
+
+void HeaderCompressor::reset() {
+    std::fill(contexts_.begin(), contexts_.end(), Context());
+    uses_ = 0;
+}
+
+size_t HeaderCompressor::contextFor(uint64_t packageId) {
+    // Few enough contexts that a scan beats a map
+    size_t chosen = 0;
+    bool found = false;
+    for (size_t i = 0; i < contexts_.size(); ++i) {
+        const Context& context = contexts_[i];
+        if (context.inUse && context.packageId == packageId) {
+            chosen = i;
+            found = true;
+            break;
+        }
+        // Otherwise take a free context, or else the least recently used
+        if (!context.inUse ? contexts_[chosen].inUse : context.lastUsed < contexts_[chosen].lastUsed) {
+            chosen = i;
+        }
+    }
+    Context& context = contexts_[chosen];
+    if (!found) {
+        context = Context();
+        context.inUse = true;
+        context.packageId = packageId;
+    }
+    context.lastUsed = ++uses_;
+    return chosen;
+}
+
+// HeaderDecompressor implementation
+SRPTPacket HeaderDecompressor::decompress(const std::vector<uint8_t>& bytes) {
+    return decompress(bytes.data(), bytes.size());
+}
+
+SRPTPacket HeaderDecompressor::decompress(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        throw std::runtime_error("Empty compressed packet");
+    }
+    uint8_t kind = data[0] & KIND_MASK;
+    uint8_t id = data[0] & CONTEXT_MASK;
+    Context& context = contexts_[id];
+
+    if (kind == IR) {
+        try {
+            SRPTPacket packet = SRPTPacket::fromBytes(data + 1, size - 1);
+            context.valid = true;
+            context.reported = false;
+            context.packageId = packet.getPackageId();
+            context.packetType = packet.getPacketType();
+            context.totalPackets = packet.getTotalPackets();
+            context.lastSequence = packet.getSequenceNumber();
+            feedback_.erase(std::remove(feedback_.begin(), feedback_.end(), id), feedback_.end());
+            ++stats_.refreshes;
+            ++stats_.packets;
+            return packet;
+        } catch (const std::runtime_error&) {
+            reject(id, true, "Damaged header compression refresh");
+        }
+    }
+
+    if (!context.valid) {
+        reject(id, false, "No header compression context");
+    }
+    size_t pos = 1;
+    uint8_t packetType = context.packetType;
+    if (kind != CO) {
+        if (pos == size || data[pos] > 0x0F) {
+            reject(id, true, "Malformed compressed header");
+        }
+        packetType = data[pos++];
+    }
+    uint32_t sequence = 0;
+    if (kind == CO_S) {
+        bool complete = false;
+        for (size_t i = 0; i < MAX_SEQUENCE_BYTES && pos < size && !complete; ++i) {
+            uint8_t byte = data[pos++];
+            sequence |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+            complete = (byte & 0x80) == 0;
+        }
+        if (!complete) {
+            reject(id, true, "Malformed compressed header");
+        }
+    } else {
+        if (pos == size) {
+            reject(id, true, "Malformed compressed header");
+        }
+        sequence = decodeLsb(data[pos++], context.lastSequence);
+    }
+    if (size - pos < CRC_BYTES || size - pos - CRC_BYTES > MAX_PAYLOAD_BYTES) {
+        reject(id, true, "Malformed compressed header");
+    }
+    uint32_t crc;
+    std::memcpy(&crc, data + pos, CRC_BYTES);
+    pos += CRC_BYTES;
+
+    SRPTPacket packet(packetType, context.packageId, sequence, context.totalPackets,
+                      std::vector<uint8_t>(data + pos, data + size));
+    if (packet.getHeader().crc != crc) {
+        reject(id, true, "Header compression check failed");
+    }
+    context.packetType = packetType;
+    context.lastSequence = sequence;
+    ++stats_.packets;
+    return packet;
+}
+
+std::vector<uint8_t> HeaderDecompressor::takeFeedback() {
+    std::vector<uint8_t> feedback;
+    feedback.swap(feedback_);
+    return feedback;
+}
+
+void HeaderDecompressor::reset() {
+    contexts_.fill(Context());
+    feedback_.clear();
+}
+
+void HeaderDecompressor::reject(uint8_t contextId, bool checkFailed, const char* reason) {
+    if (checkFailed) {
+        ++stats_.checkFailures;
+    } else {
+        ++stats_.contextMisses;
+    }
+    Context& context = contexts_[contextId];
+    context.valid = false;
+    if (!context.reported) {
+        context.reported = true;
+        feedback_.push_back(contextId);
+    }
+    throw std::runtime_error(reason);
+}
+
+} // namespace SRPT
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "srpt_packet.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SRPT {
+
+// Context-based header compression for narrowband links, after ROHC
+// (RFC 5795) in unidirectional mode with optional feedback.
+//
+// Each flow (one package ID) is given a context ID shared by compressor
+// and decompressor. The first packet of a flow, and every refreshInterval-th
+// packet after it, goes out as an IR (initialization/refresh) packet
+// carrying the full SRPT header; in between only what changed is sent:
+//
+//   IR     00cccccc  full SRPT packet                     header + 1 byte
+//   CO     01cccccc  seq LSB   crc  payload               6 bytes
+//   CO-T   10cccccc  type      seq LSB  crc  payload      7 bytes
+//   CO-S   11cccccc  type      seq varint  crc  payload
+//
+// where cccccc is the context ID. The sequence number is sent as its low
+// 8 bits and decoded as the one value with those bits in [last - 64,
+// last + 191], last being the sequence number last restored, so up to 190
+// consecutive losses are absorbed; jumps outside that window use CO-S.
+// The payload size is taken from the datagram length, and the version,
+// package ID and total packets from the context. The packet's CRC-32C is
+// carried whole: the decompressor rebuilds the packet, recomputes the CRC
+// and compares, which catches a wrongly restored header along with payload
+// damage as reliably as for an uncompressed packet. Truncating it would
+// save bytes only by leaning on the link layer for integrity.
+//
+// A failed check invalidates the context: its packets are rejected until
+// the next IR, and the context ID is queued as feedback which, if there is
+// a return path, the compressor takes through onFeedback() to send an IR
+// right away instead of waiting for the periodic refresh.
+//
+// Neither class is thread-safe.
+class HeaderCompressor {
+public:
+    static constexpr size_t MAX_CONTEXTS = 64;
+
+    struct Options {
+        size_t maxContexts = 16;  // Flows tracked at once, 1 to MAX_CONTEXTS
+        uint32_t refreshInterval = 32;  // Packets per flow between IRs; 0 for only on demand
+    };
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t refreshes = 0;  // IR packets sent
+        uint64_t headerBytesIn = 0;  // SRPT header bytes before compression
+        uint64_t headerBytesOut = 0;  // After; the payload is not counted
+    };
+
+    HeaderCompressor();
+    explicit HeaderCompressor(const Options& options);
+
+    // Appends the compressed packet to `out`; returns its size
+    size_t compress(const SRPTPacket& packet, std::vector<uint8_t>& out);
+    std::vector<uint8_t> compress(const SRPTPacket& packet);
+
+    // Context IDs reported by HeaderDecompressor::takeFeedback(); each
+    // flow's next packet is sent as an IR
+    void onFeedback(const std::vector<uint8_t>& contextIds);
+
+    // Forgets every flow, so each starts again with an IR
+    void reset();
+
+    Stats getStats() const { return stats_; }
+
+private:
+    struct Context {
+        bool inUse = false;
+        bool refresh = true;
+        uint64_t packageId = 0;
+        uint8_t packetType = 0;
+        uint32_t totalPackets = 0;
+        uint32_t lastSequence = 0;
+        uint32_t sinceRefresh = 0;
+        uint64_t lastUsed = 0;
+    };
+
+    Options options_;
+    std::vector<Context> contexts_;
+    uint64_t uses_ = 0;
+    Stats stats_;
+
+    size_t contextFor(uint64_t packageId);
+};
+
+class HeaderDecompressor {
+public:
+    struct Stats {
+        uint64_t packets = 0;  // Restored
+        uint64_t refreshes = 0;  // IR packets received
+        uint64_t contextMisses = 0;  // Rejected for want of a valid context
+        uint64_t checkFailures = 0;  // Rejected on the CRC or as malformed
+    };
+
+    HeaderDecompressor() = default;
+
+    // Restores the original packet. Throws std::runtime_error, as
+    // SRPTPacket::fromBytes does, for a packet that cannot be restored.
+    SRPTPacket decompress(const uint8_t* data, size_t size);
+    SRPTPacket decompress(const std::vector<uint8_t>& bytes);
+
+    // Context IDs that need an IR, each reported once until refreshed
+    std::vector<uint8_t> takeFeedback();
+
+    void reset();
+
+    Stats getStats() const { return stats_; }
+
+private:
+    struct Context {
+        bool valid = false;
+        bool reported = false;
+        uint64_t packageId = 0;
+        uint8_t packetType = 0;
+        uint32_t totalPackets = 0;
+        uint32_t lastSequence = 0;
+    };
+
+    std::array<Context, HeaderCompressor::MAX_CONTEXTS> contexts_;
+    std::vector<uint8_t> feedback_;
+    Stats stats_;
+
+    [[noreturn]] void reject(uint8_t contextId, bool checkFailed, const char* reason);
+};
+
+} // namespace SRPT
@@ -56,7 +56,11 @@ uint64_t SRPTPacket::decodeVariableLength(const std::vector<uint8_t>& bytes) {
 }
 
 SRPTPacket SRPTPacket::fromBytes(const std::vector<uint8_t>& bytes) {
-    if (bytes.size() < 8) {  // Minimum header size (flags + payloadSize + crc)
+    return fromBytes(bytes.data(), bytes.size());
+}
+
+SRPTPacket SRPTPacket::fromBytes(const uint8_t* bytes, size_t size) {
+    if (size < 8) {  // Minimum header size (flags + payloadSize + crc)
         throw std::runtime_error("Insufficient data for SRPT packet header");
     }
 
@@ -64,12 +68,12 @@ SRPTPacket SRPTPacket::fromBytes(const std::vector<uint8_t>& bytes) {
     SRPTPacketHeader header;
     header.flags = bytes[offset++];
 
-    auto readVariableLength = [&bytes, &offset]() {
+    auto readVariableLength = [bytes, size, &offset]() {
         std::vector<uint8_t> value;
-        while (offset < bytes.size() && (bytes[offset] & 0x80)) {
+        while (offset < size && (bytes[offset] & 0x80)) {
             value.push_back(bytes[offset++]);
         }
-        if (offset < bytes.size()) {
+        if (offset < size) {
             value.push_back(bytes[offset++]);
         }
         return value;
@@ -79,7 +83,7 @@ SRPTPacket SRPTPacket::fromBytes(const std::vector<uint8_t>& bytes) {
     header.sequenceNumber = readVariableLength();
     header.totalPackets = readVariableLength();
 
-    if (bytes.size() - offset < 6) {  // payloadSize + crc
+    if (size - offset < 6) {  // payloadSize + crc
         throw std::runtime_error("Insufficient data for SRPT packet header");
     }
 
@@ -89,11 +93,11 @@ SRPTPacket SRPTPacket::fromBytes(const std::vector<uint8_t>& bytes) {
     std::memcpy(&header.crc, &bytes[offset], sizeof(uint32_t));
     offset += sizeof(uint32_t);
 
-    if (bytes.size() != offset + header.payloadSize) {
+    if (size != offset + header.payloadSize) {
         throw std::runtime_error("Packet size mismatch");
     }
 
-    std::vector<uint8_t> payload(bytes.begin() + offset, bytes.end());
+    std::vector<uint8_t> payload(bytes + offset, bytes + size);
 
     uint8_t packetType = header.flags & 0x0F;
     uint64_t packageId = decodeVariableLength(header.packageId);
@@ -104,7 +108,6 @@ SRPTPacket SRPTPacket::fromBytes(const std::vector<uint8_t>& bytes) {
 
     // Verify the CRC
     uint32_t receivedCRC = header.crc;
-    packet.calculateCRC();
     if (receivedCRC != packet.header.crc) {
         throw std::runtime_error("CRC mismatch");
     }
@@ -114,6 +117,18 @@ SRPTPacket SRPTPacket::fromBytes(const std::vector<uint8_t>& bytes) {
 
 std::vector<uint8_t> SRPTPacket::toBytes() const {
     std::vector<uint8_t> bytes;
+    bytes.reserve(encodedSize());
+    appendTo(bytes);
+    return bytes;
+}
+
+size_t SRPTPacket::encodedSize() const {
+    return 1 + header.packageId.size() + header.sequenceNumber.size() + header.totalPackets.size() +
+           2 + sizeof(uint32_t) + payload.size();
+}
+
+size_t SRPTPacket::appendTo(std::vector<uint8_t>& bytes) const {
+    size_t start = bytes.size();
     bytes.push_back(header.flags);
     bytes.insert(bytes.end(), header.packageId.begin(), header.packageId.end());
     bytes.insert(bytes.end(), header.sequenceNumber.begin(), header.sequenceNumber.end());
@@ -123,7 +138,36 @@ std::vector<uint8_t> SRPTPacket::toBytes() const {
     bytes.insert(bytes.end(), reinterpret_cast<const uint8_t*>(&header.crc),
                  reinterpret_cast<const uint8_t*>(&header.crc) + sizeof(uint32_t));
     bytes.insert(bytes.end(), payload.begin(), payload.end());
-    return bytes;
+    return bytes.size() - start;
+}
+
+void SRPTPacket::encodeBatch(const std::vector<SRPTPacket>& packets, std::vector<uint8_t>& out,
+                             std::vector<size_t>& sizes) {
+    size_t total = 0;
+    for (const auto& packet : packets) {
+        total += packet.encodedSize();
+    }
+    out.reserve(out.size() + total);
+    sizes.reserve(sizes.size() + packets.size());
+    for (const auto& packet : packets) {
+        sizes.push_back(packet.appendTo(out));
+    }
+}
+
+size_t SRPTPacket::decodeBatch(const std::vector<SRPTPacketView>& views, std::vector<SRPTPacket>& packets,
+                               std::vector<size_t>& indices) {
+    size_t failures = 0;
+    packets.reserve(packets.size() + views.size());
+    indices.reserve(indices.size() + views.size());
+    for (size_t i = 0; i < views.size(); ++i) {
+        try {
+            packets.push_back(fromBytes(views[i].data, views[i].size));
+            indices.push_back(i);
+        } catch (const std::runtime_error&) {
+            ++failures;
+        }
+    }
+    return failures;
 }
 
 uint64_t SRPTPacket::getPackageId() const {
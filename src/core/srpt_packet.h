@@ -1,8 +1,22 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
+// Packet types carried in the low 4 bits of the header flags
+enum class SRPTPacketType : uint8_t {
+    DATA = 0x0,
+    DATA_ACK = 0x1,       // Acknowledges the data packet with the same sequence number
+    SYN = 0x2,
+    SYN_ACK = 0x3,
+    ACK = 0x4,            // Acknowledges a SYN_ACK or FIN
+    FIN = 0x5,
+    RESET = 0x6,
+    KEEP_ALIVE = 0x7,
+    WINDOW_UPDATE = 0x8   // Payload is the receiver's available window (4 bytes, little endian)
+};
+
 struct SRPTPacketHeader {
     uint8_t flags;  // Contains version (4 bits) and packet type (4 bits)
     std::vector<uint8_t> packageId;  // Variable-length, up to 8 bytes
@@ -12,13 +26,32 @@ struct SRPTPacketHeader {
     uint32_t crc; // CRC-32C
 };
 
+// Non-owning view of one encoded packet, e.g. a datagram in a receive batch
+struct SRPTPacketView {
+    const uint8_t* data;
+    size_t size;
+};
+
 class SRPTPacket {
 public:
     SRPTPacket(uint8_t packetType, uint64_t packageId, uint32_t sequenceNumber, 
                uint32_t totalPackets, const std::vector<uint8_t>& payload);
     
     static SRPTPacket fromBytes(const std::vector<uint8_t>& bytes);
+    static SRPTPacket fromBytes(const uint8_t* data, size_t size);
     std::vector<uint8_t> toBytes() const;
+    // Append the encoded packet to `out`; returns the encoded size
+    size_t appendTo(std::vector<uint8_t>& out) const;
+    size_t encodedSize() const;
+
+    // Batch codec. encodeBatch appends every packet back to back and records
+    // each encoded size; decodeBatch decodes every view, appending the good
+    // packets to `packets` and their view index to `indices`. Returns the
+    // number of views that failed to decode.
+    static void encodeBatch(const std::vector<SRPTPacket>& packets, std::vector<uint8_t>& out,
+                            std::vector<size_t>& sizes);
+    static size_t decodeBatch(const std::vector<SRPTPacketView>& views, std::vector<SRPTPacket>& packets,
+                              std::vector<size_t>& indices);
 
     const SRPTPacketHeader& getHeader() const { return header; }
     const std::vector<uint8_t>& getPayload() const { return payload; }
@@ -0,0 +1,219 @@
+#include "srpt_timer_wheel.h"
+#include <algorithm>
+
+namespace SRPT {
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tickInterval, TimePoint start)
+    : tickInterval_(std::max(tickInterval, std::chrono::milliseconds(1))),
+      start_(start),
+      currentTick_(0),
+      pending_(0),
+      rootPending_(0) {
+    slots_.fill(NIL);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback) {
+    return scheduleAt(currentTime() + delay, std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::scheduleAt(TimePoint deadline, Callback callback) {
+    uint32_t index = allocateNode();
+    Node& node = nodes_[index];
+    node.callback = std::move(callback);
+    node.expiry = std::max(toTick(deadline), currentTick_ + 1);
+    insert(index);
+    ++pending_;
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (!lookup(id)) {
+        return false;
+    }
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFF) - 1;
+    unlink(index);
+    releaseNode(index);
+    --pending_;
+    return true;
+}
+
+bool TimerWheel::isPending(TimerId id) const {
+    return lookup(id) != nullptr;
+}
+
+size_t TimerWheel::advance(TimePoint now) {
+    if (now < start_) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>((now - start_) / tickInterval_);
+    size_t fired = 0;
+
+    while (currentTick_ < target) {
+        if (pending_ == 0) {
+            // Nothing armed: jump straight to the target tick
+            currentTick_ = target;
+            break;
+        }
+        if (rootPending_ == 0) {
+            // Level 0 is empty: skip ahead to the tick before the next cascade
+            currentTick_ = std::min(target - 1, currentTick_ | (ROOT_SIZE - 1));
+        }
+        ++currentTick_;
+
+        // Pull the next block of timers down from each level whose lower level wrapped
+        uint64_t tick = currentTick_;
+        if ((tick & (ROOT_SIZE - 1)) == 0) {
+            for (int level = 1; level < LEVELS; ++level) {
+                cascade(level);
+                int shift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+                if (((tick >> shift) & (LEVEL_SIZE - 1)) != 0) {
+                    break;
+                }
+            }
+        }
+
+        fired += runSlot(static_cast<uint32_t>(tick & (ROOT_SIZE - 1)));
+    }
+    return fired;
+}
+
+std::chrono::milliseconds TimerWheel::timeUntilNextTick(TimePoint now) const {
+    TimePoint next = start_ + tickInterval_ * (currentTick_ + 1);
+    if (next <= now) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(next - now) + std::chrono::milliseconds(1);
+}
+
+TimerWheel::TimePoint TimerWheel::currentTime() const {
+    return start_ + tickInterval_ * currentTick_;
+}
+
+uint64_t TimerWheel::toTick(TimePoint deadline) const {
+    if (deadline <= start_) {
+        return 0;
+    }
+    auto elapsed = deadline - start_;
+    auto ticks = elapsed / tickInterval_;
+    if (elapsed % tickInterval_ != TimePoint::duration::zero()) {
+        ++ticks;  // Never fire early
+    }
+    return static_cast<uint64_t>(ticks);
+}
+
+uint32_t TimerWheel::allocateNode() {
+    if (!freeList_.empty()) {
+        uint32_t index = freeList_.back();
+        freeList_.pop_back();
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimerWheel::releaseNode(uint32_t index) {
+    Node& node = nodes_[index];
+    node.callback = nullptr;
+    node.slot = NIL;
+    node.prev = NIL;
+    node.next = NIL;
+    ++node.generation;
+    freeList_.push_back(index);
+}
+
+uint32_t TimerWheel::slotFor(uint64_t expiry) const {
+    uint64_t delta = expiry > currentTick_ ? expiry - currentTick_ : 0;
+    if (delta < ROOT_SIZE) {
+        return static_cast<uint32_t>(expiry & (ROOT_SIZE - 1));
+    }
+    for (int level = 1; level < LEVELS; ++level) {
+        int shift = ROOT_BITS + level * LEVEL_BITS;
+        if (delta < (uint64_t{1} << shift) || level == LEVELS - 1) {
+            if (delta >= (uint64_t{1} << shift)) {
+                // Beyond the wheel span: park in the farthest slot and re-cascade later
+                expiry = currentTick_ + (uint64_t{1} << shift) - 1;
+            }
+            int indexShift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+            return ROOT_SIZE + (level - 1) * LEVEL_SIZE +
+                   static_cast<uint32_t>((expiry >> indexShift) & (LEVEL_SIZE - 1));
+        }
+    }
+    return NIL;  // Unreachable
+}
+
+void TimerWheel::insert(uint32_t index) {
+    Node& node = nodes_[index];
+    uint32_t slot = slotFor(node.expiry);
+    node.slot = slot;
+    if (slot < ROOT_SIZE) {
+        ++rootPending_;
+    }
+    node.prev = NIL;
+    node.next = slots_[slot];
+    if (node.next != NIL) {
+        nodes_[node.next].prev = index;
+    }
+    slots_[slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        slots_[node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    }
+    if (node.slot < ROOT_SIZE) {
+        --rootPending_;
+    }
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+void TimerWheel::cascade(int level) {
+    int indexShift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+    uint32_t slot = ROOT_SIZE + (level - 1) * LEVEL_SIZE +
+                    static_cast<uint32_t>((currentTick_ >> indexShift) & (LEVEL_SIZE - 1));
+
+    uint32_t index = slots_[slot];
+    slots_[slot] = NIL;
+    while (index != NIL) {
+        uint32_t next = nodes_[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+size_t TimerWheel::runSlot(uint32_t slot) {
+    size_t fired = 0;
+    // Re-read the head each time: callbacks may cancel or arm other timers
+    while (slots_[slot] != NIL) {
+        uint32_t index = slots_[slot];
+        unlink(index);
+        Callback callback = std::move(nodes_[index].callback);
+        releaseNode(index);
+        --pending_;
+        if (callback) {
+            callback();
+        }
+        ++fired;
+    }
+    return fired;
+}
+
+const TimerWheel::Node* TimerWheel::lookup(TimerId id) const {
+    uint32_t raw = static_cast<uint32_t>(id & 0xFFFFFFFF);
+    if (raw == 0 || raw > nodes_.size()) {
+        return nullptr;
+    }
+    const Node& node = nodes_[raw - 1];
+    if (node.generation != static_cast<uint32_t>(id >> 32) || node.slot == NIL) {
+        return nullptr;
+    }
+    return &node;
+}
+
+} // namespace SRPT
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace SRPT {
+
+// Hierarchical timing wheel shared by many connections.
+//
+// Timers are stored in intrusive doubly-linked slot lists, so arming and
+// cancelling are O(1) and an idle timer costs nothing until its slot comes
+// round. Level 0 has 256 slots of one tick each; every higher level has 64
+// slots covering 64x the range of the level below. Deadlines further out
+// than the wheel span are parked in the last slot and re-cascaded.
+//
+// The wheel is not thread-safe: it is meant to be driven from a single
+// event loop which calls advance() with the current time.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;
+
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    explicit TimerWheel(std::chrono::milliseconds tickInterval = std::chrono::milliseconds(10),
+                        TimePoint start = Clock::now());
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Arm a timer. Deadlines at or before the current tick fire on the next tick.
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+    TimerId scheduleAt(TimePoint deadline, Callback callback);
+
+    // Returns false if the timer already fired or was cancelled.
+    bool cancel(TimerId id);
+    bool isPending(TimerId id) const;
+
+    // Run every timer whose deadline is at or before `now`. Returns the
+    // number of callbacks invoked.
+    size_t advance(TimePoint now);
+
+    // Time until the next tick boundary, for event loops that need a poll timeout.
+    std::chrono::milliseconds timeUntilNextTick(TimePoint now) const;
+
+    TimePoint currentTime() const;
+    std::chrono::milliseconds getTickInterval() const { return tickInterval_; }
+    size_t pendingCount() const { return pending_; }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr int LEVELS = 4;
+    static constexpr int ROOT_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr uint32_t ROOT_SIZE = 1u << ROOT_BITS;
+    static constexpr uint32_t LEVEL_SIZE = 1u << LEVEL_BITS;
+    static constexpr uint32_t SLOT_COUNT = ROOT_SIZE + (LEVELS - 1) * LEVEL_SIZE;
+
+    struct Node {
+        Callback callback;
+        uint64_t expiry = 0;   // In ticks
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t slot = NIL;   // Slot list the node is linked into, NIL when free
+        uint32_t generation = 1;
+    };
+
+    std::chrono::milliseconds tickInterval_;
+    TimePoint start_;
+    uint64_t currentTick_;
+    size_t pending_;
+    size_t rootPending_;   // Timers linked into level 0
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeList_;
+    std::array<uint32_t, SLOT_COUNT> slots_;
+
+    uint64_t toTick(TimePoint deadline) const;
+    uint32_t allocateNode();
+    void releaseNode(uint32_t index);
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    void cascade(int level);
+    size_t runSlot(uint32_t slot);
+    uint32_t slotFor(uint64_t expiry) const;
+    const Node* lookup(TimerId id) const;
+};
+
+} // namespace SRPT
@@ -0,0 +1,306 @@
+#include "async_provider.h"
+#include <algorithm>
+
+namespace SRPT {
+namespace Satellite {
+
+// CompletionQueue implementation
+void CompletionQueue::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+size_t CompletionQueue::runOnce(std::chrono::milliseconds maxWait) {
+    std::vector<Task> tasks;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait_for(lock, maxWait, [&] { return !tasks_.empty() || stopped_; });
+        tasks.swap(tasks_);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+    return tasks.size();
+}
+
+void CompletionQueue::run() {
+    while (!stopped_) {
+        runOnce(std::chrono::milliseconds(100));
+    }
+}
+
+bool CompletionQueue::runUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return done();
+        }
+        runOnce(std::min(remaining, std::chrono::milliseconds(10)));
+    }
+    return true;
+}
+
+void CompletionQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    ready_.notify_all();
+}
+
+// AsyncProviderAdapter implementation
+AsyncProviderAdapter::AsyncProviderAdapter(std::unique_ptr<ISatelliteProvider> provider, CompletionQueue& completions)
+    : AsyncProviderAdapter(std::move(provider), completions, Options()) {}
+
+AsyncProviderAdapter::AsyncProviderAdapter(std::unique_ptr<ISatelliteProvider> provider, CompletionQueue& completions,
+                                           const Options& options)
+    : AsyncProviderAdapter(
+          std::move(provider), [&completions](std::function<void()> task) { completions.post(std::move(task)); },
+          options) {}
+
+AsyncProviderAdapter::AsyncProviderAdapter(std::unique_ptr<ISatelliteProvider> provider, Post post,
+                                           const Options& options)
+    : provider_(std::move(provider)), post_(std::move(post)), options_(options) {
+    options_.maxPending = std::max<size_t>(options_.maxPending, 1);
+    worker_ = std::thread(&AsyncProviderAdapter::run, this);
+}
+
+AsyncProviderAdapter::~AsyncProviderAdapter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_one();
+    worker_.join();
+}
+
+void AsyncProviderAdapter::InitializeAsync(const std::map<std::string, std::string>& options, Completion done) {
+    enqueue(Operation{OperationType::INITIALIZE, {}, options, {}, std::move(done), nullptr});
+}
+
+void AsyncProviderAdapter::ConnectAsync(const std::string& satellite_id, Completion done) {
+    enqueue(Operation{OperationType::CONNECT, satellite_id, {}, {}, std::move(done), nullptr});
+}
+
+void AsyncProviderAdapter::DisconnectAsync(Completion done) {
+    enqueue(Operation{OperationType::DISCONNECT, {}, {}, {}, std::move(done), nullptr});
+}
+
+void AsyncProviderAdapter::SendAsync(ByteVector data, Completion done) {
+    enqueue(Operation{OperationType::SEND, {}, {}, std::move(data), std::move(done), nullptr});
+}
+
+void AsyncProviderAdapter::ExecuteCommandAsync(const std::string& command, CommandCompletion done) {
+    enqueue(Operation{OperationType::COMMAND, command, {}, {}, nullptr, std::move(done)});
+}
+
+void AsyncProviderAdapter::ReceiveAsync(ReceiveCompletion done) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_ && operations_.size() + running_ + receives_.size() < options_.maxPending) {
+            receives_.push_back(std::move(done));
+            wakeup_.notify_one();
+            return;
+        }
+    }
+    if (done) {
+        post_([done] { done(false, ByteVector()); });
+    }
+}
+
+double AsyncProviderAdapter::GetSignalStrength() const {
+    return provider_->GetSignalStrength();
+}
+
+double AsyncProviderAdapter::GetLatency() const {
+    return provider_->GetLatency();
+}
+
+uint64_t AsyncProviderAdapter::GetBandwidth() const {
+    return provider_->GetBandwidth();
+}
+
+std::unique_ptr<AsyncSatelliteStream> AsyncProviderAdapter::CreateAsyncStream() {
+    return std::make_unique<AdapterStream>(*this);
+}
+
+size_t AsyncProviderAdapter::getPendingOperations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return operations_.size() + running_;
+}
+
+bool AsyncProviderAdapter::enqueue(Operation&& operation) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_ && operations_.size() + running_ + receives_.size() < options_.maxPending) {
+            operations_.push_back(std::move(operation));
+            wakeup_.notify_one();
+            return true;
+        }
+    }
+    if (operation.commandDone) {
+        auto done = std::move(operation.commandDone);
+        post_([done] { done(false, "Too many pending operations"); });
+    }
+    complete(std::move(operation.done), false);
+    return false;
+}
+
+void AsyncProviderAdapter::complete(Completion done, bool ok) {
+    if (done) {
+        post_([done, ok] { done(ok); });
+    }
+}
+
+void AsyncProviderAdapter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (operations_.empty()) {
+            if (receives_.empty()) {
+                wakeup_.wait(lock, [&] { return stopping_ || !operations_.empty() || !receives_.empty(); });
+            } else {
+                wakeup_.wait_for(lock, options_.receivePoll, [&] { return stopping_ || !operations_.empty(); });
+            }
+            if (stopping_) {
+                break;
+            }
+        }
+        std::deque<Operation> batch;
+        batch.swap(operations_);
+        running_ = batch.size();
+        lock.unlock();
+        execute(batch);
+        pollReceives();
+        lock.lock();
+        running_ = 0;
+    }
+
+    std::deque<Operation> abandoned;
+    abandoned.swap(operations_);
+    lock.unlock();
+    for (auto& operation : abandoned) {
+        if (operation.commandDone) {
+            auto done = std::move(operation.commandDone);
+            post_([done] { done(false, "Shut down"); });
+        }
+        complete(std::move(operation.done), false);
+    }
+    failReceives();
+}
+
+void AsyncProviderAdapter::execute(std::deque<Operation>& batch) {
+    while (!batch.empty()) {
+        Operation& operation = batch.front();
+        switch (operation.type) {
+            case OperationType::INITIALIZE:
+                complete(std::move(operation.done), provider_->Initialize(operation.options));
+                break;
+            case OperationType::CONNECT:
+                complete(std::move(operation.done), provider_->Connect(operation.argument));
+                break;
+            case OperationType::DISCONNECT:
+                complete(std::move(operation.done), provider_->Disconnect());
+                failReceives();
+                break;
+            case OperationType::COMMAND: {
+                std::string response;
+                bool ok = provider_->ExecuteCommand(operation.argument, response);
+                if (operation.commandDone) {
+                    auto done = std::move(operation.commandDone);
+                    post_([done, ok, response] { done(ok, response); });
+                }
+                break;
+            }
+            case OperationType::SEND: {
+                // Consecutive sends go over as one batch, moved rather than copied
+                std::vector<ByteVector> packets;
+                std::vector<Completion> completions;
+                while (!batch.empty() && batch.front().type == OperationType::SEND) {
+                    packets.push_back(std::move(batch.front().data));
+                    completions.push_back(std::move(batch.front().done));
+                    batch.pop_front();
+                }
+                size_t taken = provider_->SendBatch(packets);
+                post_([completions = std::move(completions), taken] {
+                    for (size_t i = 0; i < completions.size(); ++i) {
+                        if (completions[i]) {
+                            completions[i](i < taken);
+                        }
+                    }
+                });
+                continue;
+            }
+        }
+        batch.pop_front();
+    }
+}
+
+void AsyncProviderAdapter::pollReceives() {
+    size_t waiting;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        waiting = receives_.size();
+    }
+    if (waiting == 0) {
+        return;
+    }
+    std::vector<ByteVector> packets;
+    provider_->ReceiveBatch(packets, waiting);
+    if (packets.empty()) {
+        return;
+    }
+    // Only this thread removes receives, so at least `waiting` are still there
+    std::vector<ReceiveCompletion> completions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < packets.size(); ++i) {
+            completions.push_back(std::move(receives_.front()));
+            receives_.pop_front();
+        }
+    }
+    post_([completions = std::move(completions), packets = std::move(packets)]() mutable {
+        for (size_t i = 0; i < completions.size(); ++i) {
+            if (completions[i]) {
+                completions[i](true, std::move(packets[i]));
+            }
+        }
+    });
+}
+
+void AsyncProviderAdapter::failReceives() {
+    std::deque<ReceiveCompletion> receives;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        receives.swap(receives_);
+    }
+    if (receives.empty()) {
+        return;
+    }
+    post_([receives = std::move(receives)] {
+        for (const auto& done : receives) {
+            if (done) {
+                done(false, ByteVector());
+            }
+        }
+    });
+}
+
+// AdapterStream implementation
+AsyncProviderAdapter::AdapterStream::AdapterStream(AsyncProviderAdapter& adapter) : m_adapter(adapter) {}
+
+void AsyncProviderAdapter::AdapterStream::WriteAsync(ByteVector data, Completion done) {
+    m_adapter.SendAsync(std::move(data), std::move(done));
+}
+
+void AsyncProviderAdapter::AdapterStream::ReadAsync(ReadCompletion done) {
+    m_adapter.ReceiveAsync(std::move(done));
+}
+
+void AsyncProviderAdapter::AdapterStream::Close() {}
+
+} // namespace Satellite
+} // namespace SRPT
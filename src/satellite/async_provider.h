@@ -0,0 +1,146 @@
+#pragma once
+
+#include "../../include/srpt_satellite.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SRPT {
+namespace Satellite {
+
+// Completions posted from provider threads, run by one event-loop thread.
+// Mirrors the task side of Transport::EventLoop for code that drives
+// terminals without sockets; with an EventLoop at hand, adapters can post
+// to it directly instead.
+class CompletionQueue {
+public:
+    using Task = std::function<void()>;
+
+    CompletionQueue() = default;
+    CompletionQueue(const CompletionQueue&) = delete;
+    CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+    // Thread-safe
+    void post(Task task);
+
+    // Wait at most `maxWait` for tasks, then run every task queued by then.
+    // Returns the number that ran.
+    size_t runOnce(std::chrono::milliseconds maxWait);
+    // Run until stop() is called. A stop() issued before run() makes it return at once.
+    void run();
+    // Run until `done` returns true or `timeout` elapses; returns done()
+    bool runUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout);
+
+    // Thread-safe
+    void stop();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::vector<Task> tasks_;
+    std::atomic<bool> stopped_{false};
+};
+
+// Runs a synchronous ISatelliteProvider behind the async interface. Each
+// adapter owns one worker thread that makes the blocking calls for its
+// terminal, in order, and posts completions back; the caller's thread is
+// never blocked, so one event-loop thread can drive many terminals, each
+// behind its own adapter. Consecutive sends go to the provider as one
+// SendBatch(). Pending receives are served by polling the provider every
+// Options::receivePoll while any are waiting.
+//
+// Once Options::maxPending operations are queued, new ones fail at once.
+// On destruction, operations not yet started complete with ok == false.
+// The status getters call the provider directly from the caller's thread.
+class AsyncProviderAdapter : public IAsyncSatelliteProvider {
+public:
+    using Post = std::function<void(std::function<void()>)>;
+
+    struct Options {
+        std::chrono::microseconds receivePoll{1000};
+        size_t maxPending = 4096;  // Operations, including waiting receives
+    };
+
+    AsyncProviderAdapter(std::unique_ptr<ISatelliteProvider> provider, CompletionQueue& completions);
+    AsyncProviderAdapter(std::unique_ptr<ISatelliteProvider> provider, CompletionQueue& completions,
+                         const Options& options);
+    // Completions go through `post`, e.g. into a Transport::EventLoop
+    AsyncProviderAdapter(std::unique_ptr<ISatelliteProvider> provider, Post post, const Options& options);
+    ~AsyncProviderAdapter();
+
+    AsyncProviderAdapter(const AsyncProviderAdapter&) = delete;
+    AsyncProviderAdapter& operator=(const AsyncProviderAdapter&) = delete;
+
+    void InitializeAsync(const std::map<std::string, std::string>& options, Completion done) override;
+    void ConnectAsync(const std::string& satellite_id, Completion done) override;
+    void DisconnectAsync(Completion done) override;
+    void SendAsync(ByteVector data, Completion done) override;
+    void ReceiveAsync(ReceiveCompletion done) override;
+    void ExecuteCommandAsync(const std::string& command, CommandCompletion done) override;
+    double GetSignalStrength() const override;
+    double GetLatency() const override;
+    uint64_t GetBandwidth() const override;
+    std::unique_ptr<AsyncSatelliteStream> CreateAsyncStream() override;
+
+    // Operations queued or running, not counting waiting receives
+    size_t getPendingOperations() const;
+
+private:
+    enum class OperationType {
+        INITIALIZE,
+        CONNECT,
+        DISCONNECT,
+        SEND,
+        COMMAND,
+    };
+
+    struct Operation {
+        OperationType type;
+        std::string argument;
+        std::map<std::string, std::string> options;
+        ByteVector data;
+        Completion done;
+        CommandCompletion commandDone;
+    };
+
+    std::unique_ptr<ISatelliteProvider> provider_;
+    Post post_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<Operation> operations_;
+    std::deque<ReceiveCompletion> receives_;
+    size_t running_ = 0;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    bool enqueue(Operation&& operation);
+    void complete(Completion done, bool ok);
+    void run();
+    void execute(std::deque<Operation>& batch);
+    void pollReceives();
+    void failReceives();
+
+    class AdapterStream : public AsyncSatelliteStream {
+    public:
+        explicit AdapterStream(AsyncProviderAdapter& adapter);
+        void WriteAsync(ByteVector data, Completion done) override;
+        void ReadAsync(ReadCompletion done) override;
+        void Close() override;
+
+    private:
+        AsyncProviderAdapter& m_adapter;
+    };
+};
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,518 @@
+#include "contact_scheduler.h"
+#include "../core/srpt_packet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+
+namespace SRPT {
+namespace Satellite {
+
+namespace {
+
+// The package ID in the SRPT header is 64 bits; SRPTPackage IDs are 32 hex
+// digits, so take the first 16
+uint64_t wireIdOf(const std::string& id) {
+    if (id.size() >= 16) {
+        std::string prefix = id.substr(0, 16);
+        char* end = nullptr;
+        uint64_t value = std::strtoull(prefix.c_str(), &end, 16);
+        if (*end == '\0') {
+            return value;
+        }
+    }
+    return std::hash<std::string>()(id);
+}
+
+// Bytes a contact has allowed so far at its rate
+uint64_t allowedBytes(const Contact& contact, std::chrono::milliseconds now) {
+    if (now <= contact.start) {
+        return 0;
+    }
+    auto elapsed = std::min(now, contact.end) - contact.start;
+    return contact.bitsPerSecond * static_cast<uint64_t>(elapsed.count()) / 8000;
+}
+
+} // namespace
+
+uint64_t Contact::capacityBytes() const {
+    return end > start ? bitsPerSecond * static_cast<uint64_t>((end - start).count()) / 8000 : 0;
+}
+
+bool ContactPlan::addContact(const Contact& contact) {
+    if (contact.link.empty() || contact.start.count() < 0 || contact.end <= contact.start ||
+        contact.bitsPerSecond == 0 || contact.latency.count() < 0) {
+        lastError_ = "Invalid contact";
+        return false;
+    }
+    for (const auto& other : contacts_) {
+        if (other.link == contact.link && contact.start < other.end && other.start < contact.end) {
+            lastError_ = "Contact overlaps another of link " + contact.link;
+            return false;
+        }
+    }
+    auto position = std::upper_bound(contacts_.begin(), contacts_.end(), contact,
+                                     [](const Contact& a, const Contact& b) { return a.start < b.start; });
+    contacts_.insert(position, contact);
+    return true;
+}
+
+std::chrono::milliseconds ContactPlan::end() const {
+    std::chrono::milliseconds last{0};
+    for (const auto& contact : contacts_) {
+        last = std::max(last, contact.end);
+    }
+    return last;
+}
+
+bool ContactPlan::parseText(const std::string& text) {
+    ContactPlan plan;
+    std::istringstream in(text);
+    std::string line;
+    for (size_t number = 1; std::getline(in, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        Contact contact;
+        if (!(fields >> contact.link)) {
+            continue;
+        }
+        int64_t start = 0;
+        int64_t end = 0;
+        double kbps = 0;
+        int64_t latency = 0;
+        std::string rest;
+        bool ok = fields >> start >> end >> kbps >> latency && kbps > 0 && !(fields >> rest);
+        if (ok) {
+            contact.start = std::chrono::milliseconds(start);
+            contact.end = std::chrono::milliseconds(end);
+            contact.bitsPerSecond = static_cast<uint64_t>(std::llround(kbps * 1000));
+            contact.latency = std::chrono::milliseconds(latency);
+            ok = plan.addContact(contact);
+        }
+        if (!ok) {
+            lastError_ = "Malformed contact line " + std::to_string(number);
+            return false;
+        }
+    }
+    contacts_ = std::move(plan.contacts_);
+    return true;
+}
+
+ContactScheduler::ContactScheduler(const ContactPlan& plan)
+    : ContactScheduler(plan, Common::SteadyClock::instance()) {}
+
+ContactScheduler::ContactScheduler(const ContactPlan& plan, const Common::Clock& clock)
+    : ContactScheduler(plan, clock, Options()) {}
+
+ContactScheduler::ContactScheduler(const ContactPlan& plan, const Common::Clock& clock, const Options& options)
+    : plan_(plan),
+      clock_(clock),
+      options_(options),
+      start_(clock.now()),
+      chunking_(std::max<size_t>(options.chunkSize, 1)),
+      contactStates_(plan.getContacts().size(), ContactState::PENDING),
+      contactBytes_(plan.getContacts().size(), 0),
+      contactBegin_(plan.getContacts().size() + 1, 0),
+      contactNext_(plan.getContacts().size(), 0) {
+    transmit_ = [this](const Contact& contact, const ByteVector& packet, std::chrono::milliseconds&) {
+        auto it = links_.find(contact.link);
+        return it != links_.end() && it->second.stream && it->second.stream->Write(packet);
+    };
+}
+
+void ContactScheduler::addLink(const std::string& name, SatelliteSession& session) {
+    links_[name].session = &session;
+    replan(false);
+}
+
+std::string ContactScheduler::submit(const SRPTPackage& package, PackagePriority priority) {
+    Package entry;
+    entry.id = package.getId();
+    entry.ordinal = submitted_++;
+    entry.wireId = wireIdOf(entry.id);
+    entry.priority = priority;
+    entry.chunks = chunking_.createChunks(package);
+    auto total = static_cast<uint32_t>(entry.chunks.size());
+    for (const auto& chunk : entry.chunks) {
+        SRPTPacket packet(static_cast<uint8_t>(SRPTPacketType::DATA), entry.wireId,
+                          static_cast<uint32_t>(chunk.getSequenceNumber()), total, chunk.getData());
+        entry.wireBytes.push_back(packet.encodedSize());
+    }
+    entry.sentChunks.assign(entry.chunks.size(), false);
+    entry.deliveredAt = elapsed();
+    std::string id = entry.id;
+    packages_.push_back(std::move(entry));
+    replan(true);
+    return id;
+}
+
+size_t ContactScheduler::poll() {
+    auto now = elapsed();
+    const auto& contacts = plan_.getContacts();
+    size_t sent = 0;
+    bool stranded = false;  // Planned chunks lost their contact
+    for (size_t c = 0; c < contacts.size(); ++c) {
+        const Contact& contact = contacts[c];
+        bool planned = contactNext_[c] < contactBegin_[c + 1];
+        if (contactStates_[c] == ContactState::OPEN && now >= contact.end) {
+            // What the contact allowed up to its end goes before it closes
+            sent += sendDue(c, contact.end);
+            closeContact(c);
+            stranded = stranded || contactNext_[c] < contactBegin_[c + 1];
+        } else if (contactStates_[c] == ContactState::PENDING && now >= contact.start) {
+            if (now >= contact.end || !usable(c)) {
+                contactStates_[c] = ContactState::CLOSED;  // Missed, e.g. by a late poll()
+                stranded = stranded || planned;
+            } else if (!openContact(c)) {
+                stranded = stranded || planned;
+            }
+        }
+    }
+    if (stranded) {
+        replan(false);
+    }
+
+    for (size_t c = 0; c < contacts.size(); ++c) {
+        if (contactStates_[c] == ContactState::OPEN) {
+            sent += sendDue(c, now);
+        }
+    }
+    return sent;
+}
+
+std::vector<ContactScheduler::Assignment> ContactScheduler::getSchedule() const {
+    std::vector<Assignment> schedule;
+    for (size_t c = 0; c < contactNext_.size(); ++c) {
+        schedule.insert(schedule.end(), schedule_.begin() + contactNext_[c], schedule_.begin() + contactBegin_[c + 1]);
+    }
+    return schedule;
+}
+
+std::vector<ContactScheduler::PackageStatus> ContactScheduler::getPackages() const {
+    // Merge the retired and the pending, both in order of submission
+    std::vector<PackageStatus> packages;
+    packages.reserve(delivered_.size() + packages_.size());
+    auto retired = delivered_.begin();
+    for (const auto& package : packages_) {
+        for (; retired != delivered_.end() && retired->first < package.ordinal; ++retired) {
+            packages.push_back(retired->second);
+        }
+        packages.push_back(statusOf(package));
+    }
+    for (; retired != delivered_.end(); ++retired) {
+        packages.push_back(retired->second);
+    }
+    return packages;
+}
+
+ContactScheduler::SimulationResult ContactScheduler::simulate(const ContactPlan& plan,
+                                                              const std::vector<SimulatedPackage>& packages,
+                                                              const Options& options) {
+    return simulate(plan, packages, options, plan);
+}
+
+ContactScheduler::SimulationResult ContactScheduler::simulate(const ContactPlan& plan,
+                                                              const std::vector<SimulatedPackage>& packages,
+                                                              const Options& options, const ContactPlan& actual,
+                                                              std::chrono::milliseconds step) {
+    step = std::max(step, std::chrono::milliseconds(1));
+    Common::ManualClock clock;
+    ContactScheduler scheduler(plan, clock, options);
+    scheduler.simulated_ = true;
+
+    // The actual contacts carry what their rate allows, whatever the plan says
+    std::vector<uint64_t> actualBytes(actual.getContacts().size(), 0);
+    scheduler.transmit_ = [&](const Contact& contact, const ByteVector& packet,
+                              std::chrono::milliseconds& latency) {
+        auto now = scheduler.elapsed();
+        const auto& windows = actual.getContacts();
+        for (size_t a = 0; a < windows.size(); ++a) {
+            const Contact& window = windows[a];
+            if (window.link != contact.link || now < window.start || now > window.end ||
+                actualBytes[a] + packet.size() > allowedBytes(window, now)) {
+                continue;
+            }
+            actualBytes[a] += packet.size();
+            latency = window.latency;
+            return true;
+        }
+        return false;
+    };
+
+    std::vector<size_t> order(packages.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return packages[a].submitAt < packages[b].submitAt; });
+    auto horizon = std::max(plan.end(), actual.end());
+    if (!order.empty()) {
+        horizon = std::max(horizon, packages[order.back()].submitAt);
+    }
+
+    std::vector<size_t> ordinals(packages.size());
+    size_t submitted = 0;
+    while (true) {
+        auto now = scheduler.elapsed();
+        for (; submitted < order.size() && packages[order[submitted]].submitAt <= now; ++submitted) {
+            const auto& package = packages[order[submitted]];
+            scheduler.submit(SRPTPackage(package.bytes), package.priority);
+            ordinals[order[submitted]] = scheduler.submitted_ - 1;
+        }
+        scheduler.poll();
+        if (now >= horizon) {
+            break;
+        }
+
+        // Step through open contacts; otherwise jump to the next opening or
+        // submission
+        auto next = horizon;
+        const auto& contacts = plan.getContacts();
+        for (size_t c = 0; c < contacts.size(); ++c) {
+            if (scheduler.contactStates_[c] == ContactState::OPEN) {
+                next = std::min({next, now + step, contacts[c].end});
+            } else if (scheduler.contactStates_[c] == ContactState::PENDING) {
+                next = std::min(next, contacts[c].start);
+            }
+        }
+        if (submitted < order.size()) {
+            next = std::min(next, packages[order[submitted]].submitAt);
+        }
+        clock.advance(std::max(next - now, std::chrono::milliseconds(1)));
+    }
+
+    SimulationResult result;
+    auto statuses = scheduler.getPackages();
+    for (size_t ordinal : ordinals) {
+        result.packages.push_back(statuses[ordinal]);
+    }
+    result.contactBytes = scheduler.contactBytes_;
+    result.stats = scheduler.stats_;
+    return result;
+}
+
+std::chrono::milliseconds ContactScheduler::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(clock_.now() - start_);
+}
+
+bool ContactScheduler::usable(size_t contact) const {
+    if (contactStates_[contact] == ContactState::CLOSED) {
+        return false;
+    }
+    return simulated_ || links_.count(plan_.getContacts()[contact].link) > 0;
+}
+
+void ContactScheduler::replan(bool countPreempted) {
+    retireDelivered();
+    const auto& contacts = plan_.getContacts();
+    auto now = elapsed();
+
+    // Where each unsent chunk stood, to count what this plan displaces
+    std::map<std::pair<size_t, size_t>, size_t> previous;
+    if (countPreempted) {
+        for (size_t c = 0; c < contacts.size(); ++c) {
+            for (size_t i = contactNext_[c]; i < contactBegin_[c + 1]; ++i) {
+                previous[{scheduled_[i], schedule_[i].chunk}] = c;
+            }
+        }
+    }
+
+    // By priority, then in order of submission
+    std::vector<size_t> order;
+    for (size_t p = 0; p < packages_.size(); ++p) {
+        Package& package = packages_[p];
+        package.planned = package.sent == package.chunks.size();
+        package.plannedArrival = package.deliveredAt;
+        if (!package.planned) {
+            order.push_back(p);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t a, size_t b) { return packages_[a].priority > packages_[b].priority; });
+    std::vector<size_t> next(packages_.size(), 0);  // First chunk not yet planned or sent
+
+    schedule_.clear();
+    scheduled_.clear();
+    for (size_t c = 0; c < contacts.size(); ++c) {
+        const Contact& contact = contacts[c];
+        contactBegin_[c] = contactNext_[c] = schedule_.size();
+        if (!usable(c) || contact.end <= now) {
+            continue;
+        }
+        uint64_t capacity = contact.capacityBytes();
+        uint64_t room = capacity > contactBytes_[c] ? capacity - contactBytes_[c] : 0;
+        // Send times run on from what the contact has sent, or from now if
+        // it has fallen behind
+        double at = std::max(static_cast<double>(contact.start.count()) + contactBytes_[c] * 8000.0 /
+                                                                                  contact.bitsPerSecond,
+                             static_cast<double>(now.count()));
+        for (size_t p : order) {
+            Package& package = packages_[p];
+            size_t& chunk = next[p];
+            while (true) {
+                while (chunk < package.chunks.size() && package.sentChunks[chunk]) {
+                    ++chunk;
+                }
+                if (chunk == package.chunks.size() || package.wireBytes[chunk] > room) {
+                    break;
+                }
+                size_t bytes = package.wireBytes[chunk];
+                Assignment assignment;
+                assignment.contact = c;
+                assignment.packageId = package.id;
+                assignment.chunk = chunk;
+                assignment.bytes = bytes;
+                assignment.sendAt = std::chrono::milliseconds(static_cast<int64_t>(at));
+                schedule_.push_back(std::move(assignment));
+                scheduled_.push_back(p);
+                room -= bytes;
+                at += bytes * 8000.0 / contact.bitsPerSecond;
+                ++chunk;
+                auto arrival = std::chrono::milliseconds(static_cast<int64_t>(std::ceil(at))) + contact.latency;
+                package.plannedArrival = std::max(package.plannedArrival, arrival);
+            }
+            if (room == 0) {
+                break;
+            }
+        }
+    }
+    contactBegin_[contacts.size()] = schedule_.size();
+
+    for (size_t p : order) {
+        Package& package = packages_[p];
+        size_t chunk = next[p];
+        while (chunk < package.chunks.size() && package.sentChunks[chunk]) {
+            ++chunk;
+        }
+        package.planned = chunk == package.chunks.size();
+    }
+
+    if (countPreempted) {
+        std::map<std::pair<size_t, size_t>, size_t> current;
+        for (size_t i = 0; i < schedule_.size(); ++i) {
+            current[{scheduled_[i], schedule_[i].chunk}] = schedule_[i].contact;
+        }
+        for (const auto& entry : previous) {
+            auto it = current.find(entry.first);
+            if (it == current.end() || it->second > entry.second) {
+                ++stats_.preemptedChunks;
+            }
+        }
+    }
+    ++stats_.replans;
+}
+
+void ContactScheduler::retireDelivered() {
+    std::vector<size_t> moved(packages_.size(), SIZE_MAX);
+    size_t kept = 0;
+    for (size_t p = 0; p < packages_.size(); ++p) {
+        Package& package = packages_[p];
+        if (package.sent == package.chunks.size()) {
+            delivered_.emplace(package.ordinal, statusOf(package));
+            continue;
+        }
+        moved[p] = kept;
+        if (kept != p) {
+            packages_[kept] = std::move(package);
+        }
+        ++kept;
+    }
+    if (kept == packages_.size()) {
+        return;
+    }
+    packages_.erase(packages_.begin() + kept, packages_.end());
+    // Only sent assignments point at retired packages, and those are not
+    // read again
+    for (size_t& p : scheduled_) {
+        p = moved[p];
+    }
+}
+
+bool ContactScheduler::openContact(size_t contact) {
+    const Contact& window = plan_.getContacts()[contact];
+    if (!simulated_) {
+        Link& link = links_[window.link];
+        if (!link.session->Connect(window.link)) {
+            ++stats_.failedConnects;
+            contactStates_[contact] = ContactState::CLOSED;
+            return false;
+        }
+        link.stream = link.session->CreateSatelliteStream();
+        if (!link.stream) {
+            link.session->Disconnect();
+            ++stats_.failedConnects;
+            contactStates_[contact] = ContactState::CLOSED;
+            return false;
+        }
+        link.contact = contact;
+    }
+    contactStates_[contact] = ContactState::OPEN;
+    return true;
+}
+
+void ContactScheduler::closeContact(size_t contact) {
+    contactStates_[contact] = ContactState::CLOSED;
+    if (simulated_) {
+        return;
+    }
+    Link& link = links_[plan_.getContacts()[contact].link];
+    if (link.contact != contact) {
+        return;
+    }
+    if (link.stream) {
+        link.stream->Close();
+        link.stream.reset();
+    }
+    link.session->Disconnect();
+    link.contact = SIZE_MAX;
+}
+
+size_t ContactScheduler::sendDue(size_t contact, std::chrono::milliseconds now) {
+    const Contact& window = plan_.getContacts()[contact];
+    uint64_t allowed = allowedBytes(window, now);
+    size_t sent = 0;
+    size_t& i = contactNext_[contact];
+    for (; i < contactBegin_[contact + 1]; ++i) {
+        const Assignment& assignment = schedule_[i];
+        Package& package = packages_[scheduled_[i]];
+        if (contactBytes_[contact] + assignment.bytes > allowed) {
+            break;
+        }
+        const SRPTChunk& chunk = package.chunks[assignment.chunk];
+        SRPTPacket packet(static_cast<uint8_t>(SRPTPacketType::DATA), package.wireId,
+                          static_cast<uint32_t>(chunk.getSequenceNumber()),
+                          static_cast<uint32_t>(package.chunks.size()), chunk.getData());
+        std::chrono::milliseconds latency = window.latency;
+        if (!transmit_(window, packet.toBytes(), latency)) {
+            ++stats_.refusedSends;
+            break;
+        }
+        package.sentChunks[assignment.chunk] = true;
+        ++package.sent;
+        package.deliveredAt = std::max(package.deliveredAt, now + latency);
+        contactBytes_[contact] += assignment.bytes;
+        ++stats_.chunksSent;
+        stats_.bytesSent += assignment.bytes;
+        ++sent;
+    }
+    return sent;
+}
+
+ContactScheduler::PackageStatus ContactScheduler::statusOf(const Package& package) const {
+    PackageStatus status;
+    status.id = package.id;
+    status.priority = package.priority;
+    status.chunks = package.chunks.size();
+    status.sent = package.sent;
+    status.planned = package.planned;
+    status.plannedArrival = package.plannedArrival;
+    status.delivered = package.sent == package.chunks.size();
+    if (status.delivered) {
+        status.deliveredAt = package.deliveredAt;
+    }
+    return status;
+}
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "../../include/srpt_satellite.h"
+#include "../common/clock.h"
+#include "../core/srpt_chunking.h"
+#include "../core/srpt_package.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SRPT {
+namespace Satellite {
+
+// A window in which a link is expected to be up, at a known rate and
+// latency. Times are since the start of the plan.
+struct Contact {
+    std::string link;  // Name the link is added to the scheduler under
+    std::chrono::milliseconds start{0};
+    std::chrono::milliseconds end{0};
+    uint64_t bitsPerSecond = 0;
+    std::chrono::milliseconds latency{0};  // One way
+
+    // Bytes the window carries at its rate
+    uint64_t capacityBytes() const;
+};
+
+// The predicted contacts of LEO passes, drone flights and the like, in
+// order of start. Windows of one link may not overlap; windows of
+// different links may.
+//
+// Text form, one contact per line, '#' starting a comment:
+//   <link> <start ms> <end ms> <rate kbit/s> <latency ms>
+class ContactPlan {
+public:
+    // False for an empty window, a zero rate, or an overlap with another
+    // window of the same link
+    bool addContact(const Contact& contact);
+    void clear() { contacts_.clear(); }
+
+    const std::vector<Contact>& getContacts() const { return contacts_; }
+    bool empty() const { return contacts_.empty(); }
+    // End of the last window
+    std::chrono::milliseconds end() const;
+
+    // Replaces the plan; false, with the plan unchanged, on a malformed line
+    bool parseText(const std::string& text);
+    std::string getLastError() const { return lastError_; }
+
+private:
+    std::vector<Contact> contacts_;
+    std::string lastError_;
+};
+
+enum class PackagePriority : uint8_t {
+    BULK,
+    NORMAL,
+    URGENT,
+};
+
+// Plans which chunks of which packages go out in which contact, and sends
+// them when the time comes.
+//
+// Packages are cut into chunks by SRPTChunking and each chunk goes out as
+// one SRPTPacket of type DATA. The plan takes packages by priority, then
+// in order of submission. It walks the contacts in order of start and
+// fills each one to capacity. A chunk that does not fit what is left of a
+// contact gives way to a later package's chunk that does. Chunks of one
+// package keep their order.
+//
+// The plan is redone whenever a package is submitted, and whenever a
+// contact closes with planned chunks unsent. A contact also closes early if
+// its link fails to connect. An urgent package therefore takes the place of
+// bulk chunks in the current contact, and the displaced chunks move to later
+// contacts. Stats::preemptedChunks counts them. Each replan first retires
+// packages whose chunks have all been sent: their chunks are freed and only
+// their PackageStatus is kept, so planning cost follows the packages still
+// pending, not everything ever submitted.
+//
+// Links are SatelliteSessions, added by name. poll() connects a link when
+// one of its contacts opens, paces chunks out at the contact's rate, and
+// disconnects it when the contact closes. Contacts of links never added
+// are left out of the plan. A chunk the link refuses is retried on the
+// next poll().
+//
+// simulate() runs the same planning and pacing offline, against a
+// ManualClock and links that follow a second plan: the contacts that
+// actually happened, which may open late, run slower or not at all. The
+// result shows how well the plan holds up.
+//
+// Not thread-safe: one thread calls submit() and poll().
+class ContactScheduler {
+public:
+    struct Options {
+        size_t chunkSize = 1024;  // Payload bytes per chunk
+    };
+
+    // One chunk planned into one contact
+    struct Assignment {
+        size_t contact = 0;  // Index in the plan's contacts
+        std::string packageId;
+        size_t chunk = 0;
+        size_t bytes = 0;  // On the wire
+        std::chrono::milliseconds sendAt{0};  // Planned, since the start of the plan
+    };
+
+    struct PackageStatus {
+        std::string id;
+        PackagePriority priority = PackagePriority::NORMAL;
+        size_t chunks = 0;
+        size_t sent = 0;
+        // Every unsent chunk has a contact, and the last should arrive at
+        // plannedArrival
+        bool planned = false;
+        std::chrono::milliseconds plannedArrival{0};
+        bool delivered = false;  // Every chunk handed to a link
+        std::chrono::milliseconds deliveredAt{0};  // Last chunk sent, plus the link's latency
+    };
+
+    struct Stats {
+        uint64_t chunksSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t replans = 0;
+        uint64_t preemptedChunks = 0;  // Pushed to a later contact, or out of the plan, by a replan
+        uint64_t refusedSends = 0;
+        uint64_t failedConnects = 0;
+    };
+
+    // A package for simulate(), by size; its bytes do not matter
+    struct SimulatedPackage {
+        size_t bytes = 0;
+        PackagePriority priority = PackagePriority::NORMAL;
+        std::chrono::milliseconds submitAt{0};
+    };
+
+    struct SimulationResult {
+        std::vector<PackageStatus> packages;  // In the order given
+        std::vector<uint64_t> contactBytes;  // Sent in each planned contact
+        Stats stats;
+    };
+
+    // The plan starts now, by `clock`
+    explicit ContactScheduler(const ContactPlan& plan);
+    ContactScheduler(const ContactPlan& plan, const Common::Clock& clock);
+    ContactScheduler(const ContactPlan& plan, const Common::Clock& clock, const Options& options);
+
+    ContactScheduler(const ContactScheduler&) = delete;
+    ContactScheduler& operator=(const ContactScheduler&) = delete;
+
+    // The session must outlive the scheduler. Replans.
+    void addLink(const std::string& name, SatelliteSession& session);
+
+    // Queues a package and replans; returns its ID
+    std::string submit(const SRPTPackage& package, PackagePriority priority = PackagePriority::NORMAL);
+
+    // Opens and closes contacts that are due, and sends what the plan has
+    // for the open ones, up to what each contact's rate allows so far.
+    // Returns the number of chunks sent.
+    size_t poll();
+
+    const ContactPlan& getContactPlan() const { return plan_; }
+    // Unsent chunks, by contact then in sending order
+    std::vector<Assignment> getSchedule() const;
+    // Every package submitted, in order of submission
+    std::vector<PackageStatus> getPackages() const;
+    Stats getStats() const { return stats_; }
+
+    // Replays `packages` against `plan` offline: chunks are sent where
+    // `actual` has an open contact with room, and take its latency.
+    // `step` is how far the simulated clock moves between polls while a
+    // contact is open; between contacts it jumps to the next event.
+    static SimulationResult simulate(const ContactPlan& plan, const std::vector<SimulatedPackage>& packages,
+                                     const Options& options);
+    static SimulationResult simulate(const ContactPlan& plan, const std::vector<SimulatedPackage>& packages,
+                                     const Options& options, const ContactPlan& actual,
+                                     std::chrono::milliseconds step = std::chrono::milliseconds(100));
+
+private:
+    // Hands one packet to a link; sets the latency it will see
+    using Transmit = std::function<bool(const Contact& contact, const ByteVector& packet,
+                                        std::chrono::milliseconds& latency)>;
+
+    struct Package {
+        std::string id;
+        uint64_t ordinal = 0;  // Order of submission
+        uint64_t wireId = 0;  // Package ID in the SRPT header
+        PackagePriority priority = PackagePriority::NORMAL;
+        std::vector<SRPTChunk> chunks;
+        std::vector<size_t> wireBytes;  // Per chunk
+        std::vector<bool> sentChunks;  // Contacts on different links may overlap, so chunks can go out of order
+        size_t sent = 0;
+        std::chrono::milliseconds deliveredAt{0};
+        bool planned = false;
+        std::chrono::milliseconds plannedArrival{0};
+    };
+
+    struct Link {
+        SatelliteSession* session = nullptr;
+        std::unique_ptr<SatelliteStream> stream;
+        size_t contact = SIZE_MAX;  // Open contact, if any
+    };
+
+    enum class ContactState : uint8_t {
+        PENDING,
+        OPEN,
+        CLOSED,
+    };
+
+    ContactPlan plan_;
+    const Common::Clock& clock_;
+    Options options_;
+    Common::Clock::TimePoint start_;
+    SRPTChunking chunking_;
+    std::vector<Package> packages_;  // Not yet delivered, in order of submission
+    std::map<uint64_t, PackageStatus> delivered_;  // Retired, by ordinal
+    uint64_t submitted_ = 0;
+    std::map<std::string, Link> links_;
+    std::vector<ContactState> contactStates_;
+    std::vector<uint64_t> contactBytes_;  // Sent in each contact
+    std::vector<Assignment> schedule_;
+    std::vector<size_t> scheduled_;  // Package index of each assignment
+    std::vector<size_t> contactBegin_;  // First assignment of each contact; one past the end last
+    std::vector<size_t> contactNext_;  // First unsent assignment of each contact
+    bool simulated_ = false;
+    Transmit transmit_;
+    Stats stats_;
+
+    std::chrono::milliseconds elapsed() const;
+    bool usable(size_t contact) const;
+    void replan(bool countPreempted);
+    void retireDelivered();
+    bool openContact(size_t contact);
+    void closeContact(size_t contact);
+    size_t sendDue(size_t contact, std::chrono::milliseconds now);
+    PackageStatus statusOf(const Package& package) const;
+};
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,380 @@
+#include "emulated_link_provider.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+namespace SRPT {
+namespace Satellite {
+
+namespace {
+std::chrono::nanoseconds serializationTime(size_t bytes, uint64_t bitsPerSecond) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(bytes * 8e9 / bitsPerSecond));
+}
+}
+
+EmulatedLink::Endpoints EmulatedLink::createPair(const Config& config) {
+    return createPair(config, config);
+}
+
+EmulatedLink::Endpoints EmulatedLink::createPair(const Config& aToB, const Config& bToA) {
+    std::shared_ptr<EmulatedLink> link(new EmulatedLink(aToB, bToA));
+    return Endpoints(std::unique_ptr<EmulatedLinkProvider>(new EmulatedLinkProvider(link, 0)),
+                     std::unique_ptr<EmulatedLinkProvider>(new EmulatedLinkProvider(link, 1)));
+}
+
+EmulatedLink::EmulatedLink(const Config& aToB, const Config& bToA) {
+    directions_[0].config = aToB;
+    directions_[1].config = bToA;
+    for (auto& direction : directions_) {
+        direction.rng.seed(direction.config.seed);
+    }
+    thread_ = std::thread(&EmulatedLink::deliveryLoop, this);
+}
+
+EmulatedLink::~EmulatedLink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    pending_.notify_all();
+    thread_.join();
+}
+
+bool EmulatedLink::connect(int side) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_[side] = true;
+    inbox_[side].clear();
+    return true;
+}
+
+void EmulatedLink::disconnect(int side) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_[side] = false;
+    inbox_[side].clear();
+    arrived_[side].notify_all();
+}
+
+bool EmulatedLink::isConnected(int side) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connected_[side];
+}
+
+bool EmulatedLink::send(int side, const ByteVector& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connected_[side]) {
+        return false;
+    }
+    sendLocked(side, ByteVector(data));
+    return true;
+}
+
+size_t EmulatedLink::sendBatch(int side, std::vector<ByteVector>& packets) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connected_[side]) {
+        return 0;
+    }
+    size_t taken = packets.size();
+    for (auto& packet : packets) {
+        sendLocked(side, std::move(packet));
+    }
+    packets.clear();
+    return taken;
+}
+
+void EmulatedLink::sendLocked(int side, ByteVector&& data) {
+    Direction& direction = directions_[side];
+    const Config& config = direction.config;
+    ++direction.stats.packetsSent;
+    direction.stats.bytesSent += data.size();
+    if (config.lossRate > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(direction.rng) < config.lossRate) {
+        ++direction.stats.randomLosses;
+        return;
+    }
+
+    TimePoint now = std::chrono::steady_clock::now();
+    auto serialization = serializationTime(data.size(), config.bitsPerSecond);
+    TimePoint departure = std::max(now, direction.linkFree) + serialization;
+    auto wait = std::chrono::duration<double>(departure - now - serialization).count();
+    uint64_t buffer = config.queueBytes > 0
+                          ? config.queueBytes
+                          : static_cast<uint64_t>(config.bitsPerSecond / 8.0 * roundTrip().count() / 1e6);
+    if (wait * config.bitsPerSecond / 8 > buffer) {
+        ++direction.stats.queueDrops;
+        return;
+    }
+    direction.linkFree = departure;
+
+    auto delay = config.delay;
+    if (config.jitter.count() > 0) {
+        delay += std::chrono::microseconds(
+            std::uniform_int_distribution<int64_t>(0, config.jitter.count())(direction.rng));
+    }
+    direction.lastArrival = std::max(departure + delay, direction.lastArrival);
+    bool wasIdle = direction.inFlight.empty();
+    direction.inFlight.push_back(Packet{direction.lastArrival, std::move(data)});
+    // Packets keep their order, so only a first packet can move the delivery
+    // thread's next wakeup earlier
+    if (wasIdle) {
+        pending_.notify_one();
+    }
+}
+
+bool EmulatedLink::receive(int side, ByteVector& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inbox_[side].empty()) {
+        data.clear();
+        return false;
+    }
+    data = std::move(inbox_[side].front());
+    inbox_[side].pop_front();
+    return true;
+}
+
+size_t EmulatedLink::receiveBatch(int side, std::vector<ByteVector>& packets, size_t maxPackets) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t received = 0;
+    while (received < maxPackets && !inbox_[side].empty()) {
+        packets.push_back(std::move(inbox_[side].front()));
+        inbox_[side].pop_front();
+        ++received;
+    }
+    return received;
+}
+
+bool EmulatedLink::waitForData(int side, std::chrono::microseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return arrived_[side].wait_for(lock, timeout, [&] { return !inbox_[side].empty() || !connected_[side]; }) &&
+           !inbox_[side].empty();
+}
+
+EmulatedLink::Config EmulatedLink::getConfig(int side) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directions_[side].config;
+}
+
+void EmulatedLink::setConfig(int side, const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Direction& direction = directions_[side];
+    if (config.seed != direction.config.seed) {
+        direction.rng.seed(config.seed);
+    }
+    // Packets already in flight keep their arrival times
+    direction.config = config;
+}
+
+EmulatedLink::Stats EmulatedLink::getStats(int side) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directions_[side].stats;
+}
+
+std::chrono::microseconds EmulatedLink::roundTrip() const {
+    return directions_[0].config.delay + directions_[1].config.delay;
+}
+
+void EmulatedLink::deliveryLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        TimePoint next = TimePoint::max();
+        for (const auto& direction : directions_) {
+            if (!direction.inFlight.empty()) {
+                next = std::min(next, direction.inFlight.front().arrival);
+            }
+        }
+        if (next == TimePoint::max()) {
+            pending_.wait(lock);
+            continue;
+        }
+        TimePoint now = std::chrono::steady_clock::now();
+        if (next > now) {
+            pending_.wait_until(lock, next);
+            continue;
+        }
+        for (int side = 0; side < 2; ++side) {
+            Direction& direction = directions_[side];
+            int peer = 1 - side;
+            bool delivered = false;
+            while (!direction.inFlight.empty() && direction.inFlight.front().arrival <= now) {
+                Packet& packet = direction.inFlight.front();
+                if (connected_[peer]) {
+                    ++direction.stats.packetsDelivered;
+                    direction.stats.bytesDelivered += packet.data.size();
+                    inbox_[peer].push_back(std::move(packet.data));
+                    delivered = true;
+                } else {
+                    ++direction.stats.undeliverable;
+                }
+                direction.inFlight.pop_front();
+            }
+            if (delivered) {
+                arrived_[peer].notify_all();
+            }
+        }
+    }
+}
+
+// EmulatedLinkProvider implementation
+EmulatedLinkProvider::EmulatedLinkProvider(std::shared_ptr<EmulatedLink> link, int side)
+    : m_link(std::move(link)), m_side(side) {}
+
+bool EmulatedLinkProvider::Initialize(const std::map<std::string, std::string>& options) {
+    EmulatedLink::Config config = m_link->getConfig(m_side);
+    for (const auto& option : options) {
+        if (!applyOption(config, option.first, option.second)) {
+            return false;
+        }
+    }
+    m_link->setConfig(m_side, config);
+    return true;
+}
+
+bool EmulatedLinkProvider::Connect(const std::string& satellite_id) {
+    if (m_verboseLogging) {
+        std::cout << "EmulatedLinkProvider::Connect - endpoint " << m_side << " to " << satellite_id << std::endl;
+    }
+    return m_link->connect(m_side);
+}
+
+bool EmulatedLinkProvider::Disconnect() {
+    m_link->disconnect(m_side);
+    return true;
+}
+
+bool EmulatedLinkProvider::SendData(const ByteVector& data) {
+    if (!m_link->send(m_side, data)) {
+        m_lastError = "Not connected";
+        return false;
+    }
+    return true;
+}
+
+bool EmulatedLinkProvider::ReceiveData(ByteVector& data) {
+    return m_link->receive(m_side, data);
+}
+
+size_t EmulatedLinkProvider::SendBatch(std::vector<ByteVector>& packets) {
+    size_t taken = m_link->sendBatch(m_side, packets);
+    if (!packets.empty()) {
+        m_lastError = "Not connected";
+    }
+    return taken;
+}
+
+size_t EmulatedLinkProvider::ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    return m_link->receiveBatch(m_side, packets, maxPackets);
+}
+
+bool EmulatedLinkProvider::ExecuteCommand(const std::string& command, std::string& response) {
+    std::istringstream in(command);
+    std::string verb;
+    in >> verb;
+    if (verb == "status") {
+        auto config = m_link->getConfig(m_side);
+        auto stats = m_link->getStats(m_side);
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+                      "delay=%.1f ms rate=%.3f Mbit/s loss=%.4f%% sent=%llu delivered=%llu lost=%llu dropped=%llu",
+                      config.delay.count() / 1000.0, config.bitsPerSecond / 1e6, config.lossRate * 100,
+                      static_cast<unsigned long long>(stats.packetsSent),
+                      static_cast<unsigned long long>(stats.packetsDelivered),
+                      static_cast<unsigned long long>(stats.randomLosses),
+                      static_cast<unsigned long long>(stats.queueDrops));
+        response = buffer;
+        return true;
+    }
+    std::string key;
+    std::string value;
+    if (verb == "set" && in >> key >> value) {
+        auto config = m_link->getConfig(m_side);
+        if (!applyOption(config, key, value)) {
+            response = m_lastError;
+            return false;
+        }
+        m_link->setConfig(m_side, config);
+        response = "OK";
+        return true;
+    }
+    response = "Unknown command";
+    return false;
+}
+
+double EmulatedLinkProvider::GetSignalStrength() const {
+    return 1.0 - m_link->getConfig(m_side).lossRate;
+}
+
+double EmulatedLinkProvider::GetLatency() const {
+    auto forward = m_link->getConfig(m_side).delay;
+    auto reverse = m_link->getConfig(1 - m_side).delay;
+    return (forward + reverse).count() / 1000.0;
+}
+
+uint64_t EmulatedLinkProvider::GetBandwidth() const {
+    return m_link->getConfig(m_side).bitsPerSecond;
+}
+
+std::unique_ptr<SatelliteStream> EmulatedLinkProvider::CreateStream() {
+    return std::make_unique<EmulatedLinkStream>(*this);
+}
+
+bool EmulatedLinkProvider::waitForData(std::chrono::microseconds timeout) {
+    return m_link->waitForData(m_side, timeout);
+}
+
+EmulatedLink::Stats EmulatedLinkProvider::getStats() const {
+    return m_link->getStats(m_side);
+}
+
+bool EmulatedLinkProvider::applyOption(EmulatedLink::Config& config, const std::string& key,
+                                       const std::string& value) {
+    try {
+        if (key == "delay_ms") {
+            config.delay = std::chrono::microseconds(static_cast<int64_t>(std::stod(value) * 1000));
+        } else if (key == "jitter_ms") {
+            config.jitter = std::chrono::microseconds(static_cast<int64_t>(std::stod(value) * 1000));
+        } else if (key == "rate_bps") {
+            config.bitsPerSecond = std::stoull(value);
+        } else if (key == "queue_bytes") {
+            config.queueBytes = std::stoull(value);
+        } else if (key == "loss") {
+            config.lossRate = std::stod(value);
+        } else if (key == "seed") {
+            config.seed = std::stoull(value);
+        } else {
+            m_lastError = "Unknown option: " + key;
+            return false;
+        }
+    } catch (const std::exception&) {
+        m_lastError = "Invalid value for " + key;
+        return false;
+    }
+    if (config.delay.count() < 0 || config.jitter.count() < 0 || config.bitsPerSecond == 0 || config.lossRate < 0 ||
+        config.lossRate > 1) {
+        m_lastError = "Value out of range for " + key;
+        return false;
+    }
+    return true;
+}
+
+// EmulatedLinkStream implementation
+EmulatedLinkProvider::EmulatedLinkStream::EmulatedLinkStream(EmulatedLinkProvider& provider) : m_provider(provider) {}
+
+bool EmulatedLinkProvider::EmulatedLinkStream::Write(const ByteVector& data) {
+    return m_provider.SendData(data);
+}
+
+bool EmulatedLinkProvider::EmulatedLinkStream::Read(ByteVector& data) {
+    return m_provider.ReceiveData(data);
+}
+
+size_t EmulatedLinkProvider::EmulatedLinkStream::WriteBatch(std::vector<ByteVector>& packets) {
+    return m_provider.SendBatch(packets);
+}
+
+size_t EmulatedLinkProvider::EmulatedLinkStream::ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    return m_provider.ReceiveBatch(packets, maxPackets);
+}
+
+void EmulatedLinkProvider::EmulatedLinkStream::Close() {}
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "../../include/srpt_satellite.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace SRPT {
+namespace Satellite {
+
+class EmulatedLinkProvider;
+
+// Two-ended emulated satellite link on real time. Unlike the Starlink and
+// Iridium providers, whose loopback hands data straight back to the
+// sender, what one endpoint sends arrives at the other, so two
+// SatelliteSessions in one process talk to each other across the link.
+// It is the harness for end-to-end throughput benchmarks without hardware.
+//
+// Each direction has a one-way delay with optional jitter, a rate limit
+// with a drop-tail queue in front of it, and random loss. Packets never
+// overtake each other. A background thread hands packets to the receiving
+// endpoint when they are due, so ReceiveData() stays non-blocking and
+// waitForData() can sleep until something arrives.
+//
+// The link lives as long as either endpoint. Thread-safe.
+class EmulatedLink {
+public:
+    struct Config {
+        std::chrono::microseconds delay{20000};  // One way
+        std::chrono::microseconds jitter{0};     // Uniform extra delay per packet
+        uint64_t bitsPerSecond = 100000000;
+        uint64_t queueBytes = 0;  // Drop-tail bottleneck queue; 0 = one BDP over the round trip
+        double lossRate = 0;
+        uint64_t seed = 1;
+    };
+
+    // Per direction
+    struct Stats {
+        uint64_t packetsSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t packetsDelivered = 0;
+        uint64_t bytesDelivered = 0;
+        uint64_t randomLosses = 0;
+        uint64_t queueDrops = 0;
+        uint64_t undeliverable = 0;  // Arrived while the receiver was disconnected
+    };
+
+    using Endpoints = std::pair<std::unique_ptr<EmulatedLinkProvider>, std::unique_ptr<EmulatedLinkProvider>>;
+
+    // first sends to second over aToB, second to first over bToA
+    static Endpoints createPair(const Config& config);
+    static Endpoints createPair(const Config& aToB, const Config& bToA);
+
+    ~EmulatedLink();
+
+    EmulatedLink(const EmulatedLink&) = delete;
+    EmulatedLink& operator=(const EmulatedLink&) = delete;
+
+private:
+    friend class EmulatedLinkProvider;
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Packet {
+        TimePoint arrival;
+        ByteVector data;
+    };
+
+    struct Direction {
+        Config config;
+        std::mt19937_64 rng;
+        TimePoint linkFree;
+        TimePoint lastArrival;
+        std::deque<Packet> inFlight;
+        Stats stats;
+    };
+
+    EmulatedLink(const Config& aToB, const Config& bToA);
+
+    // Endpoint 0 sends over directions_[0] and receives from directions_[1]
+    bool connect(int side);
+    void disconnect(int side);
+    bool isConnected(int side) const;
+    bool send(int side, const ByteVector& data);
+    size_t sendBatch(int side, std::vector<ByteVector>& packets);
+    void sendLocked(int side, ByteVector&& data);
+    bool receive(int side, ByteVector& data);
+    size_t receiveBatch(int side, std::vector<ByteVector>& packets, size_t maxPackets);
+    bool waitForData(int side, std::chrono::microseconds timeout);
+    Config getConfig(int side) const;
+    void setConfig(int side, const Config& config);
+    Stats getStats(int side) const;
+    std::chrono::microseconds roundTrip() const;
+
+    void deliveryLoop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable pending_;      // Delivery thread: new packet in flight, or stopping
+    std::condition_variable arrived_[2];   // Receivers, per endpoint
+    Direction directions_[2];
+    std::deque<ByteVector> inbox_[2];
+    bool connected_[2] = {false, false};
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+// One end of an EmulatedLink.
+//
+// Initialize() options, applied to the direction this endpoint sends on:
+//   delay_ms, jitter_ms, rate_bps, queue_bytes, loss (0-1), seed
+// Commands: "status", and "set <option> <value>" with the same options to
+// change the link mid-run.
+class EmulatedLinkProvider : public ISatelliteProvider {
+public:
+    bool Initialize(const std::map<std::string, std::string>& options) override;
+    bool Connect(const std::string& satellite_id) override;
+    bool Disconnect() override;
+    // Fails only when disconnected; lost and dropped packets vanish silently
+    bool SendData(const ByteVector& data) override;
+    bool ReceiveData(ByteVector& data) override;
+    bool ExecuteCommand(const std::string& command, std::string& response) override;
+    double GetSignalStrength() const override;
+    // Round trip in ms, without queueing
+    double GetLatency() const override;
+    // Sending direction's rate in bits/s
+    uint64_t GetBandwidth() const override;
+    std::unique_ptr<SatelliteStream> CreateStream() override;
+    // Moves the whole batch onto the link under one lock
+    size_t SendBatch(std::vector<ByteVector>& packets) override;
+    size_t ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets) override;
+    void setVerboseLogging(bool verbose) override { m_verboseLogging = verbose; }
+
+    // Until data is waiting or the timeout passes; true if data is waiting
+    bool waitForData(std::chrono::microseconds timeout);
+    // Sending direction
+    EmulatedLink::Stats getStats() const;
+    std::string getLastError() const { return m_lastError; }
+
+private:
+    friend class EmulatedLink;
+
+    EmulatedLinkProvider(std::shared_ptr<EmulatedLink> link, int side);
+
+    bool applyOption(EmulatedLink::Config& config, const std::string& key, const std::string& value);
+
+    std::shared_ptr<EmulatedLink> m_link;
+    int m_side;
+    bool m_verboseLogging = false;
+    std::string m_lastError;
+
+    class EmulatedLinkStream : public SatelliteStream {
+    public:
+        explicit EmulatedLinkStream(EmulatedLinkProvider& provider);
+        bool Write(const ByteVector& data) override;
+        bool Read(ByteVector& data) override;
+        size_t WriteBatch(std::vector<ByteVector>& packets) override;
+        size_t ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets) override;
+        void Close() override;
+
+    private:
+        EmulatedLinkProvider& m_provider;
+    };
+};
+
+} // namespace Satellite
+} // namespace SRPT
@@ -1,18 +1,70 @@
 #include "iridium_provider.h"
+#include <algorithm>
 #include <iostream>
-#include <deque>
 
 namespace SRPT::Satellite {
 
 // Add this member variable to the IridiumProvider class
 
+IridiumProvider::IridiumProvider() : IridiumProvider(Common::SteadyClock::instance()) {}
+
+IridiumProvider::IridiumProvider(const Common::Clock& clock)
+    : m_clock(clock),
+      m_framer(std::min(DEFAULT_MO_BYTES, DEFAULT_MT_BYTES)),
+      m_dataQueue(std::make_unique<Common::SpscRing<ByteVector>>(DEFAULT_QUEUE_PACKETS)),
+      m_telemetry(clock) {}
+
 bool IridiumProvider::Initialize(const std::map<std::string, std::string>& options) {
     // Implement Iridium-specific initialization
+    // Leaves `value` at its default when the option is absent
+    auto number = [&](const std::string& key, size_t& value) {
+        auto it = options.find(key);
+        if (it == options.end()) {
+            return true;
+        }
+        try {
+            value = std::stoull(it->second);
+            return true;
+        } catch (const std::exception&) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_lastError = "Invalid value for " + key;
+            return false;
+        }
+    };
+    size_t capacity = DEFAULT_QUEUE_PACKETS;
+    size_t moBytes = DEFAULT_MO_BYTES;
+    size_t mtBytes = DEFAULT_MT_BYTES;
+    size_t pollMs = 0;
+    size_t holdMs = DEFAULT_MAX_HOLD_MS;
+    if (!number("queue_packets", capacity) || !number("mo_bytes", moBytes) || !number("mt_bytes", mtBytes) ||
+        !number("mailbox_poll_ms", pollMs) || !number("max_hold_ms", holdMs)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // stoull() takes "-1" as the largest value
+    if (capacity == 0 || capacity > MAX_QUEUE_PACKETS) {
+        m_lastError = "Value out of range for queue_packets";
+        return false;
+    }
+    if (std::min(moBytes, mtBytes) < SbdFramer::MIN_MESSAGE_BYTES) {
+        m_lastError = "Message limit below " + std::to_string(SbdFramer::MIN_MESSAGE_BYTES) + " bytes";
+        return false;
+    }
+    if (options.count("queue_packets")) {
+        m_dataQueue = std::make_unique<Common::SpscRing<ByteVector>>(capacity);
+    }
+    m_framer = SbdFramer(std::min(moBytes, mtBytes));
+    m_mailboxPoll = std::chrono::milliseconds(pollMs);
+    m_maxHold = std::chrono::milliseconds(holdMs);
     return true;
 }
 
 bool IridiumProvider::Connect(const std::string& satellite_id) {
+    if (m_verboseLogging) {
+        std::cout << "IridiumProvider::Connect - satellite " << satellite_id << std::endl;
+    }
     // Implement Iridium connection logic
+    m_telemetry.reset();
     return true;
 }
 
@@ -22,32 +74,145 @@ bool IridiumProvider::Disconnect() {
 }
 
 bool IridiumProvider::SendData(const ByteVector& data) {
-    m_dataQueue.push_back(data);
-    if(m_verboseLogging) {
-        std::cout << "IridiumProvider::SendData - Data sent: ";
-        for (const auto& byte : data) {
-            std::cout << static_cast<int>(byte) << " ";
-        }
-       std::cout << std::endl;
-    }
-    return true;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return acceptLocked(ByteVector(data));
 }
 
 bool IridiumProvider::ReceiveData(ByteVector& data) {
-    if (m_dataQueue.empty()) {
+    if (m_received.empty()) {
+        checkMailbox();
+    }
+    if (m_received.empty()) {
         data.clear();
         return false;
     }
-    data = m_dataQueue.front();
-    m_dataQueue.pop_front();
-    std::cout << "IridiumProvider::ReceiveData - Data received: ";
-    for (const auto& byte : data) {
-        std::cout << static_cast<int>(byte) << " ";
+    data = std::move(m_received.front());
+    m_received.pop_front();
+    m_telemetry.onDelivered(data.size());
+    return true;
+}
+
+size_t IridiumProvider::SendBatch(std::vector<ByteVector>& packets) {
+    size_t taken = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (taken < packets.size() && acceptLocked(std::move(packets[taken]))) {
+            ++taken;
+        }
     }
-    std::cout << std::endl;
+    packets.erase(packets.begin(), packets.begin() + taken);
+    return taken;
+}
+
+size_t IridiumProvider::ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    if (m_received.empty()) {
+        checkMailbox();
+    }
+    size_t received = 0;
+    size_t bytes = 0;
+    while (received < maxPackets && !m_received.empty()) {
+        bytes += m_received.front().size();
+        packets.push_back(std::move(m_received.front()));
+        m_received.pop_front();
+        ++received;
+    }
+    if (received > 0) {
+        m_telemetry.onDelivered(bytes, static_cast<uint32_t>(received));
+    }
+    return received;
+}
+
+bool IridiumProvider::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    transmitLocked(true);
+    return m_framer.empty();
+}
+
+IridiumProvider::SbdStats IridiumProvider::getSbdStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::string IridiumProvider::getLastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastError;
+}
+
+bool IridiumProvider::acceptLocked(ByteVector&& packet) {
+    // While a whole message is waiting on a full mailbox, take no more
+    transmitLocked(false);
+    if (m_framer.hasFullMessage()) {
+        return false;
+    }
+    auto now = m_clock.now();
+    if (m_framer.empty()) {
+        m_heldSince = now;
+    }
+    size_t size = packet.size();
+    if (!m_framer.add(std::move(packet))) {
+        return false;
+    }
+    m_telemetry.onSent(size);
+    // A partial message that has waited long enough goes with this packet
+    bool expired = m_maxHold.count() > 0 && now - m_heldSince >= m_maxHold;
+    transmitLocked(expired);
     return true;
 }
 
+void IridiumProvider::transmitLocked(bool flush) {
+    // One session per message, which also checks the mailbox. The ring
+    // only grows under m_mutex, so a free slot seen here is still free at
+    // the push.
+    while ((m_framer.hasFullMessage() || (flush && !m_framer.empty())) &&
+           m_dataQueue->size() < m_dataQueue->capacity()) {
+        ByteVector message;
+        uint64_t overhead = m_framer.getStats().overheadBytes;
+        m_framer.nextMessage(message);
+        ++m_stats.sessions;
+        ++m_stats.moMessages;
+        m_stats.moBytes += message.size();
+        m_stats.framingBytes += m_framer.getStats().overheadBytes - overhead;
+        m_dataQueue->tryPush(std::move(message));
+        m_lastMailboxCheck = m_clock.now();
+        // What is left over came in with the latest packet
+        m_heldSince = m_lastMailboxCheck;
+    }
+}
+
+void IridiumProvider::checkMailbox() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto now = m_clock.now();
+        if (!m_framer.empty()) {
+            transmitLocked(true);
+        } else if (m_dataQueue->empty() && now - m_lastMailboxCheck >= m_mailboxPoll) {
+            ++m_stats.sessions;
+            ++m_stats.mailboxChecks;
+            m_lastMailboxCheck = now;
+        }
+    }
+
+    // Every session, sending or not, brought down what was waiting then;
+    // take it all in one pass
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    ByteVector message;
+    std::vector<ByteVector> packets;
+    while (m_dataQueue->tryPop(message)) {
+        ++messages;
+        bytes += message.size();
+        m_reassembler.addMessage(message, packets);
+    }
+    for (auto& packet : packets) {
+        m_received.push_back(std::move(packet));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.mtMessages += messages;
+    m_stats.mtBytes += bytes;
+    m_stats.droppedPackets = m_reassembler.getStats().droppedPackets;
+}
+
 bool IridiumProvider::ExecuteCommand(const std::string& command, std::string& response) {
     // Implement Iridium-specific command execution logic
     response = "Iridium command executed: " + command;
@@ -55,18 +220,18 @@ bool IridiumProvider::ExecuteCommand(const std::string& command, std::string& re
 }
 
 double IridiumProvider::GetSignalStrength() const {
-    // Implement signal strength measurement
-    return 0.0;
+    double reported = m_telemetry.snapshot().signalStrength;
+    return reported >= 0 ? reported : NOMINAL_SIGNAL_STRENGTH;
 }
 
 double IridiumProvider::GetLatency() const {
-    // Implement latency measurement
-    return 0.0;
+    auto live = m_telemetry.snapshot();
+    return live.rttSamples > 0 ? live.srtt.count() / 1000.0 : NOMINAL_LATENCY_MS;
 }
 
 uint64_t IridiumProvider::GetBandwidth() const {
-    // Implement bandwidth measurement
-    return 0;
+    uint64_t delivered = m_telemetry.snapshot().throughput;
+    return delivered > 0 ? delivered : NOMINAL_BANDWIDTH;
 }
 
 std::unique_ptr<SatelliteStream> IridiumProvider::CreateStream() {
@@ -82,6 +247,14 @@ bool IridiumProvider::IridiumStream::Read(ByteVector& data) {
     return m_provider.ReceiveData(data);
 }
 
+size_t IridiumProvider::IridiumStream::WriteBatch(std::vector<ByteVector>& packets) {
+    return m_provider.SendBatch(packets);
+}
+
+size_t IridiumProvider::IridiumStream::ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    return m_provider.ReceiveBatch(packets, maxPackets);
+}
+
 void IridiumProvider::IridiumStream::Close() {
     // Implement stream close logic
 }
@@ -1,12 +1,70 @@
 #pragma once
 #include "../../include/srpt_satellite.h"
+#include "../common/spsc_ring.h"
+#include "link_telemetry.h"
+#include "sbd_framing.h"
+#include <chrono>
 #include <deque>
+#include <memory>
+#include <mutex>
 
 namespace SRPT {
 namespace Satellite {
 
+// Loopback over Iridium Short Burst Data: packets are framed into SBD
+// messages (SbdFramer), each message goes up in one billed session, and
+// what comes back down from the mailbox is reassembled into the packets
+// that were sent. A message goes out as soon as queued packets fill one;
+// a partly filled message waits for the next mailbox check, so small
+// packets share messages instead of each paying for its own. It waits at
+// most max_hold_ms: the first send after that sends it, whether or not the
+// new packet fills it.
+//
+// Every session also checks the mailbox and takes down all messages
+// waiting, which ReceiveData() and ReceiveBatch() hand out as packets. When
+// they run out, a partial message waiting to go is sent, and its session
+// checks the mailbox; with nothing to send, a mailbox-only session is paid
+// for at most once per mailbox_poll_ms.
+// Messages are framed to the smaller of the MO and MT limits, since in the
+// loopback each travels both ways.
+//
+// One thread may send while another receives. SendData() and SendBatch()
+// refuse packets while the mailbox is full.
+//
+// Initialize() options:
+//   queue_packets     mailbox capacity in messages (default 4096, at most
+//                     MAX_QUEUE_PACKETS), rounded up to a power of two
+//   mo_bytes          mobile originated message limit (default 340)
+//   mt_bytes          mobile terminated message limit (default 270)
+//   mailbox_poll_ms   minimum time between mailbox-only sessions (default 0)
+//   max_hold_ms       longest a partly filled message waits for more
+//                     packets (default 5000; 0 waits for a mailbox check)
+// Initialize() returns false, with getLastError() set, on a bad option.
+//
+// GetLatency(), GetBandwidth() and GetSignalStrength() report the link's
+// telemetry: smoothed RTT once RTT samples have been reported, delivered
+// throughput once traffic has been measured, and the last reported signal
+// strength. Until then they return the nominal figures. Connect() starts
+// the measurements afresh. The provider has no radio to measure signal
+// strength on: whatever drives the modem reports it through
+// GetTelemetry()->onSignalStrength(), and without that it stays nominal.
 class IridiumProvider : public ISatelliteProvider {
 public:
+    IridiumProvider();
+    // Telemetry measured on `clock`
+    explicit IridiumProvider(const Common::Clock& clock);
+
+    struct SbdStats {
+        uint64_t sessions = 0;       // Each one billed
+        uint64_t mailboxChecks = 0;  // Sessions with nothing to send
+        uint64_t moMessages = 0;
+        uint64_t moBytes = 0;
+        uint64_t mtMessages = 0;
+        uint64_t mtBytes = 0;
+        uint64_t framingBytes = 0;    // Of moBytes, spent on SBD framing
+        uint64_t droppedPackets = 0;  // Incomplete after a lost message
+    };
+
     bool Initialize(const std::map<std::string, std::string>& options) override;
     bool Connect(const std::string& satellite_id) override;
     bool Disconnect() override;
@@ -17,15 +75,58 @@ public:
     double GetLatency() const override;
     uint64_t GetBandwidth() const override;
     std::unique_ptr<SatelliteStream> CreateStream() override;
+    size_t SendBatch(std::vector<ByteVector>& packets) override;
+    size_t ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets) override;
+    LinkTelemetry* GetTelemetry() override { return &m_telemetry; }
     void setVerboseLogging(bool verbose) override {m_verboseLogging = verbose;};
+
+    // Sends the partly filled message, if any, without waiting for a
+    // mailbox check; returns false if the mailbox is full
+    bool flush();
+    SbdStats getSbdStats() const;
+    std::string getLastError() const;
+
+    static constexpr size_t MAX_QUEUE_PACKETS = 1 << 20;
+
 private:
-    std::deque<ByteVector> m_dataQueue;
+    static constexpr size_t DEFAULT_QUEUE_PACKETS = 4096;
+    static constexpr size_t DEFAULT_MO_BYTES = 340;
+    static constexpr size_t DEFAULT_MT_BYTES = 270;
+    static constexpr size_t DEFAULT_MAX_HOLD_MS = 5000;
+    static constexpr double NOMINAL_LATENCY_MS = 0.0;
+    static constexpr uint64_t NOMINAL_BANDWIDTH = 0;
+    static constexpr double NOMINAL_SIGNAL_STRENGTH = 0.0;
+
+    const Common::Clock& m_clock;
+    std::chrono::milliseconds m_mailboxPoll{0};
+    std::chrono::milliseconds m_maxHold{DEFAULT_MAX_HOLD_MS};
+
+    // Sending side, and the producer end of the mailbox
+    mutable std::mutex m_mutex;
+    SbdFramer m_framer;
+    SbdStats m_stats;
+    Common::Clock::TimePoint m_lastMailboxCheck{};
+    Common::Clock::TimePoint m_heldSince{};  // When the partial message was started
+    std::unique_ptr<Common::SpscRing<ByteVector>> m_dataQueue;
+
+    // Receiving side; only the receiving thread touches these
+    SbdReassembler m_reassembler;
+    std::deque<ByteVector> m_received;
+
+    LinkTelemetry m_telemetry;
     bool m_verboseLogging = false;
+    std::string m_lastError;  // Guarded by m_mutex
+
+    bool acceptLocked(ByteVector&& packet);
+    void transmitLocked(bool flush);
+    void checkMailbox();
     class IridiumStream : public SatelliteStream {
     public:
         explicit IridiumStream(IridiumProvider& provider);
         bool Write(const ByteVector& data) override;
         bool Read(ByteVector& data) override;
+        size_t WriteBatch(std::vector<ByteVector>& packets) override;
+        size_t ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets) override;
         void Close() override;
   
     private:
@@ -0,0 +1,190 @@
+#include "link_telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SRPT {
+namespace Satellite {
+
+namespace {
+constexpr std::chrono::milliseconds FOLD_INTERVAL{100};
+constexpr double SRTT_GAIN = 1.0 / 8;         // RFC 6298 alpha
+constexpr double RTT_VARIANCE_GAIN = 1.0 / 4;  // RFC 6298 beta
+constexpr double THROUGHPUT_GAIN = 1.0 / 4;
+constexpr double LOSS_GAIN = 1.0 / 8;
+
+uint64_t toWord(double value) {
+    uint64_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    return word;
+}
+
+double fromWord(uint64_t word) {
+    double value;
+    std::memcpy(&value, &word, sizeof(value));
+    return value;
+}
+} // namespace
+
+LinkTelemetry::LinkTelemetry() : LinkTelemetry(Common::SteadyClock::instance()) {}
+
+LinkTelemetry::LinkTelemetry(const Common::Clock& clock) : clock_(clock) {
+    reset();
+}
+
+void LinkTelemetry::onSent(size_t bytes, uint32_t packets) {
+    packetsSent_.fetch_add(packets, std::memory_order_relaxed);
+    bytesSent_.fetch_add(bytes, std::memory_order_relaxed);
+    maybeFold();
+}
+
+void LinkTelemetry::onDelivered(size_t bytes, uint32_t packets) {
+    packetsDelivered_.fetch_add(packets, std::memory_order_relaxed);
+    bytesDelivered_.fetch_add(bytes, std::memory_order_relaxed);
+    maybeFold();
+}
+
+void LinkTelemetry::onRttSample(std::chrono::microseconds rtt) {
+    if (rtt.count() <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    double sample = static_cast<double>(rtt.count());
+    if (state_.rttSamples == 0) {
+        state_.srtt = sample;
+        state_.rttVariance = sample / 2;
+        state_.minRtt = rtt.count();
+    } else {
+        state_.rttVariance += RTT_VARIANCE_GAIN * (std::abs(state_.srtt - sample) - state_.rttVariance);
+        state_.srtt += SRTT_GAIN * (sample - state_.srtt);
+        state_.minRtt = std::min(state_.minRtt, rtt.count());
+    }
+    ++state_.rttSamples;
+    auto now = clock_.now();
+    state_.updated = now;
+    foldLocked(now);
+    publishLocked();
+}
+
+void LinkTelemetry::onLost(uint32_t packets) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_.packetsLost += packets;
+    foldLocked(clock_.now());
+    publishLocked();
+}
+
+void LinkTelemetry::onSignalStrength(double strength) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_.signalStrength = std::clamp(strength, 0.0, 1.0);
+    foldLocked(clock_.now());
+    publishLocked();
+}
+
+LinkTelemetry::Snapshot LinkTelemetry::snapshot() const {
+    uint64_t words[WORD_COUNT];
+    uint32_t before;
+    while (true) {
+        before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        for (int i = 0; i < WORD_COUNT; ++i) {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+
+    Snapshot snapshot;
+    snapshot.srtt = std::chrono::microseconds(static_cast<int64_t>(fromWord(words[SRTT])));
+    snapshot.rttVariance = std::chrono::microseconds(static_cast<int64_t>(fromWord(words[RTT_VARIANCE])));
+    snapshot.minRtt = std::chrono::microseconds(static_cast<int64_t>(words[MIN_RTT]));
+    snapshot.throughput = static_cast<uint64_t>(fromWord(words[THROUGHPUT]));
+    snapshot.lossRate = fromWord(words[LOSS_RATE]);
+    snapshot.signalStrength = fromWord(words[SIGNAL_STRENGTH]);
+    snapshot.rttSamples = words[RTT_SAMPLES];
+    snapshot.packetsLost = words[PACKETS_LOST];
+    snapshot.updated = TimePoint(TimePoint::duration(static_cast<TimePoint::rep>(words[UPDATED])));
+    snapshot.packetsSent = packetsSent_.load(std::memory_order_relaxed);
+    snapshot.bytesSent = bytesSent_.load(std::memory_order_relaxed);
+    snapshot.packetsDelivered = packetsDelivered_.load(std::memory_order_relaxed);
+    snapshot.bytesDelivered = bytesDelivered_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void LinkTelemetry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    packetsSent_.store(0, std::memory_order_relaxed);
+    bytesSent_.store(0, std::memory_order_relaxed);
+    packetsDelivered_.store(0, std::memory_order_relaxed);
+    bytesDelivered_.store(0, std::memory_order_relaxed);
+    state_ = State();
+    state_.intervalStart = clock_.now();
+    state_.updated = state_.intervalStart;
+    nextFold_.store((state_.intervalStart + FOLD_INTERVAL).time_since_epoch().count(), std::memory_order_relaxed);
+    publishLocked();
+}
+
+void LinkTelemetry::maybeFold() {
+    auto now = clock_.now();
+    if (now.time_since_epoch().count() < nextFold_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // Whoever gets the lock folds; everyone else carries on
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    foldLocked(now);
+    publishLocked();
+}
+
+void LinkTelemetry::foldLocked(TimePoint now) {
+    auto elapsed = now - state_.intervalStart;
+    if (elapsed < FOLD_INTERVAL) {
+        return;
+    }
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    uint64_t bytesDelivered = bytesDelivered_.load(std::memory_order_relaxed);
+    uint64_t packetsSent = packetsSent_.load(std::memory_order_relaxed);
+
+    double rate = (bytesDelivered - state_.intervalBytes) * 8 / seconds;
+    state_.throughput = state_.haveThroughput ? state_.throughput + THROUGHPUT_GAIN * (rate - state_.throughput) : rate;
+    state_.haveThroughput = true;
+
+    // Losses are reported against what this end sent
+    uint64_t sent = packetsSent - state_.intervalPackets;
+    uint64_t lost = state_.packetsLost - state_.intervalLost;
+    if (sent > 0 || lost > 0) {
+        double sample = std::min(1.0, static_cast<double>(lost) / std::max(sent, lost));
+        state_.lossRate += LOSS_GAIN * (sample - state_.lossRate);
+    }
+
+    state_.intervalStart = now;
+    state_.intervalBytes = bytesDelivered;
+    state_.intervalPackets = packetsSent;
+    state_.intervalLost = state_.packetsLost;
+    state_.updated = now;
+    nextFold_.store((now + FOLD_INTERVAL).time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void LinkTelemetry::publishLocked() {
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    words_[SRTT].store(toWord(state_.srtt), std::memory_order_relaxed);
+    words_[RTT_VARIANCE].store(toWord(state_.rttVariance), std::memory_order_relaxed);
+    words_[MIN_RTT].store(static_cast<uint64_t>(state_.minRtt), std::memory_order_relaxed);
+    words_[THROUGHPUT].store(toWord(state_.throughput), std::memory_order_relaxed);
+    words_[LOSS_RATE].store(toWord(state_.lossRate), std::memory_order_relaxed);
+    words_[SIGNAL_STRENGTH].store(toWord(state_.signalStrength), std::memory_order_relaxed);
+    words_[RTT_SAMPLES].store(state_.rttSamples, std::memory_order_relaxed);
+    words_[PACKETS_LOST].store(state_.packetsLost, std::memory_order_relaxed);
+    words_[UPDATED].store(static_cast<uint64_t>(state_.updated.time_since_epoch().count()), std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+} // namespace Satellite
+} // namespace SRPT
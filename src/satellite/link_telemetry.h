@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../common/clock.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace SRPT {
+namespace Satellite {
+
+// Live measurements of one satellite link, taken from its traffic: smoothed
+// RTT from ack samples (RFC 6298 gains), delivered throughput and loss rate
+// as EWMAs over 100 ms intervals.
+//
+// Recording is split by cost. Per-packet onSent()/onDelivered() only bump
+// atomic counters, and once an interval has passed fold them into the
+// averages if no other thread is already doing so; they never block. RTT,
+// loss and signal samples take a short lock. Readers get a consistent
+// snapshot() without any lock or syscall (a sequence lock over atomic
+// words), so congestion control, chunk sizing and path selection can poll
+// it per packet. The averages in a snapshot always come from one update;
+// its traffic counters are read live and may run slightly ahead of them.
+class LinkTelemetry {
+public:
+    using TimePoint = Common::Clock::TimePoint;
+
+    struct Snapshot {
+        std::chrono::microseconds srtt{0};  // 0 until the first RTT sample
+        std::chrono::microseconds rttVariance{0};
+        std::chrono::microseconds minRtt{0};
+        uint64_t throughput = 0;  // Delivered bits/s; 0 until the first full interval
+        double lossRate = 0;      // Fraction of packets lost
+        double signalStrength = -1;  // Last reported, 0-1; negative if never reported
+        uint64_t rttSamples = 0;
+        uint64_t packetsSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t packetsDelivered = 0;
+        uint64_t bytesDelivered = 0;
+        uint64_t packetsLost = 0;
+        TimePoint updated;  // Last time the averages moved
+    };
+
+    LinkTelemetry();
+    explicit LinkTelemetry(const Common::Clock& clock);
+
+    LinkTelemetry(const LinkTelemetry&) = delete;
+    LinkTelemetry& operator=(const LinkTelemetry&) = delete;
+
+    // Any thread, per packet or per batch
+    void onSent(size_t bytes, uint32_t packets = 1);
+    void onDelivered(size_t bytes, uint32_t packets = 1);
+
+    // Any thread
+    void onRttSample(std::chrono::microseconds rtt);
+    void onLost(uint32_t packets = 1);
+    void onSignalStrength(double strength);
+
+    // Lock-free; any thread
+    Snapshot snapshot() const;
+
+    void reset();
+
+private:
+    enum Word {
+        SRTT,
+        RTT_VARIANCE,
+        MIN_RTT,
+        THROUGHPUT,
+        LOSS_RATE,
+        SIGNAL_STRENGTH,
+        RTT_SAMPLES,
+        PACKETS_LOST,
+        UPDATED,
+        WORD_COUNT,
+    };
+
+    // Averages, owned by whoever holds mutex_
+    struct State {
+        double srtt = 0;  // Microseconds
+        double rttVariance = 0;
+        int64_t minRtt = 0;
+        double throughput = 0;
+        double lossRate = 0;
+        double signalStrength = -1;
+        uint64_t rttSamples = 0;
+        uint64_t packetsLost = 0;
+        TimePoint intervalStart;
+        uint64_t intervalBytes = 0;    // bytesDelivered_ at intervalStart
+        uint64_t intervalPackets = 0;  // packetsSent_ at intervalStart
+        uint64_t intervalLost = 0;     // packetsLost at intervalStart
+        bool haveThroughput = false;
+        TimePoint updated;
+    };
+
+    const Common::Clock& clock_;
+
+    // Sender and receiver are usually different threads; keep their
+    // counters and the shared fold deadline on separate cache lines
+    alignas(64) std::atomic<uint64_t> packetsSent_{0};
+    std::atomic<uint64_t> bytesSent_{0};
+    alignas(64) std::atomic<uint64_t> packetsDelivered_{0};
+    std::atomic<uint64_t> bytesDelivered_{0};
+    alignas(64) std::atomic<int64_t> nextFold_;  // Clock ticks; per-packet calls fold once this has passed
+
+    alignas(64) std::mutex mutex_;
+    State state_;
+
+    std::atomic<uint32_t> sequence_{0};  // Odd while a publish is in progress
+    std::atomic<uint64_t> words_[WORD_COUNT];
+
+    void maybeFold();
+    void foldLocked(TimePoint now);
+    void publishLocked();
+};
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,292 @@
+#include "packet_pacer.h"
+#include "link_telemetry.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace SRPT {
+namespace Satellite {
+
+namespace {
+constexpr double MIN_BUCKET_BYTES = 1500.0;  // Always room for one full-size packet
+}
+
+PacketPacer::PacketPacer(ISatelliteProvider& provider, CongestionControl::ICongestionControl& congestionControl)
+    : PacketPacer(provider, congestionControl, Options()) {}
+
+PacketPacer::PacketPacer(ISatelliteProvider& provider, CongestionControl::ICongestionControl& congestionControl,
+                         const Options& options)
+    : provider_(provider),
+      congestionControl_(congestionControl),
+      options_(options),
+      tokens_(0),
+      lastRefill_(Clock::now()),
+      countsPackets_(congestionControl.countsPackets()),
+      classifier_(options.classifier) {
+    options_.tick = std::max(options_.tick, std::chrono::microseconds(1));
+    options_.minRate = std::max<uint32_t>(options_.minRate, 1);
+    options_.mss = std::max<uint32_t>(options_.mss, 1);
+}
+
+PacketPacer::~PacketPacer() {
+    stop();
+}
+
+bool PacketPacer::enqueue(const ByteVector& packet) {
+    return enqueue(ByteVector(packet));
+}
+
+bool PacketPacer::enqueue(ByteVector&& packet) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= options_.queueLimit) {
+            ++stats_.queueDrops;
+            return false;
+        }
+        queue_.push_back(std::move(packet));
+    }
+    wakeup_.notify_one();
+    return true;
+}
+
+size_t PacketPacer::releaseDue(Clock::time_point now) {
+    std::vector<ByteVector> burst;
+    std::vector<uint32_t> sizes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (now < retryAt_) {
+            return 0;
+        }
+        refill(now);
+        while (!queue_.empty() && tokens_ > 0) {
+            uint32_t size = static_cast<uint32_t>(queue_.front().size());
+            tokens_ -= size;
+            sizes.push_back(size);
+            burst.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+    }
+    if (burst.empty()) {
+        return 0;
+    }
+
+    // The provider is called without the lock so enqueue() never waits on
+    // I/O. The burst goes over in one call and the buffers are moved, not
+    // copied; whatever the provider pushes back is left in `burst`.
+    size_t sent = provider_.SendBatch(burst);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < sent; ++i) {
+        bytes += sizes[i];
+        congestionControl_.onPacketSent(countsPackets_ ? 1 : sizes[i]);
+    }
+    if (!burst.empty()) {
+        // Back to the head of the queue in order, tokens refunded; the
+        // provider gets a tick to make room
+        for (auto it = burst.rbegin(); it != burst.rend(); ++it) {
+            tokens_ += static_cast<double>(it->size());
+            queue_.push_front(std::move(*it));
+        }
+        retryAt_ = now + options_.tick;
+        stats_.sendFailures += burst.size();
+    }
+    ++stats_.bursts;
+    stats_.packetsReleased += sent;
+    stats_.bytesReleased += bytes;
+    return sent;
+}
+
+PacketPacer::Clock::time_point PacketPacer::nextReleaseTime() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextReleaseLocked();
+}
+
+bool PacketPacer::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return false;
+    }
+    running_ = true;
+    stopping_ = false;
+    thread_ = std::thread(&PacketPacer::run, this);
+    return true;
+}
+
+void PacketPacer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+}
+
+void PacketPacer::onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) {
+    if (LinkTelemetry* telemetry = provider_.GetTelemetry()) {
+        telemetry->onRttSample(rtt);
+    }
+    auto now = Clock::now();
+    double signal = pollSignal(now);
+    std::lock_guard<std::mutex> lock(mutex_);
+    observeRtt(rtt, now, signal);
+    if (countsPackets_) {
+        // Whole packets only; the rest waits for the next ack
+        ackCredit_ += ackedBytes;
+        uint32_t packets = ackCredit_ / options_.mss;
+        ackCredit_ %= options_.mss;
+        if (packets == 0) {
+            return;
+        }
+        ackedBytes = packets;
+    }
+    congestionControl_.onAckReceived(ackedBytes, rtt);
+}
+
+void PacketPacer::onPacketLoss() {
+    if (LinkTelemetry* telemetry = provider_.GetTelemetry()) {
+        telemetry->onLost();
+    }
+    auto now = Clock::now();
+    double signal = pollSignal(now);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (options_.classifyLosses) {
+        observeRtt(std::chrono::microseconds(0), now, signal);
+        if (classifier_.classify(1, now) == CongestionControl::LossCause::WIRELESS) {
+            ++stats_.wirelessLosses;
+            return;
+        }
+    }
+    congestionControl_.onPacketLoss();
+}
+
+void PacketPacer::onAck(const CongestionControl::AckEvent& ack) {
+    if (LinkTelemetry* telemetry = provider_.GetTelemetry()) {
+        telemetry->onRttSample(ack.rtt);
+        if (ack.lostBytes > 0) {
+            telemetry->onLost(std::max(ack.lostPackets, 1U));
+        }
+    }
+    double signal = pollSignal(ack.now);
+    std::lock_guard<std::mutex> lock(mutex_);
+    observeRtt(ack.rtt, ack.now, signal);
+    if (!options_.classifyLosses || ack.lostBytes == 0 || ack.lossCause != CongestionControl::LossCause::UNKNOWN) {
+        congestionControl_.onAck(ack);
+        return;
+    }
+    CongestionControl::AckEvent classified = ack;
+    classified.lossCause = classifier_.classify(std::max(ack.lostPackets, 1U), ack.now);
+    if (classified.lossCause == CongestionControl::LossCause::WIRELESS) {
+        stats_.wirelessLosses += std::max(ack.lostPackets, 1U);
+    }
+    congestionControl_.onAck(classified);
+}
+
+uint32_t PacketPacer::getRate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return currentRate();
+}
+
+size_t PacketPacer::getQueuedPackets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+PacketPacer::Stats PacketPacer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+double PacketPacer::pollSignal(Clock::time_point now) {
+    if (!options_.classifyLosses) {
+        return -1;
+    }
+    // Only the caller that moves the poll time forward asks the provider
+    Clock::rep last = lastSignalPoll_.load(std::memory_order_relaxed);
+    Clock::rep at = now.time_since_epoch().count();
+    if (at - last < std::chrono::duration_cast<Clock::duration>(options_.signalPollInterval).count() ||
+        !lastSignalPoll_.compare_exchange_strong(last, at, std::memory_order_relaxed)) {
+        return -1;
+    }
+    return provider_.GetSignalStrength();
+}
+
+void PacketPacer::observeRtt(std::chrono::microseconds rtt, Clock::time_point now, double signal) {
+    if (!options_.classifyLosses) {
+        return;
+    }
+    classifier_.onRttSample(rtt, now);
+    if (signal >= 0) {
+        classifier_.onSignalStrength(signal, now);
+    }
+}
+
+uint32_t PacketPacer::currentRate() const {
+    uint64_t rate = congestionControl_.getSendingRate();
+    if (countsPackets_) {
+        rate = std::min<uint64_t>(rate * options_.mss, std::numeric_limits<uint32_t>::max());
+    }
+    return std::max(static_cast<uint32_t>(rate), options_.minRate);
+}
+
+void PacketPacer::refill(Clock::time_point now) {
+    if (now <= lastRefill_) {
+        return;
+    }
+    double rate = currentRate();
+    double elapsed = std::chrono::duration<double>(now - lastRefill_).count();
+    // Two ticks of depth absorb a late wakeup without losing rate
+    double depth = std::clamp(rate * std::chrono::duration<double>(options_.tick).count() * 2, MIN_BUCKET_BYTES,
+                              std::max(static_cast<double>(options_.maxBurstBytes), MIN_BUCKET_BYTES));
+    tokens_ = std::min(tokens_ + rate * elapsed, depth);
+    lastRefill_ = now;
+}
+
+PacketPacer::Clock::time_point PacketPacer::nextReleaseLocked() const {
+    if (queue_.empty()) {
+        return Clock::time_point::max();
+    }
+    if (tokens_ > 0) {
+        return std::max(lastRefill_, retryAt_);
+    }
+    // Sleep at least one tick so the next wakeup sends a batch, not a packet
+    auto deficit = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::duration<double>((1.0 - tokens_) / currentRate()));
+    return std::max(lastRefill_ + std::max(deficit, options_.tick), retryAt_);
+}
+
+void PacketPacer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        Clock::time_point next = nextReleaseLocked();
+        if (next == Clock::time_point::max()) {
+            wakeup_.wait(lock);
+            continue;
+        }
+        if (next > Clock::now()) {
+            wakeup_.wait_until(lock, next);
+            continue;
+        }
+        lock.unlock();
+        releaseDue(Clock::now());
+        lock.lock();
+    }
+}
+
+CongestionControl::PathEstimate EstimatePathFromProvider(const ISatelliteProvider& provider) {
+    CongestionControl::PathEstimate estimate;
+    estimate.bandwidth = provider.GetBandwidth() / 8;
+    double latency = provider.GetLatency();
+    if (latency > 0) {
+        estimate.rtt = std::chrono::microseconds(static_cast<int64_t>(latency * 1000));
+    }
+    return estimate;
+}
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../../include/srpt_satellite.h"
+#include "../congestion_control/interface.h"
+#include "../congestion_control/jump_start.h"
+#include "../congestion_control/loss_classifier.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace SRPT {
+namespace Satellite {
+
+// Userspace pacer in front of any ISatelliteProvider. Packets are queued and
+// released through SendBatch at the active congestion controller's sending
+// rate, using a token bucket refilled by a coarse timer: each wakeup sends
+// every packet the accumulated tokens allow, so a high rate costs one
+// wakeup per tick rather than one per packet.
+//
+// Either run the pacing thread with start(), or call releaseDue() from an
+// existing loop. The congestion controller is not thread-safe; while the
+// pacer is in use, feed it acknowledgements and losses through the pacer so
+// all access is serialized.
+//
+// The pacer works in bytes. For a controller that counts packets instead
+// (ICongestionControl::countsPackets(), e.g. Cubic) its rate is converted
+// at Options::mss bytes a packet, each packet sent counts as one, and acked
+// bytes are passed on as whole packets.
+//
+// Packets the provider pushes back go back to the head of the queue, in
+// order, with their tokens refunded, and are offered again a tick later.
+// Only the packets the provider took are reported to the controller as
+// sent.
+//
+// Losses reported through the pacer are classified (LossClassifier) from
+// the RTT samples of the acks it forwards and the provider's signal
+// strength; wireless losses do not reach the controller as a window cut.
+// RTT samples and losses, whatever their cause, also go to the provider's
+// LinkTelemetry if it keeps one.
+class PacketPacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::chrono::microseconds tick{1000};  // Timer granularity
+        uint32_t maxBurstBytes = 1 << 20;      // Bucket depth cap; bounds the rate at maxBurstBytes per tick
+        uint32_t minRate = 16 * 1024;          // Bytes/s floor when the controller reports 0
+        size_t queueLimit = 4096;              // Packets
+        uint32_t mss = 1460;                   // Bytes per packet, for controllers that count packets
+        bool classifyLosses = true;
+        std::chrono::milliseconds signalPollInterval{100};  // GetSignalStrength() at most this often
+        CongestionControl::LossClassifier::Options classifier;
+    };
+
+    struct Stats {
+        uint64_t packetsReleased = 0;
+        uint64_t bytesReleased = 0;
+        uint64_t bursts = 0;
+        uint64_t sendFailures = 0;  // Pushed back by the provider and requeued
+        uint64_t queueDrops = 0;
+        uint64_t wirelessLosses = 0;  // Kept from the controller
+    };
+
+    PacketPacer(ISatelliteProvider& provider, CongestionControl::ICongestionControl& congestionControl);
+    PacketPacer(ISatelliteProvider& provider, CongestionControl::ICongestionControl& congestionControl,
+                const Options& options);
+    ~PacketPacer();
+
+    PacketPacer(const PacketPacer&) = delete;
+    PacketPacer& operator=(const PacketPacer&) = delete;
+
+    // Returns false if the queue is full
+    bool enqueue(const ByteVector& packet);
+    bool enqueue(ByteVector&& packet);
+
+    // Send every packet the bucket allows at `now`; returns the number sent
+    size_t releaseDue(Clock::time_point now = Clock::now());
+
+    // When releaseDue() can next send something, or time_point::max() if
+    // the queue is empty
+    Clock::time_point nextReleaseTime() const;
+
+    // Pacing thread
+    bool start();
+    void stop();
+    bool isRunning() const { return running_; }
+
+    void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt);
+    void onPacketLoss();
+    void onAck(const CongestionControl::AckEvent& ack);
+
+    uint32_t getRate() const;
+    size_t getQueuedPackets() const;
+    Stats getStats() const;
+
+private:
+    ISatelliteProvider& provider_;
+    CongestionControl::ICongestionControl& congestionControl_;
+    Options options_;
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<ByteVector> queue_;
+    double tokens_;  // Bytes; may go negative after a packet larger than the balance
+    Clock::time_point lastRefill_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    bool stopping_ = false;
+    Stats stats_;
+    bool countsPackets_;  // Controller counts packets, not bytes
+    Clock::time_point retryAt_;  // After a pushback, no release before this
+    uint32_t ackCredit_ = 0;  // Acked bytes short of a whole packet
+    CongestionControl::LossClassifier classifier_;
+    std::atomic<Clock::rep> lastSignalPoll_{0};  // Claimed before the provider is asked, outside the lock
+
+    uint32_t currentRate() const;
+    void refill(Clock::time_point now);
+    // The provider's signal strength if a poll is due at `now`, else a
+    // negative value; called without the lock
+    double pollSignal(Clock::time_point now);
+    void observeRtt(std::chrono::microseconds rtt, Clock::time_point now, double signal);
+    Clock::time_point nextReleaseLocked() const;
+    void run();
+};
+
+// The provider's path figures as a starting estimate for JumpStart:
+// GetBandwidth() in bits/s and GetLatency() in ms, taken as the RTT. These
+// are live measurements for providers that keep LinkTelemetry, nominal
+// figures otherwise. Invalid if the provider reports either as zero.
+CongestionControl::PathEstimate EstimatePathFromProvider(const ISatelliteProvider& provider);
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,689 @@
+#include "packet_spool.h"
+#include "../core/srpt_error_detection.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SRPT {
+namespace Satellite {
+
+namespace {
+constexpr char SEGMENT_SUFFIX[] = ".seg";
+constexpr size_t SEGMENT_DIGITS = 20;
+constexpr char CURSOR_FILE[] = "cursor";
+constexpr uint32_t CURSOR_MAGIC = 0x31525053;  // "SPR1"
+constexpr size_t CURSOR_BYTES = 16;  // Magic, 4 spare bytes, acknowledged index
+constexpr size_t MIN_SEGMENT_BYTES = 4096;
+
+uint32_t load32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+}
+
+void store32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+std::string segmentName(uint64_t firstIndex) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu%s", static_cast<unsigned long long>(firstIndex), SEGMENT_SUFFIX);
+    return name;
+}
+
+bool parseSegmentName(const std::string& name, uint64_t& firstIndex) {
+    if (name.size() != SEGMENT_DIGITS + std::strlen(SEGMENT_SUFFIX) ||
+        name.compare(SEGMENT_DIGITS, std::string::npos, SEGMENT_SUFFIX) != 0 ||
+        !std::all_of(name.begin(), name.begin() + SEGMENT_DIGITS, [](char c) { return c >= '0' && c <= '9'; })) {
+        return false;
+    }
+    firstIndex = std::strtoull(name.c_str(), nullptr, 10);
+    return true;
+}
+
+std::string systemError(const std::string& what, const std::string& path, int error) {
+    return what + " " + path + ": " + std::strerror(error);
+}
+
+// The acknowledged index is one aligned 8-byte word, so it is never seen
+// half written
+void storeCursor(uint8_t* cursor, uint64_t index) {
+    std::memcpy(cursor + 8, &index, sizeof(index));
+}
+
+void syncRange(uint8_t* data, size_t offset, size_t length) {
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t start = offset / page * page;
+    ::msync(data + start, offset + length - start, MS_SYNC);
+}
+} // namespace
+
+// PacketSpool implementation
+PacketSpool::~PacketSpool() {
+    close();
+}
+
+bool PacketSpool::open(const std::string& directory) {
+    return open(directory, Options());
+}
+
+bool PacketSpool::open(const std::string& directory, const Options& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeLocked();
+    options_ = options;
+    options_.segmentBytes = std::min<size_t>(std::max(options_.segmentBytes, MIN_SEGMENT_BYTES), UINT32_MAX);
+    options_.maxBytes = std::max<uint64_t>(options_.maxBytes, options_.segmentBytes);
+    directory_ = directory;
+    stats_ = Stats();
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        lastError_ = systemError("Cannot create", directory, errno);
+        return false;
+    }
+    if (!recoverLocked()) {
+        closeLocked();
+        return false;
+    }
+    return true;
+}
+
+void PacketSpool::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeLocked();
+}
+
+bool PacketSpool::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cursor_ != nullptr;
+}
+
+bool PacketSpool::append(const ByteVector& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cursor_ == nullptr) {
+        lastError_ = "Spool is not open";
+        return false;
+    }
+    size_t needed = RECORD_HEADER_BYTES + record.size();
+    if (record.empty() || needed > options_.segmentBytes) {
+        lastError_ = "Record size " + std::to_string(record.size()) + " does not fit a segment";
+        return false;
+    }
+
+    if (segments_.empty() || segments_.back().size - segments_.back().end < needed) {
+        uint64_t used = 0;
+        for (const auto& segment : segments_) {
+            used += segment.size;
+        }
+        if (used + options_.segmentBytes > options_.maxBytes) {
+            lastError_ = "Spool is full";
+            return false;
+        }
+        Segment segment;
+        segment.firstIndex = nextIndex_;
+        segment.path = directory_ + "/" + segmentName(nextIndex_);
+        if (!mapLocked(segment.path, true, options_.segmentBytes, segment.data, segment.size)) {
+            return false;
+        }
+        if (segments_.empty()) {
+            acked_ = Position{0, 0, nextIndex_};
+            read_ = acked_;
+        }
+        segments_.push_back(std::move(segment));
+        ++stats_.segmentsCreated;
+    }
+
+    // The length goes in last: until it does, the record is not there
+    Segment& segment = segments_.back();
+    uint8_t* at = segment.data + segment.end;
+    store32(at + 4, calculateCRC32C(record.data(), record.size()));
+    std::memcpy(at + RECORD_HEADER_BYTES, record.data(), record.size());
+    store32(at, static_cast<uint32_t>(record.size()));
+    if (options_.syncEveryAppend) {
+        syncRange(segment.data, segment.end, needed);
+    }
+    segment.end += needed;
+    ++segment.records;
+    ++nextIndex_;
+    ++records_;
+    ++unread_;
+    ++stats_.appended;
+    return true;
+}
+
+bool PacketSpool::readNext(ByteVector& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!atRecordLocked(read_)) {
+        return false;
+    }
+    const uint8_t* at = segments_[read_.segment].data + read_.offset;
+    record.assign(at + RECORD_HEADER_BYTES, at + RECORD_HEADER_BYTES + load32(at));
+    skipRecordLocked(read_);
+    --unread_;
+    ++stats_.read;
+    return true;
+}
+
+void PacketSpool::rewind() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    read_ = acked_;
+    unread_ = records_;
+}
+
+size_t PacketSpool::acknowledge(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t acknowledged = 0;
+    while (acknowledged < count && atRecordLocked(acked_)) {
+        atRecordLocked(read_);
+        bool unread = read_.segment == acked_.segment && read_.offset == acked_.offset;
+        skipRecordLocked(acked_);
+        if (unread) {
+            read_ = acked_;
+            --unread_;
+        }
+        --records_;
+        ++acknowledged;
+    }
+    if (acknowledged > 0) {
+        storeCursor(cursor_, acked_.index);
+        stats_.acknowledged += acknowledged;
+        compactLocked();
+    }
+    return acknowledged;
+}
+
+bool PacketSpool::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cursor_ == nullptr) {
+        lastError_ = "Spool is not open";
+        return false;
+    }
+    bool ok = true;
+    for (const auto& segment : segments_) {
+        if (segment.end > 0 && ::msync(segment.data, segment.end, MS_SYNC) != 0) {
+            lastError_ = systemError("Cannot sync", segment.path, errno);
+            ok = false;
+        }
+    }
+    if (::msync(cursor_, CURSOR_BYTES, MS_SYNC) != 0) {
+        lastError_ = systemError("Cannot sync", directory_ + "/" + CURSOR_FILE, errno);
+        ok = false;
+    }
+    // Segment files created and removed since the last sync
+    int fd = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0 || ::fsync(fd) != 0) {
+        lastError_ = systemError("Cannot sync", directory_, errno);
+        ok = false;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return ok;
+}
+
+uint64_t PacketSpool::unacknowledged() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+uint64_t PacketSpool::unread() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unread_;
+}
+
+uint64_t PacketSpool::sizeBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t bytes = 0;
+    for (const auto& segment : segments_) {
+        bytes += segment.size;
+    }
+    return bytes;
+}
+
+std::string PacketSpool::getDirectory() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directory_;
+}
+
+PacketSpool::Stats PacketSpool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string PacketSpool::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+bool PacketSpool::mapLocked(const std::string& path, bool create, size_t size, uint8_t*& data, size_t& mapped) {
+    data = nullptr;
+    mapped = 0;
+    int fd = ::open(path.c_str(), O_RDWR | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    if (fd < 0) {
+        lastError_ = systemError("Cannot open", path, errno);
+        return false;
+    }
+    if (create) {
+        // Reserving the blocks now means a full disk fails here, not with
+        // SIGBUS on the first write to a mapped page
+        int error = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+        if (error == EINVAL || error == EOPNOTSUPP) {
+            error = ::ftruncate(fd, static_cast<off_t>(size)) == 0 ? 0 : errno;
+        }
+        if (error != 0) {
+            lastError_ = systemError("Cannot allocate", path, error);
+            ::close(fd);
+            ::unlink(path.c_str());
+            return false;
+        }
+    } else {
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            lastError_ = systemError("Cannot stat", path, errno);
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(status.st_size);
+    }
+    if (size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        lastError_ = systemError("Cannot map", path, error);
+        return false;
+    }
+    data = static_cast<uint8_t*>(address);
+    mapped = size;
+    return true;
+}
+
+bool PacketSpool::recoverLocked() {
+    std::string cursorPath = directory_ + "/" + CURSOR_FILE;
+    size_t mapped = 0;
+    bool exists = ::access(cursorPath.c_str(), F_OK) == 0;
+    if (!mapLocked(cursorPath, !exists, CURSOR_BYTES, cursor_, mapped)) {
+        return false;
+    }
+    if (mapped < CURSOR_BYTES) {
+        if (cursor_ != nullptr) {
+            ::munmap(cursor_, mapped);
+        }
+        if (!mapLocked(cursorPath, true, CURSOR_BYTES, cursor_, mapped)) {
+            return false;
+        }
+    }
+    uint64_t acknowledged = 0;
+    if (load32(cursor_) == CURSOR_MAGIC) {
+        std::memcpy(&acknowledged, cursor_ + 8, sizeof(acknowledged));
+    } else {
+        store32(cursor_, CURSOR_MAGIC);
+        storeCursor(cursor_, 0);
+    }
+
+    DIR* dir = ::opendir(directory_.c_str());
+    if (dir == nullptr) {
+        lastError_ = systemError("Cannot list", directory_, errno);
+        return false;
+    }
+    std::vector<uint64_t> firstIndexes;
+    while (dirent* entry = ::readdir(dir)) {
+        uint64_t firstIndex;
+        if (parseSegmentName(entry->d_name, firstIndex)) {
+            firstIndexes.push_back(firstIndex);
+        }
+    }
+    ::closedir(dir);
+    std::sort(firstIndexes.begin(), firstIndexes.end());
+
+    records_ = 0;
+    for (uint64_t firstIndex : firstIndexes) {
+        Segment segment;
+        segment.firstIndex = firstIndex;
+        segment.path = directory_ + "/" + segmentName(firstIndex);
+        if (!mapLocked(segment.path, false, 0, segment.data, segment.size)) {
+            return false;
+        }
+        // Records run up to a zero length or the first torn one
+        size_t offset = 0;
+        while (segment.size - offset >= RECORD_HEADER_BYTES) {
+            const uint8_t* at = segment.data + offset;
+            uint32_t length = load32(at);
+            if (length == 0) {
+                break;
+            }
+            if (length > segment.size - offset - RECORD_HEADER_BYTES ||
+                calculateCRC32C(at + RECORD_HEADER_BYTES, length) != load32(at + 4)) {
+                stats_.discardedBytes += std::min<size_t>(RECORD_HEADER_BYTES + length, segment.size - offset);
+                // Cleared so that appends carry on from the last good record
+                std::memset(segment.data + offset, 0, segment.size - offset);
+                break;
+            }
+            offset += RECORD_HEADER_BYTES + length;
+            ++segment.records;
+        }
+        segment.end = offset;
+        records_ += segment.records;
+        segments_.push_back(std::move(segment));
+    }
+
+    nextIndex_ = acknowledged;
+    if (!segments_.empty()) {
+        nextIndex_ = std::max(acknowledged, segments_.back().firstIndex + segments_.back().records);
+    }
+    // Skip what was acknowledged before the restart
+    acked_ = Position{0, 0, segments_.empty() ? nextIndex_ : segments_.front().firstIndex};
+    while (atRecordLocked(acked_) && acked_.index < acknowledged) {
+        skipRecordLocked(acked_);
+        --records_;
+    }
+    read_ = acked_;
+    unread_ = records_;
+    stats_.recovered = records_;
+    compactLocked();
+    return true;
+}
+
+bool PacketSpool::atRecordLocked(Position& position) const {
+    while (position.segment < segments_.size()) {
+        if (position.offset < segments_[position.segment].end) {
+            return true;
+        }
+        if (position.segment + 1 == segments_.size()) {
+            return false;
+        }
+        ++position.segment;
+        position.offset = 0;
+        position.index = segments_[position.segment].firstIndex;
+    }
+    return false;
+}
+
+void PacketSpool::skipRecordLocked(Position& position) const {
+    position.offset += RECORD_HEADER_BYTES + load32(segments_[position.segment].data + position.offset);
+    ++position.index;
+}
+
+void PacketSpool::compactLocked() {
+    // Segments before the acknowledgement cursor are done with, and so is
+    // the last one once everything in it is acknowledged
+    atRecordLocked(acked_);
+    atRecordLocked(read_);
+    size_t done = records_ == 0 ? segments_.size() : acked_.segment;
+    if (done == 0) {
+        return;
+    }
+    for (size_t i = 0; i < done; ++i) {
+        Segment& segment = segments_[i];
+        if (segment.data != nullptr) {
+            ::munmap(segment.data, segment.size);
+        }
+        ::unlink(segment.path.c_str());
+        ++stats_.segmentsRemoved;
+    }
+    segments_.erase(segments_.begin(), segments_.begin() + static_cast<std::ptrdiff_t>(done));
+    if (segments_.empty()) {
+        acked_ = Position{0, 0, nextIndex_};
+        read_ = acked_;
+    } else {
+        acked_.segment -= done;
+        read_.segment -= done;
+    }
+}
+
+void PacketSpool::closeLocked() {
+    for (auto& segment : segments_) {
+        if (segment.data != nullptr) {
+            ::munmap(segment.data, segment.size);
+        }
+    }
+    segments_.clear();
+    if (cursor_ != nullptr) {
+        ::munmap(cursor_, CURSOR_BYTES);
+        cursor_ = nullptr;
+    }
+    acked_ = Position();
+    read_ = Position();
+    nextIndex_ = 0;
+    records_ = 0;
+    unread_ = 0;
+}
+
+// SpoolingProvider implementation
+SpoolingProvider::SpoolingProvider(std::unique_ptr<ISatelliteProvider> provider, const std::string& directory)
+    : m_provider(std::move(provider)), m_directory(directory) {
+    // Reported by Initialize(), which tries again
+    if (!m_spool.open(m_directory)) {
+        m_lastError = m_spool.getLastError();
+    }
+}
+
+bool SpoolingProvider::Initialize(const std::map<std::string, std::string>& options) {
+    std::map<std::string, std::string> providerOptions;
+    PacketSpool::Options spoolOptions;
+    bool reopen = false;
+    std::string key;
+    try {
+        for (const auto& option : options) {
+            key = option.first;
+            if (option.first == "spool_segment_bytes") {
+                spoolOptions.segmentBytes = std::stoull(option.second);
+                reopen = true;
+            } else if (option.first == "spool_max_bytes") {
+                spoolOptions.maxBytes = std::stoull(option.second);
+                reopen = true;
+            } else if (option.first == "spool_sync") {
+                spoolOptions.syncEveryAppend = option.second == "true";
+                reopen = true;
+            } else {
+                providerOptions.insert(option);
+            }
+        }
+    } catch (const std::exception&) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lastError = "Invalid value for " + key;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if ((reopen || !m_spool.isOpen()) && !m_spool.open(m_directory, spoolOptions)) {
+            m_lastError = m_spool.getLastError();
+            return false;
+        }
+        m_headRefusals = 0;
+        m_lastError.clear();
+    }
+    return m_provider->Initialize(providerOptions);
+}
+
+bool SpoolingProvider::Connect(const std::string& satellite_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_provider->Connect(satellite_id)) {
+        return false;
+    }
+    m_connected = true;
+    // Whatever was read but not taken before the link went down goes again
+    m_spool.rewind();
+    size_t drained = drainLocked();
+    if (m_verboseLogging) {
+        std::cout << "SpoolingProvider::Connect - sent " << drained << " spooled packets, "
+                  << m_spool.unacknowledged() << " left" << std::endl;
+    }
+    return true;
+}
+
+bool SpoolingProvider::Disconnect() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connected = false;
+    return m_provider->Disconnect();
+}
+
+bool SpoolingProvider::SendData(const ByteVector& data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_connected && m_spool.unacknowledged() == 0 && m_provider->SendData(data)) {
+        return true;
+    }
+    if (!m_spool.append(data)) {
+        return false;
+    }
+    if (m_connected) {
+        drainLocked();
+    }
+    return true;
+}
+
+bool SpoolingProvider::ReceiveData(ByteVector& data) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_connected) {
+            drainLocked();
+        }
+    }
+    return m_provider->ReceiveData(data);
+}
+
+size_t SpoolingProvider::SendBatch(std::vector<ByteVector>& packets) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t taken = 0;
+    if (m_connected) {
+        drainLocked();
+        if (m_spool.unacknowledged() == 0) {
+            taken = m_provider->SendBatch(packets);
+        }
+    }
+    size_t spooled = 0;
+    while (spooled < packets.size() && m_spool.append(packets[spooled])) {
+        ++spooled;
+    }
+    packets.erase(packets.begin(), packets.begin() + static_cast<std::ptrdiff_t>(spooled));
+    if (m_connected && spooled > 0) {
+        drainLocked();
+    }
+    return taken + spooled;
+}
+
+bool SpoolingProvider::ExecuteCommand(const std::string& command, std::string& response) {
+    if (command == "spool status") {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        char buffer[192];
+        std::snprintf(buffer, sizeof(buffer), "queued=%llu unsent=%llu bytes=%llu dropped=%llu connected=%d",
+                      static_cast<unsigned long long>(m_spool.unacknowledged()),
+                      static_cast<unsigned long long>(m_spool.unread()),
+                      static_cast<unsigned long long>(m_spool.sizeBytes()),
+                      static_cast<unsigned long long>(m_dropped), m_connected ? 1 : 0);
+        response = buffer;
+        return true;
+    }
+    return m_provider->ExecuteCommand(command, response);
+}
+
+double SpoolingProvider::GetSignalStrength() const {
+    return m_provider->GetSignalStrength();
+}
+
+double SpoolingProvider::GetLatency() const {
+    return m_provider->GetLatency();
+}
+
+uint64_t SpoolingProvider::GetBandwidth() const {
+    return m_provider->GetBandwidth();
+}
+
+std::unique_ptr<SatelliteStream> SpoolingProvider::CreateStream() {
+    return std::make_unique<SpoolingStream>(*this);
+}
+
+void SpoolingProvider::setVerboseLogging(bool verbose) {
+    m_verboseLogging = verbose;
+    m_provider->setVerboseLogging(verbose);
+}
+
+LinkTelemetry* SpoolingProvider::GetTelemetry() {
+    return m_provider->GetTelemetry();
+}
+
+uint64_t SpoolingProvider::getDropped() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+std::string SpoolingProvider::getLastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastError;
+}
+
+size_t SpoolingProvider::drain() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_connected ? drainLocked() : 0;
+}
+
+size_t SpoolingProvider::drainLocked() {
+    size_t sent = 0;
+    std::vector<ByteVector> batch;
+    ByteVector record;
+    ByteVector head;
+    while (m_spool.unread() > 0) {
+        batch.clear();
+        // Every drain ends with the read cursor back on the oldest record,
+        // so this passes over the one refused so often
+        bool skipHead = m_headRefusals >= MAX_HEAD_REFUSALS && m_spool.unread() > 1;
+        if (skipHead) {
+            m_spool.readNext(head);
+        }
+        while (batch.size() < DRAIN_BATCH && m_spool.readNext(record)) {
+            batch.push_back(std::move(record));
+        }
+        size_t offered = batch.size();
+        size_t taken = m_provider->SendBatch(batch);
+        if (skipHead) {
+            if (taken == 0) {
+                // Refusing everything is back-pressure; the head waits
+                m_spool.rewind();
+                break;
+            }
+            m_spool.acknowledge(1);
+            ++m_dropped;
+            m_lastError = "Dropped a spooled packet of " + std::to_string(head.size()) + " bytes after " +
+                          std::to_string(m_headRefusals) + " refusals";
+            if (m_verboseLogging) {
+                std::cout << "SpoolingProvider::drain - " << m_lastError << std::endl;
+            }
+        }
+        m_spool.acknowledge(taken);
+        sent += taken;
+        if (taken < offered) {
+            // The provider pushed back; the rest waits for the next drain
+            m_headRefusals = taken == 0 ? m_headRefusals + 1 : 1;
+            m_spool.rewind();
+            break;
+        }
+        m_headRefusals = 0;
+    }
+    return sent;
+}
+
+// SpoolingStream implementation
+SpoolingProvider::SpoolingStream::SpoolingStream(SpoolingProvider& provider) : m_provider(provider) {}
+
+bool SpoolingProvider::SpoolingStream::Write(const ByteVector& data) {
+    return m_provider.SendData(data);
+}
+
+bool SpoolingProvider::SpoolingStream::Read(ByteVector& data) {
+    return m_provider.ReceiveData(data);
+}
+
+void SpoolingProvider::SpoolingStream::Close() {}
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "../../include/srpt_satellite.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SRPT {
+namespace Satellite {
+
+// Persistent store-and-forward queue for outgoing packets and chunks: an
+// append-only log of memory-mapped segment files in one directory.
+//
+// Records are appended at the tail, read from a read cursor, and
+// acknowledged from the head once delivered. Segments whose records have
+// all been acknowledged are deleted. The acknowledgement cursor lives in a
+// small mapped file of its own. Reopening the directory after a restart
+// or a crash recovers every record not yet acknowledged, and reading
+// starts again from the first of them, so delivery is at least once.
+//
+// Segment files are named after the index of their first record and
+// preallocated to Options::segmentBytes. A record is
+//   length   4 bytes, little endian; 0 ends the segment
+//   crc      4 bytes, CRC-32C of the data
+//   data
+// The length is stored last, so a record torn by a crash is either absent
+// or caught by its CRC. Recovery stops at the first such record in a
+// segment.
+//
+// Mapped pages reach the disk when the kernel writes them back, which
+// survives a crash of the process but not of the machine;
+// Options::syncEveryAppend, or sync() at chosen points, waits for the disk.
+//
+// Thread-safe.
+class PacketSpool {
+public:
+    struct Options {
+        size_t segmentBytes = 4 << 20;  // A record must fit in one segment
+        uint64_t maxBytes = 256ull << 20;  // Segment files on disk; append() fails past it
+        bool syncEveryAppend = false;
+    };
+
+    struct Stats {
+        uint64_t appended = 0;
+        uint64_t read = 0;
+        uint64_t acknowledged = 0;
+        uint64_t recovered = 0;  // Unacknowledged records found by open()
+        uint64_t discardedBytes = 0;  // Torn or corrupt tails skipped by open()
+        uint64_t segmentsCreated = 0;
+        uint64_t segmentsRemoved = 0;
+    };
+
+    static constexpr size_t RECORD_HEADER_BYTES = 8;
+
+    PacketSpool() = default;
+    ~PacketSpool();
+
+    PacketSpool(const PacketSpool&) = delete;
+    PacketSpool& operator=(const PacketSpool&) = delete;
+
+    // Opens the spool in `directory`, creating both if need be. False,
+    // with getLastError() set, if the directory or its files cannot be
+    // used. An open spool is closed first.
+    bool open(const std::string& directory);
+    bool open(const std::string& directory, const Options& options);
+    void close();
+    bool isOpen() const;
+
+    // False for an empty record, one too large for a segment, a full or
+    // closed spool, or an I/O error
+    bool append(const ByteVector& record);
+
+    // The next record after the read cursor; false if every record has
+    // been read
+    bool readNext(ByteVector& record);
+    // Moves the read cursor back to the first unacknowledged record, e.g.
+    // when records read for sending did not get through
+    void rewind();
+    // Acknowledges up to `count` of the oldest unacknowledged records,
+    // read or not, and deletes the segments this empties. Returns the
+    // number acknowledged.
+    size_t acknowledge(size_t count);
+
+    // Waits until appended records and the acknowledgement cursor are on disk
+    bool sync();
+
+    uint64_t unacknowledged() const;
+    uint64_t unread() const;
+    // Bytes of segment files in use
+    uint64_t sizeBytes() const;
+    std::string getDirectory() const;
+    Stats getStats() const;
+    std::string getLastError() const;
+
+private:
+    struct Segment {
+        uint64_t firstIndex = 0;
+        uint64_t records = 0;
+        size_t end = 0;  // Bytes written
+        uint8_t* data = nullptr;
+        size_t size = 0;
+        std::string path;
+    };
+
+    // Where a cursor stands: a segment of segments_ and a byte offset in it
+    struct Position {
+        size_t segment = 0;
+        size_t offset = 0;
+        uint64_t index = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::string directory_;
+    Options options_;
+    std::deque<Segment> segments_;
+    uint8_t* cursor_ = nullptr;  // Mapped acknowledgement cursor
+    Position acked_;
+    Position read_;
+    uint64_t nextIndex_ = 0;
+    uint64_t records_ = 0;  // Unacknowledged
+    uint64_t unread_ = 0;
+    Stats stats_;
+    std::string lastError_;
+
+    bool mapLocked(const std::string& path, bool create, size_t size, uint8_t*& data, size_t& mapped);
+    bool recoverLocked();
+    // Moves `position` over segment ends to the record it stands before;
+    // false if there is none
+    bool atRecordLocked(Position& position) const;
+    void skipRecordLocked(Position& position) const;
+    void compactLocked();
+    void closeLocked();
+};
+
+// Store-and-forward in front of another provider. While the link is down,
+// or pushes back, packets go to a PacketSpool instead of being refused;
+// once it is up again the spool is drained in batches through the
+// provider's SendBatch() ahead of anything newer, so order is kept.
+// Packets spooled before a restart are sent after the next Connect().
+//
+// A record is acknowledged, and its space reclaimed, as soon as the wrapped
+// provider takes it, not when the peer receives it. A packet the provider
+// accepts and then loses (a send queue dropped on disconnect, a frame lost
+// on the link) is not sent again from the spool; recovering it is left to
+// the SRPT retransmission above.
+//
+// There is no background thread: the spool drains only inside Connect(),
+// SendData(), SendBatch(), ReceiveData() and drain(). An application that
+// stops calling them while packets are spooled should call drain()
+// periodically, e.g. from a timer, to empty the spool.
+//
+// A provider that keeps refusing the oldest spooled packet while taking
+// others, one it cannot frame for instance, would hold the spool up for
+// good. After MAX_HEAD_REFUSALS drains that took nothing, the drain offers
+// what follows that packet instead; if the provider takes any of it, the
+// refused packet is dropped, counted in getDropped() and reported through
+// getLastError(). Once the provider refuses everything, the head stays,
+// since that is only back-pressure.
+//
+// Initialize() options, the rest going to the wrapped provider:
+//   spool_segment_bytes   segment file size
+//   spool_max_bytes       spool size limit; SendData() fails past it
+//   spool_sync            "true" to sync every packet to disk
+// Commands: "spool status"; the rest go to the wrapped provider.
+class SpoolingProvider : public ISatelliteProvider {
+public:
+    static constexpr size_t DRAIN_BATCH = 64;
+    static constexpr size_t MAX_HEAD_REFUSALS = 8;
+
+    // The spool is opened in `directory` at once with default options;
+    // Initialize() reopens it with any spool_* options given. Initialize()
+    // returns false, with getLastError() set, on a bad option or if the
+    // spool cannot be opened.
+    SpoolingProvider(std::unique_ptr<ISatelliteProvider> provider, const std::string& directory);
+
+    bool Initialize(const std::map<std::string, std::string>& options) override;
+    bool Connect(const std::string& satellite_id) override;
+    bool Disconnect() override;
+    bool SendData(const ByteVector& data) override;
+    bool ReceiveData(ByteVector& data) override;
+    size_t SendBatch(std::vector<ByteVector>& packets) override;
+    bool ExecuteCommand(const std::string& command, std::string& response) override;
+    double GetSignalStrength() const override;
+    double GetLatency() const override;
+    uint64_t GetBandwidth() const override;
+    std::unique_ptr<SatelliteStream> CreateStream() override;
+    void setVerboseLogging(bool verbose) override;
+    LinkTelemetry* GetTelemetry() override;
+
+    // Hands spooled packets to the provider until it pushes back or the
+    // spool is empty; returns the number handed over. Runs on Connect()
+    // and on every send and receive while connected.
+    size_t drain();
+
+    PacketSpool& getSpool() { return m_spool; }
+    ISatelliteProvider& getProvider() { return *m_provider; }
+    // Spooled packets dropped because the provider would not take them
+    uint64_t getDropped() const;
+    std::string getLastError() const;
+
+private:
+    std::unique_ptr<ISatelliteProvider> m_provider;
+    PacketSpool m_spool;
+    std::string m_directory;
+    mutable std::mutex m_mutex;  // Orders sends and drains
+    bool m_connected = false;
+    bool m_verboseLogging = false;
+    size_t m_headRefusals = 0;  // Drains in a row that took nothing
+    uint64_t m_dropped = 0;
+    std::string m_lastError;
+
+    size_t drainLocked();
+
+    class SpoolingStream : public SatelliteStream {
+    public:
+        explicit SpoolingStream(SpoolingProvider& provider);
+        bool Write(const ByteVector& data) override;
+        bool Read(ByteVector& data) override;
+        void Close() override;
+
+    private:
+        SpoolingProvider& m_provider;
+    };
+};
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,210 @@
+#include "sbd_framing.h"
+#include <algorithm>
+
+namespace SRPT {
+namespace Satellite {
+
+namespace {
+constexpr uint32_t CONTINUES = 1;
+constexpr uint32_t MORE = 2;
+constexpr size_t MAX_HEADER_BYTES = 3;  // (MAX_PACKET_BYTES << 2 | flags) fits 21 bits
+
+size_t varintSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void appendVarint(ByteVector& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool readVarint(const ByteVector& in, size_t& pos, uint32_t& value) {
+    value = 0;
+    for (size_t i = 0; i < MAX_HEADER_BYTES && pos < in.size(); ++i) {
+        uint8_t byte = in[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+// SbdFramer implementation
+SbdFramer::SbdFramer(size_t maxMessageBytes) : maxMessageBytes_(std::max(maxMessageBytes, MIN_MESSAGE_BYTES)) {}
+
+bool SbdFramer::add(const ByteVector& packet) {
+    return add(ByteVector(packet));
+}
+
+bool SbdFramer::add(ByteVector&& packet) {
+    if (packet.empty() || packet.size() > MAX_PACKET_BYTES) {
+        return false;
+    }
+    pendingBytes_ += packet.size();
+    packets_.push_back(std::move(packet));
+    ++stats_.packets;
+    return true;
+}
+
+bool SbdFramer::hasFullMessage() const {
+    // At least the sequence byte and a 1-byte header per packet, so this
+    // never overstates what is queued
+    return !packets_.empty() && 1 + packets_.size() + pendingBytes_ >= maxMessageBytes_;
+}
+
+bool SbdFramer::nextMessage(ByteVector& message) {
+    if (packets_.empty()) {
+        return false;
+    }
+    message.clear();
+    message.reserve(maxMessageBytes_);
+    message.push_back(sequence_++);
+
+    size_t payload = 0;
+    while (!packets_.empty()) {
+        size_t space = maxMessageBytes_ - message.size();
+        if (space < 2) {
+            break;
+        }
+        ByteVector& packet = packets_.front();
+        size_t remaining = packet.size() - offset_;
+        uint32_t flags = offset_ > 0 ? CONTINUES : 0;
+
+        // With another packet to follow and room for it to start here, the
+        // length is spelled out; otherwise this record runs to the end
+        uint32_t header = static_cast<uint32_t>(remaining << 2) | flags;
+        size_t take;
+        bool last = true;
+        if (packets_.size() > 1 && remaining + varintSize(header) + 2 <= space) {
+            appendVarint(message, header);
+            take = remaining;
+            last = false;
+        } else {
+            take = std::min(remaining, space - 1);
+            if (take < remaining) {
+                flags |= MORE;
+                if (offset_ == 0) {
+                    ++stats_.fragmentedPackets;
+                }
+            }
+            message.push_back(static_cast<uint8_t>(flags));
+        }
+
+        message.insert(message.end(), packet.begin() + offset_, packet.begin() + offset_ + take);
+        offset_ += take;
+        pendingBytes_ -= take;
+        payload += take;
+        if (offset_ == packet.size()) {
+            packets_.pop_front();
+            offset_ = 0;
+        }
+        if (last) {
+            break;
+        }
+    }
+
+    ++stats_.messages;
+    stats_.payloadBytes += payload;
+    stats_.overheadBytes += message.size() - payload;
+    return true;
+}
+
+void SbdFramer::clear() {
+    packets_.clear();
+    offset_ = 0;
+    pendingBytes_ = 0;
+}
+
+// SbdReassembler implementation
+bool SbdReassembler::addMessage(const ByteVector& message, std::vector<ByteVector>& packets) {
+    if (message.empty()) {
+        ++stats_.malformedMessages;
+        dropPartial();
+        return false;
+    }
+    ++stats_.messages;
+    uint8_t sequence = message[0];
+    bool inOrder = haveSequence_ && sequence == static_cast<uint8_t>(lastSequence_ + 1);
+    haveSequence_ = true;
+    lastSequence_ = sequence;
+    if (!inOrder) {
+        dropPartial();
+    }
+
+    size_t pos = 1;
+    bool first = true;
+    while (pos < message.size()) {
+        uint32_t header;
+        if (!readVarint(message, pos, header)) {
+            ++stats_.malformedMessages;
+            dropPartial();
+            return false;
+        }
+        uint32_t flags = header & 3;
+        size_t length = header >> 2;
+        if (length == 0) {
+            length = message.size() - pos;
+        }
+        bool last = pos + length == message.size();
+        if (pos + length > message.size() || ((flags & MORE) && !last) || ((flags & CONTINUES) && !first)) {
+            ++stats_.malformedMessages;
+            dropPartial();
+            return false;
+        }
+        auto begin = message.begin() + pos;
+        pos += length;
+        first = false;
+
+        if (flags & CONTINUES) {
+            if (partial_.empty()) {
+                // The start of this packet went missing
+                if (!skipping_) {
+                    skipping_ = true;
+                    ++stats_.droppedPackets;
+                }
+                continue;
+            }
+        } else {
+            dropPartial();
+            skipping_ = false;
+        }
+        partial_.insert(partial_.end(), begin, begin + length);
+        if (partial_.size() > SbdFramer::MAX_PACKET_BYTES) {
+            dropPartial();
+            continue;
+        }
+        if (!(flags & MORE)) {
+            packets.push_back(std::move(partial_));
+            partial_.clear();
+            ++stats_.packets;
+        }
+    }
+    return true;
+}
+
+void SbdReassembler::reset() {
+    partial_.clear();
+    skipping_ = false;
+    haveSequence_ = false;
+}
+
+void SbdReassembler::dropPartial() {
+    if (!partial_.empty()) {
+        partial_.clear();
+        skipping_ = true;
+        ++stats_.droppedPackets;
+    }
+}
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../../include/srpt.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace SRPT {
+namespace Satellite {
+
+// Framing of SRPT packets into Iridium Short Burst Data messages, which
+// carry at most a few hundred bytes (340 mobile originated, 270 mobile
+// terminated on 9602/9603 modems) and are billed per message and per byte.
+// Small packets are packed several to a message; packets larger than the
+// space left are split across consecutive messages.
+//
+// Message layout:
+//   sequence   1 byte, incremented per message; a gap tells the receiver
+//              that a packet continuing across it is incomplete
+//   records    until the end of the message, each a header followed by
+//              its bytes
+//
+// A record header is a LEB128 varint of (length << 2 | flags), flags being
+// CONTINUES (the record continues a packet from the previous message) and
+// MORE (the packet goes on in the next message). Length 0 means "to the end
+// of the message", which the last record always uses, so a message costs 1
+// byte of sequence plus 1 byte per record, 2 for records of 32 bytes or
+// more that are not last.
+class SbdFramer {
+public:
+    static constexpr size_t MAX_PACKET_BYTES = 65535;
+    static constexpr size_t MIN_MESSAGE_BYTES = 3;
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t messages = 0;
+        uint64_t payloadBytes = 0;
+        uint64_t overheadBytes = 0;  // Sequence bytes and record headers
+        uint64_t fragmentedPackets = 0;  // Split across messages
+    };
+
+    // `maxMessageBytes` is clamped to at least MIN_MESSAGE_BYTES
+    explicit SbdFramer(size_t maxMessageBytes);
+
+    // Returns false, keeping nothing, for empty packets and ones over
+    // MAX_PACKET_BYTES
+    bool add(const ByteVector& packet);
+    bool add(ByteVector&& packet);
+
+    // Whether enough is queued to fill a whole message
+    bool hasFullMessage() const;
+    bool empty() const { return packets_.empty(); }
+    // Packet bytes not yet framed
+    size_t pendingBytes() const { return pendingBytes_; }
+    size_t getMaxMessageBytes() const { return maxMessageBytes_; }
+
+    // Frames the next message: a full one while enough is queued, otherwise
+    // whatever is left. Returns false if nothing is queued.
+    bool nextMessage(ByteVector& message);
+
+    // Drops queued packets; the sequence carries on
+    void clear();
+
+    Stats getStats() const { return stats_; }
+
+private:
+    size_t maxMessageBytes_;
+    std::deque<ByteVector> packets_;
+    size_t offset_ = 0;  // Bytes of packets_.front() already framed
+    size_t pendingBytes_ = 0;
+    uint8_t sequence_ = 0;
+    Stats stats_;
+};
+
+// The receiving side of SbdFramer. Messages must be added in the order they
+// were framed; a packet split across a missing or reordered message is
+// dropped, and everything else in the message is kept.
+class SbdReassembler {
+public:
+    struct Stats {
+        uint64_t messages = 0;
+        uint64_t packets = 0;
+        uint64_t droppedPackets = 0;  // Incomplete after a missing message
+        uint64_t malformedMessages = 0;
+    };
+
+    SbdReassembler() = default;
+
+    // Appends the packets the message completes. Returns false if the
+    // message is malformed; packets completed before the fault are kept.
+    bool addMessage(const ByteVector& message, std::vector<ByteVector>& packets);
+
+    void reset();
+
+    Stats getStats() const { return stats_; }
+
+private:
+    ByteVector partial_;  // Packet waiting for its next fragment
+    bool skipping_ = false;  // Discarding the rest of an incomplete packet
+    bool haveSequence_ = false;
+    uint8_t lastSequence_ = 0;
+    Stats stats_;
+
+    void dropPartial();
+};
+
+} // namespace Satellite
+} // namespace SRPT
@@ -21,6 +21,12 @@ public:
         }
         std::cout << "Provider created successfully" << std::endl;
     }
+
+    Impl(std::unique_ptr<ISatelliteProvider> provider) : provider_(std::move(provider)) {
+        if (!provider_) {
+            throw std::runtime_error("No satellite provider");
+        }
+    }
     
     bool Connect(const std::string& satellite_id);
     bool Disconnect();
@@ -39,6 +45,9 @@ private:
 // SatelliteSession method implementations
 SatelliteSession::SatelliteSession(const SatelliteConfig& config) : pImpl(std::make_unique<Impl>(config)) {}
 
+SatelliteSession::SatelliteSession(std::unique_ptr<ISatelliteProvider> provider)
+    : pImpl(std::make_unique<Impl>(std::move(provider))) {}
+
 SatelliteSession::~SatelliteSession() = default;
 
 bool SatelliteSession::Connect(const std::string& satellite_id) {
@@ -139,6 +148,44 @@ std::unique_ptr<ISatelliteProvider> CreateSatelliteProvider(Provider provider) {
     }
 }
 
+size_t ISatelliteProvider::SendBatch(std::vector<ByteVector>& packets) {
+    size_t taken = 0;
+    while (taken < packets.size() && SendData(packets[taken])) {
+        ++taken;
+    }
+    packets.erase(packets.begin(), packets.begin() + taken);
+    return taken;
+}
+
+size_t ISatelliteProvider::ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    size_t received = 0;
+    ByteVector data;
+    while (received < maxPackets && ReceiveData(data)) {
+        packets.push_back(std::move(data));
+        ++received;
+    }
+    return received;
+}
+
+size_t SatelliteStream::WriteBatch(std::vector<ByteVector>& packets) {
+    size_t taken = 0;
+    while (taken < packets.size() && Write(packets[taken])) {
+        ++taken;
+    }
+    packets.erase(packets.begin(), packets.begin() + taken);
+    return taken;
+}
+
+size_t SatelliteStream::ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    size_t received = 0;
+    ByteVector data;
+    while (received < maxPackets && Read(data)) {
+        packets.push_back(std::move(data));
+        ++received;
+    }
+    return received;
+}
+
 // Add implementations for SatelliteConfig methods
 void SatelliteConfig::setProvider(Provider provider) {
     provider_ = provider;
@@ -4,18 +4,42 @@
 #include <algorithm>
 #include <cstdint>
 #include <stdexcept>
-#include <deque>
 
 namespace SRPT {
 namespace Satellite {
 
+StarlinkProvider::StarlinkProvider() : StarlinkProvider(Common::SteadyClock::instance()) {}
+
+StarlinkProvider::StarlinkProvider(const Common::Clock& clock)
+    : m_dataQueue(std::make_unique<Common::SpscRing<ByteVector>>(DEFAULT_QUEUE_PACKETS)), m_telemetry(clock) {}
+
 bool StarlinkProvider::Initialize(const std::map<std::string, std::string>& options) {
     // Implement Starlink-specific initialization
+    auto it = options.find("queue_packets");
+    if (it != options.end()) {
+        size_t capacity = 0;
+        try {
+            capacity = std::stoull(it->second);
+        } catch (const std::exception&) {
+            m_lastError = "Invalid value for queue_packets";
+            return false;
+        }
+        // stoull() takes "-1" as the largest value
+        if (capacity == 0 || capacity > MAX_QUEUE_PACKETS) {
+            m_lastError = "Value out of range for queue_packets";
+            return false;
+        }
+        m_dataQueue = std::make_unique<Common::SpscRing<ByteVector>>(capacity);
+    }
     return true;
 }
 
 bool StarlinkProvider::Connect(const std::string& satellite_id) {
+    if (m_verboseLogging) {
+        std::cout << "StarlinkProvider::Connect - satellite " << satellite_id << std::endl;
+    }
     // Implement Starlink-specific connection logic
+    m_telemetry.reset();
     return true;
 }
 
@@ -25,32 +49,55 @@ bool StarlinkProvider::Disconnect() {
 }
 
 bool StarlinkProvider::SendData(const ByteVector& data) {
-    m_dataQueue.push_back(data);
-    if(m_verboseLogging) {
-        std::cout << "StarlinkProvider::SendData - Data sent: ";
-        for (const auto& byte : data) {
-            std::cout << static_cast<int>(byte) << " ";
-        }
-        std::cout << std::endl;
+    if (!m_dataQueue->tryPush(ByteVector(data))) {
+        return false;
     }
+    m_telemetry.onSent(data.size());
     return true;
 }
 
 bool StarlinkProvider::ReceiveData(ByteVector& data) {
-    if (m_dataQueue.empty()) {
+    if (!m_dataQueue->tryPop(data)) {
         data.clear();
         return false;
     }
-    data = m_dataQueue.front();
-    m_dataQueue.pop_front();
-    std::cout << "StarlinkProvider::ReceiveData - Data received: ";
-    for (const auto& byte : data) {
-        std::cout << static_cast<int>(byte) << " ";
-    }
-    std::cout << std::endl;
+    m_telemetry.onDelivered(data.size());
     return true;
 }
 
+size_t StarlinkProvider::SendBatch(std::vector<ByteVector>& packets) {
+    size_t taken = 0;
+    size_t bytes = 0;
+    while (taken < packets.size()) {
+        size_t size = packets[taken].size();
+        if (!m_dataQueue->tryPush(std::move(packets[taken]))) {
+            break;
+        }
+        bytes += size;
+        ++taken;
+    }
+    packets.erase(packets.begin(), packets.begin() + taken);
+    if (taken > 0) {
+        m_telemetry.onSent(bytes, static_cast<uint32_t>(taken));
+    }
+    return taken;
+}
+
+size_t StarlinkProvider::ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    size_t received = 0;
+    ByteVector data;
+    size_t bytes = 0;
+    while (received < maxPackets && m_dataQueue->tryPop(data)) {
+        bytes += data.size();
+        packets.push_back(std::move(data));
+        ++received;
+    }
+    if (received > 0) {
+        m_telemetry.onDelivered(bytes, static_cast<uint32_t>(received));
+    }
+    return received;
+}
+
 bool StarlinkProvider::ExecuteCommand(const std::string& command, std::string& response) {
     // Implement Starlink-specific command execution logic
     response = "Starlink command executed";
@@ -58,18 +105,18 @@ bool StarlinkProvider::ExecuteCommand(const std::string& command, std::string& r
 }
 
 double StarlinkProvider::GetSignalStrength() const {
-    // Implement Starlink-specific signal strength logic
-    return 0.9;
+    double reported = m_telemetry.snapshot().signalStrength;
+    return reported >= 0 ? reported : NOMINAL_SIGNAL_STRENGTH;
 }
 
 double StarlinkProvider::GetLatency() const {
-    // Implement Starlink-specific latency logic
-    return 20.0;
+    auto live = m_telemetry.snapshot();
+    return live.rttSamples > 0 ? live.srtt.count() / 1000.0 : NOMINAL_LATENCY_MS;
 }
 
 uint64_t StarlinkProvider::GetBandwidth() const {
-    // Implement Starlink-specific bandwidth logic
-    return 100000000;
+    uint64_t delivered = m_telemetry.snapshot().throughput;
+    return delivered > 0 ? delivered : NOMINAL_BANDWIDTH;
 }
 
 std::unique_ptr<SatelliteStream> StarlinkProvider::CreateStream() {
@@ -85,6 +132,14 @@ bool StarlinkProvider::StarlinkStream::Read(ByteVector& data) {
     return m_provider.ReceiveData(data);
 }
 
+size_t StarlinkProvider::StarlinkStream::WriteBatch(std::vector<ByteVector>& packets) {
+    return m_provider.SendBatch(packets);
+}
+
+size_t StarlinkProvider::StarlinkStream::ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets) {
+    return m_provider.ReceiveBatch(packets, maxPackets);
+}
+
 StarlinkProvider::StarlinkStream::StarlinkStream(StarlinkProvider& provider) : m_provider(provider) {}
 
 void StarlinkProvider::StarlinkStream::Close() {
@@ -1,12 +1,35 @@
 #pragma once
 #include "../../include/srpt_satellite.h"
-#include <deque>
+#include "../common/spsc_ring.h"
+#include "link_telemetry.h"
+#include <memory>
 
 namespace SRPT {
 namespace Satellite {
 
+// Loopback: what is sent comes back on ReceiveData(). The queue between the
+// two is a bounded lock-free ring, so one thread may send while another
+// receives; SendData() and SendBatch() refuse packets while it is full.
+//
+// Initialize() options:
+//   queue_packets  ring capacity (default 4096, at most MAX_QUEUE_PACKETS),
+//                  rounded up to a power of two
+//
+// Initialize() returns false, with getLastError() set, on a bad option.
+//
+// GetLatency(), GetBandwidth() and GetSignalStrength() report the link's
+// telemetry: smoothed RTT once RTT samples have been reported, delivered
+// throughput once traffic has been measured, and the last reported signal
+// strength. Until then they return the nominal figures. Connect() starts
+// the measurements afresh. The provider has no radio to measure signal
+// strength on: whatever drives the modem reports it through
+// GetTelemetry()->onSignalStrength(), and without that it stays nominal.
 class StarlinkProvider : public ISatelliteProvider {
 public:
+    StarlinkProvider();
+    // Telemetry measured on `clock`
+    explicit StarlinkProvider(const Common::Clock& clock);
+
     bool Initialize(const std::map<std::string, std::string>& options) override;
     bool Connect(const std::string& satellite_id) override;
     bool Disconnect() override;
@@ -17,16 +40,32 @@ public:
     double GetLatency() const override;
     uint64_t GetBandwidth() const override;
     std::unique_ptr<SatelliteStream> CreateStream() override;
+    size_t SendBatch(std::vector<ByteVector>& packets) override;
+    size_t ReceiveBatch(std::vector<ByteVector>& packets, size_t maxPackets) override;
+    LinkTelemetry* GetTelemetry() override { return &m_telemetry; }
     void setVerboseLogging(bool verbose) override {m_verboseLogging = verbose;};
 
+    std::string getLastError() const { return m_lastError; }
+
+    static constexpr size_t MAX_QUEUE_PACKETS = 1 << 20;
+
 private:
-    std::deque<ByteVector> m_dataQueue;
+    static constexpr size_t DEFAULT_QUEUE_PACKETS = 4096;
+    static constexpr double NOMINAL_LATENCY_MS = 20.0;
+    static constexpr uint64_t NOMINAL_BANDWIDTH = 100000000;
+    static constexpr double NOMINAL_SIGNAL_STRENGTH = 0.9;
+
+    std::unique_ptr<Common::SpscRing<ByteVector>> m_dataQueue;
+    LinkTelemetry m_telemetry;
     bool m_verboseLogging = false;
+    std::string m_lastError;
     class StarlinkStream : public SatelliteStream {
     public:
         explicit StarlinkStream(StarlinkProvider& provider);
         bool Write(const ByteVector& data) override;
         bool Read(ByteVector& data) override;
+        size_t WriteBatch(std::vector<ByteVector>& packets) override;
+        size_t ReadBatch(std::vector<ByteVector>& packets, size_t maxPackets) override;
         void Close() override;
 
     private:
@@ -0,0 +1,256 @@
+#include "trace_replay_provider.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+namespace SRPT {
+namespace Satellite {
+
+namespace {
+using TimePoint = std::chrono::steady_clock::time_point;
+
+std::chrono::nanoseconds serializationTime(size_t bytes, uint64_t bitsPerSecond) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(bytes * 8e9 / bitsPerSecond));
+}
+}
+
+TraceReplayProvider::TraceReplayProvider() : TraceReplayProvider(Common::SteadyClock::instance()) {}
+
+TraceReplayProvider::TraceReplayProvider(const Common::Clock& clock) : clock_(clock) {}
+
+TraceReplayProvider::TraceReplayProvider(const CongestionControl::LinkTrace& trace, const Common::Clock& clock)
+    : clock_(clock), trace_(trace) {}
+
+bool TraceReplayProvider::Initialize(const std::map<std::string, std::string>& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto option = [&](const char* key) {
+        auto it = options.find(key);
+        return it == options.end() ? std::string() : it->second;
+    };
+    try {
+        if (!option("trace").empty()) {
+            CongestionControl::LinkTrace trace;
+            if (!trace.load(option("trace"))) {
+                lastError_ = trace.getLastError();
+                return false;
+            }
+            trace_ = std::move(trace);
+        }
+        if (trace_.empty()) {
+            lastError_ = "No trace to replay";
+            return false;
+        }
+        loop_ = option("loop") != "false";
+        if (!option("start_ms").empty()) {
+            startOffset_ = std::chrono::milliseconds(std::stoll(option("start_ms")));
+        }
+        if (!option("buffer_bytes").empty()) {
+            bufferBytes_ = std::stoull(option("buffer_bytes"));
+        }
+        if (!option("seed").empty()) {
+            rng_.seed(std::stoull(option("seed")));
+        }
+    } catch (const std::exception&) {
+        lastError_ = "Invalid numeric option";
+        return false;
+    }
+    return true;
+}
+
+bool TraceReplayProvider::Connect(const std::string&) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (trace_.empty()) {
+        lastError_ = "No trace to replay";
+        return false;
+    }
+    TimePoint now = clock_.now();
+    if (verboseLogging_) {
+        std::cout << "TraceReplayProvider::Connect - replaying " << trace_.getProvider() << " trace from "
+                  << startOffset_.count() << " ms" << std::endl;
+    }
+    connected_ = true;
+    replayStart_ = now - startOffset_;
+    linkFree_ = now;
+    lastArrival_ = now;
+    inFlight_.clear();
+    return true;
+}
+
+bool TraceReplayProvider::Disconnect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = false;
+    inFlight_.clear();
+    return true;
+}
+
+bool TraceReplayProvider::SendData(const ByteVector& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connected_) {
+        lastError_ = "Not connected";
+        return false;
+    }
+    TimePoint now = clock_.now();
+    auto position = positionLocked(now);
+    if (outageLocked(position)) {
+        ++stats_.outageDrops;
+        lastError_ = "Link outage";
+        return false;
+    }
+    ++stats_.packetsSent;
+    auto sample = sampleLocked(position);
+    if (std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < sample.lossRate) {
+        ++stats_.randomLosses;
+        return true;  // Lost on the way, as far as the sender can tell
+    }
+
+    auto serialization = serializationTime(data.size(), sample.bitsPerSecond);
+    TimePoint departure = std::max(now, linkFree_) + serialization;
+    auto wait = std::chrono::duration<double>(departure - now - serialization).count();
+    uint64_t buffer = bufferBytes_ > 0 ? bufferBytes_
+                                       : static_cast<uint64_t>(sample.bitsPerSecond / 8.0 * sample.rtt.count() / 1e6);
+    if (wait * sample.bitsPerSecond / 8 > buffer) {
+        ++stats_.queueDrops;
+        return true;
+    }
+    linkFree_ = departure;
+    lastArrival_ = std::max(departure + sample.rtt, lastArrival_);
+    inFlight_.push_back(InFlight{lastArrival_, positionLocked(lastArrival_), data});
+    return true;
+}
+
+bool TraceReplayProvider::ReceiveData(ByteVector& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TimePoint now = clock_.now();
+    while (!inFlight_.empty() && inFlight_.front().arrival <= now) {
+        InFlight packet = std::move(inFlight_.front());
+        inFlight_.pop_front();
+        if (outageLocked(packet.tracePosition)) {
+            ++stats_.outageDrops;
+            continue;
+        }
+        ++stats_.packetsDelivered;
+        data = std::move(packet.data);
+        return true;
+    }
+    data.clear();
+    return false;
+}
+
+bool TraceReplayProvider::ExecuteCommand(const std::string& command, std::string& response) {
+    std::istringstream in(command);
+    std::string verb;
+    in >> verb;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (verb == "status") {
+        auto position = positionLocked(clock_.now());
+        auto sample = sampleLocked(position);
+        char buffer[160];
+        std::snprintf(buffer, sizeof(buffer), "t=%lld ms rtt=%.1f ms capacity=%.3f Mbit/s loss=%.4f%% outage=%d",
+                      static_cast<long long>(position.count()), sample.rtt.count() / 1000.0,
+                      sample.bitsPerSecond / 1e6, sample.lossRate * 100, outageLocked(position) ? 1 : 0);
+        response = buffer;
+        return true;
+    }
+    long long target = 0;
+    if (verb == "seek" && in >> target && target >= 0) {
+        if (!connected_) {
+            response = "Not connected";
+            return false;
+        }
+        // Packets in flight keep their arrival times
+        replayStart_ = clock_.now() - std::chrono::milliseconds(target);
+        response = "OK";
+        return true;
+    }
+    response = "Unknown command";
+    return false;
+}
+
+double TraceReplayProvider::GetSignalStrength() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto position = positionLocked(clock_.now());
+    if (outageLocked(position)) {
+        return 0.0;
+    }
+    return 1.0 - sampleLocked(position).lossRate;
+}
+
+double TraceReplayProvider::GetLatency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sampleLocked(positionLocked(clock_.now())).rtt.count() / 1000.0;
+}
+
+uint64_t TraceReplayProvider::GetBandwidth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto position = positionLocked(clock_.now());
+    return outageLocked(position) ? 0 : sampleLocked(position).bitsPerSecond;
+}
+
+std::unique_ptr<SatelliteStream> TraceReplayProvider::CreateStream() {
+    return std::make_unique<TraceReplayStream>(*this);
+}
+
+void TraceReplayProvider::setVerboseLogging(bool verbose) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    verboseLogging_ = verbose;
+}
+
+std::chrono::milliseconds TraceReplayProvider::getTracePosition() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return positionLocked(clock_.now());
+}
+
+bool TraceReplayProvider::inOutage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outageLocked(positionLocked(clock_.now()));
+}
+
+TraceReplayProvider::Stats TraceReplayProvider::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string TraceReplayProvider::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+std::chrono::milliseconds TraceReplayProvider::positionLocked(TimePoint now) const {
+    if (!connected_) {
+        return wrap(startOffset_);
+    }
+    return wrap(std::chrono::duration_cast<std::chrono::milliseconds>(now - replayStart_));
+}
+
+std::chrono::milliseconds TraceReplayProvider::wrap(std::chrono::milliseconds position) const {
+    auto period = trace_.duration();
+    if (loop_ && period.count() > 0) {
+        return position % period;
+    }
+    return position;
+}
+
+CongestionControl::LinkTrace::Sample TraceReplayProvider::sampleLocked(std::chrono::milliseconds position) const {
+    return trace_.sampleAt(position);
+}
+
+bool TraceReplayProvider::outageLocked(std::chrono::milliseconds position) const {
+    return trace_.inOutage(position) || sampleLocked(position).bitsPerSecond == 0;
+}
+
+// TraceReplayStream implementation
+TraceReplayProvider::TraceReplayStream::TraceReplayStream(TraceReplayProvider& provider) : m_provider(provider) {}
+
+bool TraceReplayProvider::TraceReplayStream::Write(const ByteVector& data) {
+    return m_provider.SendData(data);
+}
+
+bool TraceReplayProvider::TraceReplayStream::Read(ByteVector& data) {
+    return m_provider.ReceiveData(data);
+}
+
+void TraceReplayProvider::TraceReplayStream::Close() {}
+
+} // namespace Satellite
+} // namespace SRPT
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../../include/srpt_satellite.h"
+#include "../common/clock.h"
+#include "../congestion_control/link_trace.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+
+namespace SRPT {
+namespace Satellite {
+
+// A satellite link replayed from a recorded LinkTrace, so sessions, the
+// pacer and the congestion controllers run unchanged against the RTT,
+// capacity, loss and outages a real terminal saw.
+//
+// Like the other providers' loopback, sent data comes back on
+// ReceiveData(), here after the trace's RTT at the time of sending plus
+// the wait in a drop-tail queue draining at the trace's capacity. Packets
+// never overtake each other. Random loss and queue overflow drop packets
+// silently; during an outage SendData() fails, and packets due to arrive
+// in one are lost. GetLatency(), GetBandwidth() and GetSignalStrength()
+// follow the trace.
+//
+// The replay starts at Connect() and follows the clock it was given, so a
+// ManualClock steps through hours of trace at test speed. Thread-safe.
+//
+// Initialize() options:
+//   trace         path of a binary or text trace (required unless one was
+//                 passed to the constructor)
+//   loop          "false" to hold the last sample at the end of the trace
+//   start_ms      where in the trace Connect() starts
+//   buffer_bytes  bottleneck queue; default one BDP at the current sample
+//   seed          random loss generator seed
+// Commands: "status", and "seek <ms>" to jump within the trace.
+class TraceReplayProvider : public ISatelliteProvider {
+public:
+    struct Stats {
+        uint64_t packetsSent = 0;
+        uint64_t packetsDelivered = 0;
+        uint64_t randomLosses = 0;
+        uint64_t queueDrops = 0;
+        uint64_t outageDrops = 0;  // Refused sends and packets lost in flight
+    };
+
+    TraceReplayProvider();
+    explicit TraceReplayProvider(const Common::Clock& clock);
+    explicit TraceReplayProvider(const CongestionControl::LinkTrace& trace,
+                                 const Common::Clock& clock = Common::SteadyClock::instance());
+
+    bool Initialize(const std::map<std::string, std::string>& options) override;
+    bool Connect(const std::string& satellite_id) override;
+    bool Disconnect() override;
+    bool SendData(const ByteVector& data) override;
+    bool ReceiveData(ByteVector& data) override;
+    bool ExecuteCommand(const std::string& command, std::string& response) override;
+    double GetSignalStrength() const override;
+    // Trace RTT in ms
+    double GetLatency() const override;
+    // Trace capacity in bits/s; 0 during an outage
+    uint64_t GetBandwidth() const override;
+    std::unique_ptr<SatelliteStream> CreateStream() override;
+    void setVerboseLogging(bool verbose) override;
+
+    // Position in the trace; 0 until Connect()
+    std::chrono::milliseconds getTracePosition() const;
+    bool inOutage() const;
+    const CongestionControl::LinkTrace& getTrace() const { return trace_; }
+    Stats getStats() const;
+    std::string getLastError() const;
+
+private:
+    struct InFlight {
+        std::chrono::steady_clock::time_point arrival;
+        std::chrono::milliseconds tracePosition;  // At arrival
+        ByteVector data;
+    };
+
+    const Common::Clock& clock_;
+    CongestionControl::LinkTrace trace_;
+    mutable std::mutex mutex_;
+    bool connected_ = false;
+    bool loop_ = true;
+    std::chrono::milliseconds startOffset_{0};
+    uint64_t bufferBytes_ = 0;
+    std::chrono::steady_clock::time_point replayStart_;
+    std::chrono::steady_clock::time_point linkFree_;
+    std::chrono::steady_clock::time_point lastArrival_;
+    std::deque<InFlight> inFlight_;
+    std::mt19937_64 rng_{1};
+    Stats stats_;
+    bool verboseLogging_ = false;
+    std::string lastError_;
+
+    std::chrono::milliseconds positionLocked(std::chrono::steady_clock::time_point now) const;
+    std::chrono::milliseconds wrap(std::chrono::milliseconds position) const;
+    CongestionControl::LinkTrace::Sample sampleLocked(std::chrono::milliseconds position) const;
+    bool outageLocked(std::chrono::milliseconds position) const;
+
+    class TraceReplayStream : public SatelliteStream {
+    public:
+        explicit TraceReplayStream(TraceReplayProvider& provider);
+        bool Write(const ByteVector& data) override;
+        bool Read(ByteVector& data) override;
+        void Close() override;
+
+    private:
+        TraceReplayProvider& m_provider;
+    };
+};
+
+} // namespace Satellite
+} // namespace SRPT
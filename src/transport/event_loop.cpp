@@ -0,0 +1,164 @@
+#include "event_loop.h"
+#include <algorithm>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace SRPT {
+namespace Transport {
+
+EventLoop::EventLoop(std::chrono::milliseconds tickInterval)
+    : epollFd_(epoll_create1(EPOLL_CLOEXEC)),
+      wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      stopped_(false),
+      timers_(tickInterval) {
+    if (isValid()) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.fd = wakeFd_;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (wakeFd_ >= 0) {
+        ::close(wakeFd_);
+    }
+    if (epollFd_ >= 0) {
+        ::close(epollFd_);
+    }
+}
+
+bool EventLoop::addFd(int fd, uint32_t events, Handler handler) {
+    epoll_event event{};
+    event.events = events | EPOLLET;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return false;
+    }
+    handlers_[fd] = std::make_shared<Handler>(std::move(handler));
+    return true;
+}
+
+bool EventLoop::modifyFd(int fd, uint32_t events) {
+    epoll_event event{};
+    event.events = events | EPOLLET;
+    event.data.fd = fd;
+    return epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::removeFd(int fd) {
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    handlers_.erase(fd);
+}
+
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        tasks_.push_back(std::move(task));
+    }
+    wake();
+}
+
+void EventLoop::defer(Task task) {
+    deferred_.push_back(std::move(task));
+}
+
+size_t EventLoop::runOnce(std::chrono::milliseconds maxWait) {
+    auto now = TimerWheel::Clock::now();
+    auto wait = maxWait;
+    if (!deferred_.empty()) {
+        wait = std::chrono::milliseconds(0);
+    } else if (timers_.pendingCount() > 0) {
+        wait = std::min(wait, timers_.timeUntilNextTick(now));
+    }
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        if (!tasks_.empty()) {
+            wait = std::chrono::milliseconds(0);
+        }
+    }
+
+    epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(epollFd_, events, MAX_EVENTS, static_cast<int>(wait.count()));
+    size_t dispatched = 0;
+
+    for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == wakeFd_) {
+            uint64_t value;
+            while (::read(wakeFd_, &value, sizeof(value)) > 0) {
+            }
+            continue;
+        }
+        auto it = handlers_.find(fd);
+        if (it == handlers_.end()) {
+            continue;  // Removed by an earlier handler in this batch
+        }
+        // Hold a reference so the handler may remove itself
+        std::shared_ptr<Handler> handler = it->second;
+        (*handler)(events[i].events);
+        ++dispatched;
+    }
+
+    dispatched += timers_.advance(TimerWheel::Clock::now());
+    dispatched += runTasks();
+    dispatched += runDeferred();
+    return dispatched;
+}
+
+void EventLoop::run() {
+    while (!stopped_) {
+        runOnce(std::chrono::milliseconds(1000));
+    }
+    stopped_ = false;  // Allow the loop to be run again
+}
+
+bool EventLoop::runUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return done();
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+        runOnce(std::min(remaining, std::chrono::milliseconds(100)));
+    }
+    return true;
+}
+
+void EventLoop::stop() {
+    stopped_ = true;
+    wake();
+}
+
+void EventLoop::wake() {
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+size_t EventLoop::runTasks() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        tasks.swap(tasks_);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+    return tasks.size();
+}
+
+size_t EventLoop::runDeferred() {
+    std::vector<Task> deferred;
+    deferred.swap(deferred_);
+    for (auto& task : deferred) {
+        task();
+    }
+    return deferred.size();
+}
+
+} // namespace Transport
+} // namespace SRPT
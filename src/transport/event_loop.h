@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../core/srpt_timer_wheel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace SRPT {
+namespace Transport {
+
+// Single-threaded epoll reactor. Descriptors are registered edge-triggered,
+// so handlers must drain their descriptor until EAGAIN. Timers run on the
+// loop's TimerWheel and the epoll timeout is bounded by the next wheel tick.
+class EventLoop {
+public:
+    using Handler = std::function<void(uint32_t events)>;
+    using Task = std::function<void()>;
+
+    explicit EventLoop(std::chrono::milliseconds tickInterval = std::chrono::milliseconds(10));
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool isValid() const { return epollFd_ >= 0 && wakeFd_ >= 0; }
+
+    // `events` is a mask of EPOLLIN / EPOLLOUT; EPOLLET is always added
+    bool addFd(int fd, uint32_t events, Handler handler);
+    bool modifyFd(int fd, uint32_t events);
+    void removeFd(int fd);
+
+    TimerWheel& timers() { return timers_; }
+
+    // Thread-safe: queue a task to run on the loop thread and wake it
+    void post(Task task);
+    // Loop thread only: run `task` at the end of the current iteration, after
+    // I/O, timers and posted tasks. Used to flush batched output.
+    void defer(Task task);
+
+    // Wait at most `maxWait` for events, then dispatch I/O, timers and posted
+    // tasks. Returns the number of handlers, timers and tasks that ran.
+    size_t runOnce(std::chrono::milliseconds maxWait);
+
+    // Run until stop() is called. A stop() issued before run() makes it return at once.
+    void run();
+    // Run until `done` returns true or `timeout` elapses; returns done()
+    bool runUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout);
+
+    // Thread-safe
+    void stop();
+
+private:
+    static constexpr int MAX_EVENTS = 64;
+
+    int epollFd_;
+    int wakeFd_;
+    std::atomic<bool> stopped_;
+    TimerWheel timers_;
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers_;
+    std::mutex taskMutex_;
+    std::vector<Task> tasks_;
+    std::vector<Task> deferred_;
+
+    void wake();
+    size_t runTasks();
+    size_t runDeferred();
+};
+
+} // namespace Transport
+} // namespace SRPT
@@ -0,0 +1,319 @@
+#include "io_ring.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace SRPT {
+namespace Transport {
+
+IoRing::IoRing(EventLoop& loop, unsigned entries) : loop_(loop) {
+    io_uring_params params{};
+    // Multishot receives can post many CQEs per SQE
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 4;
+
+    ringFd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd_ < 0) {
+        lastError_ = std::string("io_uring_setup: ") + std::strerror(errno);
+        return;
+    }
+
+    size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    ringSize_ = singleMap ? std::max(sqSize, cqSize) : sqSize;
+    ringMemory_ = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                       IORING_OFF_SQ_RING);
+    void* cqMemory = ringMemory_;
+    if (ringMemory_ != MAP_FAILED && !singleMap) {
+        completionSize_ = cqSize;
+        completionMemory_ = mmap(nullptr, completionSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                 ringFd_, IORING_OFF_CQ_RING);
+        cqMemory = completionMemory_;
+    }
+    sqeSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqeMemory_ = mmap(nullptr, sqeSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_,
+                      IORING_OFF_SQES);
+    if (ringMemory_ == MAP_FAILED || cqMemory == MAP_FAILED || sqeMemory_ == MAP_FAILED) {
+        lastError_ = std::string("mmap: ") + std::strerror(errno);
+        if (ringMemory_ == MAP_FAILED) {
+            ringMemory_ = nullptr;
+        }
+        if (completionMemory_ == MAP_FAILED) {
+            completionMemory_ = nullptr;
+        }
+        if (sqeMemory_ == MAP_FAILED) {
+            sqeMemory_ = nullptr;
+        }
+        release();
+        return;
+    }
+
+    auto* sq = static_cast<uint8_t*>(ringMemory_);
+    sq_.head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_.tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_.mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_.entries = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    sq_.array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sq_.sqes = static_cast<io_uring_sqe*>(sqeMemory_);
+
+    auto* cq = static_cast<uint8_t*>(cqMemory);
+    cq_.head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_.tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_.mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cq_.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    localTail_ = *sq_.tail;
+
+    // The ring descriptor polls readable while completions are pending
+    if (!loop_.addFd(ringFd_, EPOLLIN, [this](uint32_t) { reap(); })) {
+        lastError_ = "Failed to register io_uring with event loop";
+        release();
+    }
+}
+
+IoRing::~IoRing() {
+    alive_.reset();
+    if (ringFd_ >= 0) {
+        loop_.removeFd(ringFd_);
+    }
+    release();
+}
+
+void IoRing::release() {
+    if (sqeMemory_) {
+        munmap(sqeMemory_, sqeSize_);
+        sqeMemory_ = nullptr;
+    }
+    if (completionMemory_) {
+        munmap(completionMemory_, completionSize_);
+        completionMemory_ = nullptr;
+    }
+    if (ringMemory_) {
+        munmap(ringMemory_, ringSize_);
+        ringMemory_ = nullptr;
+    }
+    if (ringFd_ >= 0) {
+        ::close(ringFd_);
+        ringFd_ = -1;
+    }
+}
+
+io_uring_sqe* IoRing::prepare(Completion handler) {
+    if (!isValid()) {
+        return nullptr;
+    }
+    if (localTail_ - __atomic_load_n(sq_.head, __ATOMIC_ACQUIRE) >= *sq_.entries) {
+        submit();
+        if (localTail_ - __atomic_load_n(sq_.head, __ATOMIC_ACQUIRE) >= *sq_.entries) {
+            lastError_ = "Submission queue full";
+            return nullptr;
+        }
+    }
+    unsigned index = localTail_ & *sq_.mask;
+    sq_.array[index] = index;
+    ++localTail_;
+    io_uring_sqe* sqe = &sq_.sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+
+    uint64_t slot;
+    if (!freeHandlers_.empty()) {
+        slot = freeHandlers_.back();
+        freeHandlers_.pop_back();
+        handlers_[slot] = std::move(handler);
+    } else {
+        slot = handlers_.size();
+        handlers_.push_back(std::move(handler));
+    }
+    sqe->user_data = slot + 1;
+    scheduleSubmit();
+    return sqe;
+}
+
+int IoRing::submit() {
+    submitScheduled_ = false;
+    if (!isValid()) {
+        return -1;
+    }
+    // Also covers SQEs a previous short submit left behind
+    unsigned pending = localTail_ - __atomic_load_n(sq_.head, __ATOMIC_ACQUIRE);
+    if (pending == 0) {
+        return 0;
+    }
+    __atomic_store_n(sq_.tail, localTail_, __ATOMIC_RELEASE);
+    int submitted = enter(pending, 0, 0);
+    if (submitted < 0) {
+        lastError_ = std::string("io_uring_enter: ") + std::strerror(-submitted);
+        return -1;
+    }
+    stats_.submissions += static_cast<uint64_t>(submitted);
+    return submitted;
+}
+
+void IoRing::waitUntil(const std::function<bool()>& done) {
+    while (isValid() && !done()) {
+        if (reap() > 0) {
+            continue;
+        }
+        unsigned pending = localTail_ - __atomic_load_n(sq_.head, __ATOMIC_ACQUIRE);
+        __atomic_store_n(sq_.tail, localTail_, __ATOMIC_RELEASE);
+        int submitted = enter(pending, 1, IORING_ENTER_GETEVENTS);
+        if (submitted < 0 && submitted != -EINTR && submitted != -EAGAIN && submitted != -EBUSY) {
+            lastError_ = std::string("io_uring_enter: ") + std::strerror(-submitted);
+            return;
+        }
+        if (submitted > 0) {
+            stats_.submissions += static_cast<uint64_t>(submitted);
+        }
+    }
+}
+
+bool IoRing::readFile(int fd, uint64_t offset, uint8_t* buffer, size_t size, FileCallback callback) {
+    io_uring_sqe* sqe = prepare([callback = std::move(callback)](int32_t result, uint32_t) { callback(result); });
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = static_cast<uint32_t>(size);
+    sqe->off = offset;
+    return true;
+}
+
+bool IoRing::writeFile(int fd, uint64_t offset, const uint8_t* data, size_t size, FileCallback callback) {
+    io_uring_sqe* sqe = prepare([callback = std::move(callback)](int32_t result, uint32_t) { callback(result); });
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(size);
+    sqe->off = offset;
+    return true;
+}
+
+int IoRing::enter(unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    int result;
+    do {
+        ++stats_.enterCalls;
+        result = static_cast<int>(::syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete, flags, nullptr, 0));
+    } while (result < 0 && errno == EINTR && minComplete == 0);
+    return result < 0 ? -errno : result;
+}
+
+size_t IoRing::reap() {
+    size_t count = 0;
+    while (true) {
+        unsigned head = *cq_.head;
+        if (head == __atomic_load_n(cq_.tail, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        io_uring_cqe cqe = cq_.cqes[head & *cq_.mask];
+        __atomic_store_n(cq_.head, head + 1, __ATOMIC_RELEASE);
+        ++count;
+
+        if (cqe.user_data == 0 || cqe.user_data > handlers_.size()) {
+            continue;
+        }
+        uint64_t slot = cqe.user_data - 1;
+        if (cqe.flags & IORING_CQE_F_MORE) {
+            // handlers_ is a deque, so the reference survives new prepare() calls
+            handlers_[slot](cqe.res, cqe.flags);
+        } else {
+            Completion handler = std::move(handlers_[slot]);
+            handlers_[slot] = nullptr;
+            freeHandlers_.push_back(slot);
+            if (handler) {
+                handler(cqe.res, cqe.flags);
+            }
+        }
+    }
+    stats_.completions += count;
+    return count;
+}
+
+void IoRing::scheduleSubmit() {
+    if (submitScheduled_) {
+        return;
+    }
+    submitScheduled_ = true;
+    std::weak_ptr<bool> alive = alive_;
+    loop_.defer([this, alive]() {
+        if (alive.lock()) {
+            submit();
+        }
+    });
+}
+
+int IoRing::registerBuffers(unsigned opcode, void* arg, unsigned count) {
+    int result = static_cast<int>(::syscall(__NR_io_uring_register, ringFd_, opcode, arg, count));
+    if (result < 0) {
+        lastError_ = std::string("io_uring_register: ") + std::strerror(errno);
+    }
+    return result;
+}
+
+BufferRing::BufferRing(IoRing& ring, uint16_t groupId, uint16_t count, uint32_t bufferSize)
+    : ring_(ring), groupId_(groupId), count_(1), bufferSize_(bufferSize) {
+    while (count_ < count && count_ < 32768) {
+        count_ <<= 1;
+    }
+    if (!ring_.isValid()) {
+        return;
+    }
+    ringSize_ = count_ * sizeof(io_uring_buf);
+    ringMemory_ = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ringMemory_ == MAP_FAILED) {
+        ringMemory_ = nullptr;
+        return;
+    }
+    bufRing_ = static_cast<io_uring_buf_ring*>(ringMemory_);
+
+    io_uring_buf_reg registration{};
+    registration.ring_addr = reinterpret_cast<uint64_t>(ringMemory_);
+    registration.ring_entries = count_;
+    registration.bgid = groupId_;
+    if (ring_.registerBuffers(IORING_REGISTER_PBUF_RING, &registration, 1) != 0) {
+        return;
+    }
+    registered_ = true;
+
+    storage_.resize(static_cast<size_t>(count_) * bufferSize_);
+    for (uint16_t id = 0; id < count_; ++id) {
+        add(id);
+    }
+    __atomic_store_n(&bufRing_->tail, tail_, __ATOMIC_RELEASE);
+}
+
+BufferRing::~BufferRing() {
+    if (registered_) {
+        io_uring_buf_reg registration{};
+        registration.bgid = groupId_;
+        ring_.registerBuffers(IORING_UNREGISTER_PBUF_RING, &registration, 1);
+    }
+    if (ringMemory_) {
+        munmap(ringMemory_, ringSize_);
+    }
+}
+
+void BufferRing::recycle(uint16_t id) {
+    add(id);
+    __atomic_store_n(&bufRing_->tail, tail_, __ATOMIC_RELEASE);
+}
+
+void BufferRing::add(uint16_t id) {
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(ringMemory_)[tail_ & (count_ - 1)];
+    entry.addr = reinterpret_cast<uint64_t>(buffer(id));
+    entry.len = bufferSize_;
+    entry.bid = id;
+    ++tail_;
+}
+
+} // namespace Transport
+} // namespace SRPT
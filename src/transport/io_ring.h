@@ -0,0 +1,147 @@
+#pragma once
+
+#include "event_loop.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <linux/io_uring.h>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace SRPT {
+namespace Transport {
+
+// io_uring instance driven by an EventLoop. The ring descriptor is
+// registered with the loop, so completions are reaped from the loop thread
+// alongside epoll I/O and timers. Everything prepared during a loop
+// iteration is submitted with a single io_uring_enter at the end of it.
+// Talks to the kernel through raw syscalls; no liburing dependency.
+// Loop thread only.
+class IoRing {
+public:
+    // `result` is the CQE result (negative errno on failure)
+    using Completion = std::function<void(int32_t result, uint32_t flags)>;
+    using FileCallback = std::function<void(ssize_t result)>;
+
+    struct Stats {
+        uint64_t enterCalls = 0;
+        uint64_t submissions = 0;
+        uint64_t completions = 0;
+    };
+
+    explicit IoRing(EventLoop& loop, unsigned entries = 256);
+    ~IoRing();
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    bool isValid() const { return ringFd_ >= 0; }
+    int fd() const { return ringFd_; }
+
+    // Zeroed SQE whose completion runs `handler`. Multishot requests keep the
+    // handler while their CQEs carry IORING_CQE_F_MORE. Returns nullptr if
+    // the submission queue is still full after flushing it.
+    io_uring_sqe* prepare(Completion handler);
+
+    // Submit everything prepared so far; returns the number submitted or -1
+    int submit();
+
+    // Block until `done` returns true, reaping completions as they arrive.
+    // Used for teardown, when the loop can no longer be relied on.
+    void waitUntil(const std::function<bool()>& done);
+
+    // File I/O on the same ring. The buffer must stay valid until `callback`.
+    // Building blocks for spooling packages to and from disk: the transport
+    // itself only moves packets, and SRPTReassembly keeps packages in memory,
+    // so nothing in the library calls these yet.
+    bool readFile(int fd, uint64_t offset, uint8_t* buffer, size_t size, FileCallback callback);
+    bool writeFile(int fd, uint64_t offset, const uint8_t* data, size_t size, FileCallback callback);
+
+    const Stats& getStats() const { return stats_; }
+    std::string getLastError() const { return lastError_; }
+
+private:
+    friend class BufferRing;
+
+    struct SubmissionQueue {
+        unsigned* head = nullptr;
+        unsigned* tail = nullptr;
+        unsigned* mask = nullptr;
+        unsigned* entries = nullptr;
+        unsigned* array = nullptr;
+        io_uring_sqe* sqes = nullptr;
+    };
+
+    struct CompletionQueue {
+        unsigned* head = nullptr;
+        unsigned* tail = nullptr;
+        unsigned* mask = nullptr;
+        io_uring_cqe* cqes = nullptr;
+    };
+
+    EventLoop& loop_;
+    int ringFd_ = -1;
+    void* ringMemory_ = nullptr;
+    size_t ringSize_ = 0;
+    void* completionMemory_ = nullptr;  // Only without IORING_FEAT_SINGLE_MMAP
+    size_t completionSize_ = 0;
+    void* sqeMemory_ = nullptr;
+    size_t sqeSize_ = 0;
+    SubmissionQueue sq_;
+    CompletionQueue cq_;
+    unsigned localTail_ = 0;  // SQEs prepared but not yet published
+
+    // Completion handlers indexed by user_data - 1
+    std::deque<Completion> handlers_;
+    std::vector<uint64_t> freeHandlers_;
+    bool submitScheduled_ = false;
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+    Stats stats_;
+    std::string lastError_;
+
+    void release();
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags);
+    size_t reap();
+    void scheduleSubmit();
+    int registerBuffers(unsigned opcode, void* arg, unsigned count);
+};
+
+// Provided buffer ring (IORING_REGISTER_PBUF_RING). Receives with
+// IOSQE_BUFFER_SELECT pick a buffer from the group; the owner hands each
+// buffer back with recycle() once the data is consumed.
+class BufferRing {
+public:
+    // `count` is rounded up to a power of two
+    BufferRing(IoRing& ring, uint16_t groupId, uint16_t count, uint32_t bufferSize);
+    ~BufferRing();
+
+    BufferRing(const BufferRing&) = delete;
+    BufferRing& operator=(const BufferRing&) = delete;
+
+    bool isValid() const { return registered_; }
+    uint16_t groupId() const { return groupId_; }
+    uint32_t bufferSize() const { return bufferSize_; }
+    uint8_t* buffer(uint16_t id) { return storage_.data() + static_cast<size_t>(id) * bufferSize_; }
+
+    void recycle(uint16_t id);
+
+private:
+    IoRing& ring_;
+    uint16_t groupId_;
+    uint16_t count_;
+    uint32_t bufferSize_;
+    void* ringMemory_ = nullptr;
+    size_t ringSize_ = 0;
+    io_uring_buf_ring* bufRing_ = nullptr;
+    uint16_t tail_ = 0;
+    bool registered_ = false;
+    std::vector<uint8_t> storage_;
+
+    void add(uint16_t id);
+};
+
+} // namespace Transport
+} // namespace SRPT
@@ -0,0 +1,405 @@
+#include "../../include/srpt.h"
+#include "event_loop.h"
+#include "udp_transport.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace SRPT {
+
+void Config::setKeepAliveInterval(std::chrono::seconds interval) {
+    keepAliveInterval_ = interval;
+}
+
+void Config::setReceiveWindowSize(uint32_t size) {
+    receiveWindowSize_ = size;
+}
+
+void Config::setMaxPacketSize(uint32_t size) {
+    maxPacketSize_ = std::max<uint32_t>(size, 1);
+}
+
+// Session state is owned by a private event loop thread. User-facing calls
+// exchange data with it through the queues below and wake it with post().
+class Session::Impl {
+public:
+    explicit Impl(const Config& config) : config_(config), transport_(loop_) {}
+    ~Impl();
+
+    bool Connect(const std::string& host, uint16_t port);
+    bool Listen(uint16_t port);
+    bool Write(const ByteVector& data);
+    bool Read(ByteVector& data);
+    void Close();
+
+    ConnectionState GetState() const;
+    uint16_t GetLocalPort() const;
+    uint32_t GetAvailableWindowSize() const;
+    std::string GetLastError() const;
+    void SetConnectionCallback(std::function<void(bool)> callback);
+    void SetErrorCallback(std::function<void(const std::string&)> callback);
+    Stats GetStats() const;
+
+private:
+    static constexpr std::chrono::seconds HANDSHAKE_TIMEOUT{10};
+
+    Config config_;
+    Transport::EventLoop loop_;
+    Transport::UdpTransport transport_;
+    std::thread loopThread_;
+    std::atomic<bool> running_{false};
+
+    // Loop thread only
+    SRPTConnection* connection_ = nullptr;
+
+    // Shared with user threads
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    ConnectionState state_ = ConnectionState::CLOSED;
+    uint16_t localPort_ = 0;
+    uint32_t availableWindow_ = 0;
+    std::deque<ByteVector> outgoing_;
+    std::deque<ByteVector> incoming_;
+    Stats stats_{};
+    std::string lastError_;
+    bool notifiedEstablished_ = false;
+    bool awaitingPeer_ = false;  // Listening and no peer adopted yet
+    std::function<void(bool)> connectionCallback_;
+    std::function<void(const std::string&)> errorCallback_;
+
+    bool start(const Transport::Endpoint& local, bool listen);
+    void loopMain();
+    void adopt(SRPTConnection& connection);
+    void pump();
+    void fail(const std::string& error);
+    static ConnectionState mapState(SRPTConnectionState state);
+};
+
+Session::Impl::~Impl() {
+    if (running_) {
+        running_ = false;
+        loop_.stop();
+        loopThread_.join();
+    }
+}
+
+bool Session::Impl::Connect(const std::string& host, uint16_t port) {
+    Transport::Endpoint peer;
+    if (!Transport::Endpoint::resolve(host, port, peer)) {
+        fail("Failed to resolve " + host);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_.clear();
+    }
+    if (!start(Transport::Endpoint::any(0, peer.address.ss_family), false)) {
+        return false;
+    }
+
+    loop_.post([this, peer]() {
+        SRPTConnection* connection = transport_.connect(peer);
+        if (!connection) {
+            fail(transport_.getLastError());
+            return;
+        }
+        adopt(*connection);
+    });
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool established = changed_.wait_for(lock, HANDSHAKE_TIMEOUT, [this]() {
+        return state_ == ConnectionState::ESTABLISHED || !lastError_.empty();
+    });
+    if (established && state_ == ConnectionState::ESTABLISHED) {
+        return true;
+    }
+    auto callback = connectionCallback_;
+    lock.unlock();
+    if (!established) {
+        fail("Connection to " + peer.toString() + " timed out");
+    }
+    if (callback) {
+        callback(false);
+    }
+    return false;
+}
+
+bool Session::Impl::Listen(uint16_t port) {
+    return start(Transport::Endpoint::any(port), true);
+}
+
+bool Session::Impl::Write(const ByteVector& data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != ConnectionState::ESTABLISHED) {
+            lastError_ = "Session is not established";
+            return false;
+        }
+        size_t chunkSize = config_.getMaxPacketSize();
+        for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+            size_t end = std::min(data.size(), offset + chunkSize);
+            outgoing_.emplace_back(data.begin() + offset, data.begin() + end);
+        }
+    }
+    loop_.post([]() {});  // Wake the loop so pump() flushes the queue
+    return true;
+}
+
+bool Session::Impl::Read(ByteVector& data) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() {
+        return !incoming_.empty() || !running_ ||
+               (!awaitingPeer_ && state_ != ConnectionState::ESTABLISHED && state_ != ConnectionState::CONNECTING);
+    });
+    if (incoming_.empty()) {
+        return false;
+    }
+    data = std::move(incoming_.front());
+    incoming_.pop_front();
+    return true;
+}
+
+void Session::Impl::Close() {
+    if (!running_) {
+        return;
+    }
+    loop_.post([this]() {
+        if (!connection_) {
+            return;
+        }
+        if (connection_->getState() == SRPTConnectionState::ESTABLISHED) {
+            connection_->initiateClose();
+        } else if (connection_->getState() == SRPTConnectionState::CLOSE_WAIT) {
+            connection_->close();
+        }
+    });
+}
+
+ConnectionState Session::Impl::GetState() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+uint16_t Session::Impl::GetLocalPort() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return localPort_;
+}
+
+uint32_t Session::Impl::GetAvailableWindowSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return availableWindow_;
+}
+
+std::string Session::Impl::GetLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+void Session::Impl::SetConnectionCallback(std::function<void(bool)> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connectionCallback_ = std::move(callback);
+}
+
+void Session::Impl::SetErrorCallback(std::function<void(const std::string&)> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    errorCallback_ = std::move(callback);
+}
+
+Session::Stats Session::Impl::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool Session::Impl::start(const Transport::Endpoint& local, bool listen) {
+    if (running_) {
+        return true;
+    }
+    if (!loop_.isValid()) {
+        fail("Failed to create event loop");
+        return false;
+    }
+    // The loop thread is not running yet, so the transport can be set up here
+    if (!transport_.bind(local)) {
+        fail(transport_.getLastError());
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        localPort_ = transport_.localEndpoint().port();
+    }
+    if (listen) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            awaitingPeer_ = true;
+        }
+        transport_.listen([this](SRPTConnection& connection, const Transport::Endpoint&) {
+            if (!connection_) {
+                adopt(connection);  // A session carries a single peer
+            }
+        });
+    }
+    running_ = true;
+    loopThread_ = std::thread(&Impl::loopMain, this);
+    return true;
+}
+
+void Session::Impl::loopMain() {
+    while (running_) {
+        loop_.runOnce(std::chrono::milliseconds(10));
+        pump();
+    }
+    changed_.notify_all();
+}
+
+void Session::Impl::adopt(SRPTConnection& connection) {
+    connection_ = &connection;
+    connection.setKeepAliveInterval(config_.getKeepAliveInterval());
+    connection.setReceiveWindowSize(config_.getReceiveWindowSize());
+    connection.setDataHandler([this](const std::vector<uint8_t>& data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming_.push_back(data);
+        }
+        changed_.notify_all();
+    });
+}
+
+void Session::Impl::pump() {
+    std::function<void(bool)> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (connection_) {
+            while (!outgoing_.empty() &&
+                   connection_->getState() == SRPTConnectionState::ESTABLISHED &&
+                   connection_->sendData(outgoing_.front())) {
+                outgoing_.pop_front();
+            }
+            state_ = mapState(connection_->getState());
+            awaitingPeer_ = false;
+            availableWindow_ = connection_->getAvailableWindowSize();
+        }
+        const auto& transportStats = transport_.getStats();
+        stats_.bytes_sent = transportStats.bytesSent;
+        stats_.bytes_received = transportStats.bytesReceived;
+        stats_.packets_sent = transportStats.packetsSent;
+        stats_.packets_received = transportStats.packetsReceived;
+
+        if (state_ == ConnectionState::ESTABLISHED && !notifiedEstablished_) {
+            notifiedEstablished_ = true;
+            callback = connectionCallback_;
+        }
+    }
+    changed_.notify_all();
+    if (callback) {
+        callback(true);
+    }
+}
+
+void Session::Impl::fail(const std::string& error) {
+    std::function<void(const std::string&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_ = error;
+        callback = errorCallback_;
+    }
+    changed_.notify_all();
+    if (callback) {
+        callback(error);
+    }
+}
+
+ConnectionState Session::Impl::mapState(SRPTConnectionState state) {
+    switch (state) {
+        case SRPTConnectionState::CLOSED:
+            return ConnectionState::CLOSED;
+        case SRPTConnectionState::SYN_SENT:
+        case SRPTConnectionState::SYN_RECEIVED:
+            return ConnectionState::CONNECTING;
+        case SRPTConnectionState::ESTABLISHED:
+            return ConnectionState::ESTABLISHED;
+        default:
+            return ConnectionState::CLOSING;
+    }
+}
+
+namespace {
+
+class SessionStream : public Stream {
+public:
+    explicit SessionStream(Session& session, std::function<bool(const ByteVector&)> write,
+                           std::function<bool(ByteVector&)> read)
+        : session_(session), write_(std::move(write)), read_(std::move(read)) {}
+
+    bool Write(const ByteVector& data) override { return write_(data); }
+    bool Read(ByteVector& data) override { return read_(data); }
+    void Close() override { session_.Close(); }
+
+private:
+    Session& session_;
+    std::function<bool(const ByteVector&)> write_;
+    std::function<bool(ByteVector&)> read_;
+};
+
+} // namespace
+
+// Session method implementations
+Session::Session(const Config& config) : pImpl(std::make_unique<Impl>(config)) {}
+
+Session::~Session() = default;
+
+bool Session::Connect(const std::string& host, uint16_t port) {
+    return pImpl->Connect(host, port);
+}
+
+bool Session::Listen(uint16_t port) {
+    return pImpl->Listen(port);
+}
+
+std::unique_ptr<Stream> Session::CreateStream() {
+    Impl* impl = pImpl.get();
+    return std::make_unique<SessionStream>(
+        *this,
+        [impl](const ByteVector& data) { return impl->Write(data); },
+        [impl](ByteVector& data) { return impl->Read(data); });
+}
+
+ConnectionState Session::GetState() const {
+    return pImpl->GetState();
+}
+
+uint16_t Session::GetLocalPort() const {
+    return pImpl->GetLocalPort();
+}
+
+bool Session::IsEstablished() const {
+    return pImpl->GetState() == ConnectionState::ESTABLISHED;
+}
+
+void Session::Close() {
+    pImpl->Close();
+}
+
+uint32_t Session::GetAvailableWindowSize() const {
+    return pImpl->GetAvailableWindowSize();
+}
+
+std::string Session::GetLastError() const {
+    return pImpl->GetLastError();
+}
+
+void Session::SetConnectionCallback(std::function<void(bool)> callback) {
+    pImpl->SetConnectionCallback(std::move(callback));
+}
+
+void Session::SetErrorCallback(std::function<void(const std::string&)> callback) {
+    pImpl->SetErrorCallback(std::move(callback));
+}
+
+Session::Stats Session::GetStats() const {
+    return pImpl->GetStats();
+}
+
+} // namespace SRPT
@@ -0,0 +1,453 @@
+#include "udp_socket.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <linux/net_tstamp.h>
+#include <netinet/udp.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#ifndef SO_TXTIME
+#define SO_TXTIME 61
+#define SCM_TXTIME SO_TXTIME
+#endif
+
+namespace SRPT {
+namespace Transport {
+
+bool Endpoint::resolve(const std::string& host, uint16_t port, Endpoint& out) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0 || !result) {
+        return false;
+    }
+    std::memcpy(&out.address, result->ai_addr, result->ai_addrlen);
+    out.length = static_cast<socklen_t>(result->ai_addrlen);
+    freeaddrinfo(result);
+    return true;
+}
+
+Endpoint Endpoint::loopback(uint16_t port) {
+    Endpoint endpoint;
+    auto* in = reinterpret_cast<sockaddr_in*>(&endpoint.address);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(port);
+    in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    endpoint.length = sizeof(sockaddr_in);
+    return endpoint;
+}
+
+Endpoint Endpoint::any(uint16_t port, int family) {
+    Endpoint endpoint;
+    if (family == AF_INET6) {
+        auto* in6 = reinterpret_cast<sockaddr_in6*>(&endpoint.address);
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(port);
+        in6->sin6_addr = in6addr_any;
+        endpoint.length = sizeof(sockaddr_in6);
+        return endpoint;
+    }
+    auto* in = reinterpret_cast<sockaddr_in*>(&endpoint.address);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(port);
+    in->sin_addr.s_addr = htonl(INADDR_ANY);
+    endpoint.length = sizeof(sockaddr_in);
+    return endpoint;
+}
+
+uint16_t Endpoint::port() const {
+    if (address.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<const sockaddr_in*>(&address)->sin_port);
+    }
+    if (address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const sockaddr_in6*>(&address)->sin6_port);
+    }
+    return 0;
+}
+
+std::string Endpoint::toString() const {
+    char host[INET6_ADDRSTRLEN] = {0};
+    if (address.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(&address)->sin_addr, host, sizeof(host));
+        return std::string(host) + ":" + std::to_string(port());
+    }
+    if (address.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6*>(&address)->sin6_addr, host, sizeof(host));
+        return "[" + std::string(host) + "]:" + std::to_string(port());
+    }
+    return "<unspecified>";
+}
+
+bool Endpoint::operator==(const Endpoint& other) const {
+    if (address.ss_family != other.address.ss_family) {
+        return false;
+    }
+    if (address.ss_family == AF_INET) {
+        auto* a = reinterpret_cast<const sockaddr_in*>(&address);
+        auto* b = reinterpret_cast<const sockaddr_in*>(&other.address);
+        return a->sin_port == b->sin_port && a->sin_addr.s_addr == b->sin_addr.s_addr;
+    }
+    if (address.ss_family == AF_INET6) {
+        auto* a = reinterpret_cast<const sockaddr_in6*>(&address);
+        auto* b = reinterpret_cast<const sockaddr_in6*>(&other.address);
+        return a->sin6_port == b->sin6_port &&
+               std::memcmp(&a->sin6_addr, &b->sin6_addr, sizeof(in6_addr)) == 0;
+    }
+    return length == other.length && std::memcmp(&address, &other.address, length) == 0;
+}
+
+size_t EndpointHash::operator()(const Endpoint& endpoint) const {
+    size_t hash = std::hash<uint16_t>()(endpoint.port());
+    if (endpoint.address.ss_family == AF_INET) {
+        auto* in = reinterpret_cast<const sockaddr_in*>(&endpoint.address);
+        hash ^= std::hash<uint32_t>()(in->sin_addr.s_addr) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    } else if (endpoint.address.ss_family == AF_INET6) {
+        auto* in6 = reinterpret_cast<const sockaddr_in6*>(&endpoint.address);
+        std::string bytes(reinterpret_cast<const char*>(&in6->sin6_addr), sizeof(in6_addr));
+        hash ^= std::hash<std::string>()(bytes) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+ReceiveBatch::ReceiveBatch(size_t slots, size_t slotSize)
+    : slotSize_(slotSize),
+      buffer_(slots * slotSize),
+      control_(slots * CONTROL_SIZE),
+      peers_(slots),
+      iov_(slots),
+      headers_(slots) {
+    datagrams_.reserve(slots);
+    for (size_t i = 0; i < slots; ++i) {
+        iov_[i].iov_base = buffer_.data() + i * slotSize_;
+        iov_[i].iov_len = slotSize_;
+        msghdr& header = headers_[i].msg_hdr;
+        header = msghdr{};
+        header.msg_iov = &iov_[i];
+        header.msg_iovlen = 1;
+        header.msg_control = control_.data() + i * CONTROL_SIZE;
+    }
+}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+UdpSocket::UdpSocket(UdpSocket&& other) noexcept
+    : fd_(other.fd_),
+      wouldBlock_(other.wouldBlock_),
+      gso_(other.gso_),
+      gro_(other.gro_),
+      txTime_(other.txTime_),
+      lastErrno_(other.lastErrno_),
+      lastError_(std::move(other.lastError_)) {
+    other.fd_ = -1;
+}
+
+UdpSocket& UdpSocket::operator=(UdpSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd_ = other.fd_;
+        wouldBlock_ = other.wouldBlock_;
+        gso_ = other.gso_;
+        gro_ = other.gro_;
+        txTime_ = other.txTime_;
+        lastErrno_ = other.lastErrno_;
+        lastError_ = std::move(other.lastError_);
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+bool UdpSocket::open(int family) {
+    close();
+    fd_ = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        recordError("socket");
+        return false;
+    }
+    return true;
+}
+
+bool UdpSocket::bind(const Endpoint& local) {
+    if (!isOpen() && !open(local.address.ss_family)) {
+        return false;
+    }
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&local.address), local.length) != 0) {
+        recordError("bind");
+        return false;
+    }
+    return true;
+}
+
+void UdpSocket::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    gso_ = false;
+    gro_ = false;
+    txTime_ = false;
+}
+
+Endpoint UdpSocket::localEndpoint() const {
+    Endpoint endpoint;
+    endpoint.length = sizeof(endpoint.address);
+    if (fd_ < 0 || getsockname(fd_, reinterpret_cast<sockaddr*>(&endpoint.address), &endpoint.length) != 0) {
+        return Endpoint{};
+    }
+    return endpoint;
+}
+
+bool UdpSocket::setBufferSizes(int sendBytes, int receiveBytes) {
+    bool ok = setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &sendBytes, sizeof(sendBytes)) == 0;
+    ok = setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receiveBytes, sizeof(receiveBytes)) == 0 && ok;
+    if (!ok) {
+        recordError("setsockopt");
+    }
+    return ok;
+}
+
+ssize_t UdpSocket::sendTo(const uint8_t* data, size_t size, const Endpoint& peer, uint64_t txTime) {
+    wouldBlock_ = false;
+    ssize_t sent;
+    if (txTime != 0 && txTime_) {
+        iovec iov{const_cast<uint8_t*>(data), size};
+        alignas(cmsghdr) uint8_t control[CONTROL_SPACE];
+        msghdr header{};
+        header.msg_name = const_cast<sockaddr_storage*>(&peer.address);
+        header.msg_namelen = peer.length;
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        header.msg_control = control;
+        header.msg_controllen = buildControl(control, 0, txTime);
+        sent = ::sendmsg(fd_, &header, 0);
+    } else {
+        sent = ::sendto(fd_, data, size, 0, reinterpret_cast<const sockaddr*>(&peer.address), peer.length);
+    }
+    if (sent < 0) {
+        recordError("sendto");
+    }
+    return sent;
+}
+
+ssize_t UdpSocket::receiveFrom(uint8_t* buffer, size_t capacity, Endpoint& peer) {
+    wouldBlock_ = false;
+    peer.length = sizeof(peer.address);
+    ssize_t received = ::recvfrom(fd_, buffer, capacity, 0, reinterpret_cast<sockaddr*>(&peer.address), &peer.length);
+    if (received < 0) {
+        recordError("recvfrom");
+    }
+    return received;
+}
+
+bool UdpSocket::enableGso() {
+    // Setting a zero default segment size is a no-op that only probes support
+    int segment = 0;
+    gso_ = setsockopt(fd_, SOL_UDP, UDP_SEGMENT, &segment, sizeof(segment)) == 0;
+    if (!gso_) {
+        recordError("setsockopt(UDP_SEGMENT)");
+    }
+    return gso_;
+}
+
+bool UdpSocket::enableGro() {
+    int enable = 1;
+    gro_ = setsockopt(fd_, SOL_UDP, UDP_GRO, &enable, sizeof(enable)) == 0;
+    if (!gro_) {
+        recordError("setsockopt(UDP_GRO)");
+    }
+    return gro_;
+}
+
+bool UdpSocket::enableTxTime() {
+    sock_txtime config{};
+    config.clockid = CLOCK_MONOTONIC;
+    config.flags = 0;
+    txTime_ = setsockopt(fd_, SOL_SOCKET, SO_TXTIME, &config, sizeof(config)) == 0;
+    if (!txTime_) {
+        recordError("setsockopt(SO_TXTIME)");
+    }
+    return txTime_;
+}
+
+uint64_t UdpSocket::txTimeFor(std::chrono::steady_clock::time_point when) {
+    // steady_clock is CLOCK_MONOTONIC on Linux
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count());
+}
+
+size_t UdpSocket::buildControl(uint8_t* buffer, uint16_t segmentSize, uint64_t txTime) {
+    msghdr header{};
+    header.msg_control = buffer;
+    header.msg_controllen = CONTROL_SPACE;
+    std::memset(buffer, 0, CONTROL_SPACE);
+    size_t length = 0;
+    cmsghdr* control = CMSG_FIRSTHDR(&header);
+    if (segmentSize != 0) {
+        control->cmsg_level = SOL_UDP;
+        control->cmsg_type = UDP_SEGMENT;
+        control->cmsg_len = CMSG_LEN(sizeof(segmentSize));
+        std::memcpy(CMSG_DATA(control), &segmentSize, sizeof(segmentSize));
+        length += CMSG_SPACE(sizeof(segmentSize));
+        header.msg_controllen = length;
+        control = reinterpret_cast<cmsghdr*>(buffer + length);
+    }
+    if (txTime != 0) {
+        control->cmsg_level = SOL_SOCKET;
+        control->cmsg_type = SCM_TXTIME;
+        control->cmsg_len = CMSG_LEN(sizeof(txTime));
+        std::memcpy(CMSG_DATA(control), &txTime, sizeof(txTime));
+        length += CMSG_SPACE(sizeof(txTime));
+    }
+    return length;
+}
+
+ssize_t UdpSocket::sendBatch(const DatagramRef* datagrams, size_t count) {
+    wouldBlock_ = false;
+    size_t sent = 0;
+    sendIov_.reserve(count);
+    sendHeaders_.reserve(MAX_SEND_MESSAGES);
+    sendCounts_.reserve(MAX_SEND_MESSAGES);
+    sendSegments_.reserve(MAX_SEND_MESSAGES);
+    sendControl_.resize(MAX_SEND_MESSAGES * CONTROL_SPACE);
+
+    while (sent < count) {
+        sendIov_.clear();
+        sendHeaders_.clear();
+        sendCounts_.clear();
+        sendSegments_.clear();
+
+        // Group datagrams into messages first; iov pointers are taken once
+        // sendIov_ is complete so that its growth cannot invalidate them
+        size_t next = sent;
+        while (next < count && sendCounts_.size() < MAX_SEND_MESSAGES) {
+            size_t first = next;
+            size_t segment = datagrams[first].size;
+            size_t bytes = segment;
+            ++next;
+            if (gso_) {
+                while (next < count && next - first < MAX_GSO_SEGMENTS &&
+                       (datagrams[next].peer == datagrams[first].peer ||
+                        *datagrams[next].peer == *datagrams[first].peer) &&
+                       datagrams[next].txTime == datagrams[first].txTime &&
+                       datagrams[next].size <= segment && bytes + datagrams[next].size <= MAX_GSO_BYTES) {
+                    bytes += datagrams[next].size;
+                    bool shorter = datagrams[next].size < segment;
+                    ++next;
+                    if (shorter) {
+                        break;  // Only the final segment may be short
+                    }
+                }
+            }
+            sendSegments_.push_back(segment);
+            for (size_t i = first; i < next; ++i) {
+                sendIov_.push_back(iovec{const_cast<uint8_t*>(datagrams[i].data), datagrams[i].size});
+            }
+            sendCounts_.push_back(next - first);
+        }
+
+        size_t iovStart = 0;
+        for (size_t m = 0; m < sendCounts_.size(); ++m) {
+            mmsghdr message{};
+            msghdr& header = message.msg_hdr;
+            const DatagramRef& lead = datagrams[sent + iovStart];
+            header.msg_name = const_cast<sockaddr_storage*>(&lead.peer->address);
+            header.msg_namelen = lead.peer->length;
+            header.msg_iov = &sendIov_[iovStart];
+            header.msg_iovlen = sendCounts_[m];
+            iovStart += sendCounts_[m];
+            uint16_t segment = sendCounts_[m] > 1 ? static_cast<uint16_t>(sendSegments_[m]) : 0;
+            uint64_t txTime = txTime_ ? lead.txTime : 0;
+            if (segment != 0 || txTime != 0) {
+                uint8_t* control = sendControl_.data() + m * CONTROL_SPACE;
+                header.msg_control = control;
+                header.msg_controllen = buildControl(control, segment, txTime);
+            }
+            sendHeaders_.push_back(message);
+        }
+
+        int messages = ::sendmmsg(fd_, sendHeaders_.data(), static_cast<unsigned int>(sendHeaders_.size()), 0);
+        if (messages < 0) {
+            int error = errno;
+            if (gso_ && (error == EIO || error == EINVAL)) {
+                gso_ = false;  // No checksum offload on this route; retry unsegmented
+                continue;
+            }
+            recordError("sendmmsg");
+            return sent > 0 ? static_cast<ssize_t>(sent) : -1;
+        }
+        for (int m = 0; m < messages; ++m) {
+            sent += sendCounts_[m];
+        }
+        if (static_cast<size_t>(messages) < sendHeaders_.size()) {
+            wouldBlock_ = true;  // Socket buffer filled part way through
+            break;
+        }
+    }
+    return static_cast<ssize_t>(sent);
+}
+
+ssize_t UdpSocket::receiveBatch(ReceiveBatch& batch) {
+    wouldBlock_ = false;
+    batch.datagrams_.clear();
+    for (size_t i = 0; i < batch.slots(); ++i) {
+        msghdr& header = batch.headers_[i].msg_hdr;
+        header.msg_name = &batch.peers_[i].address;
+        header.msg_namelen = sizeof(sockaddr_storage);
+        header.msg_controllen = ReceiveBatch::CONTROL_SIZE;
+        header.msg_flags = 0;
+    }
+
+    int messages = ::recvmmsg(fd_, batch.headers_.data(), static_cast<unsigned int>(batch.slots()), 0, nullptr);
+    if (messages < 0) {
+        recordError("recvmmsg");
+        return -1;
+    }
+
+    for (int m = 0; m < messages; ++m) {
+        msghdr& header = batch.headers_[m].msg_hdr;
+        Endpoint& peer = batch.peers_[m];
+        peer.length = header.msg_namelen;
+        const uint8_t* data = batch.buffer_.data() + m * batch.slotSize_;
+        size_t length = batch.headers_[m].msg_len;
+
+        size_t segment = length;
+        for (cmsghdr* control = CMSG_FIRSTHDR(&header); control; control = CMSG_NXTHDR(&header, control)) {
+            if (control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO) {
+                int size = 0;
+                std::memcpy(&size, CMSG_DATA(control), sizeof(size));
+                if (size > 0) {
+                    segment = static_cast<size_t>(size);
+                }
+            }
+        }
+        for (size_t offset = 0; offset < length; offset += segment) {
+            batch.datagrams_.push_back(ReceivedDatagram{&peer, data + offset, std::min(segment, length - offset)});
+        }
+    }
+    return static_cast<ssize_t>(batch.datagrams_.size());
+}
+
+void UdpSocket::recordError(const char* operation) {
+    int error = errno;
+    wouldBlock_ = (error == EAGAIN || error == EWOULDBLOCK);
+    lastErrno_ = error;
+    lastError_ = std::string(operation) + ": " + std::strerror(error);
+}
+
+} // namespace Transport
+} // namespace SRPT
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace SRPT {
+namespace Transport {
+
+// IPv4/IPv6 socket address usable as a map key
+struct Endpoint {
+    sockaddr_storage address{};
+    socklen_t length = 0;
+
+    static bool resolve(const std::string& host, uint16_t port, Endpoint& out);
+    static Endpoint loopback(uint16_t port);
+    static Endpoint any(uint16_t port, int family = AF_INET);
+
+    uint16_t port() const;
+    std::string toString() const;
+    bool operator==(const Endpoint& other) const;
+    bool operator!=(const Endpoint& other) const { return !(*this == other); }
+};
+
+struct EndpointHash {
+    size_t operator()(const Endpoint& endpoint) const;
+};
+
+// Outgoing datagram referencing caller-owned memory
+struct DatagramRef {
+    const Endpoint* peer;
+    const uint8_t* data;
+    size_t size;
+    uint64_t txTime = 0;  // SO_TXTIME release time (CLOCK_MONOTONIC ns); 0 sends now
+};
+
+// Incoming datagram pointing into a ReceiveBatch's buffers. Valid until the
+// batch is reused.
+struct ReceivedDatagram {
+    const Endpoint* peer;
+    const uint8_t* data;
+    size_t size;
+};
+
+// Preallocated recvmmsg state. With GRO enabled each slot can hold a
+// coalesced run of segments, which is split back into datagrams.
+class ReceiveBatch {
+public:
+    explicit ReceiveBatch(size_t slots = 64, size_t slotSize = 65535);
+
+    ReceiveBatch(const ReceiveBatch&) = delete;
+    ReceiveBatch& operator=(const ReceiveBatch&) = delete;
+
+    size_t slots() const { return peers_.size(); }
+    const std::vector<ReceivedDatagram>& datagrams() const { return datagrams_; }
+
+private:
+    friend class UdpSocket;
+
+    static constexpr size_t CONTROL_SIZE = 64;
+
+    size_t slotSize_;
+    std::vector<uint8_t> buffer_;
+    std::vector<uint8_t> control_;
+    std::vector<Endpoint> peers_;
+    std::vector<iovec> iov_;
+    std::vector<mmsghdr> headers_;
+    std::vector<ReceivedDatagram> datagrams_;
+};
+
+// Non-blocking UDP socket. Send and receive return -1 with wouldBlock()
+// set when the kernel buffer is full or drained.
+class UdpSocket {
+public:
+    UdpSocket() = default;
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+    UdpSocket(UdpSocket&& other) noexcept;
+    UdpSocket& operator=(UdpSocket&& other) noexcept;
+
+    bool open(int family = AF_INET);
+    bool bind(const Endpoint& local);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+    Endpoint localEndpoint() const;
+
+    bool setBufferSizes(int sendBytes, int receiveBytes);
+
+    ssize_t sendTo(const uint8_t* data, size_t size, const Endpoint& peer, uint64_t txTime = 0);
+    ssize_t receiveFrom(uint8_t* buffer, size_t capacity, Endpoint& peer);
+
+    // UDP segmentation / receive offload. Return false if the kernel does
+    // not support them; the batch calls then fall back to one datagram per
+    // message.
+    bool enableGso();
+    bool enableGro();
+    bool gsoEnabled() const { return gso_; }
+    bool groEnabled() const { return gro_; }
+
+    // Kernel pacing: datagrams carrying a txTime are held by the fq/ETF
+    // qdisc until that CLOCK_MONOTONIC time. Without SO_TXTIME the stamps
+    // are ignored and datagrams leave immediately.
+    bool enableTxTime();
+    bool txTimeEnabled() const { return txTime_; }
+    static uint64_t txTimeFor(std::chrono::steady_clock::time_point when);
+
+    // Fill `buffer` with UDP_SEGMENT / SCM_TXTIME control messages (either
+    // may be 0 to omit it); returns the control length to put in msghdr
+    static constexpr size_t CONTROL_SPACE = 64;
+    static size_t buildControl(uint8_t* buffer, uint16_t segmentSize, uint64_t txTime);
+
+    // Send with sendmmsg. Consecutive datagrams to the same peer with equal
+    // sizes (the last may be shorter) and the same txTime are coalesced into
+    // one GSO message.
+    // Returns the number of datagrams handed to the kernel, or -1 if none
+    // could be sent.
+    ssize_t sendBatch(const DatagramRef* datagrams, size_t count);
+    // Receive with recvmmsg into `batch`; returns the number of datagrams
+    // (after GRO splitting) or -1.
+    ssize_t receiveBatch(ReceiveBatch& batch);
+
+    bool wouldBlock() const { return wouldBlock_; }
+    int getLastErrno() const { return lastErrno_; }
+    std::string getLastError() const { return lastError_; }
+
+private:
+    static constexpr size_t MAX_GSO_SEGMENTS = 64;
+    static constexpr size_t MAX_GSO_BYTES = 65000;
+    static constexpr size_t MAX_SEND_MESSAGES = 64;
+
+    int fd_ = -1;
+    bool wouldBlock_ = false;
+    bool gso_ = false;
+    bool gro_ = false;
+    bool txTime_ = false;
+    int lastErrno_ = 0;
+    std::string lastError_;
+
+    // Reused by sendBatch
+    std::vector<mmsghdr> sendHeaders_;
+    std::vector<iovec> sendIov_;
+    std::vector<uint8_t> sendControl_;
+    std::vector<size_t> sendCounts_;
+    std::vector<size_t> sendSegments_;
+
+    void recordError(const char* operation);
+};
+
+} // namespace Transport
+} // namespace SRPT
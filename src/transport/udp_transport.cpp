@@ -0,0 +1,604 @@
+#include "udp_transport.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <random>
+#include <stdexcept>
+#include <sys/epoll.h>
+
+namespace SRPT {
+namespace Transport {
+
+UdpTransport::UdpTransport(EventLoop& loop) : UdpTransport(loop, Options()) {}
+
+UdpTransport::UdpTransport(EventLoop& loop, const Options& options)
+    : loop_(loop),
+      options_(options),
+      nextConnectionId_(std::random_device{}()) {
+    options_.batchSize = std::max<size_t>(options_.batchSize, 1);
+    options_.sendQueueLimit = std::max<size_t>(options_.sendQueueLimit, 1);
+    if (usingRing()) {
+        pending_.reserve(options_.batchSize);
+    } else if (options_.batching) {
+        receiveBatch_ = std::make_unique<ReceiveBatch>(options_.batchSize, MAX_DATAGRAM_SIZE);
+        receivedViews_.reserve(options_.batchSize);
+        pending_.reserve(options_.batchSize);
+        sendRefs_.reserve(options_.batchSize);
+    } else {
+        receiveBuffer_.resize(MAX_DATAGRAM_SIZE);
+    }
+}
+
+UdpTransport::~UdpTransport() {
+    // One last attempt at whatever is still queued, blocked or not
+    if (retryTimer_ != TimerWheel::INVALID_TIMER) {
+        loop_.timers().cancel(retryTimer_);
+        retryTimer_ = TimerWheel::INVALID_TIMER;
+    }
+    writeBlocked_ = false;
+    flush();
+    if (usingRing() && socket_.isOpen()) {
+        // The kernel still references our buffers; cancel and drain first
+        closing_ = true;
+        if (receiveArmed_) {
+            io_uring_sqe* sqe = options_.ring->prepare(nullptr);
+            if (sqe) {
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->fd = socket_.fd();
+                sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+            }
+        }
+        options_.ring->waitUntil([this]() { return !receiveArmed_ && sendsInFlight_ == 0; });
+    } else if (socket_.isOpen()) {
+        loop_.removeFd(socket_.fd());
+    }
+    // Connections detach from the loop's timer wheel as they are destroyed
+    connections_.clear();
+}
+
+bool UdpTransport::bind(const Endpoint& local) {
+    if (!socket_.bind(local)) {
+        lastError_ = socket_.getLastError();
+        return false;
+    }
+    if (options_.kernelPacing) {
+        // Optional: unstamped datagrams are sent immediately
+        socket_.enableTxTime();
+    }
+    if (usingRing()) {
+        return bindRing();
+    }
+    auto handler = [this](uint32_t events) {
+        if (events & EPOLLOUT) {
+            onWritable();
+        }
+        if (events & ~static_cast<uint32_t>(EPOLLOUT)) {
+            onReadable();
+        }
+    };
+    if (!loop_.addFd(socket_.fd(), EPOLLIN, handler)) {
+        lastError_ = "Failed to register socket with event loop";
+        socket_.close();
+        return false;
+    }
+    if (options_.batching && options_.offload) {
+        // Optional: without them every datagram is its own message
+        socket_.enableGso();
+        socket_.enableGro();
+    }
+    return true;
+}
+
+void UdpTransport::listen(AcceptHandler handler) {
+    acceptHandler_ = std::move(handler);
+    listening_ = true;
+}
+
+SRPTConnection* UdpTransport::connect(const Endpoint& peer) {
+    if (!socket_.isOpen() && !bind(Endpoint::any(0))) {
+        return nullptr;
+    }
+    if (connections_.count(peer)) {
+        lastError_ = "Connection to " + peer.toString() + " already exists";
+        return nullptr;
+    }
+    SRPTConnection& connection = createConnection(peer, nextConnectionId_++);
+    connection.initiate();
+    return &connection;
+}
+
+SRPTConnection* UdpTransport::findConnection(const Endpoint& peer) {
+    auto it = connections_.find(peer);
+    return it == connections_.end() ? nullptr : it->second.get();
+}
+
+void UdpTransport::setReleaseScheduler(const Endpoint& peer, ReleaseScheduler scheduler) {
+    if (scheduler) {
+        releaseSchedulers_[peer] = std::move(scheduler);
+    } else {
+        releaseSchedulers_.erase(peer);
+    }
+}
+
+void UdpTransport::removeConnection(const Endpoint& peer) {
+    releaseSchedulers_.erase(peer);
+    connections_.erase(peer);
+}
+
+void UdpTransport::onReadable() {
+    if (options_.batching) {
+        readBatches();
+        flush();  // Replies generated while handling the batch
+        return;
+    }
+    // Edge-triggered: drain the socket completely
+    while (true) {
+        Endpoint peer;
+        ssize_t received = socket_.receiveFrom(receiveBuffer_.data(), receiveBuffer_.size(), peer);
+        if (received < 0) {
+            if (!socket_.wouldBlock()) {
+                lastError_ = socket_.getLastError();
+            }
+            flushWindowUpdates();
+            return;
+        }
+        ++stats_.receiveCalls;
+        ++stats_.packetsReceived;
+        stats_.bytesReceived += static_cast<uint64_t>(received);
+        dispatch(peer, receiveBuffer_.data(), static_cast<size_t>(received));
+    }
+}
+
+void UdpTransport::readBatches() {
+    while (true) {
+        ssize_t received = socket_.receiveBatch(*receiveBatch_);
+        if (received < 0) {
+            if (!socket_.wouldBlock()) {
+                lastError_ = socket_.getLastError();
+            }
+            return;
+        }
+        ++stats_.receiveCalls;
+
+        const auto& datagrams = receiveBatch_->datagrams();
+        receivedViews_.clear();
+        for (const auto& datagram : datagrams) {
+            receivedViews_.push_back(SRPTPacketView{datagram.data, datagram.size});
+            stats_.bytesReceived += datagram.size;
+        }
+        stats_.packetsReceived += datagrams.size();
+
+        receivedPackets_.clear();
+        receivedIndices_.clear();
+        stats_.decodeErrors += SRPTPacket::decodeBatch(receivedViews_, receivedPackets_, receivedIndices_);
+        for (size_t i = 0; i < receivedPackets_.size(); ++i) {
+            deliver(*datagrams[receivedIndices_[i]].peer, receivedPackets_[i]);
+        }
+        flushWindowUpdates();
+    }
+}
+
+void UdpTransport::dispatch(const Endpoint& peer, const uint8_t* data, size_t size) {
+    try {
+        deliver(peer, SRPTPacket::fromBytes(data, size));
+    } catch (const std::runtime_error&) {
+        ++stats_.decodeErrors;
+    }
+}
+
+void UdpTransport::deliver(const Endpoint& peer, const SRPTPacket& packet) {
+    SRPTConnection* connection = findConnection(peer);
+    if (!connection) {
+        if (!listening_ || packet.getPacketType() != static_cast<uint8_t>(SRPTPacketType::SYN)) {
+            return;  // Stray packet for an unknown connection
+        }
+        connection = &createConnection(peer, packet.getPackageId());
+        if (acceptHandler_) {
+            acceptHandler_(*connection, peer);
+        }
+    }
+    if (packet.getPacketType() == static_cast<uint8_t>(SRPTPacketType::DATA) &&
+        (windowUpdatePeers_.empty() || windowUpdatePeers_.back() != peer)) {
+        windowUpdatePeers_.push_back(peer);
+    }
+    connection->handlePacket(packet);
+}
+
+void UdpTransport::flushWindowUpdates() {
+    // Looked up again: a handler may have removed the connection
+    for (const auto& peer : windowUpdatePeers_) {
+        if (SRPTConnection* connection = findConnection(peer)) {
+            connection->flushWindowUpdate();
+        }
+    }
+    windowUpdatePeers_.clear();
+}
+
+SRPTConnection& UdpTransport::createConnection(const Endpoint& peer, uint64_t connectionId) {
+    auto connection = std::make_unique<SRPTConnection>();
+    connection->setConnectionId(connectionId);
+    connection->setPacketSender([this, peer](const SRPTPacket& packet) {
+        return sendPacket(peer, packet);
+    });
+    connection->attachTimerWheel(loop_.timers());
+    SRPTConnection& ref = *connection;
+    connections_[peer] = std::move(connection);
+    return ref;
+}
+
+bool UdpTransport::sendPacket(const Endpoint& peer, const SRPTPacket& packet) {
+    if (options_.batching || usingRing()) {
+        return queuePacket(peer, packet);
+    }
+    std::vector<uint8_t> bytes = packet.toBytes();
+    ssize_t sent = socket_.sendTo(bytes.data(), bytes.size(), peer, releaseTime(peer, packet, bytes.size()));
+    if (sent < 0) {
+        // A full socket buffer is reported as a failed send so callers can retry
+        ++stats_.sendErrors;
+        lastError_ = socket_.getLastError();
+        return false;
+    }
+    ++stats_.sendCalls;
+    ++stats_.packetsSent;
+    stats_.bytesSent += static_cast<uint64_t>(sent);
+    return true;
+}
+
+bool UdpTransport::queuePacket(const Endpoint& peer, const SRPTPacket& packet) {
+    if (usingRing()) {
+        return queueRingPacket(peer, packet);
+    }
+    if (pending_.size() >= options_.sendQueueLimit) {
+        ++stats_.sendErrors;
+        lastError_ = "Send queue full";
+        return false;
+    }
+    size_t offset = sendBuffer_.size();
+    size_t size = packet.appendTo(sendBuffer_);
+    pending_.push_back(PendingDatagram{peer, offset, size, releaseTime(peer, packet, size)});
+    if (pending_.size() >= options_.batchSize) {
+        flush();
+    } else {
+        scheduleFlush();
+    }
+    return true;
+}
+
+uint64_t UdpTransport::releaseTime(const Endpoint& peer, const SRPTPacket& packet, size_t size) {
+    if (!socket_.txTimeEnabled() || releaseSchedulers_.empty() ||
+        packet.getPacketType() != static_cast<uint8_t>(SRPTPacketType::DATA)) {
+        return 0;
+    }
+    auto it = releaseSchedulers_.find(peer);
+    return it != releaseSchedulers_.end() ? UdpSocket::txTimeFor(it->second(size)) : 0;
+}
+
+void UdpTransport::scheduleFlush() {
+    if (flushScheduled_) {
+        return;
+    }
+    flushScheduled_ = true;
+    std::weak_ptr<bool> alive = alive_;
+    loop_.defer([this, alive]() {
+        if (alive.lock()) {
+            flush();
+        }
+    });
+}
+
+void UdpTransport::flush() {
+    flushScheduled_ = false;
+    if (usingRing()) {
+        flushRing();
+        return;
+    }
+    if (pending_.empty() || writeBlocked_ || retryTimer_ != TimerWheel::INVALID_TIMER) {
+        return;  // The socket is still full; onWritable() or the retry timer flushes
+    }
+    // sendBuffer_ no longer grows, so pointers into it are stable here
+    sendRefs_.clear();
+    for (const auto& datagram : pending_) {
+        sendRefs_.push_back(
+            DatagramRef{&datagram.peer, sendBuffer_.data() + datagram.offset, datagram.size, datagram.txTime});
+    }
+    size_t done = 0;
+    while (done < pending_.size()) {
+        ssize_t sent = socket_.sendBatch(sendRefs_.data() + done, sendRefs_.size() - done);
+        ++stats_.sendCalls;
+        size_t accepted = sent > 0 ? static_cast<size_t>(sent) : 0;
+        for (size_t i = done; i < done + accepted; ++i) {
+            stats_.bytesSent += pending_[i].size;
+        }
+        stats_.packetsSent += accepted;
+        done += accepted;
+        if (done == pending_.size()) {
+            break;
+        }
+        if (socket_.wouldBlock() || socket_.getLastErrno() == ENOBUFS) {
+            ++stats_.sendStalls;
+            if (socket_.wouldBlock()) {
+                awaitWritable();
+            } else {
+                retryLater();
+            }
+            break;
+        }
+        // Rejected outright (e.g. unreachable peer): only this datagram is lost
+        ++stats_.sendErrors;
+        lastError_ = socket_.getLastError();
+        ++done;
+    }
+
+    if (done == pending_.size()) {
+        pending_.clear();
+        sendBuffer_.clear();
+        return;
+    }
+    // Keep the unsent tail, in order, at the front of the queue
+    size_t consumed = pending_[done].offset;
+    sendBuffer_.erase(sendBuffer_.begin(), sendBuffer_.begin() + static_cast<std::ptrdiff_t>(consumed));
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(done));
+    for (auto& datagram : pending_) {
+        datagram.offset -= consumed;
+    }
+}
+
+void UdpTransport::awaitWritable() {
+    if (!loop_.modifyFd(socket_.fd(), EPOLLIN | EPOLLOUT)) {
+        retryLater();
+        return;
+    }
+    writeBlocked_ = true;
+}
+
+void UdpTransport::onWritable() {
+    if (!writeBlocked_) {
+        return;
+    }
+    writeBlocked_ = false;
+    loop_.modifyFd(socket_.fd(), EPOLLIN);
+    flush();
+}
+
+void UdpTransport::retryLater() {
+    // Neither ENOBUFS nor a full submission queue is signalled when it clears
+    std::weak_ptr<bool> alive = alive_;
+    retryTimer_ = loop_.timers().schedule(SEND_RETRY_DELAY, [this, alive]() {
+        if (alive.lock()) {
+            retryTimer_ = TimerWheel::INVALID_TIMER;
+            flush();
+        }
+    });
+}
+
+bool UdpTransport::bindRing() {
+    if (!options_.ring->isValid()) {
+        lastError_ = "io_uring unavailable: " + options_.ring->getLastError();
+        socket_.close();
+        return false;
+    }
+    // Descriptors are unique per process, so the socket's doubles as a
+    // buffer group id that cannot clash with other transports on the ring
+    bufferRing_ = std::make_unique<BufferRing>(*options_.ring, static_cast<uint16_t>(socket_.fd()),
+                                               RING_BUFFER_COUNT, RING_BUFFER_SIZE);
+    if (!bufferRing_->isValid() || !armRingReceive()) {
+        lastError_ = "Failed to set up io_uring receive: " + options_.ring->getLastError();
+        bufferRing_.reset();
+        socket_.close();
+        return false;
+    }
+    return true;
+}
+
+bool UdpTransport::armRingReceive() {
+    io_uring_sqe* sqe = options_.ring->prepare([this](int32_t result, uint32_t flags) {
+        onRingReceive(result, flags);
+    });
+    if (!sqe) {
+        return false;
+    }
+    // Room for an IPv4 or IPv6 source address ahead of each payload
+    receiveMessage_ = msghdr{};
+    receiveMessage_.msg_namelen = sizeof(sockaddr_in6);
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = socket_.fd();
+    sqe->addr = reinterpret_cast<uint64_t>(&receiveMessage_);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = bufferRing_->groupId();
+    receiveArmed_ = true;
+    return true;
+}
+
+void UdpTransport::onRingReceive(int32_t result, uint32_t flags) {
+    if (!(flags & IORING_CQE_F_MORE)) {
+        receiveArmed_ = false;  // Re-armed once the held buffers are recycled
+    }
+    if (result < 0) {
+        if (result != -ENOBUFS && result != -ECANCELED) {
+            lastError_ = std::string("recvmsg: ") + std::strerror(-result);
+        }
+    } else if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t id = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        uint8_t* buffer = bufferRing_->buffer(id);
+        auto* out = reinterpret_cast<io_uring_recvmsg_out*>(buffer);
+        size_t headerSize = sizeof(io_uring_recvmsg_out) + receiveMessage_.msg_namelen + receiveMessage_.msg_controllen;
+        ++stats_.packetsReceived;
+        stats_.bytesReceived += out->payloadlen;
+
+        if ((out->flags & MSG_TRUNC) || headerSize + out->payloadlen > bufferRing_->bufferSize()) {
+            ++stats_.decodeErrors;  // Larger than a ring buffer
+            bufferRing_->recycle(id);
+        } else {
+            RingDatagram datagram;
+            size_t nameLength = std::min<size_t>(out->namelen, receiveMessage_.msg_namelen);
+            std::memcpy(&datagram.peer.address, buffer + sizeof(io_uring_recvmsg_out), nameLength);
+            datagram.peer.length = static_cast<socklen_t>(nameLength);
+            datagram.bufferId = id;
+            datagram.data = buffer + headerSize;
+            datagram.size = out->payloadlen;
+            ringReceived_.push_back(datagram);
+        }
+    }
+
+    if (!ringReceiveScheduled_ && (!ringReceived_.empty() || !receiveArmed_)) {
+        // Decode everything reaped this iteration as one batch
+        ringReceiveScheduled_ = true;
+        std::weak_ptr<bool> alive = alive_;
+        loop_.defer([this, alive]() {
+            if (alive.lock()) {
+                processRingReceived();
+            }
+        });
+    }
+}
+
+void UdpTransport::processRingReceived() {
+    ringReceiveScheduled_ = false;
+    receivedViews_.clear();
+    for (const auto& datagram : ringReceived_) {
+        receivedViews_.push_back(SRPTPacketView{datagram.data, datagram.size});
+    }
+    receivedPackets_.clear();
+    receivedIndices_.clear();
+    stats_.decodeErrors += SRPTPacket::decodeBatch(receivedViews_, receivedPackets_, receivedIndices_);
+    // Packets own their payloads, so buffers can go back before delivery
+    for (const auto& datagram : ringReceived_) {
+        bufferRing_->recycle(datagram.bufferId);
+    }
+    for (size_t i = 0; i < receivedPackets_.size(); ++i) {
+        deliver(ringReceived_[receivedIndices_[i]].peer, receivedPackets_[i]);
+    }
+    ringReceived_.clear();
+    flushWindowUpdates();
+
+    if (!receiveArmed_ && !closing_) {
+        armRingReceive();
+    }
+    flush();
+}
+
+bool UdpTransport::queueRingPacket(const Endpoint& peer, const SRPTPacket& packet) {
+    if (queuedSlots_.size() + retrySlots_.size() >= options_.sendQueueLimit) {
+        ++stats_.sendErrors;
+        lastError_ = "Send queue full";
+        return false;
+    }
+    SendSlot* slot;
+    if (!freeSendSlots_.empty()) {
+        slot = freeSendSlots_.back();
+        freeSendSlots_.pop_back();
+    } else {
+        sendSlots_.push_back(std::make_unique<SendSlot>());
+        slot = sendSlots_.back().get();
+    }
+    slot->peer = peer;
+    slot->data.clear();
+    size_t size = packet.appendTo(slot->data);
+    slot->txTime = releaseTime(peer, packet, size);
+    slot->sequence = nextSendSequence_++;
+    queuedSlots_.push_back(slot);
+    if (queuedSlots_.size() >= options_.batchSize) {
+        flush();
+    } else {
+        scheduleFlush();
+    }
+    return true;
+}
+
+void UdpTransport::flushRing() {
+    if (retryTimer_ != TimerWheel::INVALID_TIMER) {
+        return;  // Backing off after -ENOBUFS or a full submission queue
+    }
+    if (!retrySlots_.empty()) {
+        // Everything still queued was queued after these were submitted;
+        // chains can complete out of order, so restore queue order first
+        std::sort(retrySlots_.begin(), retrySlots_.end(),
+                  [](const SendSlot* a, const SendSlot* b) { return a->sequence < b->sequence; });
+        queuedSlots_.insert(queuedSlots_.begin(), retrySlots_.begin(), retrySlots_.end());
+        retrySlots_.clear();
+    }
+    if (queuedSlots_.empty()) {
+        return;
+    }
+    // Linked so the kernel sends them in queue order
+    size_t prepared = 0;
+    io_uring_sqe* previous = nullptr;
+    for (; prepared < queuedSlots_.size(); ++prepared) {
+        SendSlot* slot = queuedSlots_[prepared];
+        slot->iov = iovec{slot->data.data(), slot->data.size()};
+        slot->message = msghdr{};
+        slot->message.msg_name = &slot->peer.address;
+        slot->message.msg_namelen = slot->peer.length;
+        slot->message.msg_iov = &slot->iov;
+        slot->message.msg_iovlen = 1;
+        if (slot->txTime != 0) {
+            slot->message.msg_control = slot->control;
+            slot->message.msg_controllen = UdpSocket::buildControl(slot->control, 0, slot->txTime);
+        }
+
+        io_uring_sqe* sqe = options_.ring->prepare([this, slot](int32_t result, uint32_t) {
+            onRingSendComplete(slot, result);
+        });
+        if (!sqe) {
+            // End the chain here; the rest stay queued for the retry
+            if (previous) {
+                previous->flags &= static_cast<uint8_t>(~IOSQE_IO_LINK);
+            }
+            lastError_ = options_.ring->getLastError();
+            break;
+        }
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = socket_.fd();
+        sqe->addr = reinterpret_cast<uint64_t>(&slot->message);
+        sqe->len = 1;
+        if (prepared + 1 < queuedSlots_.size()) {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+        previous = sqe;
+        ++sendsInFlight_;
+    }
+    queuedSlots_.erase(queuedSlots_.begin(), queuedSlots_.begin() + static_cast<std::ptrdiff_t>(prepared));
+    if (!queuedSlots_.empty()) {
+        ++stats_.sendStalls;
+        retryLater();
+    }
+    if (prepared > 0) {
+        options_.ring->submit();
+        ++stats_.sendCalls;
+    }
+}
+
+void UdpTransport::onRingSendComplete(SendSlot* slot, int32_t result) {
+    --sendsInFlight_;
+    if (result >= 0) {
+        ++stats_.packetsSent;
+        stats_.bytesSent += static_cast<uint64_t>(result);
+        freeSendSlots_.push_back(slot);
+        return;
+    }
+    bool transient = result == -EAGAIN || result == -ENOBUFS || result == -EINTR || result == -ECANCELED;
+    if (!transient || closing_) {
+        // Rejected outright, or cancelled by teardown: only this one is lost
+        ++stats_.sendErrors;
+        lastError_ = std::string("sendmsg: ") + std::strerror(-result);
+        freeSendSlots_.push_back(slot);
+        return;
+    }
+    // A failed link also cancels the rest of its chain (-ECANCELED); those
+    // are sent again too
+    retrySlots_.push_back(slot);
+    if (result == -EAGAIN || result == -ENOBUFS) {
+        if (retryTimer_ == TimerWheel::INVALID_TIMER) {
+            ++stats_.sendStalls;
+            retryLater();
+        }
+    } else {
+        scheduleFlush();
+    }
+}
+
+} // namespace Transport
+} // namespace SRPT
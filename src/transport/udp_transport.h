@@ -0,0 +1,200 @@
+#pragma once
+
+#include "event_loop.h"
+#include "io_ring.h"
+#include "udp_socket.h"
+#include "../core/srpt_connection.h"
+#include "../core/srpt_packet.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SRPT {
+namespace Transport {
+
+// Moves SRPTPackets between SRPTConnection endpoints over one non-blocking
+// UDP socket. Incoming datagrams are demultiplexed by peer address; when
+// listening, a SYN from an unknown peer creates a new connection. All
+// methods must be called on the event loop thread.
+//
+// With batching enabled, received datagrams are read with recvmmsg and
+// decoded as one batch, and outgoing packets are queued and flushed with
+// sendmmsg at the end of the loop iteration (or when the batch is full).
+// Packets that do not fit in the socket buffer at flush time stay queued
+// and go out once the socket reports EPOLLOUT (or, after ENOBUFS, on a
+// short timer). Once Options::sendQueueLimit packets are waiting, further
+// sends fail so the connection sees the back-pressure; only datagrams the
+// kernel rejects outright are dropped and counted in Stats::sendErrors.
+//
+// With Options::ring set, socket I/O goes through io_uring instead: one
+// multishot recvmsg fills buffers from a registered buffer ring, and each
+// flush submits the queued packets as a linked chain of sendmsg requests,
+// so the only syscall per loop iteration is a single io_uring_enter. A
+// send that fails with -EAGAIN or -ENOBUFS, and the rest of its chain
+// (cancelled with -ECANCELED), is resubmitted in queue order after
+// SEND_RETRY_DELAY; packets that find the submission queue full wait in
+// the queue the same way.
+//
+// With Options::kernelPacing, DATA packets to a peer with a release
+// scheduler are stamped with SO_TXTIME, leaving the spacing of a paced burst
+// to the fq/ETF qdisc instead of to loop timers.
+class UdpTransport {
+public:
+    using AcceptHandler = std::function<void(SRPTConnection& connection, const Endpoint& peer)>;
+    // Returns when a DATA datagram of `bytes` may leave. The scheduler charges
+    // the datagram to its pacer in the pacer's own units: Cubic counts
+    // packets, so `[&cubic](size_t) { return cubic.schedulePacedSend(1); }`
+    using ReleaseScheduler = std::function<std::chrono::steady_clock::time_point(size_t bytes)>;
+
+    struct Stats {
+        uint64_t packetsSent = 0;
+        uint64_t packetsReceived = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t sendErrors = 0;
+        uint64_t decodeErrors = 0;
+        uint64_t sendCalls = 0;
+        uint64_t receiveCalls = 0;
+        uint64_t sendStalls = 0;  // Flushes that left packets queued for later
+    };
+
+    struct Options {
+        bool batching = true;
+        bool offload = true;    // UDP GSO/GRO, when batching and supported
+        size_t batchSize = 64;  // Datagrams per sendmmsg/recvmmsg
+        size_t sendQueueLimit = 4096;  // Queued packets before sends fail
+        IoRing* ring = nullptr; // io_uring backend; must outlive the transport
+        bool kernelPacing = false;  // SO_TXTIME stamps from release schedulers
+    };
+
+    static constexpr size_t MAX_DATAGRAM_SIZE = 65535;
+    static constexpr std::chrono::milliseconds SEND_RETRY_DELAY{1};  // After ENOBUFS
+
+    explicit UdpTransport(EventLoop& loop);
+    UdpTransport(EventLoop& loop, const Options& options);
+    ~UdpTransport();
+
+    UdpTransport(const UdpTransport&) = delete;
+    UdpTransport& operator=(const UdpTransport&) = delete;
+
+    bool bind(const Endpoint& local);
+    Endpoint localEndpoint() const { return socket_.localEndpoint(); }
+
+    // Accept connections from unknown peers
+    void listen(AcceptHandler handler);
+
+    // Create a connection to `peer` and send its SYN. The connection stays
+    // owned by the transport until removeConnection().
+    SRPTConnection* connect(const Endpoint& peer);
+
+    SRPTConnection* findConnection(const Endpoint& peer);
+    void removeConnection(const Endpoint& peer);
+    size_t getConnectionCount() const { return connections_.size(); }
+
+    // Pace DATA packets to `peer` (kernelPacing only); an empty scheduler
+    // removes it
+    void setReleaseScheduler(const Endpoint& peer, ReleaseScheduler scheduler);
+    bool kernelPacingActive() const { return socket_.txTimeEnabled(); }
+
+    // Send any queued packets now, unless the socket is still full
+    void flush();
+
+    const Options& getOptions() const { return options_; }
+    const Stats& getStats() const { return stats_; }
+    std::string getLastError() const { return lastError_; }
+
+private:
+    struct PendingDatagram {
+        Endpoint peer;
+        size_t offset;
+        size_t size;
+        uint64_t txTime;
+    };
+
+    // io_uring send state; must stay put until the sendmsg completes
+    struct SendSlot {
+        msghdr message;
+        iovec iov;
+        Endpoint peer;
+        std::vector<uint8_t> data;
+        uint64_t txTime;
+        uint64_t sequence;  // Queue order, kept across resubmission
+        alignas(cmsghdr) uint8_t control[UdpSocket::CONTROL_SPACE];
+    };
+
+    struct RingDatagram {
+        Endpoint peer;
+        uint16_t bufferId;
+        const uint8_t* data;
+        size_t size;
+    };
+
+    static constexpr uint16_t RING_BUFFER_COUNT = 512;
+    static constexpr uint32_t RING_BUFFER_SIZE = 2048;
+
+    EventLoop& loop_;
+    Options options_;
+    UdpSocket socket_;
+    std::unordered_map<Endpoint, std::unique_ptr<SRPTConnection>, EndpointHash> connections_;
+    AcceptHandler acceptHandler_;
+    std::unordered_map<Endpoint, ReleaseScheduler, EndpointHash> releaseSchedulers_;
+    bool listening_ = false;
+    uint64_t nextConnectionId_;
+    std::vector<uint8_t> receiveBuffer_;
+    std::unique_ptr<ReceiveBatch> receiveBatch_;
+    std::vector<SRPTPacketView> receivedViews_;
+    std::vector<SRPTPacket> receivedPackets_;
+    std::vector<size_t> receivedIndices_;
+    std::vector<Endpoint> windowUpdatePeers_;  // Sent DATA in the current receive batch
+    std::vector<uint8_t> sendBuffer_;
+    std::vector<PendingDatagram> pending_;
+    std::vector<DatagramRef> sendRefs_;
+    bool flushScheduled_ = false;
+    bool writeBlocked_ = false;  // Waiting for EPOLLOUT
+    TimerWheel::TimerId retryTimer_ = TimerWheel::INVALID_TIMER;
+    std::unique_ptr<BufferRing> bufferRing_;
+    msghdr receiveMessage_{};
+    bool receiveArmed_ = false;
+    bool closing_ = false;
+    std::vector<RingDatagram> ringReceived_;
+    bool ringReceiveScheduled_ = false;
+    std::vector<std::unique_ptr<SendSlot>> sendSlots_;
+    std::vector<SendSlot*> freeSendSlots_;
+    std::vector<SendSlot*> queuedSlots_;
+    std::vector<SendSlot*> retrySlots_;  // Failed transiently; sent again ahead of queuedSlots_
+    uint64_t nextSendSequence_ = 0;
+    size_t sendsInFlight_ = 0;
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);  // Guards deferred work
+    Stats stats_;
+    std::string lastError_;
+
+    void onReadable();
+    void readBatches();
+    void dispatch(const Endpoint& peer, const uint8_t* data, size_t size);
+    void deliver(const Endpoint& peer, const SRPTPacket& packet);
+    void flushWindowUpdates();
+    SRPTConnection& createConnection(const Endpoint& peer, uint64_t connectionId);
+    bool sendPacket(const Endpoint& peer, const SRPTPacket& packet);
+    bool queuePacket(const Endpoint& peer, const SRPTPacket& packet);
+    uint64_t releaseTime(const Endpoint& peer, const SRPTPacket& packet, size_t size);
+    void scheduleFlush();
+    void awaitWritable();
+    void onWritable();
+    void retryLater();
+
+    bool usingRing() const { return options_.ring != nullptr; }
+    bool bindRing();
+    bool armRingReceive();
+    void onRingReceive(int32_t result, uint32_t flags);
+    void processRingReceived();
+    bool queueRingPacket(const Endpoint& peer, const SRPTPacket& packet);
+    void flushRing();
+    void onRingSendComplete(SendSlot* slot, int32_t result);
+};
+
+} // namespace Transport
+} // namespace SRPT
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/adaptive_selector.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <random>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = AdaptiveSelector::TimePoint;
+using Algorithm = AdaptiveSelector::Algorithm;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// Window-limited sender over a bottleneck of `bytesPerSecond` with a FIFO of
+// one BDP; the base RTT may change over time. A non-zero `appBytesPerSecond`
+// caps what the application offers. Simulated time only.
+struct Path {
+    double bytesPerSecond;
+    std::function<std::chrono::microseconds(TimePoint)> rtt;
+    double lossRate = 0;
+    double appBytesPerSecond = 0;
+};
+
+void runPath(AdaptiveSelector& selector, const Path& path, TimePoint& now, std::chrono::seconds duration) {
+    struct InFlight {
+        TimePoint sentAt;
+        TimePoint ackAt;
+        bool lost;
+    };
+    std::mt19937 rng(11);
+    std::bernoulli_distribution loss(path.lossRate);
+    std::deque<InFlight> flight;
+    auto serialization = std::chrono::nanoseconds(static_cast<int64_t>(MSS * 1e9 / path.bytesPerSecond));
+    TimePoint end = now + duration;
+    TimePoint linkFree = now;
+    TimePoint lastArrival = now;
+    TimePoint nextSend = now;
+    uint64_t inflight = 0;
+
+    while (now < end) {
+        while (!flight.empty() && flight.front().ackAt <= now) {
+            InFlight packet = flight.front();
+            flight.pop_front();
+            inflight -= MSS;
+            if (packet.lost) {
+                selector.onPacketLoss(packet.ackAt);
+            } else {
+                selector.onAckReceived(
+                    MSS, std::chrono::duration_cast<std::chrono::microseconds>(packet.ackAt - packet.sentAt),
+                    packet.ackAt);
+            }
+        }
+        if (now >= nextSend && inflight + MSS <= selector.getCongestionWindow()) {
+            if (path.appBytesPerSecond > 0) {
+                nextSend = now + std::chrono::nanoseconds(static_cast<int64_t>(MSS * 1e9 / path.appBytesPerSecond));
+            }
+            selector.onPacketSent(MSS, now);
+            inflight += MSS;
+            auto rtt = path.rtt(now);
+            TimePoint departure = std::max(now, linkFree) + serialization;
+            bool dropped = loss(rng) || departure - now > rtt;
+            if (!dropped) {
+                linkFree = departure;
+            }
+            // In order end to end, even when the RTT drops
+            TimePoint ackAt = std::max((dropped ? now + serialization : departure) + rtt, lastArrival);
+            lastArrival = ackAt;
+            flight.push_back(InFlight{now, ackAt, dropped});
+            continue;
+        }
+        TimePoint next = flight.empty() ? now + 1ms : flight.front().ackAt;
+        if (nextSend > now) {
+            next = std::min(next, nextSend);
+        }
+        now = next;
+    }
+}
+
+std::function<std::chrono::microseconds(TimePoint)> fixedRtt(std::chrono::microseconds rtt) {
+    return [rtt](TimePoint) { return rtt; };
+}
+
+} // namespace
+
+class AdaptiveSelectorTest : public ::testing::Test {
+protected:
+    TimePoint start = TimePoint() + 1h;
+    AdaptiveSelector::Options options;
+};
+
+TEST_F(AdaptiveSelectorTest, InitialState) {
+    AdaptiveSelector selector(options, start);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::CUBIC);
+    EXPECT_EQ(selector.getCongestionWindow(), Cubic::INITIAL_WINDOW * MSS);
+    EXPECT_GT(selector.getSendingRate(), 0u);
+    EXPECT_EQ(selector.getSwitches(), 0u);
+}
+
+TEST_F(AdaptiveSelectorTest, CleanTerrestrialPathStaysOnCubic) {
+    AdaptiveSelector selector(options, start);
+    TimePoint now = start;
+    runPath(selector, Path{2.5e6, fixedRtt(30ms), 0, 1.5e6}, now, 30s);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::CUBIC);
+    EXPECT_EQ(selector.getSwitches(), 0u);
+}
+
+TEST_F(AdaptiveSelectorTest, GeoPathSwitchesToSatellite) {
+    AdaptiveSelector selector(options, start);
+    TimePoint now = start;
+    runPath(selector, Path{2.5e6, fixedRtt(600ms)}, now, 20s);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::SATELLITE);
+    EXPECT_EQ(selector.getSwitches(), 1u);
+    EXPECT_GE(selector.getMetrics().minRtt, 600ms);
+}
+
+TEST_F(AdaptiveSelectorTest, RandomLossSwitchesToBbr) {
+    AdaptiveSelector selector(options, start);
+    TimePoint now = start;
+    runPath(selector, Path{2.5e6, fixedRtt(40ms), 0.01, 1.5e6}, now, 30s);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::BBR);
+    EXPECT_GT(selector.getMetrics().randomLossRate, options.lossyRate);
+}
+
+TEST_F(AdaptiveSelectorTest, LeoHandoversSwitchToSatellite) {
+    AdaptiveSelector selector(options, start);
+    TimePoint now = start;
+    // Base RTT alternates between two satellites every 5 s
+    auto rtt = [this](TimePoint at) {
+        return (at - start) / 5s % 2 == 0 ? std::chrono::microseconds(30ms) : std::chrono::microseconds(55ms);
+    };
+    // Steps are seen while the queue is short; a standing queue absorbs them
+    runPath(selector, Path{2.5e6, rtt, 0, 1.5e6}, now, 30s);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::SATELLITE);
+    EXPECT_GE(selector.getMetrics().rttSteps, options.handoverSteps);
+}
+
+TEST_F(AdaptiveSelectorTest, HeavyLossLeavesCubic) {
+    // Unpaced Cubic overruns a one-BDP buffer and keeps losing
+    AdaptiveSelector selector(options, start);
+    TimePoint now = start;
+    runPath(selector, Path{2.5e6, fixedRtt(30ms)}, now, 20s);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::BBR);
+    // And stays there once the losses stop
+    runPath(selector, Path{2.5e6, fixedRtt(30ms)}, now, 20s);
+    EXPECT_LT(selector.getMetrics().lossRate, options.failingLossRate);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::BBR);
+    EXPECT_EQ(selector.getSwitches(), 1u);
+}
+
+TEST_F(AdaptiveSelectorTest, SwitchKeepsTheWindow) {
+    AdaptiveSelector selector(options, start);
+    TimePoint now = start;
+    runPath(selector, Path{2.5e6, fixedRtt(100ms)}, now, 5s);
+    ASSERT_EQ(selector.getAlgorithm(), Algorithm::CUBIC);
+
+    for (Algorithm next : {Algorithm::BBR, Algorithm::SATELLITE, Algorithm::CUBIC}) {
+        uint32_t cwnd = selector.getCongestionWindow();
+        ASSERT_GT(cwnd, 10 * Cubic::INITIAL_WINDOW * MSS);
+        selector.switchTo(next, now);
+        EXPECT_EQ(selector.getAlgorithm(), next);
+        // Within a packet (Cubic rounds to whole packets) or BBR's own
+        // 2 BDP cap, never back to an initial window
+        uint64_t bdp = static_cast<uint64_t>(2.5e6 * 0.1);
+        EXPECT_GE(selector.getCongestionWindow() + MSS, std::min<uint64_t>(cwnd, 2 * bdp));
+        runPath(selector, Path{2.5e6, fixedRtt(100ms)}, now, 1s);
+    }
+    EXPECT_EQ(selector.getSwitches(), 3u);
+}
+
+TEST_F(AdaptiveSelectorTest, ShortDisturbanceDoesNotSwitch) {
+    AdaptiveSelector selector(options, start);
+    TimePoint now = start;
+    runPath(selector, Path{2.5e6, fixedRtt(30ms), 0, 1.5e6}, now, 15s);
+    // One lossy second is not enough for the required confirmations
+    runPath(selector, Path{2.5e6, fixedRtt(30ms), 0.05, 1.5e6}, now, 1s);
+    runPath(selector, Path{2.5e6, fixedRtt(30ms), 0, 1.5e6}, now, 10s);
+    EXPECT_EQ(selector.getAlgorithm(), Algorithm::CUBIC);
+    EXPECT_EQ(selector.getSwitches(), 0u);
+}
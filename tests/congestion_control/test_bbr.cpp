@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/bbr.h"
+#include <algorithm>
+#include <deque>
+#include <random>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = Bbr::TimePoint;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// Paced sender over a bottleneck of `bytesPerSecond` with a FIFO of one BDP
+// and independent random loss; simulated time only
+struct Link {
+    double bytesPerSecond;
+    std::chrono::microseconds rtt;
+    double lossRate = 0;
+};
+
+void runLink(Bbr& bbr, const Link& link, TimePoint start, std::chrono::seconds duration) {
+    struct InFlight {
+        TimePoint sentAt;
+        TimePoint ackAt;
+        bool lost;
+    };
+    std::mt19937 rng(7);
+    std::bernoulli_distribution loss(link.lossRate);
+    std::deque<InFlight> flight;
+    auto serialization = std::chrono::nanoseconds(static_cast<int64_t>(MSS * 1e9 / link.bytesPerSecond));
+    auto queueLimit = link.rtt;
+    TimePoint now = start;
+    TimePoint nextSend = start;
+    TimePoint linkFree = start;
+    uint64_t inflight = 0;
+
+    while (now < start + duration) {
+        while (!flight.empty() && flight.front().ackAt <= now) {
+            InFlight packet = flight.front();
+            flight.pop_front();
+            inflight -= MSS;
+            if (packet.lost) {
+                bbr.onPacketsLost(MSS, packet.ackAt);
+            } else {
+                bbr.onAckReceived(MSS, std::chrono::duration_cast<std::chrono::microseconds>(packet.ackAt - packet.sentAt),
+                                  packet.ackAt);
+            }
+        }
+        if (now >= nextSend && inflight + MSS <= bbr.getCongestionWindow()) {
+            bbr.onPacketSent(MSS, now);
+            inflight += MSS;
+            TimePoint departure = std::max(now, linkFree) + serialization;
+            bool dropped = loss(rng) || departure - now > queueLimit;
+            if (!dropped) {
+                linkFree = departure;
+            }
+            // Losses are noticed when the packet's ack would have arrived
+            InFlight packet{now, (dropped ? now + serialization : departure) + link.rtt, dropped};
+            auto position = std::upper_bound(flight.begin(), flight.end(), packet.ackAt,
+                                             [](TimePoint at, const InFlight& other) { return at < other.ackAt; });
+            flight.insert(position, packet);
+            nextSend = now + std::chrono::nanoseconds(static_cast<int64_t>(MSS * 1e9 / bbr.getSendingRate()));
+            continue;
+        }
+        TimePoint next = flight.empty() ? nextSend : std::min(flight.front().ackAt, std::max(nextSend, now));
+        if (next <= now) {
+            next = flight.empty() ? now + 1ms : flight.front().ackAt;
+        }
+        now = next;
+    }
+}
+
+} // namespace
+
+class BbrTest : public ::testing::Test {
+protected:
+    TimePoint start = TimePoint() + 1h;
+    Bbr bbr{MSS, start};
+};
+
+TEST_F(BbrTest, InitialState) {
+    EXPECT_EQ(bbr.getMode(), Bbr::Mode::STARTUP);
+    EXPECT_EQ(bbr.getCongestionWindow(), Bbr::INITIAL_WINDOW_PACKETS * MSS);
+    EXPECT_GT(bbr.getSendingRate(), 0u);
+    EXPECT_DOUBLE_EQ(bbr.getPacingGain(), Bbr::HIGH_GAIN);
+}
+
+TEST_F(BbrTest, ConvergesToBottleneckOnLongRttPath) {
+    Link link{2.5e6, 600ms};  // 20 Mbit/s GEO
+    runLink(bbr, link, start, 30s);
+    EXPECT_EQ(bbr.getMode(), Bbr::Mode::PROBE_BW);
+    EXPECT_NEAR(static_cast<double>(bbr.getBottleneckBandwidth()), link.bytesPerSecond, link.bytesPerSecond * 0.05);
+    EXPECT_NEAR(bbr.getMinRtt().count(), 600000, 5000);
+    uint64_t bdp = static_cast<uint64_t>(link.bytesPerSecond * 0.6);
+    EXPECT_GE(bbr.getCongestionWindow(), bdp);
+    EXPECT_LE(bbr.getCongestionWindow(), 3 * bdp);
+}
+
+TEST_F(BbrTest, RandomLossDoesNotShrinkTheModel) {
+    Link link{2.5e6, 600ms, 0.01};
+    runLink(bbr, link, start, 30s);
+    EXPECT_NEAR(static_cast<double>(bbr.getBottleneckBandwidth()), link.bytesPerSecond, link.bytesPerSecond * 0.1);
+    EXPECT_GE(bbr.getCongestionWindow(), static_cast<uint32_t>(link.bytesPerSecond * 0.6));
+}
+
+TEST_F(BbrTest, ProbeRttAfterMinRttExpires) {
+    // Establish a 100 ms min RTT, then only ever see 150 ms
+    TimePoint now = start;
+    bbr.onPacketSent(MSS, now);
+    now += 100ms;
+    bbr.onAckReceived(MSS, 100ms, now);
+    while (bbr.getMode() != Bbr::Mode::PROBE_RTT && now < start + 12s) {
+        bbr.onPacketSent(MSS, now);
+        now += 10ms;
+        bbr.onAckReceived(MSS, 150ms, now);
+    }
+    ASSERT_EQ(bbr.getMode(), Bbr::Mode::PROBE_RTT);
+    EXPECT_GE(now - start, Bbr::MIN_RTT_WINDOW);
+    EXPECT_EQ(bbr.getCongestionWindow(), Bbr::MIN_WINDOW_PACKETS * MSS);
+    EXPECT_EQ(bbr.getMinRtt(), 150ms);
+
+    // Holds the small window for PROBE_RTT_DURATION, then restores it
+    TimePoint entered = now;
+    while (bbr.getMode() == Bbr::Mode::PROBE_RTT && now < entered + 1s) {
+        bbr.onPacketSent(MSS, now);
+        now += 10ms;
+        bbr.onAckReceived(MSS, 150ms, now);
+    }
+    EXPECT_NE(bbr.getMode(), Bbr::Mode::PROBE_RTT);
+    EXPECT_GE(now - entered, Bbr::PROBE_RTT_DURATION);
+    EXPECT_GT(bbr.getCongestionWindow(), Bbr::MIN_WINDOW_PACKETS * MSS);
+}
+
+TEST_F(BbrTest, LossOnlyReleasesInflight) {
+    TimePoint now = start;
+    for (int i = 0; i < 5; ++i) {
+        bbr.onPacketSent(MSS, now);
+    }
+    uint32_t cwnd = bbr.getCongestionWindow();
+    bbr.onPacketsLost(2 * MSS, now + 1ms);
+    EXPECT_EQ(bbr.getBytesInFlight(), 3 * MSS);
+    EXPECT_EQ(bbr.getCongestionWindow(), cwnd);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/coupled_multipath.h"
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = CoupledMultipath::TimePoint;
+using Path = CoupledMultipath::Path;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// Acks one full window of `path` at `rtt`
+void ackRound(Path& path, std::chrono::microseconds rtt, TimePoint now) {
+    uint32_t window = path.getCongestionWindow();
+    for (uint32_t acked = 0; acked < window; acked += MSS) {
+        path.onAckReceived(MSS, rtt, now);
+    }
+}
+
+// Ends slow start with a loss and lets the recovery period pass
+void enterCongestionAvoidance(Path& path, std::chrono::microseconds rtt, TimePoint& now) {
+    ackRound(path, rtt, now);
+    path.onPacketLoss(now);
+    ASSERT_FALSE(path.inSlowStart());
+    now += 2 * rtt;
+}
+
+} // namespace
+
+class CoupledMultipathTest : public ::testing::Test {
+protected:
+    TimePoint start = TimePoint() + 1h;
+    CoupledMultipath::Options options;
+};
+
+TEST_F(CoupledMultipathTest, SinglePathIsReno) {
+    options.algorithm = CoupledMultipath::Algorithm::LIA;
+    CoupledMultipath coupled(options);
+    Path& path = coupled.addPath("starlink", start);
+    EXPECT_EQ(path.getCongestionWindow(), CoupledMultipath::INITIAL_WINDOW_PACKETS * MSS);
+    EXPECT_TRUE(path.inSlowStart());
+
+    TimePoint now = start;
+    enterCongestionAvoidance(path, 50ms, now);
+    EXPECT_DOUBLE_EQ(coupled.getLiaAlpha(), 1.0);
+    uint32_t before = path.getCongestionWindow();
+    for (int round = 0; round < 10; ++round) {
+        ackRound(path, 50ms, now);
+        now += 50ms;
+    }
+    EXPECT_NEAR(path.getCongestionWindow(), before + 10 * MSS, MSS);
+}
+
+TEST_F(CoupledMultipathTest, SharedBottleneckTakesOneFlowsShare) {
+    for (auto algorithm : {CoupledMultipath::Algorithm::LIA, CoupledMultipath::Algorithm::OLIA}) {
+        options.algorithm = algorithm;
+        CoupledMultipath coupled(options);
+        Path& a = coupled.addPath("a", start);
+        Path& b = coupled.addPath("b", start);
+        TimePoint now = start;
+        enterCongestionAvoidance(a, 50ms, now);
+        enterCongestionAvoidance(b, 50ms, now);
+
+        uint64_t before = coupled.getTotalWindow();
+        for (int round = 0; round < 20; ++round) {
+            ackRound(a, 50ms, now);
+            ackRound(b, 50ms, now);
+            now += 50ms;
+        }
+        // Together no faster than one Reno flow, a packet per RTT, where
+        // two uncoupled flows would add two
+        uint64_t growth = coupled.getTotalWindow() - before;
+        EXPECT_LE(growth, 21u * MSS);
+        EXPECT_GE(growth, 8u * MSS);
+    }
+}
+
+TEST_F(CoupledMultipathTest, LiaAlphaFavoursBestPath) {
+    options.algorithm = CoupledMultipath::Algorithm::LIA;
+    CoupledMultipath coupled(options);
+    Path& leo = coupled.addPath("starlink", start);
+    Path& geo = coupled.addPath("geo", start);
+    TimePoint now = start;
+    enterCongestionAvoidance(leo, 40ms, now);
+    enterCongestionAvoidance(geo, 600ms, now);
+    // Same windows, very different rates: the 40 ms path is the one to
+    // match, and its window is only half of the total
+    EXPECT_GT(coupled.getLiaAlpha(), 1.5);
+
+    uint32_t before = leo.getCongestionWindow();
+    for (int round = 0; round < 15; ++round) {
+        ackRound(leo, 40ms, now);
+        now += 40ms;
+    }
+    // Never faster than a single-path flow on the path
+    EXPECT_LE(leo.getCongestionWindow(), before + 16 * MSS);
+    EXPECT_GT(leo.getCongestionWindow(), before + 10 * MSS);
+}
+
+TEST_F(CoupledMultipathTest, OliaMovesLoadFromLossyPath) {
+    CoupledMultipath coupled(options);
+    Path& good = coupled.addPath("starlink", start);
+    Path& lossy = coupled.addPath("iridium", start);
+    TimePoint now = start;
+    enterCongestionAvoidance(good, 50ms, now);
+    // The lossy path starts with the larger window
+    ackRound(lossy, 50ms, now);
+    ackRound(lossy, 50ms, now);
+    lossy.onPacketLoss(now);
+    now += 100ms;
+    ASSERT_GT(lossy.getCongestionWindow(), good.getCongestionWindow());
+
+    for (int round = 0; round < 40; ++round) {
+        ackRound(good, 50ms, now);
+        // One loss every four rounds on the degraded provider
+        ackRound(lossy, 50ms, now);
+        if (round % 4 == 3) {
+            lossy.onPacketLoss(now);
+        }
+        now += 50ms;
+    }
+    EXPECT_GT(good.getCongestionWindow(), 3 * lossy.getCongestionWindow());
+    EXPECT_GT(good.getDeliveredSinceLoss(), lossy.getDeliveredBetweenLosses());
+}
+
+TEST_F(CoupledMultipathTest, LossesArePerPath) {
+    CoupledMultipath coupled(options);
+    Path& a = coupled.addPath("a", start);
+    Path& b = coupled.addPath("b", start);
+    uint32_t initial = CoupledMultipath::INITIAL_WINDOW_PACKETS * MSS;
+
+    a.onPacketLoss(start);
+    EXPECT_EQ(a.getCongestionWindow(), initial / 2);
+    EXPECT_EQ(b.getCongestionWindow(), initial);
+    a.onPacketLoss(start + 10ms);  // Same loss event
+    EXPECT_EQ(a.getCongestionWindow(), initial / 2);
+
+    AckEvent ack;
+    ack.now = start;
+    ack.lostBytes = MSS;
+    ack.lostPackets = 1;
+    ack.lossCause = LossCause::WIRELESS;
+    b.onAck(ack);
+    EXPECT_EQ(b.getCongestionWindow(), initial);
+    ack.lossCause = LossCause::CONGESTION;
+    b.onAck(ack);
+    EXPECT_EQ(b.getCongestionWindow(), initial / 2);
+}
+
+TEST_F(CoupledMultipathTest, RemovedPathLeavesCoupling) {
+    CoupledMultipath coupled(options);
+    Path& a = coupled.addPath("a", start);
+    Path& b = coupled.addPath("b", start);
+    EXPECT_EQ(coupled.getPathCount(), 2u);
+    EXPECT_EQ(coupled.getTotalWindow(), 2u * a.getCongestionWindow());
+    EXPECT_EQ(coupled.getPath(1).getName(), "b");
+
+    EXPECT_TRUE(coupled.removePath(b));
+    EXPECT_EQ(coupled.getPathCount(), 1u);
+    EXPECT_EQ(coupled.getTotalWindow(), a.getCongestionWindow());
+    EXPECT_FALSE(coupled.removePath(b));
+    EXPECT_GT(coupled.getAggregateRate(), 0u);
+}
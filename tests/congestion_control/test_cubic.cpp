@@ -1,14 +1,19 @@
 #include <gtest/gtest.h>
 #include "../../src/congestion_control/cubic.h"
-#include <thread>
 #include <chrono>
 #include <stdexcept>
 
 using namespace SRPT::CongestionControl;
 
-class CubicTest : public ::testing::Test, public Cubic {
+// Declared before Cubic in the base list so the clock exists when Cubic
+// reads its start time
+struct ManualClockHolder {
+    SRPT::Common::ManualClock clock;
+};
+
+class CubicTest : public ::testing::Test, protected ManualClockHolder, public Cubic {
 protected:
-    // Add any additional setup or teardown here if needed
+    CubicTest() : Cubic(clock) {}
 };
 
 class TestTimeout : public std::runtime_error {
@@ -82,7 +87,7 @@ TEST_F(CubicTest, PacketPacing) {
         onAckReceived(1460, std::chrono::milliseconds(100));
     }
     
-    auto start = std::chrono::steady_clock::now();
+    auto start = clock.now();
     int packets_sent = 0;
     for (int i = 0; i < 1000; ++i) {
         if (canSendPacket(1460)) {
@@ -95,27 +100,47 @@ TEST_F(CubicTest, PacketPacing) {
             onAckReceived(1460, std::chrono::milliseconds(100));
         }
         
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        clock.advance(std::chrono::microseconds(100));
         
         if (i % 100 == 0) {
             std::cout << "Iteration " << i << ", Packets sent: " << packets_sent << std::endl;
         }
     }
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - start);
+        clock.now() - start);
     
     EXPECT_LT(packets_sent, 1000);
     EXPECT_GT(duration.count(), 0);
     EXPECT_GT(packets_sent, 10);
 }
 
+TEST_F(CubicTest, KernelPacedBurst) {
+    for (int i = 0; i < 10; ++i) {
+        onAckReceived(1460, std::chrono::milliseconds(100));
+    }
+    auto interval = getPacingInterval();
+
+    // A whole window is admitted at once, with release times one pacing
+    // interval apart (the window is counted in packets here)
+    auto previous = schedulePacedSend(1);
+    uint32_t scheduled = 1;
+    while (hasWindowFor(1)) {
+        auto release = schedulePacedSend(1);
+        EXPECT_EQ(release - previous, interval);
+        previous = release;
+        ++scheduled;
+    }
+    EXPECT_EQ(scheduled, getCongestionWindow());
+    EXPECT_FALSE(canSendPacket(1));
+}
+
 TEST_F(CubicTest, IdlePeriodHandling) {
     // Grow the window
     for (int i = 0; i < 100; ++i) {
         onAckReceived(1460, std::chrono::milliseconds(100));
     }
     uint32_t cwnd_before_idle = getCongestionWindow();
-    std::this_thread::sleep_for(std::chrono::seconds(2)); // Simulate idle period
+    clock.advance(std::chrono::seconds(2)); // Simulate idle period
     onPacketSent(1460);
     EXPECT_EQ(getCongestionWindow(), INITIAL_WINDOW);
     EXPECT_EQ(getSsthresh(), UINT32_MAX);
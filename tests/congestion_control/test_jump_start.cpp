@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/jump_start.h"
+#include "../../src/congestion_control/adaptive_selector.h"
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+// 100 Mbit/s at 600 ms: a 7.5 MB BDP
+const PathEstimate GEO{100000000 / 8, 600ms};
+
+} // namespace
+
+TEST(JumpStartTest, PlansShareOfEstimatedBdp) {
+    JumpStart jump;
+    ControllerState state;
+    ASSERT_TRUE(jump.plan(GEO, 10 * MSS, 0, state));
+    EXPECT_EQ(jump.getPhase(), JumpStart::Phase::UNVALIDATED);
+    EXPECT_EQ(state.cwnd % MSS, 0u);
+    EXPECT_NEAR(static_cast<double>(state.cwnd), 3750000.0, MSS);
+    EXPECT_EQ(state.ssthresh, UINT32_MAX);  // Still slow start
+    EXPECT_EQ(state.minRtt, 600ms);
+    EXPECT_EQ(state.bandwidth, GEO.bandwidth / 2);
+
+    JumpStart::Options options;
+    options.maxWindow = 1000000;
+    JumpStart capped(options);
+    ASSERT_TRUE(capped.plan(GEO, 10 * MSS, 0, state));
+    EXPECT_LE(state.cwnd, 1000000u);
+
+    // Nothing to gain on a small path, or from no estimate
+    EXPECT_FALSE(jump.plan(PathEstimate{1000000, 10ms}, 10 * MSS, 0, state));
+    EXPECT_FALSE(jump.plan(PathEstimate(), 10 * MSS, 0, state));
+    EXPECT_EQ(jump.getPhase(), JumpStart::Phase::IDLE);
+}
+
+TEST(JumpStartTest, ValidatedOnceJumpIsAcked) {
+    JumpStart jump;
+    ControllerState state;
+    ASSERT_TRUE(jump.plan(GEO, 10 * MSS, 0, state));
+    uint32_t packets = state.cwnd / MSS;
+    for (uint32_t i = 0; i < packets; ++i) {
+        jump.onPacketSent(MSS);
+    }
+    EXPECT_EQ(jump.getPhase(), JumpStart::Phase::VALIDATING);
+    for (uint32_t i = 0; i < packets; ++i) {
+        EXPECT_FALSE(jump.onAck(MSS, 610ms));
+    }
+    EXPECT_EQ(jump.getPhase(), JumpStart::Phase::DONE);
+    EXPECT_FALSE(jump.onLoss());
+}
+
+TEST(JumpStartTest, LossRetreatsToHalfOfDelivered) {
+    JumpStart jump;
+    ControllerState state;
+    ASSERT_TRUE(jump.plan(GEO, 10 * MSS, 0, state));
+    for (uint32_t i = 0; i < 1000; ++i) {
+        jump.onPacketSent(MSS);
+    }
+    for (uint32_t i = 0; i < 400; ++i) {
+        jump.onAck(MSS, 600ms);
+    }
+    EXPECT_TRUE(jump.onLoss());
+    EXPECT_EQ(jump.getPhase(), JumpStart::Phase::RETREATED);
+    ControllerState retreat = jump.retreatState(500 * MSS);
+    EXPECT_EQ(retreat.cwnd, 200 * MSS);
+    EXPECT_EQ(retreat.ssthresh, retreat.cwnd);
+    EXPECT_EQ(retreat.bytesInFlight, 500 * MSS);
+}
+
+TEST(JumpStartTest, RttMismatchFallsBackToSlowStart) {
+    JumpStart jump;
+    ControllerState state;
+    ASSERT_TRUE(jump.plan(GEO, 10 * MSS, 0, state));
+    jump.onPacketSent(MSS);
+    // A 40 ms path is not the GEO link the estimate came from
+    EXPECT_TRUE(jump.onAck(MSS, 40ms));
+    ControllerState retreat = jump.retreatState(0);
+    EXPECT_EQ(retreat.cwnd, 10 * MSS);
+    EXPECT_EQ(retreat.ssthresh, UINT32_MAX);
+}
+
+TEST(JumpStartTest, SelectorJumpsActiveController) {
+    AdaptiveSelector::TimePoint start{};
+    AdaptiveSelector::Options options;
+    options.initial = AdaptiveSelector::Algorithm::SATELLITE;
+    AdaptiveSelector selector(options, start);
+    uint32_t initial = selector.getCongestionWindow();
+    ASSERT_TRUE(selector.jumpStart(GEO, start));
+    EXPECT_GT(selector.getCongestionWindow(), 100 * initial);
+    EXPECT_GT(selector.getSendingRate(), GEO.bandwidth / 2);
+    EXPECT_EQ(selector.getJumpPhase(), JumpStart::Phase::UNVALIDATED);
+
+    selector.onPacketSent(MSS, start);
+    selector.onAckReceived(MSS, 40ms, start + 40ms);
+    EXPECT_EQ(selector.getJumpPhase(), JumpStart::Phase::RETREATED);
+    EXPECT_EQ(selector.getCongestionWindow(), 10 * MSS);
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/ledbat.h"
+#include <cmath>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = Ledbat::TimePoint;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// Acks one full window at `rtt` and advances the clock by it
+void ackRound(Ledbat& cc, std::chrono::microseconds rtt, TimePoint& now) {
+    uint32_t window = cc.getCongestionWindow();
+    TimePoint end = now + rtt;
+    for (uint32_t acked = 0; acked < window; acked += MSS) {
+        cc.onAckReceived(MSS, rtt, now);
+    }
+    now = end;
+}
+
+// Ramps up on an empty 600 ms path, then leaves slow start on a queue just
+// over 3/4 of the target
+void enterCongestionAvoidance(Ledbat& cc, TimePoint& now) {
+    for (int round = 0; round < 6; ++round) {
+        ackRound(cc, 600ms, now);
+    }
+    ackRound(cc, 620ms, now);
+    ASSERT_EQ(cc.getPhase(), Ledbat::Phase::CONGESTION_AVOIDANCE);
+}
+
+} // namespace
+
+class LedbatTest : public ::testing::Test {
+protected:
+    TimePoint start = TimePoint() + 1h;
+    Ledbat::Options options;
+
+    void SetUp() override { options.periodicSlowdown = false; }
+};
+
+TEST_F(LedbatTest, InitialState) {
+    Ledbat cc(options, start);
+    EXPECT_EQ(cc.getCongestionWindow(), Ledbat::INITIAL_WINDOW_PACKETS * MSS);
+    EXPECT_TRUE(cc.inSlowStart());
+    EXPECT_GT(cc.getSendingRate(), 0u);
+    EXPECT_EQ(cc.getQueuingDelay(), 0us);
+}
+
+TEST_F(LedbatTest, SlowStartEndsBelowTarget) {
+    Ledbat cc(options, start);
+    TimePoint now = start;
+    ackRound(cc, 600ms, now);
+    EXPECT_EQ(cc.getCongestionWindow(), 2 * Ledbat::INITIAL_WINDOW_PACKETS * MSS);
+    EXPECT_EQ(cc.getBaseDelay(), 600ms);
+
+    // 15 ms of queue is under 3/4 of the 25 ms target: keep going
+    ackRound(cc, 615ms, now);
+    EXPECT_TRUE(cc.inSlowStart());
+    ackRound(cc, 620ms, now);
+    EXPECT_FALSE(cc.inSlowStart());
+    EXPECT_EQ(cc.getQueuingDelay(), 20ms);
+    EXPECT_LE(cc.getSsthresh(), cc.getCongestionWindow());
+    EXPECT_GT(cc.getSsthresh(), 4 * MSS);
+}
+
+TEST_F(LedbatTest, GrowsWithSpareCapacity) {
+    Ledbat cc(options, start);
+    TimePoint now = start;
+    enterCongestionAvoidance(cc, now);
+    // Drain the filter of the slow-start exit samples
+    ackRound(cc, 600ms, now);
+
+    // A sixteenth per RTT on an empty queue
+    uint32_t before = cc.getCongestionWindow();
+    for (int round = 0; round < 10; ++round) {
+        ackRound(cc, 600ms, now);
+    }
+    EXPECT_NEAR(static_cast<double>(cc.getCongestionWindow()) / before, std::pow(1.0625, 10), 0.05);
+
+    // Close to the target, less than a packet per RTT
+    before = cc.getCongestionWindow();
+    for (int round = 0; round < 10; ++round) {
+        ackRound(cc, 600ms + 20ms, now);
+    }
+    EXPECT_GT(cc.getCongestionWindow(), before);
+    EXPECT_LE(cc.getCongestionWindow(), before + 3 * MSS);
+}
+
+TEST_F(LedbatTest, YieldsToQueueAboveTarget) {
+    Ledbat cc(options, start);
+    TimePoint now = start;
+    enterCongestionAvoidance(cc, now);
+    for (int round = 0; round < 5; ++round) {
+        ackRound(cc, 600ms, now);
+    }
+    uint32_t before = cc.getCongestionWindow();
+
+    // Another flow builds 40 ms of queue: the window halves, waits an RTT
+    // for the queue to show it, and halves again
+    ackRound(cc, 640ms, now);
+    uint32_t halved = cc.getCongestionWindow();
+    EXPECT_LT(halved, before * 0.6);
+    EXPECT_GT(halved, before * 0.4);
+    ackRound(cc, 640ms, now);
+    EXPECT_EQ(cc.getCongestionWindow(), halved);
+    for (int round = 0; round < 8; ++round) {
+        ackRound(cc, 640ms, now);
+    }
+    EXPECT_LT(cc.getCongestionWindow(), before / 16);
+    EXPECT_EQ(cc.getQueuingDelay(), 40ms);
+}
+
+TEST_F(LedbatTest, LossResponseFollowsQueue) {
+    Ledbat cc(options, start);
+    TimePoint now = start;
+    enterCongestionAvoidance(cc, now);
+    ackRound(cc, 600ms, now);
+    uint32_t before = cc.getCongestionWindow();
+
+    // No queue: a link error, 10% and not again for a few RTTs
+    cc.onPacketLoss(now);
+    uint32_t after = static_cast<uint32_t>(before * 0.9);
+    EXPECT_EQ(cc.getCongestionWindow(), after);
+    cc.onPacketLoss(now + 2s);
+    EXPECT_EQ(cc.getCongestionWindow(), after);
+
+    // With a queue of half the target or more: congestion, halved once per RTT
+    now += 3s;
+    cc.onAckReceived(MSS, 615ms, now);
+    cc.onAckReceived(MSS, 615ms, now);
+    cc.onAckReceived(MSS, 615ms, now);
+    cc.onAckReceived(MSS, 615ms, now);
+    before = cc.getCongestionWindow();
+    cc.onPacketLoss(now);
+    EXPECT_EQ(cc.getCongestionWindow(), before / 2);
+    cc.onPacketLoss(now + 100ms);
+    EXPECT_EQ(cc.getCongestionWindow(), before / 2);
+
+    AckEvent ack;
+    ack.now = now + 1s;
+    ack.lostBytes = MSS;
+    ack.lostPackets = 1;
+    ack.lossCause = LossCause::WIRELESS;
+    cc.onAck(ack);
+    EXPECT_EQ(cc.getCongestionWindow(), before / 2);
+    ack.lossCause = LossCause::CONGESTION;
+    cc.onAck(ack);
+    EXPECT_EQ(cc.getCongestionWindow(), before / 4);
+}
+
+TEST_F(LedbatTest, PeriodicSlowdownRemeasuresBaseDelay) {
+    options.periodicSlowdown = true;
+    Ledbat cc(options, start);
+    TimePoint now = start;
+    enterCongestionAvoidance(cc, now);
+    uint32_t window = cc.getCongestionWindow();
+
+    // Two RTTs after slow start, down to the minimum for two RTTs
+    ackRound(cc, 600ms, now);
+    ackRound(cc, 600ms, now);
+    cc.onAckReceived(MSS, 600ms, now);
+    EXPECT_EQ(cc.getPhase(), Ledbat::Phase::SLOWDOWN);
+    EXPECT_EQ(cc.getCongestionWindow(), Ledbat::MIN_WINDOW_PACKETS * MSS);
+    EXPECT_EQ(cc.getSlowdowns(), 1u);
+    TimePoint slowdown = now;
+    ackRound(cc, 600ms, now);
+    EXPECT_EQ(cc.getCongestionWindow(), Ledbat::MIN_WINDOW_PACKETS * MSS);
+
+    // Then slow start back to where it was
+    ackRound(cc, 600ms, now);
+    while (cc.inSlowStart()) {
+        ackRound(cc, 600ms, now);
+    }
+    EXPECT_EQ(cc.getPhase(), Ledbat::Phase::CONGESTION_AVOIDANCE);
+    EXPECT_GE(cc.getCongestionWindow(), window);
+    TimePoint recovered = now;
+    auto cost = recovered - slowdown;
+
+    // The next one is nine times the cost away
+    while (now < recovered + 8 * cost) {
+        ackRound(cc, 600ms, now);
+    }
+    EXPECT_EQ(cc.getSlowdowns(), 1u);
+    while (now <= recovered + 9 * cost) {
+        ackRound(cc, 600ms, now);
+    }
+    EXPECT_EQ(cc.getSlowdowns(), 2u);
+}
+
+TEST_F(LedbatTest, PathChangeRebasesDelay) {
+    Ledbat cc(options, start);
+    TimePoint now = start;
+    enterCongestionAvoidance(cc, now);
+    ackRound(cc, 600ms, now);
+    uint32_t before = cc.getCongestionWindow();
+
+    // The new path is 50 ms longer; reported, it is not queueing
+    cc.onPathChange(now);
+    for (int round = 0; round < 5; ++round) {
+        ackRound(cc, 650ms, now);
+    }
+    EXPECT_EQ(cc.getBaseDelay(), 650ms);
+    EXPECT_GT(cc.getCongestionWindow(), before);
+}
+
+TEST_F(LedbatTest, GainShrinksOnShortPaths) {
+    Ledbat geo(options, start);
+    Ledbat terrestrial(options, start);
+    TimePoint now = start;
+    ackRound(geo, 600ms, now);
+    now = start;
+    ackRound(terrestrial, 5ms, now);
+    // 2 * 25 ms / 5 ms: a tenth of a packet per acked packet
+    EXPECT_EQ(geo.getCongestionWindow(), 4 * MSS);
+    EXPECT_LT(terrestrial.getCongestionWindow(), geo.getCongestionWindow());
+    EXPECT_GE(terrestrial.getCongestionWindow(), 2 * MSS);
+}
+
+TEST_F(LedbatTest, AdoptsState) {
+    Ledbat cc(options, start);
+    ControllerState state;
+    state.cwnd = 500 * MSS;
+    state.ssthresh = 500 * MSS;
+    state.minRtt = 600ms;
+    state.smoothedRtt = 610ms;
+    cc.adoptState(state, start);
+    EXPECT_EQ(cc.getCongestionWindow(), 500 * MSS);
+    EXPECT_EQ(cc.getPhase(), Ledbat::Phase::CONGESTION_AVOIDANCE);
+    EXPECT_EQ(cc.getBaseDelay(), 600ms);
+    EXPECT_NEAR(cc.getSendingRate(), 500.0 * MSS / 0.61, 1.0);
+}
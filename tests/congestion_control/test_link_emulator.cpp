@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/link_emulator.h"
+#include <algorithm>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = LinkEmulator::TimePoint;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// AIMD in packets, halving at most once per RTT; records what the
+// emulator hands it
+class RenoSender : public LinkEmulator::Sender {
+public:
+    explicit RenoSender(const LinkEmulator* emulator = nullptr) : emulator_(emulator) {}
+
+    const char* name() const override { return "Reno"; }
+    void sent(TimePoint now) override {
+        check(now);
+        if (sends_++ == 0) {
+            firstSend_ = now;
+        }
+        lastSend_ = now;
+    }
+    void acked(std::chrono::microseconds rtt, TimePoint now) override {
+        check(now);
+        lastRtt_ = rtt;
+        minRtt_ = std::min(minRtt_, rtt);
+        maxRtt_ = std::max(maxRtt_, rtt);
+        cwnd_ += cwnd_ < ssthresh_ ? 1.0 : 1.0 / cwnd_;
+    }
+    void lost(TimePoint now) override {
+        check(now);
+        ++losses_;
+        if (now >= recoveryEnd_) {
+            ssthresh_ = cwnd_ = std::max(cwnd_ / 2, 2.0);
+            recoveryEnd_ = now + lastRtt_;
+        }
+    }
+    uint64_t windowBytes() const override { return static_cast<uint64_t>(cwnd_) * MSS; }
+    double pacingRate() const override { return 0; }
+
+    uint64_t sends_ = 0;
+    uint64_t losses_ = 0;
+    TimePoint firstSend_;
+    TimePoint lastSend_;
+    std::chrono::microseconds minRtt_ = std::chrono::microseconds::max();
+    std::chrono::microseconds maxRtt_{0};
+    bool clockMatched_ = true;
+
+private:
+    const LinkEmulator* emulator_;
+    double cwnd_ = 10;
+    double ssthresh_ = 1e9;
+    TimePoint recoveryEnd_;
+    std::chrono::microseconds lastRtt_{0};
+
+    void check(TimePoint now) {
+        if (emulator_ && emulator_->getClock().now() != now) {
+            clockMatched_ = false;
+        }
+    }
+};
+
+} // namespace
+
+class LinkEmulatorTest : public ::testing::Test {
+protected:
+    TimePoint start = TimePoint() + 1h;
+    LinkEmulator::Config config;
+
+    void SetUp() override {
+        config.seconds = 60;
+        config.bytesPerSecond = 10e6 / 8;
+        config.rtt = 100ms;
+        config.mss = MSS;
+    }
+};
+
+TEST_F(LinkEmulatorTest, SingleFlowFillsTheLink) {
+    LinkEmulator emulator(config, start);
+    RenoSender sender;
+    emulator.addFlow(sender);
+    auto result = emulator.run();
+
+    ASSERT_EQ(result.flows.size(), 1u);
+    EXPECT_EQ(result.flows[0].name, "Reno");
+    EXPECT_DOUBLE_EQ(result.flows[0].activeSeconds, 60);
+    EXPECT_DOUBLE_EQ(result.capacityBytes, 10e6 / 8 * 60);
+    EXPECT_GT(result.utilization(), 0.9);
+    EXPECT_LE(result.utilization(), 1.0);
+    EXPECT_EQ(result.randomLosses, 0u);
+    // Reno overflows the buffer of one BDP now and then, and its queue
+    // never exceeds that buffer
+    EXPECT_GT(result.queueDrops, 0u);
+    EXPECT_GT(result.averageQueueDelayMs, 0);
+    EXPECT_LE(result.averageQueueDelayMs, 100);
+    EXPECT_GE(sender.minRtt_, 100ms);
+    EXPECT_LE(sender.maxRtt_, 201ms);
+    EXPECT_GT(result.secondsTo90, 0);
+    EXPECT_DOUBLE_EQ(result.fairness, 1.0);
+}
+
+TEST_F(LinkEmulatorTest, SameSeedSameResult) {
+    config.lossRate = 0.001;
+    config.jitter = 5ms;
+    auto runOnce = [&](uint64_t seed) {
+        config.seed = seed;
+        LinkEmulator emulator(config, start);
+        RenoSender first;
+        RenoSender second;
+        emulator.addFlow(first);
+        emulator.addFlow(second, 5);
+        return emulator.run();
+    };
+    auto a = runOnce(7);
+    auto b = runOnce(7);
+    ASSERT_EQ(a.flows.size(), 2u);
+    for (size_t flow = 0; flow < a.flows.size(); ++flow) {
+        EXPECT_EQ(a.flows[flow].deliveredBytes, b.flows[flow].deliveredBytes);
+        EXPECT_EQ(a.flows[flow].randomLosses, b.flows[flow].randomLosses);
+        EXPECT_EQ(a.flows[flow].queueDrops, b.flows[flow].queueDrops);
+        EXPECT_DOUBLE_EQ(a.flows[flow].averageQueueDelayMs, b.flows[flow].averageQueueDelayMs);
+    }
+    EXPECT_GT(a.randomLosses, 0u);
+
+    auto other = runOnce(8);
+    EXPECT_NE(other.deliveredBytes, a.deliveredBytes);
+}
+
+TEST_F(LinkEmulatorTest, EqualFlowsShareFairly) {
+    config.seconds = 300;
+    LinkEmulator emulator(config, start);
+    RenoSender first;
+    RenoSender second;
+    emulator.addFlow(first);
+    emulator.addFlow(second);
+    auto result = emulator.run();
+
+    ASSERT_EQ(result.flows.size(), 2u);
+    EXPECT_GT(result.fairness, 0.95);
+    EXPECT_GT(result.utilization(), 0.9);
+    EXPECT_EQ(result.deliveredBytes, result.flows[0].deliveredBytes + result.flows[1].deliveredBytes);
+    EXPECT_NEAR(result.flows[0].goodputMbps() + result.flows[1].goodputMbps(), 10, 1);
+}
+
+TEST_F(LinkEmulatorTest, FlowsSendOnlyWhileActive) {
+    LinkEmulator emulator(config, start);
+    RenoSender early(&emulator);
+    RenoSender late(&emulator);
+    emulator.addFlow(early, 0, 20);
+    emulator.addFlow(late, 30);
+    auto result = emulator.run();
+
+    EXPECT_EQ(early.firstSend_, start);
+    EXPECT_LT(early.lastSend_, start + 20s);
+    EXPECT_EQ(late.firstSend_, start + 30s);
+    EXPECT_DOUBLE_EQ(result.flows[0].activeSeconds, 20);
+    EXPECT_DOUBLE_EQ(result.flows[1].activeSeconds, 30);
+    // Each had the link to itself
+    EXPECT_NEAR(result.flows[0].goodputMbps(), 10, 1.5);
+    EXPECT_NEAR(result.flows[1].goodputMbps(), 10, 1.5);
+    // Callbacks come at the emulator's simulated time
+    EXPECT_TRUE(early.clockMatched_);
+    EXPECT_TRUE(late.clockMatched_);
+}
+
+TEST_F(LinkEmulatorTest, JitterDelaysWithoutReordering) {
+    config.jitter = 20ms;
+    config.bufferBytes = 10 * MSS;
+    LinkEmulator emulator(config, start);
+    RenoSender sender;
+    emulator.addFlow(sender);
+    auto result = emulator.run();
+
+    EXPECT_GE(sender.minRtt_, 100ms);
+    EXPECT_GT(sender.maxRtt_, 110ms);
+    // In-order delivery: only queue drops are declared lost
+    EXPECT_EQ(sender.losses_, result.queueDrops);
+}
+
+TEST_F(LinkEmulatorTest, PathTraceOverridesFixedPath) {
+    config.path = [](double seconds) {
+        // An outage halfway through
+        double rate = seconds >= 30 && seconds < 40 ? 1.0 : 10e6 / 8;
+        return LinkEmulator::PathState{50ms, rate, 0};
+    };
+    LinkEmulator emulator(config, start);
+    EXPECT_EQ(emulator.pathAt(0).rtt, 50ms);
+    RenoSender sender;
+    emulator.addFlow(sender);
+    auto result = emulator.run();
+
+    EXPECT_NEAR(result.capacityBytes, 10e6 / 8 * 50, 10e6 / 8);
+    EXPECT_GE(sender.minRtt_, 50ms);
+    EXPECT_LT(sender.minRtt_, 100ms);
+    // Reno times out during the outage and takes a while to recover
+    EXPECT_GT(result.utilization(), 0.5);
+    EXPECT_GT(sender.losses_, 0u);
+}
+
+TEST_F(LinkEmulatorTest, HourOfTransferInSimulatedTime) {
+    config.seconds = 3600;
+    config.bytesPerSecond = 1e6 / 8;
+    LinkEmulator emulator(config, start);
+    RenoSender sender(&emulator);
+    emulator.addFlow(sender);
+    auto result = emulator.run();
+
+    EXPECT_GT(result.utilization(), 0.9);
+    EXPECT_LT(emulator.getClock().now(), start + 3600s);
+    EXPECT_GT(emulator.getClock().now(), start + 3599s);
+    EXPECT_TRUE(sender.clockMatched_);
+}
+
+TEST(JainFairnessTest, Index) {
+    EXPECT_DOUBLE_EQ(jainFairness({5, 5, 5}), 1.0);
+    EXPECT_DOUBLE_EQ(jainFairness({1, 0}), 0.5);
+    EXPECT_DOUBLE_EQ(jainFairness({1, 0, 0, 0}), 0.25);
+    EXPECT_DOUBLE_EQ(jainFairness({}), 1.0);
+}
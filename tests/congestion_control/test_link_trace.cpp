@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/link_trace.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using Sample = LinkTrace::Sample;
+
+namespace {
+
+Sample sample(std::chrono::milliseconds at, std::chrono::microseconds rtt, uint64_t bitsPerSecond,
+              double lossRate = 0) {
+    Sample result;
+    result.at = at;
+    result.rtt = rtt;
+    result.bitsPerSecond = bitsPerSecond;
+    result.lossRate = lossRate;
+    return result;
+}
+
+// Starlink-like: 15 s handover slots with an RTT step at each, one outage
+LinkTrace starlinkTrace() {
+    LinkTrace trace;
+    trace.setProvider("starlink");
+    for (int second = 0; second < 60; ++second) {
+        auto rtt = std::chrono::microseconds(second / 15 % 2 ? 45000 : 28000);
+        trace.addSample(sample(std::chrono::seconds(second), rtt, 150000000 - second * 1000000, 0.002));
+    }
+    trace.addOutage(LinkTrace::Outage{20s, 1500ms});
+    return trace;
+}
+
+void expectSameTrace(const LinkTrace& a, const LinkTrace& b) {
+    EXPECT_EQ(a.getProvider(), b.getProvider());
+    ASSERT_EQ(a.getSamples().size(), b.getSamples().size());
+    for (size_t i = 0; i < a.getSamples().size(); ++i) {
+        EXPECT_EQ(a.getSamples()[i].at, b.getSamples()[i].at);
+        EXPECT_EQ(a.getSamples()[i].rtt, b.getSamples()[i].rtt);
+        EXPECT_EQ(a.getSamples()[i].bitsPerSecond, b.getSamples()[i].bitsPerSecond);
+        EXPECT_DOUBLE_EQ(a.getSamples()[i].lossRate, b.getSamples()[i].lossRate);
+    }
+    ASSERT_EQ(a.getOutages().size(), b.getOutages().size());
+    for (size_t i = 0; i < a.getOutages().size(); ++i) {
+        EXPECT_EQ(a.getOutages()[i].start, b.getOutages()[i].start);
+        EXPECT_EQ(a.getOutages()[i].duration, b.getOutages()[i].duration);
+    }
+}
+
+} // namespace
+
+TEST(LinkTraceTest, LooksUpSampleAndOutage) {
+    LinkTrace trace = starlinkTrace();
+    EXPECT_EQ(trace.duration(), 60s);
+    EXPECT_EQ(trace.sampleAt(0ms).rtt, 28ms);
+    EXPECT_EQ(trace.sampleAt(15999ms).rtt, 45ms);
+    EXPECT_EQ(trace.sampleAt(15999ms).bitsPerSecond, 135000000u);
+    EXPECT_EQ(trace.sampleAt(10min).bitsPerSecond, 91000000u);  // Last sample holds
+    EXPECT_FALSE(trace.inOutage(19999ms));
+    EXPECT_TRUE(trace.inOutage(20s));
+    EXPECT_TRUE(trace.inOutage(21499ms));
+    EXPECT_FALSE(trace.inOutage(21500ms));
+}
+
+TEST(LinkTraceTest, RejectsOutOfOrderRecords) {
+    LinkTrace trace;
+    EXPECT_TRUE(trace.addSample(sample(1s, 30ms, 1000000)));
+    EXPECT_FALSE(trace.addSample(sample(500ms, 30ms, 1000000)));
+    EXPECT_TRUE(trace.addOutage(LinkTrace::Outage{2s, 1s}));
+    EXPECT_FALSE(trace.addOutage(LinkTrace::Outage{2500ms, 1s}));  // Overlaps
+    EXPECT_FALSE(trace.getLastError().empty());
+    EXPECT_EQ(trace.getSamples().size(), 1u);
+}
+
+TEST(LinkTraceTest, BinaryRoundTripIsCompact) {
+    LinkTrace trace = starlinkTrace();
+    auto data = trace.serialize();
+    LinkTrace restored;
+    ASSERT_TRUE(restored.deserialize(data)) << restored.getLastError();
+    expectSameTrace(trace, restored);
+
+    // A day at one sample a second, RTT and capacity wandering by a few
+    // percent a second, is about half a megabyte
+    LinkTrace day;
+    for (int64_t second = 0; second < 86400; ++second) {
+        auto rtt = std::chrono::microseconds(25000 + (second * 7919) % 2000 + second % 15 * 1000);
+        day.addSample(sample(std::chrono::seconds(second), rtt, 100000000 + (second * 104729) % 4000000, 0.001));
+    }
+    EXPECT_LT(day.serialize().size(), 600000u);
+}
+
+TEST(LinkTraceTest, RoundsToFileResolution) {
+    LinkTrace trace;
+    trace.addSample(sample(0ms, 28349us, 1234567, 0.0012345678));
+    EXPECT_EQ(trace.getSamples()[0].rtt, 28300us);
+    EXPECT_EQ(trace.getSamples()[0].bitsPerSecond, 1235000u);
+    EXPECT_DOUBLE_EQ(trace.getSamples()[0].lossRate, 0.001235);
+}
+
+TEST(LinkTraceTest, RejectsMalformedBinary) {
+    auto data = starlinkTrace().serialize();
+    LinkTrace trace = starlinkTrace();
+
+    auto truncated = data;
+    truncated.resize(data.size() - 3);
+    EXPECT_FALSE(trace.deserialize(truncated));
+    auto trailing = data;
+    trailing.push_back(0);
+    EXPECT_FALSE(trace.deserialize(trailing));
+    auto version = data;
+    version[4] = LinkTrace::FORMAT_VERSION + 1;
+    EXPECT_FALSE(trace.deserialize(version));
+    EXPECT_NE(trace.getLastError().find("version"), std::string::npos);
+    EXPECT_FALSE(trace.deserialize({'S', 'R'}));
+
+    // Left as it was
+    expectSameTrace(trace, starlinkTrace());
+}
+
+TEST(LinkTraceTest, ParsesText) {
+    LinkTrace trace;
+    ASSERT_TRUE(trace.parseText("# Iridium Certus, terminal 3\n"
+                                "provider iridium\n"
+                                "0     1450   0.352  1.5\n"
+                                "1000  1620.5 0.352  0   # handover\n"
+                                "\n"
+                                "outage 1500 4000\n"))
+        << trace.getLastError();
+    EXPECT_EQ(trace.getProvider(), "iridium");
+    ASSERT_EQ(trace.getSamples().size(), 2u);
+    EXPECT_EQ(trace.getSamples()[0].rtt, 1450ms);
+    EXPECT_EQ(trace.getSamples()[0].bitsPerSecond, 352000u);
+    EXPECT_DOUBLE_EQ(trace.getSamples()[0].lossRate, 0.015);
+    EXPECT_EQ(trace.getSamples()[1].rtt, 1620500us);
+    EXPECT_TRUE(trace.inOutage(3s));
+
+    EXPECT_FALSE(trace.parseText("0 30 100 0\n500 30 100\n"));
+    EXPECT_NE(trace.getLastError().find("line 2"), std::string::npos);
+    EXPECT_FALSE(trace.parseText("0 30 100 0 extra\n"));
+    EXPECT_FALSE(trace.parseText("1000 30 100 0\n0 30 100 0\n"));
+    EXPECT_EQ(trace.getProvider(), "iridium");
+}
+
+TEST(LinkTraceTest, SavesAndLoadsEitherFormat) {
+    std::string binary = ::testing::TempDir() + "srpt_link_trace_test.trace";
+    std::string text = ::testing::TempDir() + "srpt_link_trace_test.txt";
+    LinkTrace trace = starlinkTrace();
+    ASSERT_TRUE(trace.save(binary)) << trace.getLastError();
+    {
+        std::ofstream out(text);
+        out << "provider starlink\n0 30 100 0\n";
+    }
+
+    LinkTrace loaded;
+    ASSERT_TRUE(loaded.load(binary)) << loaded.getLastError();
+    expectSameTrace(trace, loaded);
+    ASSERT_TRUE(loaded.load(text)) << loaded.getLastError();
+    EXPECT_EQ(loaded.getSamples().size(), 1u);
+
+    std::remove(binary.c_str());
+    std::remove(text.c_str());
+    EXPECT_FALSE(loaded.load(binary));
+}
+
+TEST(LinkTraceTest, ReplaysInLinkEmulator) {
+    LinkTrace trace = starlinkTrace();
+    auto path = trace.replay();
+    EXPECT_EQ(path(0).rtt, 28ms);
+    EXPECT_DOUBLE_EQ(path(0).bytesPerSecond, 150e6 / 8);
+    EXPECT_DOUBLE_EQ(path(0).lossRate, 0.002);
+    EXPECT_DOUBLE_EQ(path(20.5).lossRate, 1.0);  // Outage
+    EXPECT_EQ(path(70).rtt, 28ms);               // Looped: 10 s in
+    EXPECT_EQ(path(76).rtt, 45ms);
+    EXPECT_EQ(trace.replay(false)(70).rtt, 45ms);
+
+    LinkEmulator::Config config;
+    config.seconds = 60;
+    config.path = path;
+    LinkEmulator emulator(config, LinkEmulator::TimePoint() + 1h);
+    EXPECT_EQ(emulator.pathAt(16).rtt, 45ms);
+}
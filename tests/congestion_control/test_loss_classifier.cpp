@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/loss_classifier.h"
+#include "../../src/congestion_control/cubic.h"
+#include "../../src/congestion_control/satellite_optimized.h"
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = LossClassifier::TimePoint;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// One RTT sample per millisecond from `from` for `duration`
+TimePoint feedRtt(LossClassifier& classifier, TimePoint from, std::chrono::milliseconds duration,
+                  std::chrono::microseconds rtt) {
+    TimePoint now = from;
+    for (; now < from + duration; now += 1ms) {
+        classifier.onRttSample(rtt, now);
+    }
+    return now;
+}
+
+} // namespace
+
+TEST(LossClassifierTest, UnknownUntilFirstRttSample) {
+    LossClassifier classifier;
+    EXPECT_EQ(classifier.classify(1, TimePoint{}), LossCause::UNKNOWN);
+    EXPECT_EQ(classifier.getStats().unknown, 1u);
+}
+
+TEST(LossClassifierTest, DelayDecidesIsolatedLosses) {
+    LossClassifier classifier;
+    TimePoint now = feedRtt(classifier, TimePoint{}, 500ms, 50ms);
+    // Flat RTT at the floor: the queue was empty and could not overflow
+    EXPECT_EQ(classifier.classify(1, now), LossCause::WIRELESS);
+
+    // 30 ms of queueing on a 50 ms path
+    now = feedRtt(classifier, now + 1s, 500ms, 80ms);
+    EXPECT_TRUE(classifier.queueStanding());
+    EXPECT_EQ(classifier.classify(1, now), LossCause::CONGESTION);
+    EXPECT_EQ(classifier.getStats().wireless, 1u);
+    EXPECT_EQ(classifier.getStats().congestion, 1u);
+}
+
+TEST(LossClassifierTest, BurstWithoutStandingQueueIsWireless) {
+    LossClassifier classifier;
+    // A few ms of queue: not standing, not empty either
+    TimePoint now = feedRtt(classifier, TimePoint{}, 2s, 50ms);
+    now = feedRtt(classifier, now, 500ms, 54ms);
+    EXPECT_FALSE(classifier.queueStanding());
+    EXPECT_EQ(classifier.classify(1, now), LossCause::CONGESTION);
+
+    // A fade drops a run of packets at once
+    now += 1s;
+    EXPECT_EQ(classifier.classify(4, now), LossCause::WIRELESS);
+    EXPECT_TRUE(classifier.inBurst(now));
+    EXPECT_FALSE(classifier.inBurst(now + 200ms));
+
+    // The same burst with a standing queue is overflow
+    now = feedRtt(classifier, now + 1s, 500ms, 90ms);
+    EXPECT_EQ(classifier.classify(4, now), LossCause::CONGESTION);
+}
+
+TEST(LossClassifierTest, DegradedSignalOutweighsDelay) {
+    LossClassifier classifier;
+    TimePoint now = feedRtt(classifier, TimePoint{}, 500ms, 50ms);
+    now = feedRtt(classifier, now, 500ms, 90ms);
+    classifier.onSignalStrength(0.9, now);
+    EXPECT_EQ(classifier.classify(1, now), LossCause::CONGESTION);
+
+    // Rain fade: the signal drops well below its recent level
+    now += 1s;
+    classifier.onSignalStrength(0.6, now);
+    EXPECT_TRUE(classifier.signalDegraded(now));
+    EXPECT_EQ(classifier.classify(1, now), LossCause::WIRELESS);
+
+    // Steady again, and the fade has left the window
+    now += 3s;
+    classifier.onSignalStrength(0.6, now);
+    EXPECT_FALSE(classifier.signalDegraded(now));
+    EXPECT_EQ(classifier.classify(1, now), LossCause::CONGESTION);
+
+    classifier.onSignalStrength(0.1, now + 100ms);
+    EXPECT_EQ(classifier.classify(1, now + 100ms), LossCause::WIRELESS);
+}
+
+TEST(LossClassifierTest, ZeroSignalFromProviderWithoutMeasurementIsIgnored) {
+    LossClassifier classifier;
+    TimePoint now = feedRtt(classifier, TimePoint{}, 500ms, 50ms);
+    now = feedRtt(classifier, now, 500ms, 90ms);
+    classifier.onSignalStrength(0.0, now);
+    EXPECT_FALSE(classifier.signalDegraded(now));
+    EXPECT_EQ(classifier.classify(1, now), LossCause::CONGESTION);
+}
+
+TEST(LossClassifierTest, ControllersKeepWindowOnWirelessLoss) {
+    TimePoint start{};
+    Cubic cubic(start);
+    SatelliteOptimized satellite(SatelliteOptimized::Options(), start);
+    AckEvent ack;
+    ack.ackedPackets = 1;
+    ack.ackedBytes = MSS;
+    ack.rtt = 50ms;
+    for (int i = 0; i < 20; ++i) {
+        ack.now = start + std::chrono::milliseconds(10 * i);
+        cubic.onAck(ack);
+        satellite.onAck(ack);
+    }
+
+    AckEvent loss;
+    loss.now = start + 1s;
+    loss.lostPackets = 2;
+    loss.lostBytes = 2 * MSS;
+    loss.lossCause = LossCause::WIRELESS;
+    uint32_t cubic_cwnd = cubic.getCongestionWindow();
+    uint32_t satellite_cwnd = satellite.getCongestionWindow();
+    cubic.onAck(loss);
+    satellite.onAck(loss);
+    EXPECT_EQ(cubic.getCongestionWindow(), cubic_cwnd);
+    EXPECT_EQ(satellite.getCongestionWindow(), satellite_cwnd);
+    EXPECT_EQ(satellite.getRandomLosses(), 1u);
+
+    // Classified congestion halves SatelliteOptimized even with no queue
+    loss.lossCause = LossCause::CONGESTION;
+    satellite.onAck(loss);
+    EXPECT_EQ(satellite.getCongestionWindow(), static_cast<uint32_t>(satellite_cwnd * 0.5));
+    cubic.onAck(loss);
+    EXPECT_LT(cubic.getCongestionWindow(), cubic_cwnd);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/path_cache.h"
+#include "../../src/congestion_control/adaptive_selector.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using Clock = PathCache::Clock;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+PathCache::Entry geoEntry(Clock::time_point now) {
+    PathCache::Entry entry;
+    entry.minRtt = 600ms;
+    entry.bandwidth = 12500000;
+    entry.ssthresh = 3000000;
+    entry.lossRate = 0.001;
+    entry.updated = now;
+    return entry;
+}
+
+} // namespace
+
+TEST(PathCacheTest, StoresPerPeerAndProvider) {
+    PathCache cache;
+    auto now = Clock::now();
+    cache.store("ground-1", "starlink", geoEntry(now));
+
+    PathCache::Entry entry;
+    ASSERT_TRUE(cache.lookup("ground-1", "starlink", entry, now));
+    EXPECT_EQ(entry.minRtt, 600ms);
+    EXPECT_EQ(entry.bandwidth, 12500000u);
+    EXPECT_EQ(entry.ssthresh, 3000000u);
+    EXPECT_FALSE(cache.lookup("ground-1", "iridium", entry, now));
+    EXPECT_FALSE(cache.lookup("ground-2", "starlink", entry, now));
+
+    // A later connection replaces the RTT and averages the bandwidth
+    ControllerState state;
+    state.minRtt = 580ms;
+    state.bandwidth = 6250000;
+    state.ssthresh = UINT32_MAX;
+    cache.store("ground-1", "starlink", state, 0.003, now);
+    ASSERT_TRUE(cache.lookup("ground-1", "starlink", entry, now));
+    EXPECT_EQ(entry.minRtt, 580ms);
+    EXPECT_EQ(entry.bandwidth, 9375000u);
+    EXPECT_EQ(entry.ssthresh, 3000000u);  // Kept: slow start never ended
+    EXPECT_NEAR(entry.lossRate, 0.002, 1e-12);
+}
+
+TEST(PathCacheTest, EntriesAgeAndExpire) {
+    PathCache::Options options;
+    options.maxAge = 3600s;
+    options.bandwidthHalfLife = 600s;
+    PathCache cache(options);
+    auto now = Clock::now();
+    cache.store("ground-1", "starlink", geoEntry(now));
+
+    PathCache::Entry entry;
+    ASSERT_TRUE(cache.lookup("ground-1", "starlink", entry, now + 1200s));
+    EXPECT_NEAR(static_cast<double>(entry.bandwidth), 12500000 / 4.0, 1.0);
+    EXPECT_EQ(entry.minRtt, 600ms);
+
+    EXPECT_FALSE(cache.lookup("ground-1", "starlink", entry, now + 3601s));
+    EXPECT_EQ(cache.size(), 1u);
+    cache.expire(now + 3601s);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(PathCacheTest, EvictsLeastRecentlyUpdated) {
+    PathCache::Options options;
+    options.capacity = 2;
+    PathCache cache(options);
+    auto now = Clock::now();
+    cache.store("a", "starlink", geoEntry(now));
+    cache.store("b", "starlink", geoEntry(now + 1s));
+    cache.store("c", "starlink", geoEntry(now + 2s));
+    PathCache::Entry entry;
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_FALSE(cache.lookup("a", "starlink", entry, now + 2s));
+    EXPECT_TRUE(cache.lookup("c", "starlink", entry, now + 2s));
+}
+
+TEST(PathCacheTest, PersistsAcrossInstances) {
+    std::string path = ::testing::TempDir() + "srpt_path_cache_test.txt";
+    auto now = Clock::now();
+    {
+        PathCache cache;
+        cache.store("ground-1", "starlink", geoEntry(now));
+        cache.store("ground-2", "iridium", geoEntry(now - 7200s));  // Expired by load time
+        cache.store("bad\tpeer", "starlink", geoEntry(now));
+        ASSERT_TRUE(cache.save(path)) << cache.getLastError();
+    }
+    {
+        std::ofstream append(path, std::ios::app);
+        append << "truncated\tline\n";
+    }
+
+    PathCache restored;
+    ASSERT_TRUE(restored.load(path, now));
+    EXPECT_EQ(restored.size(), 1u);
+    PathCache::Entry entry;
+    ASSERT_TRUE(restored.lookup("ground-1", "starlink", entry, now));
+    EXPECT_EQ(entry.minRtt, 600ms);
+    EXPECT_EQ(entry.ssthresh, 3000000u);
+    EXPECT_DOUBLE_EQ(entry.lossRate, 0.001);
+    EXPECT_LE(std::chrono::abs(entry.updated - now), 1ms);
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(restored.load(path, now));
+    EXPECT_FALSE(restored.getLastError().empty());
+}
+
+TEST(PathCacheTest, WarmStartsSelector) {
+    AdaptiveSelector::TimePoint start{};
+    AdaptiveSelector selector(AdaptiveSelector::Options(), start);
+    selector.warmStart(geoEntry(Clock::now()), start);
+    // GEO-class RTT: straight to SatelliteOptimized, without counting a switch
+    EXPECT_EQ(selector.getAlgorithm(), AdaptiveSelector::Algorithm::SATELLITE);
+    EXPECT_EQ(selector.getSwitches(), 0u);
+    EXPECT_EQ(selector.getJumpPhase(), JumpStart::Phase::UNVALIDATED);
+    // Half the BDP would be 3.75 MB; the cached ssthresh caps it
+    EXPECT_LE(selector.getCongestionWindow(), 3000000u);
+    EXPECT_GT(selector.getCongestionWindow(), 3000000u - MSS);
+}
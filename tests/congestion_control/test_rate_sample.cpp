@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/rate_sample.h"
+#include "../../src/congestion_control/bbr.h"
+#include "../../src/congestion_control/cubic.h"
+#include <deque>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = RateSampler::TimePoint;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// Records what the default onAck forwards
+class Recorder : public ICongestionControl {
+public:
+    void onPacketSent(uint32_t) override {}
+    void onAckReceived(uint32_t ackedBytes, std::chrono::milliseconds rtt) override {
+        acked += ackedBytes;
+        lastRtt = rtt;
+    }
+    void onPacketLoss() override { ++losses; }
+    uint32_t getCongestionWindow() const override { return 0; }
+    uint32_t getSendingRate() const override { return 0; }
+
+    uint32_t acked = 0;
+    uint32_t losses = 0;
+    std::chrono::milliseconds lastRtt{0};
+};
+
+} // namespace
+
+TEST(WindowedMinRttTest, KeepsMinimumWithinWindow) {
+    TimePoint start{};
+    WindowedMinRtt filter(10s);
+    EXPECT_EQ(filter.get(), 0us);
+
+    filter.update(50ms, start);
+    filter.update(80ms, start + 1s);
+    filter.update(60ms, start + 2s);
+    EXPECT_EQ(filter.get(), 50ms);
+
+    // The 50 ms sample ages out; 60 ms evicted 80 ms when it arrived
+    filter.update(70ms, start + 11s);
+    EXPECT_EQ(filter.get(), 60ms);
+    filter.update(90ms, start + 13s);
+    EXPECT_EQ(filter.get(), 70ms);
+
+    filter.reset(200ms, start + 14s);
+    EXPECT_EQ(filter.get(), 200ms);
+}
+
+TEST(RateSamplerTest, SteadyLinkMeasuresBottleneckRate) {
+    // One packet per millisecond, each acked 50 ms after it is sent
+    TimePoint start{};
+    RateSampler sampler;
+    AckEvent last;
+    uint64_t next = 0;
+    for (int ms = 0; ms < 500; ++ms) {
+        TimePoint now = start + std::chrono::milliseconds(ms);
+        if (ms >= 50) {
+            sampler.onPacketAcked(next - 50, now);
+            last = sampler.takeAckEvent(now);
+        }
+        sampler.onPacketSent(next++, MSS, now);
+    }
+    EXPECT_EQ(last.rtt, 50ms);
+    EXPECT_EQ(last.minRtt, 50ms);
+    EXPECT_EQ(last.ackedPackets, 1u);
+    EXPECT_FALSE(last.appLimited);
+    EXPECT_NEAR(static_cast<double>(last.deliveryRate), MSS * 1000.0, MSS * 1000.0 * 0.05);
+    EXPECT_EQ(sampler.getBytesInFlight(), 50 * MSS);
+    EXPECT_EQ(sampler.getDelivered(), 450u * MSS);
+}
+
+TEST(RateSamplerTest, AckCompressionDoesNotInflateRate) {
+    // Ten packets sent 1 ms apart; their acks arrive together
+    TimePoint start{};
+    RateSampler sampler;
+    for (uint64_t i = 0; i < 10; ++i) {
+        sampler.onPacketSent(i, MSS, start + std::chrono::milliseconds(i));
+    }
+    TimePoint ackTime = start + 60ms;
+    for (uint64_t i = 0; i < 10; ++i) {
+        sampler.onPacketAcked(i, ackTime);
+        AckEvent ack = sampler.takeAckEvent(ackTime);
+        // Never faster than the packets were sent
+        EXPECT_LE(ack.deliveryRate, MSS * 1000u);
+        EXPECT_GE(ack.interval, ack.minRtt);
+    }
+}
+
+TEST(RateSamplerTest, BatchedAckAggregatesPackets) {
+    TimePoint start{};
+    RateSampler sampler;
+    for (uint64_t i = 0; i < 5; ++i) {
+        sampler.onPacketSent(i, MSS, start + std::chrono::milliseconds(i));
+    }
+    TimePoint now = start + 40ms;
+    sampler.onPacketLost(0);
+    sampler.onPacketAcked(2, now);
+    sampler.onPacketAcked(1, now);
+    sampler.onPacketAcked(3, now);
+    sampler.onPacketAcked(3, now);  // Duplicate
+    AckEvent ack = sampler.takeAckEvent(now);
+
+    EXPECT_EQ(ack.priorInFlight, 5 * MSS);
+    EXPECT_EQ(ack.ackedBytes, 3 * MSS);
+    EXPECT_EQ(ack.ackedPackets, 3u);
+    EXPECT_EQ(ack.lostBytes, MSS);
+    EXPECT_EQ(ack.lostPackets, 1u);
+    EXPECT_EQ(ack.rtt, 37ms);  // From packet 3, the most recently sent
+    EXPECT_EQ(ack.delivered, 3u * MSS);
+    EXPECT_EQ(sampler.getBytesInFlight(), MSS);
+
+    AckEvent empty = sampler.takeAckEvent(now);
+    EXPECT_EQ(empty.ackedBytes, 0u);
+    EXPECT_EQ(empty.deliveryRate, 0u);
+}
+
+TEST(RateSamplerTest, AppLimitedUntilInFlightDelivered) {
+    TimePoint start{};
+    RateSampler sampler;
+    sampler.onPacketSent(0, MSS, start);
+    sampler.onPacketSent(1, MSS, start + 1ms);
+    sampler.onAppLimited();
+    EXPECT_TRUE(sampler.isAppLimited());
+    sampler.onPacketSent(2, MSS, start + 2ms);
+
+    sampler.onPacketAcked(0, start + 20ms);
+    EXPECT_FALSE(sampler.takeAckEvent(start + 20ms).appLimited);
+    sampler.onPacketAcked(1, start + 21ms);
+    sampler.takeAckEvent(start + 21ms);
+    // Sent while limited
+    sampler.onPacketAcked(2, start + 22ms);
+    EXPECT_TRUE(sampler.takeAckEvent(start + 22ms).appLimited);
+    EXPECT_FALSE(sampler.isAppLimited());
+
+    sampler.onPacketSent(3, MSS, start + 23ms);
+    sampler.onPacketAcked(3, start + 43ms);
+    EXPECT_FALSE(sampler.takeAckEvent(start + 43ms).appLimited);
+}
+
+TEST(RateSamplerTest, DefaultOnAckMapsToLegacyCalls) {
+    Recorder recorder;
+    AckEvent ack;
+    ack.ackedBytes = 3 * MSS;
+    ack.lostBytes = 2 * MSS;
+    ack.lostPackets = 2;
+    ack.rtt = 42500us;
+    ICongestionControl& controller = recorder;
+    controller.onAck(ack);
+    EXPECT_EQ(recorder.acked, 3 * MSS);
+    EXPECT_EQ(recorder.losses, 1u);
+    EXPECT_EQ(recorder.lastRtt, 42ms);
+}
+
+TEST(RateSamplerTest, CubicPacesAtWindowPerSmoothedRtt) {
+    TimePoint start{};
+    Cubic cubic(start);
+    AckEvent ack;
+    ack.ackedPackets = 1;
+    ack.ackedBytes = MSS;
+    ack.rtt = 80ms;
+    for (int i = 0; i < 5; ++i) {
+        ack.now = start + std::chrono::milliseconds(100 + i);
+        cubic.onAck(ack);
+    }
+    EXPECT_EQ(cubic.getSmoothedRtt(), 80ms);
+    // Independent of how long ago the last loss was
+    EXPECT_EQ(cubic.getSendingRate(), cubic.getCongestionWindow() * 1000000u / 80000u);
+
+    uint32_t cwnd = cubic.getCongestionWindow();
+    ack.ackedPackets = 0;
+    ack.ackedBytes = 0;
+    ack.lostPackets = 3;
+    ack.lostBytes = 3 * MSS;
+    cubic.onAck(ack);
+    // Three losses in one ack are one congestion event
+    EXPECT_EQ(cubic.getCongestionWindow(), std::max(static_cast<uint32_t>(cwnd * Cubic::BETA_CUBIC),
+                                                    2 * Cubic::INITIAL_WINDOW));
+}
+
+TEST(RateSamplerTest, BbrModelFromRateSamples) {
+    // A 10 Mbit/s bottleneck with 40 ms RTT, driven through the sampler
+    constexpr double BYTES_PER_SECOND = 1.25e6;
+    constexpr auto RTT = 40ms;
+    TimePoint start{};
+    TimePoint now = start;
+    Bbr bbr(MSS, start);
+    RateSampler sampler;
+    struct Pending {
+        uint64_t number;
+        TimePoint ackAt;
+    };
+    std::deque<Pending> flight;
+    auto serialization = std::chrono::nanoseconds(static_cast<int64_t>(MSS * 1e9 / BYTES_PER_SECOND));
+    TimePoint linkFree = start;
+    TimePoint nextSend = start;
+    uint64_t number = 0;
+    while (now < start + 10s) {
+        bool acked = false;
+        while (!flight.empty() && flight.front().ackAt <= now) {
+            sampler.onPacketAcked(flight.front().number, now);
+            flight.pop_front();
+            acked = true;
+        }
+        if (acked) {
+            bbr.onAck(sampler.takeAckEvent(now));
+        }
+        if (now >= nextSend && sampler.getBytesInFlight() + MSS <= bbr.getCongestionWindow()) {
+            sampler.onPacketSent(number, MSS, now);
+            bbr.onPacketSent(MSS, now);
+            linkFree = std::max(now, linkFree) + serialization;
+            flight.push_back(Pending{number++, linkFree + RTT});
+            nextSend = now + std::chrono::nanoseconds(static_cast<int64_t>(MSS * 1e9 / bbr.getSendingRate()));
+        }
+        now += 100us;
+    }
+    EXPECT_TRUE(bbr.filledPipe());
+    EXPECT_NEAR(static_cast<double>(bbr.getBottleneckBandwidth()), BYTES_PER_SECOND, BYTES_PER_SECOND * 0.1);
+    EXPECT_GE(bbr.getMinRtt(), RTT);
+    EXPECT_LT(bbr.getMinRtt(), RTT + 5ms);
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "../../src/congestion_control/satellite_optimized.h"
+#include <random>
+
+using namespace SRPT::CongestionControl;
+using namespace std::chrono_literals;
+using TimePoint = SatelliteOptimized::TimePoint;
+
+namespace {
+
+constexpr uint32_t MSS = 1460;
+
+// Acks one full window at `rtt` and advances the clock by it
+void ackRound(SatelliteOptimized& cc, std::chrono::microseconds rtt, TimePoint& now) {
+    uint32_t window = cc.getCongestionWindow();
+    TimePoint end = now + rtt;
+    for (uint32_t acked = 0; acked < window; acked += MSS) {
+        cc.onAckReceived(MSS, rtt, now);
+    }
+    now = end;
+}
+
+// Leaves slow start with a congestion loss on a queue standing above `base`
+void enterCongestionAvoidance(SatelliteOptimized& cc, std::chrono::microseconds base, TimePoint& now) {
+    ackRound(cc, base, now);
+    ackRound(cc, base + base / 6, now);
+    cc.onPacketLoss(now);
+    ASSERT_FALSE(cc.inSlowStart());
+    now += base;
+}
+
+} // namespace
+
+class SatelliteOptimizedTest : public ::testing::Test {
+protected:
+    TimePoint start = TimePoint() + 1h;
+    SatelliteOptimized::Options options;
+};
+
+TEST_F(SatelliteOptimizedTest, InitialState) {
+    SatelliteOptimized cc(options, start);
+    EXPECT_EQ(cc.getCongestionWindow(), SatelliteOptimized::INITIAL_WINDOW_PACKETS * MSS);
+    EXPECT_TRUE(cc.inSlowStart());
+    EXPECT_DOUBLE_EQ(cc.getRho(), 1.0);
+    EXPECT_GT(cc.getSendingRate(), 0u);
+    EXPECT_FALSE(cc.inHandover(start));
+}
+
+TEST_F(SatelliteOptimizedTest, SlowStartScalesWithRho) {
+    SatelliteOptimized terrestrial(options, start);
+    SatelliteOptimized geo(options, start);
+    TimePoint now = start;
+    ackRound(terrestrial, 25ms, now);
+    now = start;
+    ackRound(geo, 600ms, now);
+
+    uint32_t initial = SatelliteOptimized::INITIAL_WINDOW_PACKETS * MSS;
+    EXPECT_DOUBLE_EQ(terrestrial.getRho(), 1.0);
+    EXPECT_DOUBLE_EQ(geo.getRho(), 24.0);
+    EXPECT_EQ(terrestrial.getCongestionWindow(), 2 * initial);
+    // 2^rho per round, capped at 2^MAX_SLOW_START_RHO
+    EXPECT_EQ(geo.getCongestionWindow(), 16 * initial);
+}
+
+TEST_F(SatelliteOptimizedTest, CongestionAvoidanceIsRttFair) {
+    // With a standing queue, growth is rho^2 packets per RTT, so the sending
+    // rate cwnd / RTT climbs at the same pace in wall-clock time
+    auto rateGrowth = [&](std::chrono::microseconds base, std::chrono::microseconds queued) {
+        SatelliteOptimized cc(options, start);
+        TimePoint now = start;
+        enterCongestionAvoidance(cc, base, now);
+        double rateBefore = cc.getCongestionWindow() * 1e6 / queued.count();
+        TimePoint from = now;
+        while (now - from < 3s) {
+            ackRound(cc, queued, now);
+        }
+        double rateAfter = cc.getCongestionWindow() * 1e6 / queued.count();
+        return (rateAfter - rateBefore) / std::chrono::duration<double>(now - from).count();
+    };
+    double terrestrial = rateGrowth(25ms, 30ms);
+    double geo = rateGrowth(600ms, 690ms);
+    EXPECT_GT(terrestrial, 0);
+    EXPECT_NEAR(geo / terrestrial, 1.0, 0.2);
+}
+
+TEST_F(SatelliteOptimizedTest, CongestionLossCutsOncePerRtt) {
+    SatelliteOptimized cc(options, start);
+    TimePoint now = start;
+    ackRound(cc, 100ms, now);
+    ackRound(cc, 115ms, now);  // Standing queue
+    uint32_t cwnd = cc.getCongestionWindow();
+
+    cc.onPacketLoss(now);
+    EXPECT_EQ(cc.getCongestionWindow(), static_cast<uint32_t>(cwnd * options.beta));
+    EXPECT_EQ(cc.getSsthresh(), cc.getCongestionWindow());
+    cc.onPacketLoss(now + 10ms);
+    EXPECT_EQ(cc.getCongestionWindow(), static_cast<uint32_t>(cwnd * options.beta));
+
+    cc.onPacketLoss(now + 200ms);
+    EXPECT_EQ(cc.getCongestionWindow(), static_cast<uint32_t>(static_cast<uint32_t>(cwnd * options.beta) * options.beta));
+    EXPECT_EQ(cc.getRandomLosses(), 0u);
+}
+
+TEST_F(SatelliteOptimizedTest, LossOnEmptyQueueIsRandom) {
+    SatelliteOptimized cc(options, start);
+    TimePoint now = start;
+    ackRound(cc, 600ms, now);
+    uint32_t cwnd = cc.getCongestionWindow();
+    cc.onPacketLoss(now);
+    EXPECT_EQ(cc.getRandomLosses(), 1u);
+    EXPECT_EQ(cc.getCongestionWindow(), static_cast<uint32_t>(cwnd * 0.9));
+}
+
+TEST_F(SatelliteOptimizedTest, RttStepIsAPathChange) {
+    SatelliteOptimized cc(options, start);
+    TimePoint now = start;
+    for (int i = 0; i < 5; ++i) {
+        ackRound(cc, 30ms, now);
+    }
+    EXPECT_EQ(cc.getBaseRtt(), 30ms);
+
+    // Handover to a satellite 25 ms further away: the new floor has to hold
+    // before it counts
+    ackRound(cc, 55ms, now);
+    ackRound(cc, 55ms, now);
+    EXPECT_EQ(cc.getPathChanges(), 0u);
+    for (uint32_t i = 0; i < SatelliteOptimized::STEP_HOLD_ROUNDS && cc.getPathChanges() == 0; ++i) {
+        ackRound(cc, 55ms, now);
+    }
+    EXPECT_EQ(cc.getPathChanges(), 1u);
+    EXPECT_EQ(cc.getBaseRtt(), 55ms);
+    ASSERT_TRUE(cc.inHandover(now));
+
+    uint32_t cwnd = cc.getCongestionWindow();
+    cc.onPacketLoss(now + 10ms);
+    EXPECT_EQ(cc.getCongestionWindow(), cwnd);
+    EXPECT_EQ(cc.getHandoverLosses(), 1u);
+
+    // Guard window over: losses count again
+    now += options.handoverGuard + 60ms;
+    EXPECT_FALSE(cc.inHandover(now));
+    cc.onPacketLoss(now);
+    EXPECT_LT(cc.getCongestionWindow(), cwnd);
+}
+
+TEST_F(SatelliteOptimizedTest, ShortRttExcursionIsNotAPathChange) {
+    SatelliteOptimized cc(options, start);
+    TimePoint now = start;
+    for (int i = 0; i < 5; ++i) {
+        ackRound(cc, 30ms, now);
+    }
+    ackRound(cc, 55ms, now);
+    for (int i = 0; i < 5; ++i) {
+        ackRound(cc, 30ms, now);
+    }
+    EXPECT_EQ(cc.getPathChanges(), 0u);
+    EXPECT_FALSE(cc.inHandover(now));
+}
+
+TEST_F(SatelliteOptimizedTest, JitterIsNotAPathChange) {
+    // LEO-like jitter: 40 ms plus up to 15 ms per sample, one ack per ms.
+    // Consecutive samples differ by more than a step all the time, but the
+    // floor does not move, so every loss is still a loss
+    SatelliteOptimized cc(options, start);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> jitter(0, 15000);
+    TimePoint now = start;
+    uint32_t cuts = 0;
+    for (int i = 0; i < 20000; ++i) {
+        cc.onAckReceived(MSS, 40ms + std::chrono::microseconds(jitter(rng)), now);
+        if (i % 500 == 499) {
+            uint32_t cwnd = cc.getCongestionWindow();
+            cc.onPacketLoss(now);
+            EXPECT_LT(cc.getCongestionWindow(), cwnd) << "loss at ack " << i;
+            cuts += cc.getCongestionWindow() < cwnd;
+        }
+        now += 1ms;
+    }
+    EXPECT_EQ(cc.getPathChanges(), 0u);
+    EXPECT_EQ(cc.getHandoverLosses(), 0u);
+    EXPECT_EQ(cuts, 40u);
+    EXPECT_LT(cc.getBaseRtt(), 41ms);
+}
+
+TEST_F(SatelliteOptimizedTest, QueueGrowthIsNotAPathChange) {
+    SatelliteOptimized cc(options, start);
+    TimePoint now = start;
+    for (int ms = 30; ms < 80; ++ms) {
+        cc.onAckReceived(MSS, std::chrono::milliseconds(ms), now);
+        now += 1ms;
+    }
+    EXPECT_EQ(cc.getPathChanges(), 0u);
+    EXPECT_EQ(cc.getBaseRtt(), 30ms);
+    // And the queue ended slow start
+    EXPECT_FALSE(cc.inSlowStart());
+}
+
+TEST_F(SatelliteOptimizedTest, ScheduledHandoversAreGuarded) {
+    options.handoverPeriod = 15s;
+    options.handoverEpoch = start;
+    SatelliteOptimized cc(options, start);
+    TimePoint now = start;
+    ackRound(cc, 40ms, now);
+
+    EXPECT_FALSE(cc.inHandover(start + 7s));
+    EXPECT_TRUE(cc.inHandover(start + 15s + 100ms));
+    EXPECT_TRUE(cc.inHandover(start + 30s + options.handoverGuard));
+    EXPECT_FALSE(cc.inHandover(start + 30s + options.handoverGuard + 100ms));
+
+    uint32_t cwnd = cc.getCongestionWindow();
+    cc.onPacketLoss(start + 45s + 50ms);
+    EXPECT_EQ(cc.getCongestionWindow(), cwnd);
+    EXPECT_EQ(cc.getHandoverLosses(), 1u);
+    EXPECT_EQ(cc.getPathChanges(), 0u);
+}
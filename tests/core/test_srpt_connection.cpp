@@ -174,7 +174,8 @@ TEST_F(SRPTConnectionTest, ConnectionTimeouts) {
 
 class SRPTConnectionReliabilityTest : public ::testing::Test {
 protected:
-    SRPTConnection connection;
+    Common::ManualClock clock;
+    SRPTConnection connection{clock};
 
     void SetUp() override {
         connection.setState(SRPTConnectionState::ESTABLISHED);
@@ -208,7 +209,7 @@ TEST_F(SRPTConnectionReliabilityTest, KeepAlive) {
     EXPECT_TRUE(connection.isConnectionAlive());
 
     // Simulate passage of time without activity
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    clock.advance(std::chrono::seconds(1));
     EXPECT_TRUE(connection.isConnectionAlive());
 
     // Send keep-alive
@@ -216,7 +217,7 @@ TEST_F(SRPTConnectionReliabilityTest, KeepAlive) {
     EXPECT_TRUE(connection.isConnectionAlive());
 
     // Simulate more passage of time
-    std::this_thread::sleep_for(std::chrono::seconds(3));
+    clock.advance(std::chrono::seconds(3));
     EXPECT_FALSE(connection.isConnectionAlive());
 
     // Handle incoming keep-alive
@@ -229,13 +230,13 @@ TEST_F(SRPTConnectionReliabilityTest, LongLivedConnection) {
     EXPECT_TRUE(connection.isConnectionAlive());
 
     for (int i = 0; i < 10; ++i) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        clock.advance(std::chrono::milliseconds(500));
         connection.sendKeepAlive();
         EXPECT_TRUE(connection.isConnectionAlive());
     }
 
     // Simulate network interruption
-    std::this_thread::sleep_for(std::chrono::seconds(3));
+    clock.advance(std::chrono::seconds(3));
     EXPECT_FALSE(connection.isConnectionAlive());
 
     // Restore connection
@@ -245,7 +246,8 @@ TEST_F(SRPTConnectionReliabilityTest, LongLivedConnection) {
 
 class SRPTFlowControlTest : public ::testing::Test {
 protected:
-    SRPT::SRPTConnection connection;
+    SRPT::Common::ManualClock clock;
+    SRPT::SRPTConnection connection{clock};
 
     void SetUp() override {
         connection.setState(SRPT::SRPTConnectionState::ESTABLISHED);
@@ -307,7 +309,7 @@ TEST_F(SRPTFlowControlTest, PreventSendingWhenWindowFull) {
 TEST_F(SRPTFlowControlTest, SendDataUpdatesLastActivity) {
     connection.setReceiveWindowSize(1000); // Ensure there's enough window size
     auto before = connection.getLastActivityTime();
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    clock.advance(std::chrono::milliseconds(10));
     std::vector<uint8_t> data(100, 0);
     ASSERT_TRUE(connection.sendData(data));
     EXPECT_GT(connection.getLastActivityTime(), before);
@@ -315,7 +317,7 @@ TEST_F(SRPTFlowControlTest, SendDataUpdatesLastActivity) {
 
 TEST_F(SRPTFlowControlTest, ReceiveDataUpdatesLastActivity) {
     auto before = connection.getLastActivityTime();
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    clock.advance(std::chrono::milliseconds(10));
     std::vector<uint8_t> data(100, 0);
     connection.receiveData(data);
     EXPECT_GT(connection.getLastActivityTime(), before);
@@ -329,8 +331,66 @@ TEST_F(SRPTFlowControlTest, ReceiveDataInNonEstablishedState) {
     EXPECT_EQ(connection.getAvailableWindowSize(), initialWindow);
 }
 
+TEST_F(SRPTFlowControlTest, WindowUpdatesAreCoalesced) {
+    size_t updates = 0;
+    connection.setPacketSender([&](const SRPTPacket& packet) {
+        if (packet.getPacketType() == static_cast<uint8_t>(SRPTPacketType::WINDOW_UPDATE)) {
+            ++updates;
+        }
+        return true;
+    });
+    connection.setReceiveWindowSize(1000);
+    for (int i = 0; i < 10; ++i) {
+        connection.receiveData(std::vector<uint8_t>(100, 0));
+    }
+    // One per quarter of the window consumed
+    EXPECT_EQ(updates, 3u);
+    EXPECT_TRUE(connection.windowUpdatePending());
+
+    connection.flushWindowUpdate();
+    EXPECT_EQ(updates, 4u);
+    EXPECT_FALSE(connection.windowUpdatePending());
+    connection.flushWindowUpdate();
+    EXPECT_EQ(updates, 4u);
+}
+
 TEST_F(SRPTFlowControlTest, SendWindowUpdate) {
     connection.setReceiveWindowSize(1000);
     connection.sendWindowUpdate(500);
-    EXPECT_EQ(connection.getAvailableWindowSize(), 500);
+    EXPECT_EQ(connection.getAdvertisedWindowSize(), 500);
+    // Advertising our window does not change what the peer lets us send
+    EXPECT_EQ(connection.getAvailableWindowSize(), 1000);
+}
+
+TEST_F(SRPTFlowControlTest, ReceivingDoesNotRefundSendCredit) {
+    connection.setPacketSender([](const SRPTPacket&) { return true; });
+    connection.setReceiveWindowSize(1000);
+    ASSERT_TRUE(connection.sendData(std::vector<uint8_t>(600, 0)));
+    EXPECT_EQ(connection.getAvailableWindowSize(), 400);
+
+    connection.receiveData(std::vector<uint8_t>(500, 0));
+    connection.flushWindowUpdate();
+    EXPECT_EQ(connection.getAvailableWindowSize(), 400);
+    EXPECT_FALSE(connection.canSendData(401));
+}
+
+TEST_F(SRPTFlowControlTest, DuplicateDataIsAcknowledgedButDeliveredOnce) {
+    size_t acks = 0;
+    std::vector<uint8_t> delivered;
+    connection.setPacketSender([&](const SRPTPacket& packet) {
+        acks += packet.getPacketType() == static_cast<uint8_t>(SRPTPacketType::DATA_ACK);
+        return true;
+    });
+    connection.setDataHandler([&](const std::vector<uint8_t>& data) {
+        delivered.insert(delivered.end(), data.begin(), data.end());
+    });
+
+    // Retransmissions after lost DATA_ACKs, and reordering
+    for (uint32_t sequence : {1u, 1u, 3u, 2u, 3u, 2u, 4u}) {
+        SRPTPacket packet(static_cast<uint8_t>(SRPTPacketType::DATA), 0, sequence, 0,
+                          {static_cast<uint8_t>(sequence)});
+        EXPECT_TRUE(connection.handlePacket(packet));
+    }
+    EXPECT_EQ(acks, 7u);
+    EXPECT_EQ(delivered, (std::vector<uint8_t>{1, 3, 2, 4}));
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include "../../src/core/srpt_header_compression.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+using namespace SRPT;
+
+namespace {
+
+constexpr uint64_t PACKAGE_ID = 0x123456789;  // 5 varint bytes
+
+SRPTPacket dataPacket(uint32_t sequence, uint64_t packageId = PACKAGE_ID, uint32_t totalPackets = 500) {
+    std::vector<uint8_t> payload(20, static_cast<uint8_t>(sequence));
+    return SRPTPacket(static_cast<uint8_t>(SRPTPacketType::DATA), packageId, sequence, totalPackets, payload);
+}
+
+void expectSame(const SRPTPacket& restored, const SRPTPacket& original) {
+    EXPECT_EQ(restored.toBytes(), original.toBytes());
+}
+
+} // namespace
+
+TEST(HeaderCompressionTest, SendsDeltasAfterTheFirstPacket) {
+    HeaderCompressor compressor;
+    HeaderDecompressor decompressor;
+
+    auto first = dataPacket(0);
+    auto bytes = compressor.compress(first);
+    EXPECT_EQ(bytes.size(), first.encodedSize() + 1);  // IR: context ID and the full packet
+    expectSame(decompressor.decompress(bytes), first);
+
+    for (uint32_t sequence = 1; sequence < 20; ++sequence) {
+        auto packet = dataPacket(sequence);
+        bytes = compressor.compress(packet);
+        EXPECT_EQ(bytes.size(), 6u + 20);
+        expectSame(decompressor.decompress(bytes), packet);
+    }
+
+    auto stats = compressor.getStats();
+    EXPECT_EQ(stats.packets, 20u);
+    EXPECT_EQ(stats.refreshes, 1u);
+    EXPECT_EQ(stats.headerBytesIn, 20u * 15);
+    EXPECT_EQ(stats.headerBytesOut, 16u + 19 * 6);
+    EXPECT_EQ(decompressor.getStats().packets, 20u);
+}
+
+TEST(HeaderCompressionTest, EncodesChangedFieldsOnly) {
+    HeaderCompressor compressor;
+    HeaderDecompressor decompressor;
+    decompressor.decompress(compressor.compress(dataPacket(10)));
+
+    // A different type costs a byte
+    SRPTPacket ack(static_cast<uint8_t>(SRPTPacketType::DATA_ACK), PACKAGE_ID, 9, 500, {});
+    auto bytes = compressor.compress(ack);
+    EXPECT_EQ(bytes.size(), 7u);
+    expectSame(decompressor.decompress(bytes), ack);
+
+    // Out of the LSB window the whole sequence number goes
+    auto far = dataPacket(100000);
+    bytes = compressor.compress(far);
+    EXPECT_EQ(bytes.size(), 2u + 3 + 4 + 20);
+    expectSame(decompressor.decompress(bytes), far);
+
+    // Back within the window of the new reference, and wrapping past 2^32
+    auto behind = dataPacket(100000 - 60);
+    expectSame(decompressor.decompress(compressor.compress(behind)), behind);
+    auto top = dataPacket(UINT32_MAX);
+    decompressor.decompress(compressor.compress(top));
+    auto wrapped = dataPacket(5);
+    bytes = compressor.compress(wrapped);
+    EXPECT_EQ(bytes.size(), 6u + 20);
+    expectSame(decompressor.decompress(bytes), wrapped);
+
+    // A field kept in the context changing means a refresh
+    auto resized = dataPacket(6, PACKAGE_ID, 501);
+    bytes = compressor.compress(resized);
+    EXPECT_EQ(bytes.size(), resized.encodedSize() + 1);
+    expectSame(decompressor.decompress(bytes), resized);
+    EXPECT_EQ(compressor.getStats().refreshes, 2u);
+}
+
+TEST(HeaderCompressionTest, RefreshesPeriodically) {
+    HeaderCompressor::Options options;
+    options.refreshInterval = 8;
+    HeaderCompressor compressor(options);
+    for (uint32_t sequence = 0; sequence < 27; ++sequence) {
+        compressor.compress(dataPacket(sequence));
+    }
+    EXPECT_EQ(compressor.getStats().refreshes, 3u);  // Packets 0, 9 and 18
+
+    options.refreshInterval = 0;
+    HeaderCompressor onDemand(options);
+    for (uint32_t sequence = 0; sequence < 100; ++sequence) {
+        onDemand.compress(dataPacket(sequence));
+    }
+    EXPECT_EQ(onDemand.getStats().refreshes, 1u);
+}
+
+TEST(HeaderCompressionTest, ToleratesLossWithinTheWindow) {
+    HeaderCompressor::Options options;
+    options.refreshInterval = 0;
+    HeaderCompressor compressor(options);
+    HeaderDecompressor decompressor;
+    decompressor.decompress(compressor.compress(dataPacket(0)));
+
+    // 150 packets lost in a row, none of them a refresh
+    for (uint32_t sequence = 1; sequence <= 150; ++sequence) {
+        compressor.compress(dataPacket(sequence));
+    }
+    auto next = dataPacket(151);
+    expectSame(decompressor.decompress(compressor.compress(next)), next);
+    EXPECT_TRUE(decompressor.takeFeedback().empty());
+}
+
+TEST(HeaderCompressionTest, ResynchronisesThroughFeedback) {
+    HeaderCompressor::Options options;
+    options.refreshInterval = 0;
+    HeaderCompressor compressor(options);
+    HeaderDecompressor decompressor;
+    decompressor.decompress(compressor.compress(dataPacket(0)));
+
+    auto damaged = compressor.compress(dataPacket(1));
+    damaged.back() ^= 0x01;
+    EXPECT_THROW(decompressor.decompress(damaged), std::runtime_error);
+    EXPECT_EQ(decompressor.getStats().checkFailures, 1u);
+
+    // Later packets are refused rather than restored from a suspect context
+    EXPECT_THROW(decompressor.decompress(compressor.compress(dataPacket(2))), std::runtime_error);
+    EXPECT_EQ(decompressor.getStats().contextMisses, 1u);
+
+    auto feedback = decompressor.takeFeedback();
+    ASSERT_EQ(feedback.size(), 1u);
+    EXPECT_TRUE(decompressor.takeFeedback().empty());  // Reported once
+
+    compressor.onFeedback(feedback);
+    auto packet = dataPacket(3);
+    auto bytes = compressor.compress(packet);
+    EXPECT_EQ(bytes.size(), packet.encodedSize() + 1);
+    expectSame(decompressor.decompress(bytes), packet);
+    auto next = dataPacket(4);
+    expectSame(decompressor.decompress(compressor.compress(next)), next);
+}
+
+TEST(HeaderCompressionTest, EvictsTheLeastRecentlyUsedFlow) {
+    HeaderCompressor::Options options;
+    options.maxContexts = 2;
+    HeaderCompressor compressor(options);
+    HeaderDecompressor decompressor;
+
+    for (uint32_t sequence = 0; sequence < 3; ++sequence) {
+        for (uint64_t flow = 1; flow <= 2; ++flow) {
+            auto packet = dataPacket(sequence, flow);
+            expectSame(decompressor.decompress(compressor.compress(packet)), packet);
+        }
+    }
+    EXPECT_EQ(compressor.getStats().refreshes, 2u);
+
+    decompressor.decompress(compressor.compress(dataPacket(3, 2)));
+    auto third = dataPacket(0, 3);  // Takes flow 1's context
+    expectSame(decompressor.decompress(compressor.compress(third)), third);
+    auto returning = dataPacket(3, 1);  // And flow 1 comes back with a refresh
+    auto bytes = compressor.compress(returning);
+    EXPECT_EQ(bytes.size(), returning.encodedSize() + 1);
+    expectSame(decompressor.decompress(bytes), returning);
+    EXPECT_EQ(compressor.getStats().refreshes, 4u);
+}
+
+TEST(HeaderCompressionTest, CatchesPayloadDamageTheLowCrcByteWouldMiss) {
+    HeaderCompressor::Options options;
+    options.refreshInterval = 0;
+    HeaderCompressor compressor(options);
+    HeaderDecompressor decompressor;
+    decompressor.decompress(compressor.compress(dataPacket(0)));
+
+    // Find payload damage that leaves the low CRC byte alone
+    auto packet = dataPacket(1);
+    auto payload = packet.getPayload();
+    bool found = false;
+    for (int value = 0; value < 65536 && !found; ++value) {
+        payload[0] = static_cast<uint8_t>(value);
+        payload[1] = static_cast<uint8_t>(value >> 8);
+        SRPTPacket damaged(packet.getPacketType(), PACKAGE_ID, 1, 500, payload);
+        found = payload != packet.getPayload() &&
+                static_cast<uint8_t>(damaged.getHeader().crc) == static_cast<uint8_t>(packet.getHeader().crc);
+    }
+    ASSERT_TRUE(found);
+
+    auto bytes = compressor.compress(packet);
+    std::copy(payload.begin(), payload.end(), bytes.end() - payload.size());
+    EXPECT_THROW(decompressor.decompress(bytes), std::runtime_error);
+    EXPECT_EQ(decompressor.getStats().checkFailures, 1u);
+}
+
+TEST(HeaderCompressionTest, RejectsMalformedPackets) {
+    HeaderDecompressor decompressor;
+    EXPECT_THROW(decompressor.decompress(std::vector<uint8_t>()), std::runtime_error);
+    EXPECT_THROW(decompressor.decompress(std::vector<uint8_t>{0x41, 1, 2}), std::runtime_error);  // No context
+    EXPECT_THROW(decompressor.decompress(std::vector<uint8_t>{0x00, 1, 2}), std::runtime_error);  // Short IR
+
+    HeaderCompressor compressor;
+    decompressor.decompress(compressor.compress(dataPacket(0)));
+    EXPECT_THROW(decompressor.decompress(std::vector<uint8_t>{0xC0, 0, 0x80, 0x80}), std::runtime_error);
+    EXPECT_EQ(decompressor.getStats().contextMisses, 1u);
+    EXPECT_EQ(decompressor.getStats().checkFailures, 2u);
+}
@@ -70,4 +70,35 @@ TEST(SRPTPacketTest, LargeValues) {
     EXPECT_EQ(deserializedPacket.getTotalPackets(), UINT32_MAX);
     EXPECT_EQ(deserializedPacket.getHeader().payloadSize, 65535);
     EXPECT_EQ(deserializedPacket.getPayload(), payload);
-}
\ No newline at end of file
+}
+TEST(SRPTPacketTest, BatchEncodeAndDecode) {
+    std::vector<SRPTPacket> packets;
+    for (uint32_t i = 0; i < 10; ++i) {
+        packets.emplace_back(0, 42, i, 10, std::vector<uint8_t>(100 + i, static_cast<uint8_t>(i)));
+    }
+
+    std::vector<uint8_t> buffer;
+    std::vector<size_t> sizes;
+    SRPTPacket::encodeBatch(packets, buffer, sizes);
+    ASSERT_EQ(sizes.size(), packets.size());
+
+    std::vector<SRPTPacketView> views;
+    size_t offset = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        EXPECT_EQ(sizes[i], packets[i].encodedSize());
+        views.push_back(SRPTPacketView{buffer.data() + offset, sizes[i]});
+        offset += sizes[i];
+    }
+    EXPECT_EQ(offset, buffer.size());
+    buffer[views[3].size - 1 + (views[3].data - buffer.data())] ^= 0xFF;  // Corrupt packet 3
+
+    std::vector<SRPTPacket> decoded;
+    std::vector<size_t> indices;
+    EXPECT_EQ(SRPTPacket::decodeBatch(views, decoded, indices), 1u);
+    ASSERT_EQ(decoded.size(), 9u);
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        EXPECT_NE(indices[i], 3u);
+        EXPECT_EQ(decoded[i].getSequenceNumber(), indices[i]);
+        EXPECT_EQ(decoded[i].getPayload(), packets[indices[i]].getPayload());
+    }
+}
@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include "../../src/core/srpt_timer_wheel.h"
+#include "../../src/core/srpt_connection.h"
+#include <vector>
+
+using namespace SRPT;
+using namespace std::chrono_literals;
+
+class TimerWheelTest : public ::testing::Test {
+protected:
+    TimerWheel::TimePoint start = TimerWheel::Clock::now();
+    TimerWheel wheel{10ms, start};
+};
+
+TEST_F(TimerWheelTest, FiresAtDeadline) {
+    int fired = 0;
+    wheel.schedule(100ms, [&]() { ++fired; });
+
+    EXPECT_EQ(wheel.advance(start + 90ms), 0u);
+    EXPECT_EQ(fired, 0);
+    EXPECT_EQ(wheel.advance(start + 100ms), 1u);
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+}
+
+TEST_F(TimerWheelTest, NeverFiresEarly) {
+    int fired = 0;
+    wheel.scheduleAt(start + 15ms, [&]() { ++fired; });
+    wheel.advance(start + 10ms);
+    EXPECT_EQ(fired, 0);
+    wheel.advance(start + 20ms);
+    EXPECT_EQ(fired, 1);
+}
+
+TEST_F(TimerWheelTest, CancelPreventsFiring) {
+    int fired = 0;
+    auto id = wheel.schedule(50ms, [&]() { ++fired; });
+    EXPECT_TRUE(wheel.isPending(id));
+    EXPECT_TRUE(wheel.cancel(id));
+    EXPECT_FALSE(wheel.cancel(id));
+    EXPECT_FALSE(wheel.isPending(id));
+    wheel.advance(start + 1s);
+    EXPECT_EQ(fired, 0);
+}
+
+TEST_F(TimerWheelTest, StaleIdDoesNotCancelReusedSlot) {
+    int fired = 0;
+    auto first = wheel.schedule(10ms, [&]() {});
+    wheel.advance(start + 10ms);
+    auto second = wheel.schedule(10ms, [&]() { ++fired; });
+    EXPECT_FALSE(wheel.cancel(first));
+    wheel.advance(start + 20ms);
+    EXPECT_EQ(fired, 1);
+    EXPECT_NE(first, second);
+}
+
+TEST_F(TimerWheelTest, CascadesFromUpperLevels) {
+    // Deadlines spread over every level of the wheel
+    std::vector<std::chrono::milliseconds> delays = {20ms, 2s, 5s, 3min, 2h, 30h};
+    std::vector<bool> fired(delays.size(), false);
+    for (size_t i = 0; i < delays.size(); ++i) {
+        wheel.schedule(delays[i], [&fired, i]() { fired[i] = true; });
+    }
+
+    for (size_t i = 0; i < delays.size(); ++i) {
+        wheel.advance(start + delays[i] - 10ms);
+        EXPECT_FALSE(fired[i]) << "timer " << i << " fired early";
+        wheel.advance(start + delays[i]);
+        EXPECT_TRUE(fired[i]) << "timer " << i << " did not fire on time";
+    }
+}
+
+TEST_F(TimerWheelTest, DeadlineBeyondWheelSpan) {
+    int fired = 0;
+    // 2^26 ticks of 10ms is roughly 7.7 days
+    wheel.schedule(std::chrono::hours(24 * 10), [&]() { ++fired; });
+    wheel.advance(start + std::chrono::hours(24 * 10) - 10ms);
+    EXPECT_EQ(fired, 0);
+    wheel.advance(start + std::chrono::hours(24 * 10));
+    EXPECT_EQ(fired, 1);
+}
+
+TEST_F(TimerWheelTest, CallbackCanRearm) {
+    int fired = 0;
+    std::function<void()> periodic = [&]() {
+        if (++fired < 5) {
+            wheel.schedule(100ms, periodic);
+        }
+    };
+    wheel.schedule(100ms, periodic);
+    wheel.advance(start + 1s);
+    EXPECT_EQ(fired, 5);
+}
+
+TEST_F(TimerWheelTest, ManyIdleTimersCostNothingPerTick) {
+    constexpr int kTimers = 100000;
+    std::vector<TimerWheel::TimerId> ids;
+    ids.reserve(kTimers);
+    for (int i = 0; i < kTimers; ++i) {
+        ids.push_back(wheel.schedule(std::chrono::seconds(60 + i % 60), []() {}));
+    }
+    EXPECT_EQ(wheel.pendingCount(), static_cast<size_t>(kTimers));
+
+    EXPECT_EQ(wheel.advance(start + 30s), 0u);
+    for (int i = 0; i < kTimers; i += 2) {
+        EXPECT_TRUE(wheel.cancel(ids[i]));
+    }
+    EXPECT_EQ(wheel.advance(start + 2min), static_cast<size_t>(kTimers / 2));
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+}
+
+class ConnectionTimerTest : public ::testing::Test {
+protected:
+    TimerWheel::TimePoint start = TimerWheel::Clock::now();
+    TimerWheel wheel{10ms, start};
+    SRPTConnection connection;
+};
+
+TEST_F(ConnectionTimerTest, TimeWaitClosesOnTimer) {
+    connection.attachTimerWheel(wheel);
+    connection.setTimeWaitDuration(2s);
+    connection.setState(SRPTConnectionState::FIN_WAIT_2);
+    EXPECT_TRUE(connection.handleIncomingFIN());
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::TIME_WAIT);
+
+    wheel.advance(start + 1s);
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::TIME_WAIT);
+    wheel.advance(start + 2s);
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::CLOSED);
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+}
+
+TEST_F(ConnectionTimerTest, KeepAliveSentWhenIdle) {
+    connection.attachTimerWheel(wheel);
+    connection.setKeepAliveInterval(std::chrono::seconds(10));
+    connection.setIdleTimeout(std::chrono::minutes(10));
+    connection.setState(SRPTConnectionState::ESTABLISHED);
+
+    wheel.advance(start + 5s);
+    EXPECT_EQ(connection.getKeepAlivesSent(), 0u);
+    wheel.advance(start + 11s);
+    EXPECT_EQ(connection.getKeepAlivesSent(), 1u);
+    wheel.advance(start + 31s);
+    EXPECT_EQ(connection.getKeepAlivesSent(), 3u);
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::ESTABLISHED);
+}
+
+TEST_F(ConnectionTimerTest, SilentPeerExpires) {
+    connection.attachTimerWheel(wheel);
+    connection.setKeepAliveInterval(std::chrono::seconds(10));
+    connection.setState(SRPTConnectionState::ESTABLISHED);
+
+    // Our own keep-alives do not keep the connection alive, only the peer does
+    wheel.advance(start + 29s);
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::ESTABLISHED);
+    wheel.advance(start + 31s);
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::CLOSED);
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+}
+
+TEST_F(ConnectionTimerTest, DetachCancelsTimers) {
+    connection.attachTimerWheel(wheel);
+    connection.setState(SRPTConnectionState::ESTABLISHED);
+    EXPECT_EQ(wheel.pendingCount(), 2u);
+    connection.detachTimerWheel();
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+}
+
+TEST_F(ConnectionTimerTest, DestructionCancelsTimers) {
+    {
+        SRPTConnection shortLived;
+        shortLived.attachTimerWheel(wheel);
+        shortLived.setState(SRPTConnectionState::ESTABLISHED);
+        EXPECT_EQ(wheel.pendingCount(), 2u);
+    }
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+    EXPECT_EQ(wheel.advance(start + 1h), 0u);
+}
+
+TEST_F(ConnectionTimerTest, UnacknowledgedDataIsRetransmitted) {
+    size_t dataSent = 0;
+    connection.setPacketSender([&](const SRPTPacket& packet) {
+        dataSent += packet.getPacketType() == static_cast<uint8_t>(SRPTPacketType::DATA);
+        return true;
+    });
+    connection.setRetransmissionTimeout(100ms);
+    connection.attachTimerWheel(wheel);
+    connection.setState(SRPTConnectionState::ESTABLISHED);
+    ASSERT_TRUE(connection.sendData({1, 2, 3}));
+    EXPECT_EQ(dataSent, 1u);
+
+    wheel.advance(start + 110ms);
+    EXPECT_EQ(dataSent, 2u);
+    // Backed off to 200 ms
+    wheel.advance(start + 250ms);
+    EXPECT_EQ(dataSent, 2u);
+    wheel.advance(start + 320ms);
+    EXPECT_EQ(dataSent, 3u);
+    EXPECT_EQ(connection.getRetransmissions(), 2u);
+
+    EXPECT_TRUE(connection.acknowledgePacket(1));
+    wheel.advance(start + 10s);
+    EXPECT_EQ(dataSent, 3u);
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::ESTABLISHED);
+}
+
+TEST_F(ConnectionTimerTest, UnansweredSynIsRetransmittedThenGivenUp) {
+    size_t synSent = 0;
+    connection.setPacketSender([&](const SRPTPacket& packet) {
+        synSent += packet.getPacketType() == static_cast<uint8_t>(SRPTPacketType::SYN);
+        return true;
+    });
+    connection.setRetransmissionTimeout(100ms);
+    connection.attachTimerWheel(wheel);
+    ASSERT_TRUE(connection.initiate());
+
+    for (auto now = start; now < start + 2min; now += 100ms) {
+        wheel.advance(now);
+    }
+    EXPECT_EQ(synSent, 1u + SRPTConnection::MAX_RETRANSMISSIONS);
+    EXPECT_EQ(connection.getState(), SRPTConnectionState::CLOSED);
+    EXPECT_EQ(wheel.pendingCount(), 0u);
+}
+
+TEST_F(ConnectionTimerTest, SynAckStopsSynRetransmission) {
+    size_t synSent = 0;
+    connection.setPacketSender([&](const SRPTPacket& packet) {
+        synSent += packet.getPacketType() == static_cast<uint8_t>(SRPTPacketType::SYN);
+        return true;
+    });
+    connection.setRetransmissionTimeout(100ms);
+    connection.attachTimerWheel(wheel);
+    ASSERT_TRUE(connection.initiate());
+    wheel.advance(start + 110ms);
+    EXPECT_EQ(synSent, 2u);
+
+    EXPECT_TRUE(connection.handleIncomingSYNACK());
+    wheel.advance(start + 5s);
+    EXPECT_EQ(synSent, 2u);
+}
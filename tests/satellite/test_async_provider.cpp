@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "satellite/async_provider.h"
+#include "satellite/emulated_link_provider.h"
+#include "satellite/starlink_provider.h"
+#include <atomic>
+#include <thread>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// A modem whose control calls block, like an AT command round trip
+class SlowModem : public ISatelliteProvider {
+public:
+    explicit SlowModem(std::chrono::milliseconds delay) : delay(delay) {}
+    std::chrono::milliseconds delay;
+    std::atomic<bool> connected{false};
+
+    bool Initialize(const std::map<std::string, std::string>&) override { return true; }
+    bool Connect(const std::string& id) override {
+        std::this_thread::sleep_for(delay);
+        connected = id != "unreachable";
+        return connected;
+    }
+    bool Disconnect() override {
+        connected = false;
+        return true;
+    }
+    bool SendData(const ByteVector&) override { return connected; }
+    bool ReceiveData(ByteVector&) override { return false; }
+    bool ExecuteCommand(const std::string& command, std::string& response) override {
+        std::this_thread::sleep_for(delay);
+        response = "+OK " + command;
+        return true;
+    }
+    double GetSignalStrength() const override { return 0.5; }
+    double GetLatency() const override { return 1500.0; }
+    uint64_t GetBandwidth() const override { return 352000; }
+    std::unique_ptr<SatelliteStream> CreateStream() override { return nullptr; }
+    void setVerboseLogging(bool) override {}
+};
+
+} // namespace
+
+TEST(AsyncProviderTest, ReturnsAtOnceAndCompletesOnTheLoopThread) {
+    CompletionQueue loop;
+    AsyncProviderAdapter modem(std::make_unique<SlowModem>(100ms), loop);
+    std::thread::id completedOn;
+    int results = 0;
+    bool connected = false;
+
+    auto start = Clock::now();
+    modem.ConnectAsync("iridium-1", [&](bool ok) {
+        completedOn = std::this_thread::get_id();
+        connected = ok;
+        ++results;
+    });
+    modem.ConnectAsync("unreachable", [&](bool ok) {
+        EXPECT_FALSE(ok);
+        ++results;
+    });
+    EXPECT_LT(Clock::now() - start, 50ms);
+    EXPECT_EQ(results, 0);
+    EXPECT_EQ(modem.getPendingOperations(), 2u);
+
+    ASSERT_TRUE(loop.runUntil([&] { return results == 2; }, 2s));
+    EXPECT_TRUE(connected);
+    EXPECT_EQ(completedOn, std::this_thread::get_id());
+    EXPECT_DOUBLE_EQ(modem.GetLatency(), 1500.0);
+}
+
+TEST(AsyncProviderTest, ManyOperationsInFlightCompleteInOrder) {
+    CompletionQueue loop;
+    AsyncProviderAdapter terminal(std::make_unique<StarlinkProvider>(), loop);
+    terminal.ConnectAsync("starlink-1", nullptr);
+
+    std::vector<int> received;
+    int sent = 0;
+    for (int i = 0; i < 100; ++i) {
+        terminal.ReceiveAsync([&](bool ok, ByteVector data) {
+            ASSERT_TRUE(ok);
+            received.push_back(data[0]);
+        });
+    }
+    for (int i = 0; i < 100; ++i) {
+        terminal.SendAsync(ByteVector(100, static_cast<uint8_t>(i)), [&](bool ok) {
+            EXPECT_TRUE(ok);
+            ++sent;
+        });
+    }
+    ASSERT_TRUE(loop.runUntil([&] { return received.size() == 100; }, 2s));
+    EXPECT_EQ(sent, 100);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(received[i], i);
+    }
+}
+
+TEST(AsyncProviderTest, OneThreadDrivesSeveralTerminals) {
+    CompletionQueue loop;
+    std::vector<std::unique_ptr<AsyncProviderAdapter>> terminals;
+    for (int i = 0; i < 4; ++i) {
+        terminals.push_back(std::make_unique<AsyncProviderAdapter>(std::make_unique<SlowModem>(100ms), loop));
+    }
+
+    // Four 200 ms exchanges overlap instead of taking 800 ms back to back
+    auto start = Clock::now();
+    std::vector<std::string> responses;
+    for (size_t i = 0; i < terminals.size(); ++i) {
+        terminals[i]->ConnectAsync("sat-" + std::to_string(i), nullptr);
+        terminals[i]->ExecuteCommandAsync("AT+CSQ", [&](bool ok, std::string response) {
+            EXPECT_TRUE(ok);
+            responses.push_back(response);
+        });
+    }
+    ASSERT_TRUE(loop.runUntil([&] { return responses.size() == 4; }, 2s));
+    EXPECT_LT(Clock::now() - start, 600ms);
+    EXPECT_EQ(responses[0], "+OK AT+CSQ");
+}
+
+TEST(AsyncProviderTest, DisconnectFailsPendingReceives) {
+    CompletionQueue loop;
+    AsyncProviderAdapter terminal(std::make_unique<StarlinkProvider>(), loop);
+    int failed = 0;
+    bool disconnected = false;
+    terminal.ConnectAsync("starlink-1", nullptr);
+    terminal.ReceiveAsync([&](bool ok, ByteVector data) {
+        EXPECT_FALSE(ok);
+        EXPECT_TRUE(data.empty());
+        ++failed;
+    });
+    terminal.ReceiveAsync([&](bool ok, ByteVector) { failed += ok ? 0 : 1; });
+    loop.runOnce(20ms);
+    EXPECT_EQ(failed, 0);  // Nothing to receive yet
+
+    terminal.DisconnectAsync([&](bool ok) { disconnected = ok; });
+    ASSERT_TRUE(loop.runUntil([&] { return failed == 2; }, 2s));
+    EXPECT_TRUE(disconnected);
+}
+
+TEST(AsyncProviderTest, BoundsPendingAndFailsLeftoversOnShutdown) {
+    CompletionQueue loop;
+    AsyncProviderAdapter::Options options;
+    options.maxPending = 3;
+    int succeeded = 0;
+    int failed = 0;
+    auto count = [&](bool ok) { ++(ok ? succeeded : failed); };
+    {
+        AsyncProviderAdapter modem(std::make_unique<SlowModem>(50ms), loop, options);
+        modem.ConnectAsync("iridium-1", count);
+        std::this_thread::sleep_for(10ms);  // Worker is inside Connect()
+        modem.SendAsync(ByteVector(10), count);
+        modem.SendAsync(ByteVector(10), count);
+        modem.SendAsync(ByteVector(10), count);  // Over the limit
+        loop.runOnce(0ms);
+        EXPECT_EQ(failed, 1);
+    }
+    // The sends queued behind Connect() either went out or were failed
+    // when the adapter shut down; none is left hanging
+    loop.runOnce(0ms);
+    EXPECT_EQ(succeeded + failed, 4);
+}
+
+TEST(AsyncProviderTest, StreamsAcrossEmulatedLink) {
+    CompletionQueue loop;
+    EmulatedLink::Config config;
+    config.delay = 5ms;
+    auto endpoints = EmulatedLink::createPair(config);
+    // Completions go to a CompletionQueue, or to any executor's post function
+    AsyncProviderAdapter ground(std::move(endpoints.first), loop);
+    AsyncProviderAdapter terminal(
+        std::move(endpoints.second), [&loop](std::function<void()> task) { loop.post(std::move(task)); },
+        AsyncProviderAdapter::Options());
+    int connected = 0;
+    ground.ConnectAsync("terminal", [&](bool ok) { connected += ok; });
+    terminal.ConnectAsync("ground", [&](bool ok) { connected += ok; });
+    ASSERT_TRUE(loop.runUntil([&] { return connected == 2; }, 2s));
+
+    auto out = ground.CreateAsyncStream();
+    auto in = terminal.CreateAsyncStream();
+    ByteVector received;
+    in->ReadAsync([&](bool ok, ByteVector data) {
+        ASSERT_TRUE(ok);
+        received = std::move(data);
+    });
+    out->WriteAsync(ByteVector{1, 2, 3}, nullptr);
+    ASSERT_TRUE(loop.runUntil([&] { return !received.empty(); }, 2s));
+    EXPECT_EQ(received, (ByteVector{1, 2, 3}));
+}
@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+#include "satellite/contact_scheduler.h"
+#include "satellite/starlink_provider.h"
+#include "core/srpt_packet.h"
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Loopback link that records its connections and can refuse them
+class RecordingProvider : public StarlinkProvider {
+public:
+    int connects = 0;
+    int disconnects = 0;
+    bool refuseConnect = false;
+
+    bool Connect(const std::string& satellite_id) override {
+        if (refuseConnect) {
+            return false;
+        }
+        ++connects;
+        return StarlinkProvider::Connect(satellite_id);
+    }
+    bool Disconnect() override {
+        ++disconnects;
+        return StarlinkProvider::Disconnect();
+    }
+};
+
+struct Link {
+    RecordingProvider* provider;
+    std::unique_ptr<SatelliteSession> session;
+};
+
+Link makeLink() {
+    auto provider = std::make_unique<RecordingProvider>();
+    RecordingProvider* raw = provider.get();
+    return Link{raw, std::make_unique<SatelliteSession>(std::move(provider))};
+}
+
+Contact contact(const std::string& link, int64_t startMs, int64_t endMs, uint64_t bitsPerSecond) {
+    Contact window;
+    window.link = link;
+    window.start = std::chrono::milliseconds(startMs);
+    window.end = std::chrono::milliseconds(endMs);
+    window.bitsPerSecond = bitsPerSecond;
+    window.latency = 30ms;
+    return window;
+}
+
+// Two passes of "leo", each carrying 10000 bytes: nine chunks of 1000
+// payload bytes and their headers
+ContactPlan twoPasses() {
+    ContactPlan plan;
+    plan.addContact(contact("leo", 0, 1000, 80000));
+    plan.addContact(contact("leo", 5000, 6000, 80000));
+    return plan;
+}
+
+ContactScheduler::Options chunksOf1000() {
+    ContactScheduler::Options options;
+    options.chunkSize = 1000;
+    return options;
+}
+
+std::vector<size_t> chunksPerContact(const ContactScheduler& scheduler) {
+    std::vector<size_t> counts(scheduler.getContactPlan().getContacts().size(), 0);
+    for (const auto& assignment : scheduler.getSchedule()) {
+        ++counts[assignment.contact];
+    }
+    return counts;
+}
+
+} // namespace
+
+TEST(ContactPlanTest, ParsesTextAndRejectsOverlaps) {
+    ContactPlan plan;
+    ASSERT_TRUE(plan.parseText("# link start end kbit/s latency\n"
+                               "drone 4000 9000 2000 5\n"
+                               "leo 0 600000 9.6 40   # first pass\n"
+                               "\n"
+                               "leo 5400000 6000000 9.6 40\n"));
+    const auto& contacts = plan.getContacts();
+    ASSERT_EQ(contacts.size(), 3u);
+    EXPECT_EQ(contacts[0].link, "leo");
+    EXPECT_EQ(contacts[0].bitsPerSecond, 9600u);
+    EXPECT_EQ(contacts[0].capacityBytes(), 720000u);
+    EXPECT_EQ(contacts[1].link, "drone");
+    EXPECT_EQ(contacts[1].latency, 5ms);
+    EXPECT_EQ(plan.end(), 6000000ms);
+
+    // Links may overlap each other, but not themselves
+    EXPECT_TRUE(plan.addContact(contact("drone", 500, 1000, 1000)));
+    EXPECT_FALSE(plan.addContact(contact("leo", 599999, 700000, 1000)));
+    EXPECT_FALSE(plan.addContact(contact("leo", 700000, 700000, 1000)));
+    EXPECT_FALSE(plan.addContact(contact("leo", 700000, 800000, 0)));
+
+    EXPECT_FALSE(plan.parseText("leo 0 1000 9.6 40\nleo 500 1500 9.6 40\n"));
+    EXPECT_EQ(plan.getLastError(), "Malformed contact line 2");
+    EXPECT_FALSE(plan.parseText("leo 0 1000 fast 40\n"));
+    EXPECT_EQ(plan.getContacts().size(), 4u);  // Unchanged
+}
+
+TEST(ContactSchedulerTest, FillsContactsToCapacityInPriorityOrder) {
+    Common::ManualClock clock;
+    ContactScheduler scheduler(twoPasses(), clock, chunksOf1000());
+    auto link = makeLink();
+
+    // Without a link the contacts are of no use
+    std::string first = scheduler.submit(SRPTPackage(15000), PackagePriority::NORMAL);
+    EXPECT_TRUE(scheduler.getSchedule().empty());
+    EXPECT_FALSE(scheduler.getPackages()[0].planned);
+
+    scheduler.addLink("leo", *link.session);
+    EXPECT_EQ(chunksPerContact(scheduler), (std::vector<size_t>{9, 6}));
+    std::string second = scheduler.submit(SRPTPackage(5000), PackagePriority::BULK);
+    EXPECT_EQ(chunksPerContact(scheduler), (std::vector<size_t>{9, 9}));
+
+    auto packages = scheduler.getPackages();
+    ASSERT_EQ(packages.size(), 2u);
+    EXPECT_EQ(packages[0].id, first);
+    EXPECT_TRUE(packages[0].planned);
+    EXPECT_EQ(packages[1].id, second);
+    EXPECT_FALSE(packages[1].planned);  // Two chunks left over
+
+    // Neither contact has room for another chunk
+    for (size_t c = 0; c < 2; ++c) {
+        uint64_t planned = 0;
+        for (const auto& assignment : scheduler.getSchedule()) {
+            if (assignment.contact == c) {
+                planned += assignment.bytes;
+            }
+        }
+        uint64_t capacity = scheduler.getContactPlan().getContacts()[c].capacityBytes();
+        EXPECT_LE(planned, capacity);
+        EXPECT_LT(capacity - planned, 1000u);
+    }
+
+    // Sending is paced at the planned rate
+    auto schedule = scheduler.getSchedule();
+    EXPECT_EQ(schedule[0].sendAt, 0ms);
+    EXPECT_EQ(schedule[9].sendAt, 5000ms);
+    EXPECT_GT(schedule[8].sendAt, 800ms);
+    EXPECT_EQ(packages[0].plannedArrival, std::chrono::milliseconds(5000 + (6 * schedule[9].bytes * 8 + 79) / 80) + 30ms);
+}
+
+TEST(ContactSchedulerTest, SendsThroughSessionAndPreemptsForUrgentPackages) {
+    Common::ManualClock clock;
+    ContactScheduler scheduler(twoPasses(), clock, chunksOf1000());
+    auto link = makeLink();
+    scheduler.addLink("leo", *link.session);
+    std::string bulk = scheduler.submit(SRPTPackage(20000), PackagePriority::BULK);
+    EXPECT_EQ(chunksPerContact(scheduler), (std::vector<size_t>{9, 9}));
+
+    // Half way through the first pass, half its capacity has gone out
+    clock.advance(500ms);
+    EXPECT_EQ(scheduler.poll(), 4u);
+    EXPECT_EQ(link.provider->connects, 1);
+
+    std::string urgent = scheduler.submit(SRPTPackage(3000), PackagePriority::URGENT);
+    EXPECT_EQ(chunksPerContact(scheduler), (std::vector<size_t>{5, 9}));
+    // Bulk chunks 6-8 move to the second pass and 15-17 out of the plan
+    EXPECT_EQ(scheduler.getStats().preemptedChunks, 6u);
+    auto packages = scheduler.getPackages();
+    EXPECT_TRUE(packages[1].planned);
+    EXPECT_FALSE(packages[0].planned);
+
+    clock.advance(500ms);
+    EXPECT_EQ(scheduler.poll(), 5u);
+    EXPECT_EQ(link.provider->disconnects, 1);
+    packages = scheduler.getPackages();
+    EXPECT_TRUE(packages[1].delivered);
+    EXPECT_EQ(packages[1].deliveredAt, 1030ms);
+
+    std::vector<std::pair<uint64_t, uint32_t>> received;
+    ByteVector data;
+    while (link.provider->ReceiveData(data)) {
+        SRPTPacket packet = SRPTPacket::fromBytes(data);
+        received.emplace_back(packet.getPackageId(), packet.getSequenceNumber());
+    }
+    ASSERT_EQ(received.size(), 9u);
+    uint64_t bulkId = received[0].first;
+    for (uint32_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(received[i], std::make_pair(bulkId, i));
+    }
+    for (uint32_t i = 0; i < 3; ++i) {
+        EXPECT_NE(received[4 + i].first, bulkId);
+        EXPECT_EQ(received[4 + i].second, i);
+    }
+    EXPECT_EQ(received[7], std::make_pair(bulkId, 4u));
+    EXPECT_EQ(received[8], std::make_pair(bulkId, 5u));
+
+    // Nothing goes out between passes
+    clock.advance(2000ms);
+    EXPECT_EQ(scheduler.poll(), 0u);
+    EXPECT_EQ(link.provider->connects, 1);
+    EXPECT_EQ(scheduler.getStats().chunksSent, 9u);
+}
+
+TEST(ContactSchedulerTest, DeliveredPackagesAreRetiredInOrder) {
+    Common::ManualClock clock;
+    ContactScheduler scheduler(twoPasses(), clock, chunksOf1000());
+    auto link = makeLink();
+    scheduler.addLink("leo", *link.session);
+    std::string bulk = scheduler.submit(SRPTPackage(20000), PackagePriority::BULK);
+    std::string urgent = scheduler.submit(SRPTPackage(3000), PackagePriority::URGENT);
+    EXPECT_EQ(scheduler.poll(), 0u);
+    clock.advance(1000ms);
+    EXPECT_EQ(scheduler.poll(), 9u);
+
+    // The next replan retires the urgent package but keeps its status
+    std::string late = scheduler.submit(SRPTPackage(1000));
+    auto packages = scheduler.getPackages();
+    ASSERT_EQ(packages.size(), 3u);
+    EXPECT_EQ(packages[0].id, bulk);
+    EXPECT_FALSE(packages[0].delivered);
+    EXPECT_EQ(packages[1].id, urgent);
+    EXPECT_TRUE(packages[1].delivered);
+    EXPECT_EQ(packages[1].sent, 3u);
+    EXPECT_EQ(packages[2].id, late);
+    for (const auto& assignment : scheduler.getSchedule()) {
+        EXPECT_NE(assignment.packageId, urgent);
+    }
+
+    clock.advance(4000ms);
+    EXPECT_EQ(scheduler.poll(), 0u);
+    clock.advance(1000ms);
+    EXPECT_EQ(scheduler.poll(), 9u);
+    packages = scheduler.getPackages();
+    ASSERT_EQ(packages.size(), 3u);
+    EXPECT_EQ(packages[0].sent, 6u + 8);
+    EXPECT_TRUE(packages[1].delivered);
+    EXPECT_TRUE(packages[2].delivered);
+}
+
+TEST(ContactSchedulerTest, FailedConnectReplansOntoOtherLinks) {
+    ContactPlan plan;
+    plan.addContact(contact("leo", 0, 1000, 80000));
+    plan.addContact(contact("drone", 500, 2500, 80000));
+    Common::ManualClock clock;
+    ContactScheduler scheduler(plan, clock, chunksOf1000());
+    auto leo = makeLink();
+    auto drone = makeLink();
+    leo.provider->refuseConnect = true;
+    scheduler.addLink("leo", *leo.session);
+    scheduler.addLink("drone", *drone.session);
+
+    scheduler.submit(SRPTPackage(12000));
+    EXPECT_EQ(chunksPerContact(scheduler), (std::vector<size_t>{9, 3}));
+    EXPECT_EQ(scheduler.poll(), 0u);
+    EXPECT_EQ(scheduler.getStats().failedConnects, 1u);
+    EXPECT_EQ(chunksPerContact(scheduler), (std::vector<size_t>{0, 12}));
+
+    clock.advance(2000ms);
+    EXPECT_EQ(scheduler.poll(), 12u);
+    EXPECT_TRUE(scheduler.getPackages()[0].delivered);
+    EXPECT_EQ(drone.provider->connects, 1);
+}
+
+TEST(ContactSchedulerTest, SimulatesPlanAgainstActualContacts) {
+    ContactPlan plan = twoPasses();
+    plan.addContact(contact("leo", 10000, 11000, 80000));
+    std::vector<ContactScheduler::SimulatedPackage> packages(2);
+    packages[0].bytes = 15000;
+    packages[1].bytes = 2000;
+    packages[1].priority = PackagePriority::URGENT;
+    packages[1].submitAt = 5200ms;
+
+    // As planned
+    auto result = ContactScheduler::simulate(plan, packages, chunksOf1000());
+    ASSERT_EQ(result.packages.size(), 2u);
+    EXPECT_TRUE(result.packages[0].delivered);
+    EXPECT_TRUE(result.packages[1].delivered);
+    EXPECT_LT(result.packages[1].deliveredAt, result.packages[0].deliveredAt);
+    EXPECT_LT(result.packages[0].deliveredAt, 6100ms);
+    EXPECT_GT(result.contactBytes[0], 9000u);
+    EXPECT_EQ(result.contactBytes[2], 0u);
+    EXPECT_EQ(result.stats.refusedSends, 0u);
+
+    // The second pass never happens; its chunks wait for the third
+    ContactPlan actual;
+    actual.addContact(contact("leo", 0, 1000, 80000));
+    actual.addContact(contact("leo", 10000, 11000, 80000));
+    result = ContactScheduler::simulate(plan, packages, chunksOf1000(), actual, 50ms);
+    EXPECT_TRUE(result.packages[0].delivered);
+    EXPECT_TRUE(result.packages[1].delivered);
+    EXPECT_GT(result.packages[0].deliveredAt, 10000ms);
+    EXPECT_GT(result.packages[1].deliveredAt, 10000ms);
+    EXPECT_EQ(result.contactBytes[1], 0u);
+    EXPECT_GT(result.contactBytes[2], 0u);
+    EXPECT_GT(result.stats.refusedSends, 0u);
+    EXPECT_EQ(result.stats.chunksSent, 17u);
+}
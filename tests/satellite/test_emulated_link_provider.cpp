@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "satellite/emulated_link_provider.h"
+#include <thread>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+EmulatedLink::Config linkConfig(std::chrono::microseconds delay, uint64_t bitsPerSecond) {
+    EmulatedLink::Config config;
+    config.delay = delay;
+    config.bitsPerSecond = bitsPerSecond;
+    return config;
+}
+
+} // namespace
+
+TEST(EmulatedLinkProviderTest, DeliversToPeerAfterDelay) {
+    auto endpoints = EmulatedLink::createPair(linkConfig(20ms, 100000000));
+    auto& a = *endpoints.first;
+    auto& b = *endpoints.second;
+    ASSERT_TRUE(a.Connect("ground"));
+    ASSERT_TRUE(b.Connect("terminal"));
+    EXPECT_DOUBLE_EQ(a.GetLatency(), 40.0);
+    EXPECT_EQ(a.GetBandwidth(), 100000000u);
+
+    auto sent = Clock::now();
+    ASSERT_TRUE(a.SendData(ByteVector{1, 2, 3}));
+    ByteVector received;
+    EXPECT_FALSE(b.ReceiveData(received));
+    ASSERT_TRUE(b.waitForData(1s));
+    EXPECT_GE(Clock::now() - sent, 20ms);
+    ASSERT_TRUE(b.ReceiveData(received));
+    EXPECT_EQ(received, (ByteVector{1, 2, 3}));
+    EXPECT_FALSE(a.ReceiveData(received));  // Not looped back
+
+    ASSERT_TRUE(b.SendData(ByteVector{4}));
+    ASSERT_TRUE(a.waitForData(1s));
+    ASSERT_TRUE(a.ReceiveData(received));
+    EXPECT_EQ(received, ByteVector{4});
+}
+
+TEST(EmulatedLinkProviderTest, RateLimitsAndDropsAtQueue) {
+    // 8 Mbit/s: 1 ms per 1000-byte packet, and a 10-packet queue
+    auto config = linkConfig(5ms, 8000000);
+    config.queueBytes = 10000;
+    auto endpoints = EmulatedLink::createPair(config);
+    auto& a = *endpoints.first;
+    auto& b = *endpoints.second;
+    ASSERT_TRUE(a.Connect("ground"));
+    ASSERT_TRUE(b.Connect("terminal"));
+
+    auto start = Clock::now();
+    for (int i = 0; i < 30; ++i) {
+        ASSERT_TRUE(a.SendData(ByteVector(1000, static_cast<uint8_t>(i))));
+    }
+    auto stats = a.getStats();
+    // Some slack for the sending loop being slow on a loaded machine
+    EXPECT_GE(stats.queueDrops, 15u);
+    uint64_t expected = stats.packetsSent - stats.queueDrops;
+
+    ByteVector received;
+    uint64_t delivered = 0;
+    int previous = -1;
+    while (delivered < expected && b.waitForData(1s)) {
+        while (b.ReceiveData(received)) {
+            EXPECT_GT(received[0], previous);  // In order
+            previous = received[0];
+            ++delivered;
+        }
+    }
+    EXPECT_EQ(delivered, expected);
+    EXPECT_GE(Clock::now() - start, 5ms + std::chrono::milliseconds(expected));
+    EXPECT_EQ(a.getStats().bytesDelivered, expected * 1000);
+}
+
+TEST(EmulatedLinkProviderTest, LosesAtConfiguredRate) {
+    auto endpoints = EmulatedLink::createPair(linkConfig(1ms, 1000000000));
+    auto& a = *endpoints.first;
+    auto& b = *endpoints.second;
+    ASSERT_TRUE(a.Initialize({{"loss", "0.2"}, {"seed", "7"}, {"queue_bytes", "10000000"}}));
+    EXPECT_DOUBLE_EQ(a.GetSignalStrength(), 0.8);
+    EXPECT_DOUBLE_EQ(b.GetSignalStrength(), 1.0);  // Other direction untouched
+    ASSERT_TRUE(a.Connect("ground"));
+    ASSERT_TRUE(b.Connect("terminal"));
+    for (int i = 0; i < 2000; ++i) {
+        ASSERT_TRUE(a.SendData(ByteVector(100)));
+    }
+    EXPECT_NEAR(static_cast<double>(a.getStats().randomLosses), 400, 80);
+    EXPECT_EQ(a.getStats().queueDrops, 0u);
+}
+
+TEST(EmulatedLinkProviderTest, DisconnectedEndpoints) {
+    auto endpoints = EmulatedLink::createPair(linkConfig(1ms, 100000000));
+    auto& a = *endpoints.first;
+    auto& b = *endpoints.second;
+    EXPECT_FALSE(a.SendData(ByteVector(10)));
+    EXPECT_FALSE(a.getLastError().empty());
+
+    ASSERT_TRUE(a.Connect("ground"));
+    ASSERT_TRUE(a.SendData(ByteVector(10)));  // No one listening
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(a.getStats().undeliverable, 1u);
+    ASSERT_TRUE(b.Connect("terminal"));
+    EXPECT_FALSE(b.waitForData(5ms));
+    ASSERT_TRUE(b.Disconnect());
+    EXPECT_FALSE(b.waitForData(1s));  // Returns at once
+}
+
+TEST(EmulatedLinkProviderTest, CommandsChangeTheLink) {
+    auto endpoints = EmulatedLink::createPair(linkConfig(20ms, 100000000), linkConfig(30ms, 10000000));
+    auto& a = *endpoints.first;
+    auto& b = *endpoints.second;
+    EXPECT_DOUBLE_EQ(b.GetLatency(), 50.0);
+    EXPECT_EQ(b.GetBandwidth(), 10000000u);
+
+    std::string response;
+    ASSERT_TRUE(a.ExecuteCommand("set delay_ms 250", response));
+    ASSERT_TRUE(a.ExecuteCommand("set rate_bps 2000000", response));
+    EXPECT_DOUBLE_EQ(b.GetLatency(), 280.0);
+    ASSERT_TRUE(a.ExecuteCommand("status", response));
+    EXPECT_NE(response.find("delay=250.0 ms"), std::string::npos) << response;
+    EXPECT_NE(response.find("rate=2.000 Mbit/s"), std::string::npos) << response;
+
+    EXPECT_FALSE(a.ExecuteCommand("set loss 2", response));
+    EXPECT_FALSE(a.ExecuteCommand("set rate_bps fast", response));
+    EXPECT_FALSE(a.ExecuteCommand("set altitude 550", response));
+    EXPECT_FALSE(a.Initialize({{"rate_bps", "0"}}));
+    EXPECT_EQ(a.GetBandwidth(), 2000000u);
+}
+
+TEST(EmulatedLinkProviderTest, CarriesDataBetweenSessions) {
+    auto endpoints = EmulatedLink::createPair(linkConfig(10ms, 50000000));
+    EmulatedLinkProvider* receiver = endpoints.second.get();
+    SatelliteSession ground(std::move(endpoints.first));
+    SatelliteSession terminal(std::move(endpoints.second));
+    ASSERT_TRUE(ground.Connect("terminal"));
+    ASSERT_TRUE(terminal.Connect("ground"));
+    EXPECT_DOUBLE_EQ(ground.GetLatency(), 20.0);
+
+    auto out = ground.CreateSatelliteStream();
+    auto in = terminal.CreateSatelliteStream();
+    for (uint8_t i = 0; i < 100; ++i) {
+        ASSERT_TRUE(out->Write(ByteVector(500, i)));
+    }
+    ByteVector received;
+    int count = 0;
+    while (count < 100 && receiver->waitForData(1s)) {
+        while (in->Read(received)) {
+            EXPECT_EQ(received, ByteVector(500, static_cast<uint8_t>(count)));
+            ++count;
+        }
+    }
+    EXPECT_EQ(count, 100);
+    EXPECT_THROW(SatelliteSession(std::unique_ptr<ISatelliteProvider>()), std::runtime_error);
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "satellite/iridium_provider.h"
+#include "satellite/link_telemetry.h"
+#include "satellite/packet_pacer.h"
+#include "satellite/starlink_provider.h"
+#include <atomic>
+#include <thread>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+
+namespace {
+
+class NullController : public CongestionControl::ICongestionControl {
+public:
+    void onPacketSent(uint32_t) override {}
+    void onAckReceived(uint32_t, std::chrono::milliseconds) override {}
+    void onPacketLoss() override {}
+    uint32_t getCongestionWindow() const override { return UINT32_MAX; }
+    uint32_t getSendingRate() const override { return 1000000; }
+};
+
+class LinkTelemetryTest : public ::testing::Test {
+protected:
+    Common::ManualClock clock;
+};
+
+} // namespace
+
+TEST_F(LinkTelemetryTest, SmoothsRttWithRfc6298Gains) {
+    LinkTelemetry telemetry(clock);
+    EXPECT_EQ(telemetry.snapshot().rttSamples, 0u);
+    EXPECT_EQ(telemetry.snapshot().srtt, 0us);
+
+    telemetry.onRttSample(100ms);
+    auto first = telemetry.snapshot();
+    EXPECT_EQ(first.srtt, 100ms);
+    EXPECT_EQ(first.rttVariance, 50ms);
+    EXPECT_EQ(first.minRtt, 100ms);
+
+    telemetry.onRttSample(200ms);
+    auto second = telemetry.snapshot();
+    EXPECT_EQ(second.srtt, 112500us);        // 100 + (200 - 100) / 8
+    EXPECT_EQ(second.rttVariance, 62500us);  // 50 + (100 - 50) / 4
+    EXPECT_EQ(second.minRtt, 100ms);
+
+    telemetry.onRttSample(80ms);
+    telemetry.onRttSample(0ms);  // Not a sample
+    EXPECT_EQ(telemetry.snapshot().minRtt, 80ms);
+    EXPECT_EQ(telemetry.snapshot().rttSamples, 3u);
+}
+
+TEST_F(LinkTelemetryTest, AveragesThroughputAndLossPerInterval) {
+    LinkTelemetry telemetry(clock);
+    telemetry.onSent(125000, 10);
+    telemetry.onDelivered(125000, 10);
+    EXPECT_EQ(telemetry.snapshot().throughput, 0u);  // No full interval yet
+    EXPECT_EQ(telemetry.snapshot().bytesDelivered, 125000u);
+
+    clock.advance(100ms);
+    telemetry.onLost(2);
+    auto first = telemetry.snapshot();
+    EXPECT_EQ(first.throughput, 10000000u);  // 125 KB in 100 ms
+    EXPECT_DOUBLE_EQ(first.lossRate, 0.2 / 8);  // 2 of 10 sent
+    EXPECT_EQ(first.packetsLost, 2u);
+    EXPECT_EQ(first.updated, clock.now());
+
+    telemetry.onDelivered(250000, 20);
+    clock.advance(100ms);
+    telemetry.onSignalStrength(0.7);
+    auto second = telemetry.snapshot();
+    EXPECT_EQ(second.throughput, 12500000u);  // 10 + (20 - 10) / 4 Mbit/s
+    EXPECT_DOUBLE_EQ(second.lossRate, 0.2 / 8);  // Nothing sent, nothing lost
+    EXPECT_DOUBLE_EQ(second.signalStrength, 0.7);
+}
+
+TEST_F(LinkTelemetryTest, PerPacketCallsFoldOnceAnIntervalHasPassed) {
+    LinkTelemetry telemetry(clock);
+    for (int i = 0; i < 10; ++i) {
+        telemetry.onDelivered(1250);
+        clock.advance(10ms);
+    }
+    // The eleventh delivery lands 100 ms in and closes the interval
+    telemetry.onDelivered(1250);
+    EXPECT_EQ(telemetry.snapshot().throughput, 1100000u);
+
+    telemetry.reset();
+    auto cleared = telemetry.snapshot();
+    EXPECT_EQ(cleared.throughput, 0u);
+    EXPECT_EQ(cleared.packetsDelivered, 0u);
+    EXPECT_LT(cleared.signalStrength, 0);
+}
+
+TEST(LinkTelemetryConcurrencyTest, ReadersNeverSeeTornSnapshots) {
+    LinkTelemetry telemetry;
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 1; i <= 20000; ++i) {
+            telemetry.onRttSample(std::chrono::microseconds(1000 + i % 500));
+            telemetry.onSent(1200);
+            telemetry.onDelivered(1200);
+        }
+        done = true;
+    });
+    std::vector<std::thread> readers;
+    std::atomic<uint64_t> reads{0};
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            uint64_t samples = 0;
+            uint64_t sent = 0;
+            // At least one snapshot even if the writer is already done
+            do {
+                auto snapshot = telemetry.snapshot();
+                if (snapshot.rttSamples > 0) {
+                    // Each RTT field belongs to the same update as the others
+                    EXPECT_GE(snapshot.minRtt, 1000us);
+                    EXPECT_LT(snapshot.minRtt, 1500us);
+                    EXPECT_GE(snapshot.srtt, snapshot.minRtt);
+                    EXPECT_LT(snapshot.srtt, 1500us);
+                }
+                EXPECT_GE(snapshot.rttSamples, samples);
+                EXPECT_GE(snapshot.packetsSent, sent);
+                samples = snapshot.rttSamples;
+                sent = snapshot.packetsSent;
+                ++reads;
+            } while (!done);
+        });
+    }
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_GE(reads.load(), 2u);
+    EXPECT_EQ(telemetry.snapshot().rttSamples, 20000u);
+    EXPECT_EQ(telemetry.snapshot().bytesDelivered, 20000u * 1200);
+}
+
+TEST_F(LinkTelemetryTest, ProvidersReportMeasuredFigures) {
+    StarlinkProvider provider(clock);
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+    ASSERT_NE(provider.GetTelemetry(), nullptr);
+    EXPECT_DOUBLE_EQ(provider.GetLatency(), 20.0);  // Nominal until measured
+    EXPECT_EQ(provider.GetBandwidth(), 100000000u);
+    EXPECT_DOUBLE_EQ(provider.GetSignalStrength(), 0.9);
+
+    std::vector<ByteVector> packets(50, ByteVector(1000));
+    ASSERT_EQ(provider.SendBatch(packets), 50u);
+    clock.advance(100ms);
+    std::vector<ByteVector> received;
+    ASSERT_EQ(provider.ReceiveBatch(received, 100), 50u);
+    EXPECT_EQ(provider.GetBandwidth(), 4000000u);  // 50 KB over 100 ms
+
+    // Acks and losses fed through the pacer reach the provider's telemetry
+    NullController controller;
+    PacketPacer pacer(provider, controller);
+    pacer.onAckReceived(1000, 45ms);
+    EXPECT_DOUBLE_EQ(provider.GetLatency(), 45.0);
+    CongestionControl::AckEvent ack;
+    ack.rtt = 45ms;
+    ack.lostBytes = 2000;
+    ack.lostPackets = 2;
+    ack.now = clock.now();
+    pacer.onAck(ack);
+    pacer.onPacketLoss();
+    EXPECT_EQ(provider.GetTelemetry()->snapshot().packetsLost, 3u);
+
+    auto estimate = EstimatePathFromProvider(provider);
+    EXPECT_EQ(estimate.rtt, 45ms);
+    EXPECT_EQ(estimate.bandwidth, 500000u);
+
+    // A new connection starts from the nominal figures again
+    ASSERT_TRUE(provider.Connect("starlink-2"));
+    EXPECT_DOUBLE_EQ(provider.GetLatency(), 20.0);
+    EXPECT_EQ(provider.GetBandwidth(), 100000000u);
+
+    IridiumProvider modem(clock);
+    EXPECT_DOUBLE_EQ(modem.GetLatency(), 0.0);  // Unknown until measured
+    modem.GetTelemetry()->onSignalStrength(0.4);
+    modem.GetTelemetry()->onRttSample(1500ms);
+    EXPECT_DOUBLE_EQ(modem.GetSignalStrength(), 0.4);
+    EXPECT_DOUBLE_EQ(modem.GetLatency(), 1500.0);
+}
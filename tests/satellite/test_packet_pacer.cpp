@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+#include "satellite/packet_pacer.h"
+#include "congestion_control/cubic.h"
+#include <atomic>
+#include <thread>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+
+namespace {
+
+class RecordingProvider : public ISatelliteProvider {
+public:
+    std::atomic<size_t> sent{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<double> signal{1.0};
+    double latency = 0.0;
+    uint64_t bandwidth = 0;
+
+    bool Initialize(const std::map<std::string, std::string>&) override { return true; }
+    bool Connect(const std::string&) override { return true; }
+    bool Disconnect() override { return true; }
+    bool SendData(const ByteVector& data) override {
+        ++sent;
+        bytes += data.size();
+        return true;
+    }
+    bool ReceiveData(ByteVector&) override { return false; }
+    bool ExecuteCommand(const std::string&, std::string&) override { return false; }
+    double GetSignalStrength() const override { return signal; }
+    double GetLatency() const override { return latency; }
+    uint64_t GetBandwidth() const override { return bandwidth; }
+    std::unique_ptr<SatelliteStream> CreateStream() override { return nullptr; }
+    void setVerboseLogging(bool) override {}
+};
+
+// Fixed sending rate
+class FixedRate : public CongestionControl::ICongestionControl {
+public:
+    explicit FixedRate(uint32_t rate) : rate(rate) {}
+    uint32_t rate;
+    uint64_t sentBytes = 0;
+
+    void onPacketSent(uint32_t packetSize) override { sentBytes += packetSize; }
+    void onAckReceived(uint32_t, std::chrono::milliseconds) override {}
+    void onPacketLoss() override { rate /= 2; }
+    uint32_t getCongestionWindow() const override { return UINT32_MAX; }
+    uint32_t getSendingRate() const override { return rate; }
+};
+
+} // namespace
+
+TEST(PacketPacerTest, ReleasesAtControllerRateInTickSizedBursts) {
+    RecordingProvider provider;
+    FixedRate rate(1000000);  // 1000 packets/s of 1000 bytes
+    PacketPacer pacer(provider, rate);
+    for (int i = 0; i < 500; ++i) {
+        ASSERT_TRUE(pacer.enqueue(ByteVector(1000, static_cast<uint8_t>(i))));
+    }
+
+    auto start = PacketPacer::Clock::now();
+    for (int ms = 1; ms <= 100; ++ms) {
+        pacer.releaseDue(start + std::chrono::milliseconds(ms));
+    }
+    // 100 ms at 1 MB/s, plus at most one packet of deficit
+    EXPECT_NEAR(static_cast<double>(provider.sent), 100.0, 2.0);
+    EXPECT_EQ(rate.sentBytes, provider.bytes);
+    EXPECT_LE(pacer.getStats().bursts, 100u);
+    EXPECT_EQ(pacer.getQueuedPackets(), 500u - provider.sent);
+}
+
+TEST(PacketPacerTest, FollowsRateChangesFromController) {
+    RecordingProvider provider;
+    FixedRate rate(1000000);
+    PacketPacer pacer(provider, rate);
+    for (int i = 0; i < 500; ++i) {
+        pacer.enqueue(ByteVector(1000));
+    }
+    auto now = PacketPacer::Clock::now();
+    for (int ms = 1; ms <= 50; ++ms) {
+        pacer.releaseDue(now + std::chrono::milliseconds(ms));
+    }
+    size_t fullRate = provider.sent;
+
+    pacer.onPacketLoss();  // Halves FixedRate
+    EXPECT_EQ(pacer.getRate(), 500000u);
+    now += 50ms;
+    for (int ms = 1; ms <= 50; ++ms) {
+        pacer.releaseDue(now + std::chrono::milliseconds(ms));
+    }
+    EXPECT_NEAR(static_cast<double>(provider.sent - fullRate), fullRate / 2.0, 3.0);
+}
+
+TEST(PacketPacerTest, ConvertsCubicPacketsToBytes) {
+    RecordingProvider provider;
+    CongestionControl::Cubic cubic;
+    PacketPacer::Options options;
+    options.mss = 1000;
+    PacketPacer pacer(provider, cubic, options);
+
+    // Ten packets per default 100 ms RTT, well above the floor
+    EXPECT_EQ(cubic.getSendingRate(), 100u);
+    EXPECT_EQ(pacer.getRate(), 100000u);
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(pacer.enqueue(ByteVector(1000)));
+    }
+    auto start = PacketPacer::Clock::now();
+    for (int ms = 1; ms <= 100; ++ms) {
+        pacer.releaseDue(start + std::chrono::milliseconds(ms));
+    }
+    EXPECT_NEAR(static_cast<double>(provider.sent), 10.0, 2.0);
+
+    // Acked bytes reach the window as whole packets
+    uint32_t window = cubic.getCongestionWindow();
+    pacer.onAckReceived(1500, 100ms);
+    EXPECT_EQ(cubic.getCongestionWindow(), window + 1);
+    pacer.onAckReceived(500, 100ms);
+    EXPECT_EQ(cubic.getCongestionWindow(), window + 2);
+    EXPECT_EQ(pacer.getRate(), cubic.getSendingRate() * 1000);
+}
+
+TEST(PacketPacerTest, PushedBackPacketsAreRequeuedInOrder) {
+    // Takes `room` packets, then pushes back
+    class FullProvider : public RecordingProvider {
+    public:
+        size_t room = 3;
+        std::vector<uint8_t> order;
+        bool SendData(const ByteVector& data) override {
+            if (room == 0) {
+                return false;
+            }
+            --room;
+            order.push_back(data[0]);
+            return RecordingProvider::SendData(data);
+        }
+    } provider;
+    FixedRate rate(1000000);
+    PacketPacer::Options options;
+    options.tick = 10ms;
+    PacketPacer pacer(provider, rate, options);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(pacer.enqueue(ByteVector(1000, static_cast<uint8_t>(i))));
+    }
+
+    auto start = PacketPacer::Clock::now();
+    EXPECT_EQ(pacer.releaseDue(start + 10ms), 3u);
+    EXPECT_EQ(rate.sentBytes, 3000u);  // Only what the provider took
+    EXPECT_EQ(pacer.getQueuedPackets(), 7u);
+    EXPECT_EQ(pacer.getStats().sendFailures, 7u);
+
+    // Offered again after a tick, with the refunded tokens
+    provider.room = 100;
+    EXPECT_EQ(pacer.releaseDue(start + 15ms), 0u);
+    EXPECT_EQ(pacer.releaseDue(start + 20ms), 7u);
+    EXPECT_EQ(provider.order, (std::vector<uint8_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    EXPECT_EQ(rate.sentBytes, 10000u);
+    EXPECT_EQ(pacer.getStats().packetsReleased, 10u);
+}
+
+TEST(PacketPacerTest, IdleBucketIsBoundedAndQueueIsLimited) {
+    RecordingProvider provider;
+    FixedRate rate(1000000);
+    PacketPacer::Options options;
+    options.tick = 1ms;
+    options.queueLimit = 100;
+    PacketPacer pacer(provider, rate, options);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(pacer.enqueue(ByteVector(1000)));
+    }
+    EXPECT_FALSE(pacer.enqueue(ByteVector(1000)));
+    EXPECT_EQ(pacer.getStats().queueDrops, 1u);
+
+    // A long idle period earns at most two ticks of tokens
+    pacer.releaseDue(PacketPacer::Clock::now() + 10s);
+    EXPECT_LE(provider.sent, 3u);
+    EXPECT_GT(pacer.nextReleaseTime(), PacketPacer::Clock::now());
+}
+
+TEST(PacketPacerTest, PacingThreadDrainsQueueOnSchedule) {
+    RecordingProvider provider;
+    FixedRate rate(2000000);
+    PacketPacer pacer(provider, rate);
+    ASSERT_TRUE(pacer.start());
+    EXPECT_FALSE(pacer.start());
+
+    auto start = PacketPacer::Clock::now();
+    for (int i = 0; i < 200; ++i) {
+        pacer.enqueue(ByteVector(1000));
+    }
+    while (provider.sent < 200 && PacketPacer::Clock::now() - start < 2s) {
+        std::this_thread::sleep_for(1ms);
+    }
+    auto elapsed = PacketPacer::Clock::now() - start;
+    pacer.stop();
+
+    EXPECT_EQ(provider.sent, 200u);
+    // 200 KB at 2 MB/s, released a tick's worth at a time
+    EXPECT_GE(elapsed, 90ms);
+    EXPECT_LT(pacer.getStats().bursts, 200u);
+    EXPECT_FALSE(pacer.isRunning());
+}
+
+TEST(PacketPacerTest, WirelessLossesDoNotReachController) {
+    RecordingProvider provider;
+    FixedRate rate(1000000);
+    PacketPacer pacer(provider, rate);
+    auto now = PacketPacer::Clock::now();
+    CongestionControl::AckEvent ack;
+    ack.ackedBytes = 1000;
+    ack.ackedPackets = 1;
+    // 50 ms path, then a 40 ms standing queue
+    for (int ms = 0; ms < 1000; ++ms) {
+        ack.now = now + std::chrono::milliseconds(ms);
+        ack.rtt = ms < 500 ? 50ms : 90ms;
+        pacer.onAck(ack);
+    }
+    now += 1000ms;
+
+    CongestionControl::AckEvent loss;
+    loss.now = now;
+    loss.lostBytes = 1000;
+    loss.lostPackets = 1;
+    pacer.onAck(loss);  // Overflow: halves FixedRate
+    EXPECT_EQ(rate.rate, 500000u);
+
+    // Rain fade: the provider reports the signal dropping
+    provider.signal = 0.4;
+    loss.now = now + 200ms;
+    loss.lostBytes = 2000;
+    loss.lostPackets = 2;
+    pacer.onAck(loss);
+    EXPECT_EQ(rate.rate, 500000u);
+    EXPECT_EQ(pacer.getStats().wirelessLosses, 2u);
+}
+
+TEST(PacketPacerTest, AsksProviderForSignalOutsideLock) {
+    // A provider that calls back into the pacer would deadlock if the
+    // pacer held its lock while asking
+    class CallingBackProvider : public RecordingProvider {
+    public:
+        PacketPacer* pacer = nullptr;
+        mutable int queries = 0;
+        double GetSignalStrength() const override {
+            ++queries;
+            pacer->getRate();
+            return RecordingProvider::GetSignalStrength();
+        }
+    };
+    CallingBackProvider provider;
+    FixedRate rate(1000000);
+    PacketPacer pacer(provider, rate);
+    provider.pacer = &pacer;
+
+    CongestionControl::AckEvent ack;
+    ack.ackedBytes = 1000;
+    ack.ackedPackets = 1;
+    ack.rtt = 50ms;
+    ack.now = PacketPacer::Clock::now();
+    pacer.onAck(ack);
+    pacer.onAck(ack);  // Within the poll interval
+    pacer.onAckReceived(1000, 50ms);
+    pacer.onPacketLoss();
+    EXPECT_EQ(provider.queries, 1);
+}
+
+TEST(PacketPacerTest, PathEstimateFromProviderFigures) {
+    RecordingProvider provider;
+    EXPECT_FALSE(EstimatePathFromProvider(provider).valid());
+
+    provider.latency = 600.0;
+    provider.bandwidth = 100000000;
+    auto estimate = EstimatePathFromProvider(provider);
+    ASSERT_TRUE(estimate.valid());
+    EXPECT_EQ(estimate.bandwidth, 12500000u);
+    EXPECT_EQ(estimate.rtt, 600ms);
+}
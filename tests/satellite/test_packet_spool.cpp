@@ -0,0 +1,319 @@
+#include <gtest/gtest.h>
+#include "satellite/packet_spool.h"
+#include "satellite/starlink_provider.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+
+namespace {
+
+ByteVector record(int i, size_t size = 100) {
+    ByteVector data(size, static_cast<uint8_t>(i));
+    data[0] = static_cast<uint8_t>(i >> 8);
+    return data;
+}
+
+std::vector<std::string> segmentFiles(const std::string& directory) {
+    std::vector<std::string> files;
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".seg") == 0) {
+                files.push_back(name);
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Never takes a packet of `refusedSize` bytes, nor anything after one
+class RefusingProvider : public StarlinkProvider {
+public:
+    explicit RefusingProvider(size_t refusedSize) : m_refusedSize(refusedSize) {}
+
+    bool SendData(const ByteVector& data) override {
+        return data.size() != m_refusedSize && StarlinkProvider::SendData(data);
+    }
+
+    size_t SendBatch(std::vector<ByteVector>& packets) override {
+        auto refused = std::find_if(packets.begin(), packets.end(),
+                                    [this](const ByteVector& packet) { return packet.size() == m_refusedSize; });
+        std::vector<ByteVector> accepted(std::make_move_iterator(packets.begin()), std::make_move_iterator(refused));
+        packets.erase(packets.begin(), refused);
+        size_t taken = StarlinkProvider::SendBatch(accepted);
+        packets.insert(packets.begin(), std::make_move_iterator(accepted.begin()),
+                       std::make_move_iterator(accepted.end()));
+        return taken;
+    }
+
+private:
+    size_t m_refusedSize;
+};
+
+class PacketSpoolTest : public ::testing::Test {
+protected:
+    std::string directory;
+    PacketSpool::Options options;
+
+    void SetUp() override {
+        std::string pattern = ::testing::TempDir() + "srpt_spool_XXXXXX";
+        ASSERT_NE(mkdtemp(&pattern[0]), nullptr);
+        directory = pattern;
+        options.segmentBytes = 4096;
+    }
+
+    void TearDown() override {
+        for (const auto& name : segmentFiles(directory)) {
+            unlink((directory + "/" + name).c_str());
+        }
+        unlink((directory + "/cursor").c_str());
+        rmdir(directory.c_str());
+    }
+};
+
+} // namespace
+
+TEST_F(PacketSpoolTest, AppendsReadsAndAcknowledgesAcrossSegments) {
+    PacketSpool spool;
+    ASSERT_TRUE(spool.open(directory, options));
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(spool.append(record(i)));
+    }
+    // 37 records of 108 bytes to a 4 KiB segment
+    EXPECT_EQ(segmentFiles(directory).size(), 3u);
+    EXPECT_EQ(spool.sizeBytes(), 3u * 4096);
+    EXPECT_EQ(spool.unacknowledged(), 100u);
+
+    ByteVector data;
+    for (int i = 0; i < 60; ++i) {
+        ASSERT_TRUE(spool.readNext(data));
+        ASSERT_EQ(data, record(i));
+    }
+    EXPECT_EQ(spool.unread(), 40u);
+
+    // Taking the first 50 frees the first segment only
+    EXPECT_EQ(spool.acknowledge(50), 50u);
+    EXPECT_EQ(segmentFiles(directory).size(), 2u);
+    EXPECT_EQ(spool.getStats().segmentsRemoved, 1u);
+    EXPECT_EQ(spool.unacknowledged(), 50u);
+
+    // What was read and not acknowledged is read again after a rewind
+    spool.rewind();
+    ASSERT_TRUE(spool.readNext(data));
+    EXPECT_EQ(data, record(50));
+
+    // Acknowledging past the read cursor carries it along
+    EXPECT_EQ(spool.acknowledge(20), 20u);
+    ASSERT_TRUE(spool.readNext(data));
+    EXPECT_EQ(data, record(70));
+    EXPECT_EQ(spool.unread(), 29u);
+}
+
+TEST_F(PacketSpoolTest, SurvivesRestart) {
+    {
+        PacketSpool spool;
+        ASSERT_TRUE(spool.open(directory, options));
+        for (int i = 0; i < 50; ++i) {
+            ASSERT_TRUE(spool.append(record(i)));
+        }
+        ByteVector data;
+        for (int i = 0; i < 10; ++i) {
+            spool.readNext(data);
+        }
+        spool.acknowledge(8);
+        EXPECT_TRUE(spool.sync());
+    }
+
+    PacketSpool spool;
+    ASSERT_TRUE(spool.open(directory, options));
+    EXPECT_EQ(spool.getStats().recovered, 42u);
+    EXPECT_EQ(spool.unread(), 42u);  // Read but unacknowledged goes again
+    ByteVector data;
+    ASSERT_TRUE(spool.readNext(data));
+    EXPECT_EQ(data, record(8));
+
+    // Appends carry on after the recovered records
+    ASSERT_TRUE(spool.append(record(50)));
+    spool.acknowledge(42);
+    ASSERT_TRUE(spool.readNext(data));
+    EXPECT_EQ(data, record(50));
+}
+
+TEST_F(PacketSpoolTest, DiscardsTornTailOnRecovery) {
+    {
+        PacketSpool spool;
+        ASSERT_TRUE(spool.open(directory, options));
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(spool.append(record(i)));
+        }
+    }
+    // Damage the last record as a crash mid-write might
+    auto files = segmentFiles(directory);
+    ASSERT_EQ(files.size(), 1u);
+    FILE* file = std::fopen((directory + "/" + files[0]).c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    std::fseek(file, 4 * 108 + 50, SEEK_SET);
+    std::fputc(0xEE, file);
+    std::fclose(file);
+
+    PacketSpool spool;
+    ASSERT_TRUE(spool.open(directory, options));
+    EXPECT_EQ(spool.unacknowledged(), 4u);
+    EXPECT_EQ(spool.getStats().discardedBytes, 108u);
+
+    ASSERT_TRUE(spool.append(record(9)));
+    spool.close();
+    ASSERT_TRUE(spool.open(directory, options));
+    EXPECT_EQ(spool.unacknowledged(), 5u);
+    ByteVector data;
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(spool.readNext(data));
+    }
+    EXPECT_EQ(data, record(9));
+}
+
+TEST_F(PacketSpoolTest, CompactsAcknowledgedDataAndEnforcesLimit) {
+    options.maxBytes = 2 * 4096;
+    PacketSpool spool;
+    ASSERT_TRUE(spool.open(directory, options));
+    EXPECT_FALSE(spool.append(ByteVector()));
+    EXPECT_FALSE(spool.append(ByteVector(4096)));  // Larger than a segment
+
+    int appended = 0;
+    while (spool.append(record(appended))) {
+        ++appended;
+    }
+    EXPECT_EQ(appended, 74);
+    EXPECT_EQ(spool.getLastError(), "Spool is full");
+
+    // Acknowledging everything leaves no segment behind
+    EXPECT_EQ(spool.acknowledge(1000), 74u);
+    EXPECT_TRUE(segmentFiles(directory).empty());
+    EXPECT_EQ(spool.sizeBytes(), 0u);
+    ASSERT_TRUE(spool.append(record(0)));
+
+    // Numbering carries on across a restart, so segment names stay in order
+    spool.close();
+    ASSERT_TRUE(spool.open(directory, options));
+    EXPECT_EQ(spool.unacknowledged(), 1u);
+    ASSERT_TRUE(spool.append(ByteVector(4000)));
+    auto files = segmentFiles(directory);
+    ASSERT_EQ(files.size(), 2u);
+    EXPECT_EQ(files[0], "00000000000000000074.seg");
+    EXPECT_EQ(files[1], "00000000000000000075.seg");
+}
+
+TEST_F(PacketSpoolTest, ProviderSpoolsWhileDisconnectedAndDrainsOnContact) {
+    {
+        auto inner = std::make_unique<StarlinkProvider>();
+        SpoolingProvider provider(std::move(inner), directory);
+        ASSERT_TRUE(provider.Initialize({{"queue_packets", "16"}, {"spool_segment_bytes", "4096"}}));
+        for (int i = 0; i < 30; ++i) {
+            ASSERT_TRUE(provider.SendData(record(i)));
+        }
+        EXPECT_EQ(provider.getSpool().unacknowledged(), 30u);
+        std::string response;
+        ASSERT_TRUE(provider.ExecuteCommand("spool status", response));
+        EXPECT_EQ(response, "queued=30 unsent=30 bytes=4096 dropped=0 connected=0");
+    }
+
+    // A new process picks the spool up and sends it on contact, as fast as
+    // the link takes it and ahead of newer packets
+    auto inner = std::make_unique<StarlinkProvider>();
+    SpoolingProvider provider(std::move(inner), directory);
+    ASSERT_TRUE(provider.Initialize({{"queue_packets", "16"}}));
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+    EXPECT_EQ(provider.getSpool().unacknowledged(), 14u);  // The queue took 16
+    ASSERT_TRUE(provider.SendData(record(30)));
+
+    std::vector<ByteVector> received;
+    ByteVector data;
+    while (provider.ReceiveData(data)) {
+        received.push_back(data);
+    }
+    ASSERT_EQ(received.size(), 31u);
+    for (int i = 0; i < 31; ++i) {
+        EXPECT_EQ(received[i], record(i));
+    }
+    EXPECT_EQ(provider.getSpool().unacknowledged(), 0u);
+    EXPECT_TRUE(segmentFiles(directory).empty());
+
+    // Connected and caught up, packets go straight through
+    ASSERT_TRUE(provider.SendData(record(31)));
+    EXPECT_EQ(provider.getSpool().getStats().appended, 1u);
+    ASSERT_TRUE(provider.Disconnect());
+    std::vector<ByteVector> batch{record(32), record(33)};
+    EXPECT_EQ(provider.SendBatch(batch), 2u);
+    EXPECT_EQ(provider.getSpool().unacknowledged(), 2u);
+}
+
+TEST_F(PacketSpoolTest, ProviderDropsPacketItKeepsRefusing) {
+    SpoolingProvider provider(std::make_unique<RefusingProvider>(7), directory);
+    ASSERT_TRUE(provider.Initialize({}));
+    ASSERT_TRUE(provider.SendData(record(0, 7)));
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+
+    // Alone in the spool, the refused packet cannot be told from
+    // back-pressure and waits
+    for (size_t i = 0; i < 2 * SpoolingProvider::MAX_HEAD_REFUSALS; ++i) {
+        EXPECT_EQ(provider.drain(), 0u);
+    }
+    EXPECT_EQ(provider.getSpool().unacknowledged(), 1u);
+    EXPECT_EQ(provider.getDropped(), 0u);
+
+    // Once the provider takes what follows it, it goes
+    ASSERT_TRUE(provider.SendData(record(1)));
+    ASSERT_TRUE(provider.SendData(record(2)));
+    EXPECT_EQ(provider.getSpool().unacknowledged(), 0u);
+    EXPECT_EQ(provider.getDropped(), 1u);
+    // Connect() drained once too
+    EXPECT_EQ(provider.getLastError(), "Dropped a spooled packet of 7 bytes after " +
+                                           std::to_string(2 * SpoolingProvider::MAX_HEAD_REFUSALS + 1) + " refusals");
+    std::string response;
+    ASSERT_TRUE(provider.ExecuteCommand("spool status", response));
+    EXPECT_EQ(response, "queued=0 unsent=0 bytes=0 dropped=1 connected=1");
+
+    ByteVector data;
+    ASSERT_TRUE(provider.ReceiveData(data));
+    EXPECT_EQ(data, record(1));
+    ASSERT_TRUE(provider.ReceiveData(data));
+    EXPECT_EQ(data, record(2));
+    EXPECT_FALSE(provider.ReceiveData(data));
+
+    // Below the limit nothing is dropped
+    ASSERT_TRUE(provider.SendData(record(3, 7)));
+    ASSERT_TRUE(provider.SendData(record(4)));
+    // Each send drained once
+    for (size_t i = 2; i + 1 < SpoolingProvider::MAX_HEAD_REFUSALS; ++i) {
+        EXPECT_EQ(provider.drain(), 0u);
+    }
+    EXPECT_EQ(provider.getSpool().unacknowledged(), 2u);
+    EXPECT_EQ(provider.getDropped(), 1u);
+}
+
+TEST_F(PacketSpoolTest, ProviderReportsSpoolItCannotOpen) {
+    // A regular file where the spool directory should be
+    std::string blocker = directory + "/blocker";
+    std::FILE* file = std::fopen(blocker.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fclose(file);
+
+    SpoolingProvider provider(std::make_unique<StarlinkProvider>(), blocker + "/spool");
+    EXPECT_FALSE(provider.getSpool().isOpen());
+    EXPECT_FALSE(provider.Initialize({}));
+    EXPECT_NE(provider.getLastError().find(blocker), std::string::npos) << provider.getLastError();
+    EXPECT_FALSE(provider.Initialize({{"spool_max_bytes", "lots"}}));
+    EXPECT_EQ(provider.getLastError(), "Invalid value for spool_max_bytes");
+    unlink(blocker.c_str());
+
+    SpoolingProvider usable(std::make_unique<StarlinkProvider>(), directory);
+    EXPECT_TRUE(usable.Initialize({}));
+    EXPECT_EQ(usable.getLastError(), "");
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "common/spsc_ring.h"
+#include "satellite/emulated_link_provider.h"
+#include "satellite/iridium_provider.h"
+#include "satellite/starlink_provider.h"
+#include <thread>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::vector<ByteVector> numberedPackets(int count, size_t size = 100) {
+    std::vector<ByteVector> packets;
+    for (int i = 0; i < count; ++i) {
+        packets.emplace_back(size, static_cast<uint8_t>(i));
+    }
+    return packets;
+}
+
+// Takes a fixed number of packets through SendData, then refuses
+class LimitedProvider : public ISatelliteProvider {
+public:
+    explicit LimitedProvider(size_t limit) : limit(limit) {}
+    size_t limit;
+    std::vector<ByteVector> sent;
+
+    bool Initialize(const std::map<std::string, std::string>&) override { return true; }
+    bool Connect(const std::string&) override { return true; }
+    bool Disconnect() override { return true; }
+    bool SendData(const ByteVector& data) override {
+        if (sent.size() == limit) {
+            return false;
+        }
+        sent.push_back(data);
+        return true;
+    }
+    bool ReceiveData(ByteVector& data) override {
+        if (sent.empty()) {
+            return false;
+        }
+        data = sent.front();
+        sent.erase(sent.begin());
+        return true;
+    }
+    bool ExecuteCommand(const std::string&, std::string&) override { return false; }
+    double GetSignalStrength() const override { return 1.0; }
+    double GetLatency() const override { return 0.0; }
+    uint64_t GetBandwidth() const override { return 0; }
+    std::unique_ptr<SatelliteStream> CreateStream() override { return nullptr; }
+    void setVerboseLogging(bool) override {}
+};
+
+} // namespace
+
+TEST(SpscRingTest, BoundedAndMovesElements) {
+    Common::SpscRing<ByteVector> ring(5);
+    EXPECT_EQ(ring.capacity(), 8u);
+    EXPECT_TRUE(ring.empty());
+
+    ByteVector first(1000, 1);
+    const uint8_t* buffer = first.data();
+    ASSERT_TRUE(ring.tryPush(std::move(first)));
+    for (int i = 1; i < 8; ++i) {
+        ASSERT_TRUE(ring.tryPush(ByteVector(10)));
+    }
+    ByteVector refused(10, 9);
+    EXPECT_FALSE(ring.tryPush(std::move(refused)));
+    EXPECT_EQ(refused, ByteVector(10, 9));  // Still the caller's
+    EXPECT_EQ(ring.size(), 8u);
+
+    ByteVector out;
+    ASSERT_TRUE(ring.tryPop(out));
+    EXPECT_EQ(out.data(), buffer);  // Same allocation, not a copy
+    EXPECT_TRUE(ring.tryPush(std::move(refused)));
+}
+
+TEST(SpscRingTest, KeepsOrderAcrossThreads) {
+    Common::SpscRing<uint64_t> ring(64);
+    constexpr uint64_t COUNT = 200000;
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < COUNT; ++i) {
+            uint64_t value = i;
+            while (!ring.tryPush(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t expected = 0;
+    uint64_t value = 0;
+    while (expected < COUNT) {
+        if (ring.tryPop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(ProviderBatchingTest, LoopbackQueueAppliesBackpressure) {
+    StarlinkProvider provider;
+    EXPECT_FALSE(provider.Initialize({{"queue_packets", "0"}}));
+    EXPECT_FALSE(provider.Initialize({{"queue_packets", "-1"}}));
+    EXPECT_EQ(provider.getLastError(), "Value out of range for queue_packets");
+    EXPECT_FALSE(provider.Initialize({{"queue_packets", "lots"}}));
+    EXPECT_EQ(provider.getLastError(), "Invalid value for queue_packets");
+    ASSERT_TRUE(provider.Initialize({{"queue_packets", "16"}}));
+
+    auto packets = numberedPackets(20);
+    const uint8_t* buffer = packets[0].data();
+    EXPECT_EQ(provider.SendBatch(packets), 16u);
+    ASSERT_EQ(packets.size(), 4u);  // Left for the caller to retry
+    EXPECT_EQ(packets[0], ByteVector(100, 16));
+    EXPECT_FALSE(provider.SendData(ByteVector(100)));
+
+    std::vector<ByteVector> received;
+    EXPECT_EQ(provider.ReceiveBatch(received, 10), 10u);
+    EXPECT_EQ(received[0].data(), buffer);  // Moved through, not copied
+    EXPECT_EQ(provider.SendBatch(packets), 4u);
+    EXPECT_TRUE(packets.empty());
+    EXPECT_EQ(provider.ReceiveBatch(received, 100), 10u);
+    ASSERT_EQ(received.size(), 20u);
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(received[i][0], i);
+    }
+    EXPECT_EQ(provider.ReceiveBatch(received, 100), 0u);
+}
+
+TEST(ProviderBatchingTest, StreamBatchesGoThroughProvider) {
+    IridiumProvider provider;
+    EXPECT_FALSE(provider.Initialize({{"queue_packets", "18446744073709551615"}}));
+    EXPECT_EQ(provider.getLastError(), "Value out of range for queue_packets");
+    auto stream = provider.CreateStream();
+    auto packets = numberedPackets(3);
+    EXPECT_EQ(stream->WriteBatch(packets), 3u);
+    ByteVector single;
+    ASSERT_TRUE(stream->Read(single));
+    EXPECT_EQ(single, ByteVector(100, 0));
+    std::vector<ByteVector> received;
+    EXPECT_EQ(stream->ReadBatch(received, 8), 2u);
+    EXPECT_EQ(received.back(), ByteVector(100, 2));
+}
+
+TEST(ProviderBatchingTest, DefaultBatchStopsAtFirstRefusal) {
+    LimitedProvider provider(3);
+    auto packets = numberedPackets(5);
+    EXPECT_EQ(provider.SendBatch(packets), 3u);
+    ASSERT_EQ(packets.size(), 2u);
+    EXPECT_EQ(packets[0], ByteVector(100, 3));
+
+    std::vector<ByteVector> received;
+    EXPECT_EQ(provider.ReceiveBatch(received, 2), 2u);
+    EXPECT_EQ(provider.ReceiveBatch(received, 2), 1u);
+    EXPECT_EQ(received[2], ByteVector(100, 2));
+}
+
+TEST(ProviderBatchingTest, EmulatedLinkTakesWholeBatch) {
+    EmulatedLink::Config config;
+    config.delay = 1ms;
+    config.queueBytes = 1 << 20;
+    auto endpoints = EmulatedLink::createPair(config);
+    auto& a = *endpoints.first;
+    auto& b = *endpoints.second;
+    auto packets = numberedPackets(50, 1000);
+    EXPECT_EQ(a.SendBatch(packets), 0u);  // Not connected
+    EXPECT_EQ(packets.size(), 50u);
+
+    ASSERT_TRUE(a.Connect("ground"));
+    ASSERT_TRUE(b.Connect("terminal"));
+    EXPECT_EQ(a.SendBatch(packets), 50u);
+    EXPECT_TRUE(packets.empty());
+    std::vector<ByteVector> received;
+    while (received.size() < 50 && b.waitForData(1s)) {
+        b.ReceiveBatch(received, 64);
+    }
+    ASSERT_EQ(received.size(), 50u);
+    EXPECT_EQ(received[49], ByteVector(1000, 49));
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include "satellite/iridium_provider.h"
+#include "satellite/sbd_framing.h"
+#include <random>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::vector<ByteVector> frameAll(SbdFramer& framer) {
+    std::vector<ByteVector> messages;
+    ByteVector message;
+    while (framer.nextMessage(message)) {
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+std::vector<ByteVector> reassembleAll(const std::vector<ByteVector>& messages) {
+    SbdReassembler reassembler;
+    std::vector<ByteVector> packets;
+    for (const auto& message : messages) {
+        EXPECT_TRUE(reassembler.addMessage(message, packets));
+    }
+    return packets;
+}
+
+} // namespace
+
+TEST(SbdFramingTest, PacksSmallPacketsIntoOneMessage) {
+    SbdFramer framer(340);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(framer.add(ByteVector(20, static_cast<uint8_t>(i))));
+    }
+    EXPECT_FALSE(framer.hasFullMessage());
+    EXPECT_FALSE(framer.add(ByteVector()));
+    EXPECT_FALSE(framer.add(ByteVector(SbdFramer::MAX_PACKET_BYTES + 1)));
+
+    auto messages = frameAll(framer);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].size(), 211u);  // Sequence byte and one header byte per packet
+    EXPECT_EQ(framer.getStats().overheadBytes, 11u);
+
+    auto packets = reassembleAll(messages);
+    ASSERT_EQ(packets.size(), 10u);
+    EXPECT_EQ(packets[9], ByteVector(20, 9));
+}
+
+TEST(SbdFramingTest, FragmentsLargePacketsAcrossFullMessages) {
+    SbdFramer framer(340);
+    ByteVector large(1000);
+    for (size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<uint8_t>(i * 7);
+    }
+    ASSERT_TRUE(framer.add(large));
+    EXPECT_TRUE(framer.hasFullMessage());
+
+    auto messages = frameAll(framer);
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0].size(), 340u);
+    EXPECT_EQ(messages[1].size(), 340u);
+    EXPECT_EQ(framer.getStats().fragmentedPackets, 1u);
+    EXPECT_EQ(framer.getStats().overheadBytes, 6u);
+
+    auto packets = reassembleAll(messages);
+    ASSERT_EQ(packets.size(), 1u);
+    EXPECT_EQ(packets[0], large);
+}
+
+TEST(SbdFramingTest, RoundTripsMixedSizesWithinTheLimit) {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<size_t> size(1, 900);
+    SbdFramer framer(270);
+    std::vector<ByteVector> sent;
+    std::vector<ByteVector> messages;
+    ByteVector message;
+    uint64_t payload = 0;
+    for (int i = 0; i < 500; ++i) {
+        ByteVector packet(size(random), static_cast<uint8_t>(i));
+        payload += packet.size();
+        sent.push_back(packet);
+        ASSERT_TRUE(framer.add(std::move(packet)));
+        while (framer.hasFullMessage() && framer.nextMessage(message)) {
+            // Only full messages before the flush, give or take the bytes
+            // too few to start another record
+            EXPECT_GE(message.size(), 268u);
+            EXPECT_LE(message.size(), 270u);
+            messages.push_back(message);
+        }
+    }
+    for (auto& rest : frameAll(framer)) {
+        EXPECT_LE(rest.size(), 270u);
+        messages.push_back(rest);
+    }
+
+    EXPECT_TRUE(reassembleAll(messages) == sent);
+    EXPECT_EQ(framer.getStats().payloadBytes, payload);
+    EXPECT_LT(framer.getStats().overheadBytes, payload / 50);
+}
+
+TEST(SbdFramingTest, LostMessageDropsOnlyThePacketSplitAcrossIt) {
+    SbdFramer framer(200);
+    framer.add(ByteVector(100, 'A'));
+    framer.add(ByteVector(300, 'B'));
+    framer.add(ByteVector(50, 'C'));
+    auto messages = frameAll(framer);
+    ASSERT_EQ(messages.size(), 3u);
+    messages.erase(messages.begin() + 1);
+
+    SbdReassembler reassembler;
+    std::vector<ByteVector> packets;
+    for (const auto& message : messages) {
+        EXPECT_TRUE(reassembler.addMessage(message, packets));
+    }
+    ASSERT_EQ(packets.size(), 2u);
+    EXPECT_EQ(packets[0], ByteVector(100, 'A'));
+    EXPECT_EQ(packets[1], ByteVector(50, 'C'));
+    EXPECT_EQ(reassembler.getStats().droppedPackets, 1u);
+}
+
+TEST(SbdFramingTest, RejectsMalformedMessages) {
+    SbdReassembler reassembler;
+    std::vector<ByteVector> packets;
+    EXPECT_FALSE(reassembler.addMessage(ByteVector(), packets));
+    EXPECT_FALSE(reassembler.addMessage(ByteVector{0, 40 << 2, 1, 2}, packets));  // Runs past the end
+    EXPECT_FALSE(reassembler.addMessage(ByteVector{1, 2 << 2, 1, 2, 1, 9}, packets));  // Continues mid-message
+    EXPECT_FALSE(reassembler.addMessage(ByteVector{2, 0xFF, 0xFF, 0xFF}, packets));  // Header too long
+    EXPECT_EQ(reassembler.getStats().malformedMessages, 4u);
+    EXPECT_EQ(packets.size(), 1u);  // Completed before the fault
+
+    EXPECT_TRUE(reassembler.addMessage(ByteVector{3, 0, 5}, packets));
+    EXPECT_EQ(packets.back(), ByteVector{5});
+}
+
+TEST(SbdFramingTest, IridiumProviderSharesSessionsBetweenPackets) {
+    Common::ManualClock clock;
+    IridiumProvider modem(clock);
+    EXPECT_FALSE(modem.Initialize({{"mo_bytes", "2"}}));
+    ASSERT_TRUE(modem.Initialize({{"mailbox_poll_ms", "60000"}}));
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(modem.SendData(ByteVector(20, static_cast<uint8_t>(i))));
+    }
+    EXPECT_EQ(modem.getSbdStats().sessions, 0u);  // Waiting to share a message
+
+    // The mailbox check sends the partial message and brings back all of it
+    std::vector<ByteVector> received;
+    EXPECT_EQ(modem.ReceiveBatch(received, 100), 10u);
+    auto stats = modem.getSbdStats();
+    EXPECT_EQ(stats.sessions, 1u);
+    EXPECT_EQ(stats.moMessages, 1u);
+    EXPECT_EQ(stats.moBytes, 211u);
+    EXPECT_EQ(stats.framingBytes, 11u);
+    EXPECT_EQ(stats.mtMessages, 1u);
+
+    // Checks with nothing to send are rate limited
+    ByteVector packet;
+    EXPECT_FALSE(modem.ReceiveData(packet));
+    EXPECT_EQ(modem.getSbdStats().sessions, 1u);
+    clock.advance(60s);
+    EXPECT_FALSE(modem.ReceiveData(packet));
+    EXPECT_EQ(modem.getSbdStats().mailboxChecks, 1u);
+
+    // Full messages go at once; the tail waits for flush() or a check
+    ByteVector large(600, 0x5A);
+    ASSERT_TRUE(modem.SendData(large));
+    EXPECT_EQ(modem.getSbdStats().moMessages, 3u);
+    EXPECT_TRUE(modem.flush());
+    EXPECT_EQ(modem.getSbdStats().moMessages, 4u);
+    ASSERT_TRUE(modem.ReceiveData(packet));
+    EXPECT_EQ(packet, large);
+    EXPECT_EQ(modem.getSbdStats().sessions, 5u);
+}
+
+TEST(SbdFramingTest, IridiumProviderSendsPartialMessagesAfterMaxHold) {
+    Common::ManualClock clock;
+    IridiumProvider modem(clock);
+    ASSERT_TRUE(modem.Initialize({{"mailbox_poll_ms", "60000"}, {"max_hold_ms", "2000"}}));
+
+    ASSERT_TRUE(modem.SendData(ByteVector(20, 1)));
+    clock.advance(1s);
+    ASSERT_TRUE(modem.SendData(ByteVector(20, 2)));
+    EXPECT_EQ(modem.getSbdStats().sessions, 0u);
+
+    // Held long enough: the next send takes the partial message up with it
+    clock.advance(1s);
+    ASSERT_TRUE(modem.SendData(ByteVector(20, 3)));
+    auto stats = modem.getSbdStats();
+    EXPECT_EQ(stats.sessions, 1u);
+    EXPECT_EQ(stats.moMessages, 1u);
+    std::vector<ByteVector> received;
+    EXPECT_EQ(modem.ReceiveBatch(received, 10), 3u);
+    EXPECT_EQ(modem.getSbdStats().sessions, 1u);
+
+    // The hold starts again with the next partial message
+    ASSERT_TRUE(modem.SendData(ByteVector(20, 4)));
+    clock.advance(1500ms);
+    ASSERT_TRUE(modem.SendData(ByteVector(20, 5)));
+    EXPECT_EQ(modem.getSbdStats().moMessages, 1u);
+
+    EXPECT_FALSE(modem.Initialize({{"max_hold_ms", "soon"}}));
+}
+
+TEST(SbdFramingTest, IridiumProviderPushesBackWhenMailboxIsFull) {
+    IridiumProvider modem;
+    ASSERT_TRUE(modem.Initialize({{"queue_packets", "2"}, {"mt_bytes", "100"}}));
+    int accepted = 0;
+    while (modem.SendData(ByteVector(60, static_cast<uint8_t>(accepted)))) {
+        ++accepted;
+    }
+    EXPECT_EQ(accepted, 5);  // Two full messages queued, a third's worth held back
+    EXPECT_FALSE(modem.SendData(ByteVector(10)));
+
+    std::vector<ByteVector> received;
+    EXPECT_EQ(modem.ReceiveBatch(received, 10), 3u);  // The fourth packet still has a fragment to go
+    EXPECT_TRUE(modem.SendData(ByteVector(60, 9)));
+    EXPECT_EQ(modem.ReceiveBatch(received, 10), 3u);
+    EXPECT_EQ(received.back(), ByteVector(60, 9));
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "congestion_control/bbr.h"
+#include "satellite/packet_pacer.h"
+#include "satellite/trace_replay_provider.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace SRPT;
+using namespace SRPT::Satellite;
+using namespace std::chrono_literals;
+using CongestionControl::LinkTrace;
+
+namespace {
+
+// 10 s of 8 Mbit/s at 40 ms, then 60 ms after a handover, with a 2 s
+// outage at 5 s
+LinkTrace handoverTrace(double lossRate = 0) {
+    LinkTrace trace;
+    trace.setProvider("starlink");
+    for (int second = 0; second < 10; ++second) {
+        LinkTrace::Sample sample;
+        sample.at = std::chrono::seconds(second);
+        sample.rtt = second < 8 ? 40ms : 60ms;
+        sample.bitsPerSecond = 8000000;
+        sample.lossRate = lossRate;
+        trace.addSample(sample);
+    }
+    trace.addOutage(LinkTrace::Outage{5s, 2s});
+    return trace;
+}
+
+class TraceReplayProviderTest : public ::testing::Test {
+protected:
+    Common::ManualClock clock;
+};
+
+} // namespace
+
+TEST_F(TraceReplayProviderTest, DeliversAfterTraceRtt) {
+    TraceReplayProvider provider(handoverTrace(), clock);
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+    EXPECT_DOUBLE_EQ(provider.GetLatency(), 40.0);
+    EXPECT_EQ(provider.GetBandwidth(), 8000000u);
+    EXPECT_DOUBLE_EQ(provider.GetSignalStrength(), 1.0);
+
+    ASSERT_TRUE(provider.SendData(ByteVector(1000, 7)));
+    ByteVector received;
+    clock.advance(40ms);
+    EXPECT_FALSE(provider.ReceiveData(received));  // Plus 1 ms to serialize 1000 bytes
+    clock.advance(1ms);
+    ASSERT_TRUE(provider.ReceiveData(received));
+    EXPECT_EQ(received, ByteVector(1000, 7));
+    EXPECT_FALSE(provider.ReceiveData(received));
+}
+
+TEST_F(TraceReplayProviderTest, QueuesAtTraceCapacity) {
+    TraceReplayProvider provider(handoverTrace(), clock);
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+    // 40 KB is one BDP at 8 Mbit/s and 40 ms: 41 packets go through, one
+    // on the wire and 40 queued
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(provider.SendData(ByteVector(1000, static_cast<uint8_t>(i))));
+    }
+    EXPECT_EQ(provider.getStats().queueDrops, 9u);
+
+    // Drained at 1 ms per packet, in order
+    clock.advance(50ms);
+    ByteVector received;
+    int delivered = 0;
+    while (provider.ReceiveData(received)) {
+        EXPECT_EQ(received[0], delivered);
+        ++delivered;
+    }
+    EXPECT_EQ(delivered, 10);
+    clock.advance(1s);
+    while (provider.ReceiveData(received)) {
+        ++delivered;
+    }
+    EXPECT_EQ(delivered, 41);
+    EXPECT_EQ(provider.getStats().packetsDelivered, 41u);
+}
+
+TEST_F(TraceReplayProviderTest, OutageRefusesSendsAndLosesInFlight) {
+    TraceReplayProvider provider(handoverTrace(), clock);
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+    clock.advance(4980ms);
+    ASSERT_TRUE(provider.SendData(ByteVector(100)));  // Arrives in the outage
+
+    clock.advance(100ms);
+    EXPECT_TRUE(provider.inOutage());
+    EXPECT_EQ(provider.GetBandwidth(), 0u);
+    EXPECT_DOUBLE_EQ(provider.GetSignalStrength(), 0.0);
+    EXPECT_FALSE(provider.SendData(ByteVector(100)));
+    ByteVector received;
+    EXPECT_FALSE(provider.ReceiveData(received));
+    EXPECT_EQ(provider.getStats().outageDrops, 2u);
+
+    clock.advance(2s);
+    EXPECT_FALSE(provider.inOutage());
+    EXPECT_TRUE(provider.SendData(ByteVector(100)));
+    clock.advance(8s - 5080ms - 2s);
+    EXPECT_DOUBLE_EQ(provider.GetLatency(), 60.0);  // After the handover
+}
+
+TEST_F(TraceReplayProviderTest, RandomLossFollowsTrace) {
+    TraceReplayProvider provider(handoverTrace(0.1), clock);
+    ASSERT_TRUE(provider.Initialize({{"seed", "3"}}));
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+    for (int i = 0; i < 2000; ++i) {
+        ASSERT_TRUE(provider.SendData(ByteVector(100)));
+        clock.advance(1ms);
+    }
+    EXPECT_NEAR(static_cast<double>(provider.getStats().randomLosses), 200, 50);
+    EXPECT_NEAR(provider.GetSignalStrength(), 0.9, 1e-9);
+}
+
+TEST_F(TraceReplayProviderTest, LoopsUnlessToldNot) {
+    TraceReplayProvider looped(handoverTrace(), clock);
+    ASSERT_TRUE(looped.Connect("starlink-1"));
+    clock.advance(11s);
+    EXPECT_EQ(looped.getTracePosition(), 1s);
+
+    TraceReplayProvider held(handoverTrace(), clock);
+    ASSERT_TRUE(held.Initialize({{"loop", "false"}, {"start_ms", "8500"}}));
+    ASSERT_TRUE(held.Connect("starlink-1"));
+    clock.advance(10s);
+    EXPECT_EQ(held.getTracePosition(), 18500ms);
+    EXPECT_DOUBLE_EQ(held.GetLatency(), 60.0);
+}
+
+TEST_F(TraceReplayProviderTest, InitializesFromFileAndTakesCommands) {
+    std::string path = ::testing::TempDir() + "srpt_trace_replay_test.txt";
+    {
+        std::ofstream out(path);
+        out << "provider iridium\n0 1500 0.352 0\n60000 1800 0.352 0\noutage 30000 5000\n";
+    }
+    TraceReplayProvider provider(clock);
+    std::string response;
+    EXPECT_FALSE(provider.Initialize({}));
+    EXPECT_FALSE(provider.Initialize({{"trace", path + ".missing"}}));
+    ASSERT_TRUE(provider.Initialize({{"trace", path}})) << provider.getLastError();
+    std::remove(path.c_str());
+    EXPECT_EQ(provider.getTrace().getProvider(), "iridium");
+
+    EXPECT_FALSE(provider.ExecuteCommand("seek 31000", response));  // Not connected
+    ASSERT_TRUE(provider.Connect("iridium-1"));
+    ASSERT_TRUE(provider.ExecuteCommand("seek 31000", response));
+    EXPECT_TRUE(provider.inOutage());
+    ASSERT_TRUE(provider.ExecuteCommand("status", response));
+    EXPECT_NE(response.find("t=31000 ms"), std::string::npos) << response;
+    EXPECT_NE(response.find("outage=1"), std::string::npos) << response;
+    EXPECT_FALSE(provider.ExecuteCommand("reboot", response));
+}
+
+TEST_F(TraceReplayProviderTest, DrivesExistingPacerUnchanged) {
+    TraceReplayProvider provider(handoverTrace(), clock);
+    ASSERT_TRUE(provider.Connect("starlink-1"));
+    auto estimate = EstimatePathFromProvider(provider);
+    EXPECT_EQ(estimate.bandwidth, 1000000u);
+    EXPECT_EQ(estimate.rtt, 40ms);
+
+    CongestionControl::Bbr bbr(1000);
+    PacketPacer pacer(provider, bbr);
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(pacer.enqueue(ByteVector(1000)));
+    }
+    pacer.releaseDue(PacketPacer::Clock::now() + 1s);
+    EXPECT_GT(provider.getStats().packetsSent, 0u);
+    clock.advance(1s);
+    ByteVector received;
+    EXPECT_TRUE(provider.ReceiveData(received));
+}
@@ -0,0 +1,492 @@
+#include <gtest/gtest.h>
+#include "../../src/transport/event_loop.h"
+#include "../../src/transport/io_ring.h"
+#include "../../src/transport/udp_transport.h"
+#include "../../src/congestion_control/cubic.h"
+#include "../../include/srpt.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unistd.h>
+
+using namespace SRPT;
+using namespace SRPT::Transport;
+using namespace std::chrono_literals;
+
+enum class Backend { Single, Batched, IoUring };
+
+std::string backendName(const ::testing::TestParamInfo<Backend>& info) {
+    switch (info.param) {
+        case Backend::Single: return "Single";
+        case Backend::Batched: return "Batched";
+        case Backend::IoUring: return "IoUring";
+    }
+    return "";
+}
+
+UdpTransport::Options transportOptions(Backend backend, IoRing& ring) {
+    UdpTransport::Options options;
+    options.batching = backend != Backend::Single;
+    options.ring = backend == Backend::IoUring ? &ring : nullptr;
+    return options;
+}
+
+// Runs every transport test over each I/O backend
+class UdpTransportTest : public ::testing::TestWithParam<Backend> {
+protected:
+    EventLoop loop;
+    IoRing ring{loop};
+    UdpTransport server{loop, transportOptions(GetParam(), ring)};
+    UdpTransport client{loop, transportOptions(GetParam(), ring)};
+    SRPTConnection* accepted = nullptr;
+    std::vector<std::vector<uint8_t>> received;
+
+    void SetUp() override {
+        ASSERT_TRUE(loop.isValid());
+        if (GetParam() == Backend::IoUring && !ring.isValid()) {
+            GTEST_SKIP() << ring.getLastError();
+        }
+        ASSERT_TRUE(server.bind(Endpoint::loopback(0)));
+        ASSERT_TRUE(client.bind(Endpoint::loopback(0)));
+        server.listen([this](SRPTConnection& connection, const Endpoint&) {
+            accepted = &connection;
+            connection.setDataHandler([this](const std::vector<uint8_t>& data) {
+                received.push_back(data);
+            });
+        });
+    }
+
+    SRPTConnection* establish() {
+        SRPTConnection* connection = client.connect(Endpoint::loopback(server.localEndpoint().port()));
+        EXPECT_NE(connection, nullptr);
+        bool established = loop.runUntil([&]() {
+            return connection->getState() == SRPTConnectionState::ESTABLISHED &&
+                   accepted && accepted->getState() == SRPTConnectionState::ESTABLISHED;
+        }, 2s);
+        EXPECT_TRUE(established);
+        return connection;
+    }
+};
+
+TEST_P(UdpTransportTest, HandshakeOverLoopback) {
+    SRPTConnection* connection = establish();
+    ASSERT_NE(accepted, nullptr);
+    EXPECT_EQ(accepted->getConnectionId(), connection->getConnectionId());
+    EXPECT_EQ(server.getConnectionCount(), 1u);
+}
+
+TEST_P(UdpTransportTest, DataIsDeliveredAndAcknowledged) {
+    SRPTConnection* connection = establish();
+
+    for (uint8_t i = 0; i < 20; ++i) {
+        std::vector<uint8_t> payload(1000, i);
+        ASSERT_TRUE(connection->sendData(payload));
+    }
+    ASSERT_TRUE(loop.runUntil([&]() {
+        return received.size() == 20 && connection->getUnacknowledgedPacketCount() == 0;
+    }, 2s));
+
+    for (uint8_t i = 0; i < 20; ++i) {
+        EXPECT_EQ(received[i], std::vector<uint8_t>(1000, i));
+    }
+    EXPECT_EQ(server.getStats().decodeErrors, 0u);
+}
+
+TEST_P(UdpTransportTest, WindowUpdatesReopenSenderWindow) {
+    SRPTConnection* connection = establish();
+    connection->setReceiveWindowSize(4000);
+
+    size_t sent = 0;
+    ASSERT_TRUE(loop.runUntil([&]() {
+        std::vector<uint8_t> payload(1000, 0x5A);
+        while (sent < 50 && connection->sendData(payload)) {
+            ++sent;
+        }
+        return sent == 50 && received.size() == 50;
+    }, 5s));
+}
+
+TEST_P(UdpTransportTest, GracefulClose) {
+    SRPTConnection* connection = establish();
+    connection->setTimeWaitDuration(50ms);
+
+    ASSERT_TRUE(connection->initiateClose());
+    ASSERT_TRUE(loop.runUntil([&]() {
+        return accepted->getState() == SRPTConnectionState::CLOSE_WAIT &&
+               connection->getState() == SRPTConnectionState::FIN_WAIT_2;
+    }, 2s));
+
+    ASSERT_TRUE(accepted->close());
+    // TIME_WAIT is left on the loop's timer wheel
+    ASSERT_TRUE(loop.runUntil([&]() {
+        return accepted->getState() == SRPTConnectionState::CLOSED &&
+               connection->getState() == SRPTConnectionState::CLOSED;
+    }, 2s));
+}
+
+TEST_P(UdpTransportTest, CorruptDatagramIsCounted) {
+    UdpSocket raw;
+    ASSERT_TRUE(raw.open());
+    std::vector<uint8_t> garbage(32, 0xFF);
+    raw.sendTo(garbage.data(), garbage.size(), Endpoint::loopback(server.localEndpoint().port()));
+    ASSERT_TRUE(loop.runUntil([&]() { return server.getStats().packetsReceived == 1; }, 2s));
+    EXPECT_EQ(server.getStats().decodeErrors, 1u);
+    EXPECT_EQ(server.getConnectionCount(), 0u);
+}
+
+TEST_P(UdpTransportTest, BurstLargerThanBatch) {
+    SRPTConnection* connection = establish();
+    for (uint32_t i = 0; i < 100; ++i) {
+        std::vector<uint8_t> payload(300, static_cast<uint8_t>(i));
+        ASSERT_TRUE(connection->sendData(payload));
+    }
+    ASSERT_TRUE(loop.runUntil([&]() { return received.size() == 100; }, 2s));
+    for (uint32_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(received[i].front(), static_cast<uint8_t>(i));
+    }
+    if (GetParam() == Backend::Single) {
+        EXPECT_EQ(client.getStats().sendCalls, client.getStats().packetsSent);
+    } else {
+        EXPECT_LT(client.getStats().sendCalls, client.getStats().packetsSent);
+    }
+}
+
+TEST_P(UdpTransportTest, RejectedDatagramDoesNotTakeTheBatchWithIt) {
+    SRPTConnection* connection = establish();
+    // The IPv4 socket cannot reach an IPv6 peer; this SYN heads the batch
+    ASSERT_NE(client.connect(Endpoint::any(9, AF_INET6)), nullptr);
+    for (uint8_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(connection->sendData(std::vector<uint8_t>(100, i)));
+    }
+    ASSERT_TRUE(loop.runUntil([&]() { return received.size() == 10; }, 2s));
+    for (uint8_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(received[i], std::vector<uint8_t>(100, i));
+    }
+    EXPECT_GE(client.getStats().sendErrors, 1u);
+}
+
+TEST_P(UdpTransportTest, QueuedPacketsAreSentOnShutdown) {
+    auto leaving = std::make_unique<UdpTransport>(loop, transportOptions(GetParam(), ring));
+    ASSERT_TRUE(leaving->bind(Endpoint::loopback(0)));
+    SRPTConnection* connection = leaving->connect(Endpoint::loopback(server.localEndpoint().port()));
+    ASSERT_NE(connection, nullptr);
+    ASSERT_TRUE(loop.runUntil([&]() {
+        return connection->getState() == SRPTConnectionState::ESTABLISHED &&
+               accepted && accepted->getState() == SRPTConnectionState::ESTABLISHED;
+    }, 2s));
+
+    for (uint8_t i = 0; i < 5; ++i) {
+        ASSERT_TRUE(connection->sendData(std::vector<uint8_t>(100, i)));
+    }
+    leaving.reset();  // Before the loop gets to flush them
+    ASSERT_TRUE(loop.runUntil([&]() { return received.size() == 5; }, 2s));
+}
+
+TEST_P(UdpTransportTest, FullSendQueueRefusesPackets) {
+    if (GetParam() == Backend::Single) {
+        GTEST_SKIP() << "Packets are sent without queueing";
+    }
+    UdpTransport::Options options = transportOptions(GetParam(), ring);
+    options.sendQueueLimit = 4;
+    UdpTransport limited(loop, options);
+    ASSERT_TRUE(limited.bind(Endpoint::loopback(0)));
+    SRPTConnection* connection = limited.connect(Endpoint::loopback(server.localEndpoint().port()));
+    ASSERT_NE(connection, nullptr);
+    ASSERT_TRUE(loop.runUntil([&]() {
+        return connection->getState() == SRPTConnectionState::ESTABLISHED &&
+               accepted && accepted->getState() == SRPTConnectionState::ESTABLISHED;
+    }, 2s));
+
+    // Nothing is flushed until the loop runs again
+    for (uint8_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(connection->sendData(std::vector<uint8_t>(100, i)));
+    }
+    EXPECT_FALSE(connection->sendData(std::vector<uint8_t>(100, 4)));
+    EXPECT_EQ(limited.getLastError(), "Send queue full");
+    EXPECT_EQ(limited.getStats().sendErrors, 1u);
+
+    // Queued packets are never dropped, and the queue drains
+    ASSERT_TRUE(loop.runUntil([&]() { return received.size() == 4; }, 2s));
+    EXPECT_TRUE(connection->sendData(std::vector<uint8_t>(100, 4)));
+    ASSERT_TRUE(loop.runUntil([&]() { return received.size() == 5; }, 2s));
+    EXPECT_EQ(received.back(), std::vector<uint8_t>(100, 4));
+}
+
+TEST_P(UdpTransportTest, KernelPacedDataIsStampedAndDelivered) {
+    UdpTransport::Options options = transportOptions(GetParam(), ring);
+    options.kernelPacing = true;
+    UdpTransport pacedServer(loop, options);
+    UdpTransport pacedClient(loop, options);
+    ASSERT_TRUE(pacedServer.bind(Endpoint::loopback(0)));
+    ASSERT_TRUE(pacedClient.bind(Endpoint::loopback(0)));
+    if (!pacedClient.kernelPacingActive()) {
+        GTEST_SKIP() << "SO_TXTIME unsupported";
+    }
+    size_t delivered = 0;
+    pacedServer.listen([&](SRPTConnection& connection, const Endpoint&) {
+        connection.setDataHandler([&](const std::vector<uint8_t>&) { ++delivered; });
+    });
+    Endpoint peer = Endpoint::loopback(pacedServer.localEndpoint().port());
+    SRPTConnection* connection = pacedClient.connect(peer);
+    ASSERT_TRUE(loop.runUntil([&]() { return connection->getState() == SRPTConnectionState::ESTABLISHED; }, 2s));
+
+    // Only DATA packets are paced; loopback ignores the stamps
+    size_t scheduled = 0;
+    auto release = std::chrono::steady_clock::now();
+    pacedClient.setReleaseScheduler(peer, [&](size_t) {
+        ++scheduled;
+        return release += 100us;
+    });
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(connection->sendData(std::vector<uint8_t>(200, static_cast<uint8_t>(i))));
+    }
+    ASSERT_TRUE(loop.runUntil([&]() { return delivered == 20; }, 2s));
+    EXPECT_EQ(scheduled, 20u);
+    EXPECT_EQ(pacedClient.getStats().sendErrors, 0u);
+}
+
+TEST_P(UdpTransportTest, CubicPacesKernelStampedData) {
+    UdpTransport::Options options = transportOptions(GetParam(), ring);
+    options.kernelPacing = true;
+    UdpTransport pacedServer(loop, options);
+    UdpTransport pacedClient(loop, options);
+    ASSERT_TRUE(pacedServer.bind(Endpoint::loopback(0)));
+    ASSERT_TRUE(pacedClient.bind(Endpoint::loopback(0)));
+    if (!pacedClient.kernelPacingActive()) {
+        GTEST_SKIP() << "SO_TXTIME unsupported";
+    }
+    size_t delivered = 0;
+    pacedServer.listen([&](SRPTConnection& connection, const Endpoint&) {
+        connection.setDataHandler([&](const std::vector<uint8_t>&) { ++delivered; });
+    });
+    Endpoint peer = Endpoint::loopback(pacedServer.localEndpoint().port());
+    SRPTConnection* connection = pacedClient.connect(peer);
+    ASSERT_TRUE(loop.runUntil([&]() { return connection->getState() == SRPTConnectionState::ESTABLISHED; }, 2s));
+
+    CongestionControl::Cubic cubic;
+    std::vector<std::chrono::steady_clock::time_point> releases;
+    pacedClient.setReleaseScheduler(peer, [&](size_t) {
+        releases.push_back(cubic.schedulePacedSend(1));
+        return releases.back();
+    });
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(connection->sendData(std::vector<uint8_t>(1000, static_cast<uint8_t>(i))));
+    }
+    ASSERT_TRUE(loop.runUntil([&]() { return delivered == 8; }, 2s));
+
+    // One packet of Cubic's window per datagram, at least a pacing interval apart
+    ASSERT_EQ(releases.size(), 8u);
+    EXPECT_EQ(cubic.getBytes_in_flight(), 8u);
+    EXPECT_TRUE(cubic.hasWindowFor(1));
+    for (size_t i = 1; i < releases.size(); ++i) {
+        EXPECT_GE(releases[i] - releases[i - 1], cubic.getPacingInterval());
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, UdpTransportTest,
+                         ::testing::Values(Backend::Single, Backend::Batched, Backend::IoUring), backendName);
+
+TEST(IoRingTest, ReadsFileIntoTransportAndWritesReassembledFile) {
+    EventLoop loop;
+    IoRing ring(loop);
+    if (!ring.isValid()) {
+        GTEST_SKIP() << ring.getLastError();
+    }
+    UdpTransport::Options options;
+    options.ring = &ring;
+    UdpTransport server(loop, options);
+    UdpTransport client(loop, options);
+    ASSERT_TRUE(server.bind(Endpoint::loopback(0)));
+
+    char sourcePath[] = "/tmp/srpt_ring_source_XXXXXX";
+    char sinkPath[] = "/tmp/srpt_ring_sink_XXXXXX";
+    int source = mkstemp(sourcePath);
+    int sink = mkstemp(sinkPath);
+    ASSERT_GE(source, 0);
+    ASSERT_GE(sink, 0);
+    std::vector<uint8_t> contents(64 * 1000);
+    std::iota(contents.begin(), contents.end(), 0);
+    ASSERT_EQ(::write(source, contents.data(), contents.size()), static_cast<ssize_t>(contents.size()));
+
+    // Receiver: write each chunk at its offset as soon as it arrives
+    const size_t chunkSize = 1000;
+    size_t written = 0;
+    std::vector<std::vector<uint8_t>> inFlight;
+    uint32_t nextChunk = 0;
+    server.listen([&](SRPTConnection& connection, const Endpoint&) {
+        connection.setDataHandler([&](const std::vector<uint8_t>& data) {
+            inFlight.push_back(data);
+            uint64_t offset = static_cast<uint64_t>(nextChunk++) * chunkSize;
+            ASSERT_TRUE(ring.writeFile(sink, offset, inFlight.back().data(), data.size(), [&](ssize_t result) {
+                ASSERT_GT(result, 0);
+                written += static_cast<size_t>(result);
+            }));
+        });
+    });
+
+    SRPTConnection* connection = client.connect(Endpoint::loopback(server.localEndpoint().port()));
+    ASSERT_TRUE(loop.runUntil([&]() { return connection->getState() == SRPTConnectionState::ESTABLISHED; }, 2s));
+
+    // Sender: read chunks from disk on the same ring and send them
+    std::vector<std::vector<uint8_t>> chunks(contents.size() / chunkSize, std::vector<uint8_t>(chunkSize));
+    std::vector<bool> loaded(chunks.size(), false);
+    size_t sent = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        ASSERT_TRUE(ring.readFile(source, i * chunkSize, chunks[i].data(), chunkSize, [&, i](ssize_t result) {
+            ASSERT_EQ(result, static_cast<ssize_t>(chunkSize));
+            loaded[i] = true;
+            // Reads may complete out of order; send in file order
+            while (sent < chunks.size() && loaded[sent]) {
+                EXPECT_TRUE(connection->sendData(chunks[sent]));
+                ++sent;
+            }
+        }));
+    }
+    ASSERT_TRUE(loop.runUntil([&]() { return written == contents.size(); }, 5s));
+
+    std::vector<uint8_t> result(contents.size());
+    ASSERT_EQ(::pread(sink, result.data(), result.size(), 0), static_cast<ssize_t>(result.size()));
+    EXPECT_EQ(result, contents);
+    EXPECT_LT(ring.getStats().enterCalls, ring.getStats().completions);
+
+    ::close(source);
+    ::close(sink);
+    std::remove(sourcePath);
+    std::remove(sinkPath);
+}
+
+TEST(UdpSocketTest, BatchedSendAndReceiveKeepDatagramBoundaries) {
+    UdpSocket receiver;
+    UdpSocket sender;
+    ASSERT_TRUE(receiver.bind(Endpoint::loopback(0)));
+    ASSERT_TRUE(sender.bind(Endpoint::loopback(0)));
+    receiver.setBufferSizes(1 << 20, 1 << 20);
+    sender.enableGso();
+    receiver.enableGro();
+
+    // Equal-sized runs with a short tail, as GSO coalesces them
+    Endpoint peer = receiver.localEndpoint();
+    std::vector<std::vector<uint8_t>> payloads;
+    for (int i = 0; i < 40; ++i) {
+        payloads.emplace_back(i == 39 ? 100 : 1200, static_cast<uint8_t>(i));
+    }
+    std::vector<DatagramRef> refs;
+    for (const auto& payload : payloads) {
+        refs.push_back(DatagramRef{&peer, payload.data(), payload.size()});
+    }
+    ASSERT_EQ(sender.sendBatch(refs.data(), refs.size()), 40);
+
+    ReceiveBatch batch(8);
+    std::vector<std::vector<uint8_t>> received;
+    auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (received.size() < payloads.size() && std::chrono::steady_clock::now() < deadline) {
+        if (receiver.receiveBatch(batch) < 0) {
+            ASSERT_TRUE(receiver.wouldBlock()) << receiver.getLastError();
+            std::this_thread::sleep_for(1ms);
+            continue;
+        }
+        for (const auto& datagram : batch.datagrams()) {
+            EXPECT_EQ(*datagram.peer, sender.localEndpoint());
+            received.emplace_back(datagram.data, datagram.data + datagram.size);
+        }
+    }
+    EXPECT_EQ(received, payloads);
+}
+
+TEST(UdpSocketTest, TxTimeStampedBatchIsSent) {
+    UdpSocket receiver;
+    UdpSocket sender;
+    ASSERT_TRUE(receiver.bind(Endpoint::loopback(0)));
+    ASSERT_TRUE(sender.bind(Endpoint::loopback(0)));
+    sender.enableGso();
+    if (!sender.enableTxTime()) {
+        GTEST_SKIP() << sender.getLastError();
+    }
+
+    // Distinct release times must not be coalesced into one GSO message
+    Endpoint peer = receiver.localEndpoint();
+    std::vector<uint8_t> payload(500, 0x33);
+    auto now = std::chrono::steady_clock::now();
+    std::vector<DatagramRef> refs;
+    for (int i = 0; i < 8; ++i) {
+        refs.push_back(DatagramRef{&peer, payload.data(), payload.size(), UdpSocket::txTimeFor(now + i * 50us)});
+    }
+    ASSERT_EQ(sender.sendBatch(refs.data(), refs.size()), 8) << sender.getLastError();
+    ASSERT_GT(sender.sendTo(payload.data(), payload.size(), peer, UdpSocket::txTimeFor(now + 1ms)), 0);
+
+    std::vector<uint8_t> buffer(2048);
+    size_t received = 0;
+    auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (received < 9 && std::chrono::steady_clock::now() < deadline) {
+        Endpoint from;
+        ssize_t size = receiver.receiveFrom(buffer.data(), buffer.size(), from);
+        if (size < 0) {
+            std::this_thread::sleep_for(1ms);
+            continue;
+        }
+        EXPECT_EQ(static_cast<size_t>(size), payload.size());
+        ++received;
+    }
+    EXPECT_EQ(received, 9u);
+}
+
+TEST(EventLoopTest, PostedTasksAndTimersRun) {
+    EventLoop loop;
+    bool posted = false;
+    bool timer = false;
+    std::thread other([&]() { loop.post([&]() { posted = true; }); });
+    other.join();
+    loop.timers().schedule(20ms, [&]() { timer = true; });
+    EXPECT_TRUE(loop.runUntil([&]() { return posted && timer; }, 1s));
+}
+
+TEST(EventLoopTest, DeferredTasksRunAfterIteration) {
+    EventLoop loop;
+    std::vector<int> order;
+    loop.post([&]() {
+        loop.defer([&]() { order.push_back(2); });
+        order.push_back(1);
+    });
+    loop.runOnce(100ms);
+    EXPECT_EQ(order, (std::vector<int>{1, 2}));
+}
+
+TEST(SessionTest, TransfersOverLoopback) {
+    Config config;
+    config.setMaxPacketSize(512);
+
+    Session listener(config);
+    ASSERT_TRUE(listener.Listen(0)) << listener.GetLastError();
+    const uint16_t port = listener.GetLocalPort();
+    ASSERT_NE(port, 0);
+
+    // The callback runs on the sender's loop thread, so it must outlive it
+    std::promise<bool> connected;
+    std::future<bool> connectedCallback = connected.get_future();
+    std::once_flag reported;
+    Session sender(config);
+    sender.SetConnectionCallback([&](bool ok) {
+        std::call_once(reported, [&]() { connected.set_value(ok); });
+    });
+    ASSERT_TRUE(sender.Connect("127.0.0.1", port)) << sender.GetLastError();
+    EXPECT_TRUE(sender.IsEstablished());
+
+    ByteVector message(3000);
+    std::iota(message.begin(), message.end(), 0);
+    auto out = sender.CreateStream();
+    ASSERT_TRUE(out->Write(message));
+
+    auto in = listener.CreateStream();
+    ByteVector assembled;
+    while (assembled.size() < message.size()) {
+        ByteVector piece;
+        ASSERT_TRUE(in->Read(piece));
+        assembled.insert(assembled.end(), piece.begin(), piece.end());
+    }
+    EXPECT_EQ(assembled, message);
+    ASSERT_EQ(connectedCallback.wait_for(2s), std::future_status::ready);
+    EXPECT_TRUE(connectedCallback.get());
+}